@@ -0,0 +1,75 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "BenchmarkOptions.h"
+
+#include <iostream>
+
+namespace Homegear::Benchmarks {
+
+BenchmarkOptions::BenchmarkOptions(int argc, char *argv[], int firstArgument) {
+  for (int i = firstArgument; i < argc; i++) {
+    std::string argument(argv[i]);
+    if (argument.compare(0, 2, "--") != 0) {
+      std::cerr << "Invalid argument: " << argument << std::endl;
+      _valid = false;
+      continue;
+    }
+    auto separatorPosition = argument.find('=');
+    if (separatorPosition == std::string::npos) _options[argument.substr(2)] = "true";
+    else _options[argument.substr(2, separatorPosition - 2)] = argument.substr(separatorPosition + 1);
+  }
+}
+
+std::string BenchmarkOptions::getString(const std::string &name, const std::string &defaultValue) const {
+  auto optionIterator = _options.find(name);
+  if (optionIterator == _options.end()) return defaultValue;
+  return optionIterator->second;
+}
+
+int64_t BenchmarkOptions::getInteger(const std::string &name, int64_t defaultValue) const {
+  auto optionIterator = _options.find(name);
+  if (optionIterator == _options.end()) return defaultValue;
+  try {
+    return std::stoll(optionIterator->second);
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Invalid value for option \"" << name << "\". Using default value " << defaultValue << "." << std::endl;
+  }
+  return defaultValue;
+}
+
+bool BenchmarkOptions::getBoolean(const std::string &name, bool defaultValue) const {
+  auto optionIterator = _options.find(name);
+  if (optionIterator == _options.end()) return defaultValue;
+  return optionIterator->second == "true" || optionIterator->second == "on" || optionIterator->second == "1";
+}
+
+}
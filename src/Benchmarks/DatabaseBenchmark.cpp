@@ -0,0 +1,382 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "DatabaseBenchmark.h"
+#include "LatencyStatistics.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace Homegear::Benchmarks {
+
+namespace {
+
+int64_t getTimeNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+DatabaseBenchmark::DatabaseBenchmark(const BenchmarkOptions &options) {
+  _rows = options.getInteger("rows", 10000);
+  if (_rows < 1) _rows = 1;
+  _duration = options.getInteger("duration", 5);
+  if (_duration < 1) _duration = 1;
+  _readers = options.getInteger("readers", 4);
+  if (_readers < 1) _readers = 1;
+  _operations = options.getInteger("operations", 10000);
+  if (_operations < 1) _operations = 1;
+  _writeMode = options.getString("mode", "all");
+  if (_writeMode != "all" && _writeMode != "statement" && _writeMode != "prepared" && _writeMode != "transaction" && _writeMode != "savepoint") {
+    std::cerr << "Unknown write mode \"" << _writeMode << "\". Using \"all\"." << std::endl;
+    _writeMode = "all";
+  }
+  _synchronous = options.getBoolean("synchronous", true);
+  _journalMode = options.getString("journal", "wal");
+  if (_journalMode != "wal" && _journalMode != "delete" && _journalMode != "memory") {
+    std::cerr << "Unknown journal mode \"" << _journalMode << "\". Using \"wal\"." << std::endl;
+    _journalMode = "wal";
+  }
+}
+
+DatabaseBenchmark::~DatabaseBenchmark() {
+  deleteDatabase();
+}
+
+bool DatabaseBenchmark::execute(sqlite3 *database, const std::string &command) {
+  char *errorMessage = nullptr;
+  sqlite3_exec(database, command.c_str(), nullptr, nullptr, &errorMessage);
+  if (errorMessage) {
+    std::cerr << "Can't execute \"" << command << "\": " << errorMessage << std::endl;
+    sqlite3_free(errorMessage);
+    return false;
+  }
+  return true;
+}
+
+sqlite3 *DatabaseBenchmark::openDatabase(bool readOnly) {
+  sqlite3 *database = nullptr;
+  int result = sqlite3_open_v2(_databasePath.c_str(), &database, readOnly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE), nullptr);
+  if (result || !database) {
+    std::cerr << "Can't open database: " << (database ? sqlite3_errmsg(database) : "unknown error") << std::endl;
+    if (database) sqlite3_close(database);
+    return nullptr;
+  }
+  sqlite3_busy_timeout(database, 5000);
+  if (!readOnly) {
+    execute(database, std::string("PRAGMA synchronous=") + (_synchronous ? "FULL" : "OFF"));
+    execute(database, "PRAGMA journal_mode=" + _journalMode);
+  }
+  return database;
+}
+
+void DatabaseBenchmark::closeDatabase(sqlite3 *database) {
+  if (database) sqlite3_close(database);
+}
+
+bool DatabaseBenchmark::createDatabase() {
+  deleteDatabase();
+  char path[] = "/tmp/homegear-benchmark-XXXXXX";
+  int fileDescriptor = mkstemp(path);
+  if (fileDescriptor == -1) {
+    std::cerr << "Can't create temporary database file." << std::endl;
+    return false;
+  }
+  close(fileDescriptor);
+  _databasePath = path;
+
+  auto database = openDatabase(false);
+  if (!database) return false;
+  bool success = execute(database,
+                         "CREATE TABLE IF NOT EXISTS parameters (parameterID INTEGER PRIMARY KEY UNIQUE, peerID INTEGER NOT NULL, parameterSetType INTEGER NOT NULL, peerChannel INTEGER NOT NULL, remotePeer INTEGER, remoteChannel INTEGER, parameterName TEXT, value BLOB, room INTEGER, buildingPart INTEGER, categories TEXT, roles TEXT, specialType INTEGER, metadata BLOB)")
+      && execute(database, "CREATE INDEX IF NOT EXISTS parametersIndex ON parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, specialType)");
+  if (success) {
+    sqlite3_stmt *statement = nullptr;
+    execute(database, "BEGIN IMMEDIATE");
+    sqlite3_prepare_v2(database, "INSERT INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, nullptr);
+    std::vector<uint8_t> value{0, 1, 2, 3, 4, 5, 6, 7};
+    for (int64_t i = 1; i <= _rows; i++) {
+      std::string name = "PARAMETER" + std::to_string(i % 50);
+      sqlite3_bind_int64(statement, 1, i);
+      sqlite3_bind_int64(statement, 2, i / 50 + 1);
+      sqlite3_bind_int64(statement, 3, 1);
+      sqlite3_bind_int64(statement, 4, i % 5);
+      sqlite3_bind_int64(statement, 5, 0);
+      sqlite3_bind_int64(statement, 6, -1);
+      sqlite3_bind_text(statement, 7, name.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_bind_blob(statement, 8, value.data(), value.size(), SQLITE_STATIC);
+      if (sqlite3_step(statement) != SQLITE_DONE) {
+        std::cerr << "Can't insert row: " << sqlite3_errmsg(database) << std::endl;
+        success = false;
+        break;
+      }
+      sqlite3_reset(statement);
+    }
+    sqlite3_finalize(statement);
+    execute(database, "COMMIT");
+  }
+  closeDatabase(database);
+  return success;
+}
+
+void DatabaseBenchmark::deleteDatabase() {
+  if (_databasePath.empty()) return;
+  unlink(_databasePath.c_str());
+  unlink((_databasePath + "-wal").c_str());
+  unlink((_databasePath + "-shm").c_str());
+  unlink((_databasePath + "-journal").c_str());
+  _databasePath.clear();
+}
+
+int DatabaseBenchmark::readLatency() {
+  std::cout << "Read latency under write load: " << _rows << " rows, " << _readers << " readers, " << _duration << " s per run, synchronous=" << (_synchronous ? "on" : "off") << ", journal=" << _journalMode << std::endl;
+  if (!createDatabase()) return 1;
+  std::cout << "Shared connection:" << std::endl;
+  runReadLatency(true);
+  if (_journalMode == "wal") {
+    std::cout << "Writing connection and read only connections:" << std::endl;
+    runReadLatency(false);
+  } else std::cout << "Read only connections require journal mode \"wal\". Skipping." << std::endl;
+  return 0;
+}
+
+void DatabaseBenchmark::runReadLatency(bool sharedConnection) {
+  std::atomic_bool stop{false};
+  std::mutex sharedConnectionMutex;
+  sqlite3 *sharedDatabase = sharedConnection ? openDatabase(false) : nullptr;
+  if (sharedConnection && !sharedDatabase) return;
+
+  LatencyStatistics writeStatistics;
+  std::vector<LatencyStatistics> readStatistics(_readers);
+
+  auto writer = [&]() {
+    sqlite3 *database = sharedConnection ? sharedDatabase : openDatabase(false);
+    if (!database) return;
+    sqlite3_stmt *statement = nullptr;
+    {
+      std::unique_lock<std::mutex> databaseGuard(sharedConnectionMutex, std::defer_lock);
+      if (sharedConnection) databaseGuard.lock();
+      sqlite3_prepare_v2(database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, nullptr);
+    }
+    std::mt19937_64 random(1);
+    std::uniform_int_distribution<int64_t> rowDistribution(1, _rows);
+    std::vector<uint8_t> value{0, 1, 2, 3, 4, 5, 6, 7};
+    while (!stop) {
+      value.at(0)++;
+      auto startTime = getTimeNanoseconds();
+      {
+        std::unique_lock<std::mutex> databaseGuard(sharedConnectionMutex, std::defer_lock);
+        if (sharedConnection) databaseGuard.lock();
+        sqlite3_bind_blob(statement, 1, value.data(), value.size(), SQLITE_STATIC);
+        sqlite3_bind_int64(statement, 2, rowDistribution(random));
+        sqlite3_step(statement);
+        sqlite3_reset(statement);
+      }
+      writeStatistics.add(getTimeNanoseconds() - startTime);
+    }
+    {
+      std::unique_lock<std::mutex> databaseGuard(sharedConnectionMutex, std::defer_lock);
+      if (sharedConnection) databaseGuard.lock();
+      sqlite3_finalize(statement);
+    }
+    if (!sharedConnection) closeDatabase(database);
+  };
+
+  auto reader = [&](int64_t index) {
+    sqlite3 *database = sharedConnection ? sharedDatabase : openDatabase(true);
+    if (!database) return;
+    sqlite3_stmt *statement = nullptr;
+    {
+      std::unique_lock<std::mutex> databaseGuard(sharedConnectionMutex, std::defer_lock);
+      if (sharedConnection) databaseGuard.lock();
+      sqlite3_prepare_v2(database, "SELECT * FROM parameters WHERE peerID=?", -1, &statement, nullptr);
+    }
+    std::mt19937_64 random(index + 2);
+    std::uniform_int_distribution<int64_t> peerDistribution(1, peerCount(_rows));
+    while (!stop) {
+      auto startTime = getTimeNanoseconds();
+      {
+        std::unique_lock<std::mutex> databaseGuard(sharedConnectionMutex, std::defer_lock);
+        if (sharedConnection) databaseGuard.lock();
+        sqlite3_bind_int64(statement, 1, peerDistribution(random));
+        while (sqlite3_step(statement) == SQLITE_ROW) {
+          sqlite3_column_blob(statement, 7);
+        }
+        sqlite3_reset(statement);
+      }
+      readStatistics.at(index).add(getTimeNanoseconds() - startTime);
+    }
+    {
+      std::unique_lock<std::mutex> databaseGuard(sharedConnectionMutex, std::defer_lock);
+      if (sharedConnection) databaseGuard.lock();
+      sqlite3_finalize(statement);
+    }
+    if (!sharedConnection) closeDatabase(database);
+  };
+
+  auto startTime = getTimeNanoseconds();
+  std::vector<std::thread> threads;
+  threads.emplace_back(writer);
+  for (int64_t i = 0; i < _readers; i++) {
+    threads.emplace_back(reader, i);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(_duration));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto duration = getTimeNanoseconds() - startTime;
+
+  LatencyStatistics allReads;
+  for (auto &statistics : readStatistics) {
+    allReads.merge(statistics);
+  }
+  std::cout << "  " << allReads.summary("reads", duration) << std::endl;
+  std::cout << "  " << writeStatistics.summary("writes", duration) << std::endl;
+
+  if (sharedDatabase) closeDatabase(sharedDatabase);
+}
+
+int DatabaseBenchmark::write() {
+  std::cout << "Writes: " << _rows << " existing rows, " << _operations << " operations per run, synchronous=" << (_synchronous ? "on" : "off") << ", journal=" << _journalMode << std::endl;
+  if (!createDatabase()) return 1;
+  const std::vector<std::pair<std::string, WriteMode>> modes{{"statement", WriteMode::statement}, {"prepared", WriteMode::prepared}, {"transaction", WriteMode::transaction}, {"savepoint", WriteMode::savepoint}};
+  for (auto &mode : modes) {
+    if (_writeMode != "all" && _writeMode != mode.first) continue;
+    std::cout << "Mode \"" << mode.first << "\":" << std::endl;
+    runWrite(mode.second);
+  }
+  return 0;
+}
+
+void DatabaseBenchmark::runWrite(WriteMode mode) {
+  static const std::string kReplaceCommand("REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES(?, ?, ?, ?, ?, ?, ?, ?)");
+  static const std::string kUpdateCommand("UPDATE parameters SET value=? WHERE parameterID=?");
+  static const int64_t kPeerId = 10000000;
+
+  sqlite3 *database = openDatabase(false);
+  if (!database) return;
+
+  sqlite3_stmt *replaceStatement = nullptr;
+  sqlite3_stmt *updateStatement = nullptr;
+  if (mode != WriteMode::statement) {
+    if (sqlite3_prepare_v2(database, kReplaceCommand.c_str(), -1, &replaceStatement, nullptr) != SQLITE_OK || sqlite3_prepare_v2(database, kUpdateCommand.c_str(), -1, &updateStatement, nullptr) != SQLITE_OK) {
+      std::cerr << "Can't prepare statement: " << sqlite3_errmsg(database) << std::endl;
+      sqlite3_finalize(replaceStatement);
+      sqlite3_finalize(updateStatement);
+      closeDatabase(database);
+      return;
+    }
+  }
+
+  auto begin = [&]() {
+    if (mode == WriteMode::transaction) execute(database, "BEGIN IMMEDIATE");
+    else if (mode == WriteMode::savepoint) execute(database, "SAVEPOINT benchmark");
+  };
+  auto end = [&]() {
+    if (mode == WriteMode::transaction) execute(database, "COMMIT");
+    else if (mode == WriteMode::savepoint) execute(database, "RELEASE benchmark");
+  };
+  //Without a prepared statement, every write is compiled again like an uncached call of SQLite3::executeWriteCommand().
+  auto step = [&](sqlite3_stmt *preparedStatement, const std::string &command, const std::function<void(sqlite3_stmt *)> &bind) {
+    sqlite3_stmt *statement = preparedStatement;
+    if (!statement && sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+      std::cerr << "Can't prepare statement: " << sqlite3_errmsg(database) << std::endl;
+      return false;
+    }
+    bind(statement);
+    bool success = sqlite3_step(statement) == SQLITE_DONE;
+    if (!success) std::cerr << "Can't execute statement: " << sqlite3_errmsg(database) << std::endl;
+    if (preparedStatement) {
+      sqlite3_clear_bindings(statement);
+      sqlite3_reset(statement);
+    } else sqlite3_finalize(statement);
+    return success;
+  };
+
+  std::vector<uint8_t> value{0};
+  std::vector<int64_t> ids;
+  ids.reserve(_operations);
+
+  LatencyStatistics replaceStatistics;
+  auto startTime = getTimeNanoseconds();
+  begin();
+  for (int64_t i = 0; i < _operations; i++) {
+    std::string name = "TEST" + std::to_string(i);
+    value.at(0) = (uint8_t)(i % 256);
+    auto operationStartTime = getTimeNanoseconds();
+    bool success = step(replaceStatement, kReplaceCommand, [&](sqlite3_stmt *statement) {
+      sqlite3_bind_null(statement, 1);
+      sqlite3_bind_int64(statement, 2, kPeerId);
+      sqlite3_bind_int64(statement, 3, 1);
+      sqlite3_bind_int64(statement, 4, 2);
+      sqlite3_bind_int64(statement, 5, 0);
+      sqlite3_bind_int64(statement, 6, 0);
+      sqlite3_bind_text(statement, 7, name.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_blob(statement, 8, value.data(), value.size(), SQLITE_STATIC);
+    });
+    replaceStatistics.add(getTimeNanoseconds() - operationStartTime);
+    if (!success) break;
+    ids.push_back(sqlite3_last_insert_rowid(database));
+  }
+  end();
+  std::cout << "  " << replaceStatistics.summary("REPLACE", getTimeNanoseconds() - startTime) << std::endl;
+
+  LatencyStatistics updateStatistics;
+  startTime = getTimeNanoseconds();
+  begin();
+  for (size_t i = 0; i < ids.size(); i++) {
+    value.at(0) = (uint8_t)((i + 1) % 256);
+    auto operationStartTime = getTimeNanoseconds();
+    bool success = step(updateStatement, kUpdateCommand, [&](sqlite3_stmt *statement) {
+      sqlite3_bind_blob(statement, 1, value.data(), value.size(), SQLITE_STATIC);
+      sqlite3_bind_int64(statement, 2, ids.at(i));
+    });
+    updateStatistics.add(getTimeNanoseconds() - operationStartTime);
+    if (!success) break;
+  }
+  end();
+  std::cout << "  " << updateStatistics.summary("UPDATE", getTimeNanoseconds() - startTime) << std::endl;
+
+  sqlite3_finalize(replaceStatement);
+  sqlite3_finalize(updateStatement);
+  execute(database, "DELETE FROM parameters WHERE peerID=" + std::to_string(kPeerId));
+  closeDatabase(database);
+}
+
+}
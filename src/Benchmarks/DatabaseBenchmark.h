@@ -0,0 +1,109 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_BENCHMARKS_DATABASEBENCHMARK_H_
+#define HOMEGEAR_BENCHMARKS_DATABASEBENCHMARK_H_
+
+#include "BenchmarkOptions.h"
+
+#include <string>
+
+#include <sqlite3.h>
+
+namespace Homegear::Benchmarks {
+
+/**
+ * SQLite benchmarks using the table layout and statements of DatabaseController. They run against a temporary
+ * database, which is deleted afterwards.
+ *
+ * Options:
+ *   --rows=<n>             Number of rows in the parameters table (default: 10000).
+ *   --duration=<seconds>   Duration of timed runs (default: 5).
+ *   --readers=<n>          Number of reading threads (default: 4).
+ *   --synchronous=<on|off> Value of "PRAGMA synchronous" (default: on).
+ *   --journal=<mode>       Journal mode: wal, delete or memory (default: wal).
+ */
+class DatabaseBenchmark {
+ public:
+  explicit DatabaseBenchmark(const BenchmarkOptions &options);
+  virtual ~DatabaseBenchmark();
+
+  /**
+   * Measures the latency of "getPeerParameters" like SELECT statements while another thread continuously writes
+   * single values. Compares one connection shared by all threads with one writing connection and one read only
+   * connection per reading thread.
+   */
+  int readLatency();
+
+  /**
+   * Measures inserts (REPLACE) and updates of single parameters, executed as individually prepared statements, as
+   * prepared statements, within one transaction and within one savepoint.
+   */
+  int write();
+ private:
+  enum class WriteMode {
+    statement,
+    prepared,
+    transaction,
+    savepoint
+  };
+
+  int64_t _rows = 10000;
+  int64_t _operations = 10000;
+  std::string _writeMode = "all";
+  int64_t _duration = 5;
+  int64_t _readers = 4;
+  bool _synchronous = true;
+  std::string _journalMode = "wal";
+  std::string _databasePath;
+
+  sqlite3 *openDatabase(bool readOnly);
+  void closeDatabase(sqlite3 *database);
+  bool createDatabase();
+  void deleteDatabase();
+  static bool execute(sqlite3 *database, const std::string &command);
+  static int64_t peerCount(int64_t rows) { return rows / 50 + 1; }
+
+  /**
+   * Runs one writing and _readers reading threads for _duration seconds.
+   *
+   * @param sharedConnection When true, all threads use one connection protected by a mutex.
+   */
+  void runReadLatency(bool sharedConnection);
+
+  /**
+   * Inserts and then updates _operations parameters of a new peer and deletes them afterwards.
+   */
+  void runWrite(WriteMode mode);
+};
+
+}
+
+#endif
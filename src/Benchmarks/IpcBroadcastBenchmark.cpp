@@ -0,0 +1,163 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "IpcBroadcastBenchmark.h"
+#include "LatencyStatistics.h"
+#include "../RPC/BroadcastRequest.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Homegear::Benchmarks {
+
+namespace {
+
+int64_t getTimeNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool sendAll(int fileDescriptor, const std::vector<char> &data) {
+  size_t totallySentBytes = 0;
+  while (totallySentBytes < data.size()) {
+    auto sentBytes = ::send(fileDescriptor, data.data() + totallySentBytes, data.size() - totallySentBytes, MSG_NOSIGNAL);
+    if (sentBytes <= 0) {
+      if (errno == EAGAIN || errno == EINTR) continue;
+      return false;
+    }
+    totallySentBytes += sentBytes;
+  }
+  return true;
+}
+
+}
+
+IpcBroadcastBenchmark::IpcBroadcastBenchmark(const BenchmarkOptions &options) {
+  _clients = options.getInteger("clients", 50);
+  if (_clients < 1) _clients = 1;
+  _duration = options.getInteger("duration", 5);
+  if (_duration < 1) _duration = 1;
+}
+
+int IpcBroadcastBenchmark::run() {
+  std::cout << "IPC broadcast fan-out: " << _clients << " clients, " << _duration << " s per run" << std::endl;
+  BaseLib::SharedObjects bl;
+  //Same settings as the encoder of IpcServer.
+  BaseLib::Rpc::RpcEncoder encoder(&bl, true, true);
+  std::cout << "Encoding per client:" << std::endl;
+  runFanOut(encoder, false);
+  std::cout << "Encoding once:" << std::endl;
+  runFanOut(encoder, true);
+  return 0;
+}
+
+void IpcBroadcastBenchmark::runFanOut(BaseLib::Rpc::RpcEncoder &encoder, bool encodeOnce) {
+  std::vector<int> serverDescriptors;
+  std::vector<std::thread> readers;
+  std::atomic<int64_t> receivedBytes{0};
+  for (int64_t i = 0; i < _clients; i++) {
+    int descriptors[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) == -1) {
+      std::cerr << "Can't create socket pair." << std::endl;
+      break;
+    }
+    serverDescriptors.push_back(descriptors[0]);
+    readers.emplace_back([&receivedBytes, descriptor = descriptors[1]]() {
+      std::vector<char> buffer(65536);
+      while (true) {
+        auto bytesRead = ::read(descriptor, buffer.data(), buffer.size());
+        if (bytesRead <= 0) break;
+        receivedBytes += bytesRead;
+      }
+      ::close(descriptor);
+    });
+  }
+
+  //A typical event: one variable of a device channel.
+  auto variables = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+  variables->arrayValue->push_back(std::make_shared<BaseLib::Variable>(std::string("ACTUAL_TEMPERATURE")));
+  auto values = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+
+  LatencyStatistics statistics;
+  int32_t packetId = 0;
+  int64_t value = 0;
+  auto startTime = getTimeNanoseconds();
+  auto endTime = startTime + _duration * 1000000000ll;
+  while (getTimeNanoseconds() < endTime) {
+    auto eventStartTime = getTimeNanoseconds();
+    values->arrayValue->clear();
+    values->arrayValue->push_back(std::make_shared<BaseLib::Variable>(20.0 + (double)(value++ % 100) / 10.0));
+    auto parameters = std::make_shared<BaseLib::Array>();
+    parameters->reserve(5);
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(std::string("device-1")));
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>((uint64_t)1234));
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(1));
+    parameters->emplace_back(variables);
+    parameters->emplace_back(values);
+
+    std::vector<char> data;
+    if (encodeOnce) {
+      Rpc::BroadcastRequest broadcastRequest(encoder, "broadcastEvent", BaseLib::Array{std::make_shared<BaseLib::Variable>(parameters)});
+      if (!broadcastRequest.isValid()) {
+        std::cerr << "Can't locate the packet ID in the encoded request." << std::endl;
+        break;
+      }
+      for (auto descriptor : serverDescriptors) {
+        broadcastRequest.send(descriptor, packetId++);
+      }
+    } else {
+      for (auto descriptor : serverDescriptors) {
+        BaseLib::PArray array(new BaseLib::Array{std::make_shared<BaseLib::Variable>(packetId++), std::make_shared<BaseLib::Variable>(parameters)});
+        data.clear();
+        encoder.encodeRequest("broadcastEvent", array, data);
+        sendAll(descriptor, data);
+      }
+    }
+    statistics.add(getTimeNanoseconds() - eventStartTime);
+  }
+  auto duration = getTimeNanoseconds() - startTime;
+
+  for (auto descriptor : serverDescriptors) {
+    ::close(descriptor);
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::cout << "  " << statistics.summary("events", duration) << std::endl;
+  std::cout << "  " << (double)receivedBytes / ((double)duration / 1000000.0) << " bytes/ms received by all clients" << std::endl;
+}
+
+}
@@ -0,0 +1,66 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_BENCHMARKS_IPCBROADCASTBENCHMARK_H_
+#define HOMEGEAR_BENCHMARKS_IPCBROADCASTBENCHMARK_H_
+
+#include "BenchmarkOptions.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Homegear::Benchmarks {
+
+/**
+ * Measures the fan-out of "broadcastEvent" requests to IPC clients like IpcServer::broadcastEvent() does it. The
+ * clients are socket pairs drained by one thread each.
+ *
+ * Options:
+ *   --clients=<n>          Number of connected clients (default: 50).
+ *   --duration=<seconds>   Duration of a run (default: 5).
+ */
+class IpcBroadcastBenchmark {
+ public:
+  explicit IpcBroadcastBenchmark(const BenchmarkOptions &options);
+  virtual ~IpcBroadcastBenchmark() = default;
+
+  /**
+   * Compares encoding the request for every client with encoding it once (Rpc::BroadcastRequest).
+   */
+  int run();
+ private:
+  int64_t _clients = 50;
+  int64_t _duration = 5;
+
+  void runFanOut(BaseLib::Rpc::RpcEncoder &encoder, bool encodeOnce);
+};
+
+}
+
+#endif
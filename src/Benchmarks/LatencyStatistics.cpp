@@ -0,0 +1,69 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "LatencyStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace Homegear::Benchmarks {
+
+void LatencyStatistics::merge(const LatencyStatistics &other) {
+  _latencies.insert(_latencies.end(), other._latencies.begin(), other._latencies.end());
+  _sorted = false;
+}
+
+int64_t LatencyStatistics::percentile(double percent) {
+  if (_latencies.empty()) return 0;
+  if (!_sorted) {
+    std::sort(_latencies.begin(), _latencies.end());
+    _sorted = true;
+  }
+  auto index = (size_t)std::ceil((percent / 100.0) * (double)_latencies.size());
+  if (index > 0) index--;
+  if (index >= _latencies.size()) index = _latencies.size() - 1;
+  return _latencies.at(index);
+}
+
+std::string LatencyStatistics::summary(const std::string &name, int64_t duration) {
+  std::ostringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  double operationsPerSecond = duration > 0 ? (double)_latencies.size() / ((double)duration / 1000000000.0) : 0;
+  stream << name << ": " << _latencies.size() << " ops, " << std::setprecision(0) << operationsPerSecond << " ops/s" << std::setprecision(3);
+  const std::vector<std::pair<std::string, double>> percentiles{{"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p99.9", 99.9}, {"max", 100.0}};
+  for (auto &percent : percentiles) {
+    stream << ", " << percent.first << " " << ((double)percentile(percent.second) / 1000000.0) << " ms";
+  }
+  return stream.str();
+}
+
+}
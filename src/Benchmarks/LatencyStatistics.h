@@ -0,0 +1,75 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_BENCHMARKS_LATENCYSTATISTICS_H_
+#define HOMEGEAR_BENCHMARKS_LATENCYSTATISTICS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Homegear::Benchmarks {
+
+/**
+ * Collects operation latencies of a benchmark run and calculates throughput and percentiles. Not thread safe. Use one
+ * object per thread and merge them after the run.
+ */
+class LatencyStatistics {
+ public:
+  LatencyStatistics() = default;
+  virtual ~LatencyStatistics() = default;
+
+  /**
+   * Adds the latency of one operation in nanoseconds.
+   */
+  void add(int64_t latency) { _latencies.push_back(latency); }
+
+  void merge(const LatencyStatistics &other);
+
+  size_t count() const { return _latencies.size(); }
+
+  /**
+   * Returns the latency in nanoseconds below which "percent" percent of the operations completed.
+   */
+  int64_t percentile(double percent);
+
+  /**
+   * Returns a one line summary like "reads: 1000 ops, 500 ops/s, p50 0.10 ms, p90 ..." for a run of "duration"
+   * nanoseconds.
+   */
+  std::string summary(const std::string &name, int64_t duration);
+ private:
+  std::vector<int64_t> _latencies;
+  bool _sorted = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "RpcReadBenchmark.h"
+#include "LatencyStatistics.h"
+#include "../RPC/AdaptiveReadBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Homegear::Benchmarks {
+
+namespace {
+
+int64_t getTimeNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool sendAll(int fileDescriptor, const std::vector<char> &data) {
+  size_t totallySentBytes = 0;
+  while (totallySentBytes < data.size()) {
+    auto sentBytes = ::send(fileDescriptor, data.data() + totallySentBytes, data.size() - totallySentBytes, MSG_NOSIGNAL);
+    if (sentBytes <= 0) {
+      if (errno == EAGAIN || errno == EINTR) continue;
+      return false;
+    }
+    totallySentBytes += sentBytes;
+  }
+  return true;
+}
+
+}
+
+RpcReadBenchmark::RpcReadBenchmark(const BenchmarkOptions &options) {
+  _size = options.getInteger("size", 2097152);
+  if (_size < 1) _size = 1;
+  _duration = options.getInteger("duration", 5);
+  if (_duration < 1) _duration = 1;
+}
+
+int RpcReadBenchmark::run() {
+  std::cout << "Reading large requests: " << _size << " bytes per request, " << _duration << " s per run" << std::endl;
+  BaseLib::SharedObjects bl;
+  std::string data((size_t)_size, 'a');
+
+  //A "putParamset" with one large value, e.g. the content of a file.
+  std::string content = R"({"jsonrpc":"2.0","method":"putParamset","params":[1,0,"MASTER",{"DATA":")" + data + R"("}],"id":1})";
+  std::string header = "POST / HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(content.size()) + "\r\nConnection: Keep-Alive\r\n\r\n";
+  std::vector<char> jsonRequest;
+  jsonRequest.reserve(header.size() + content.size());
+  jsonRequest.insert(jsonRequest.end(), header.begin(), header.end());
+  jsonRequest.insert(jsonRequest.end(), content.begin(), content.end());
+
+  BaseLib::Rpc::RpcEncoder encoder(&bl);
+  auto parameter = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  parameter->structValue->emplace("DATA", std::make_shared<BaseLib::Variable>(data));
+  auto parameters = std::make_shared<BaseLib::Array>();
+  parameters->emplace_back(std::make_shared<BaseLib::Variable>(1));
+  parameters->emplace_back(std::make_shared<BaseLib::Variable>(0));
+  parameters->emplace_back(std::make_shared<BaseLib::Variable>(std::string("MASTER")));
+  parameters->emplace_back(parameter);
+  std::vector<char> binaryRequest;
+  encoder.encodeRequest("putParamset", parameters, binaryRequest);
+
+  std::cout << "JSON-RPC, 1 KiB buffer:" << std::endl;
+  runRead(bl, jsonRequest, false, false);
+  std::cout << "JSON-RPC, adaptive buffer:" << std::endl;
+  runRead(bl, jsonRequest, false, true);
+  std::cout << "Binary RPC, 1 KiB buffer:" << std::endl;
+  runRead(bl, binaryRequest, true, false);
+  std::cout << "Binary RPC, adaptive buffer:" << std::endl;
+  runRead(bl, binaryRequest, true, true);
+  return 0;
+}
+
+void RpcReadBenchmark::runRead(BaseLib::SharedObjects &bl, const std::vector<char> &request, bool binary, bool adaptive) {
+  int descriptors[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) == -1) {
+    std::cerr << "Can't create socket pair." << std::endl;
+    return;
+  }
+
+  std::thread writer([&request, descriptor = descriptors[0]]() {
+    while (sendAll(descriptor, request)) {}
+    ::close(descriptor);
+  });
+
+  //Same sizes as the RpcServer defaults. The minimum and maximum size of 1024 bytes equal the former fixed buffer.
+  Rpc::AdaptiveReadBuffer buffer(adaptive ? 16384 : 1024, adaptive ? 1048576 : 1024);
+  BaseLib::Rpc::BinaryRpc binaryRpc(&bl);
+  BaseLib::Http http;
+  LatencyStatistics statistics;
+  int64_t reads = 0;
+  int64_t receivedBytes = 0;
+  int64_t requestStartTime = 0;
+  auto startTime = getTimeNanoseconds();
+  auto endTime = startTime + _duration * 1000000000ll;
+  try {
+    while (getTimeNanoseconds() < endTime) {
+      auto bytesRead = ::read(descriptors[1], buffer.data(), buffer.size());
+      if (bytesRead <= 0) break;
+      buffer.data()[bytesRead] = '\0';
+      reads++;
+      receivedBytes += bytesRead;
+
+      int32_t processedBytes = 0;
+      while (processedBytes < bytesRead) {
+        if (requestStartTime == 0) requestStartTime = getTimeNanoseconds();
+        if (binary) {
+          processedBytes += binaryRpc.process(buffer.data() + processedBytes, bytesRead - processedBytes);
+          if (binaryRpc.isFinished()) {
+            statistics.add(getTimeNanoseconds() - requestStartTime);
+            requestStartTime = 0;
+            binaryRpc.reset();
+          }
+        } else {
+          processedBytes += http.process(buffer.data() + processedBytes, bytesRead - processedBytes);
+          if (http.isFinished()) {
+            statistics.add(getTimeNanoseconds() - requestStartTime);
+            requestStartTime = 0;
+            http.reset();
+          }
+        }
+      }
+      buffer.update(bytesRead);
+    }
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Error parsing request: " << ex.what() << std::endl;
+  }
+  auto duration = getTimeNanoseconds() - startTime;
+
+  ::close(descriptors[1]);
+  writer.join();
+
+  std::cout << "  " << statistics.summary("requests", duration) << std::endl;
+  std::cout << "  " << (double)receivedBytes / ((double)duration / 1000.0) << " MB/s, "
+            << (statistics.count() > 0 ? (double)reads / (double)statistics.count() : 0) << " reads per request" << std::endl;
+}
+
+}
@@ -0,0 +1,66 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_BENCHMARKS_RPCREADBENCHMARK_H_
+#define HOMEGEAR_BENCHMARKS_RPCREADBENCHMARK_H_
+
+#include "BenchmarkOptions.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Homegear::Benchmarks {
+
+/**
+ * Measures how fast large requests are read from a socket and assembled by the parsers of BaseLib like
+ * RpcServer::readClient() does it. The requests are sent over a socket pair by a separate thread.
+ *
+ * Options:
+ *   --size=<bytes>         Size of the string parameter of a request (default: 2097152).
+ *   --duration=<seconds>   Duration of a run (default: 5).
+ */
+class RpcReadBenchmark {
+ public:
+  explicit RpcReadBenchmark(const BenchmarkOptions &options);
+  virtual ~RpcReadBenchmark() = default;
+
+  /**
+   * Compares the former fixed 1 KiB read buffer with Rpc::AdaptiveReadBuffer for JSON-RPC and binary RPC requests.
+   */
+  int run();
+ private:
+  int64_t _size = 2097152;
+  int64_t _duration = 5;
+
+  void runRead(BaseLib::SharedObjects &bl, const std::vector<char> &request, bool binary, bool adaptive);
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "BenchmarkOptions.h"
+#include "DatabaseBenchmark.h"
+#include "IpcBroadcastBenchmark.h"
+#include "RpcReadBenchmark.h"
+
+#include <iostream>
+#include <string>
+
+using namespace Homegear::Benchmarks;
+
+void printHelp() {
+  std::cout << "Usage: homegear-benchmark BENCHMARK [OPTIONS]" << std::endl << std::endl;
+  std::cout << "Benchmarks:" << std::endl;
+  std::cout << "  database-read-latency  Latency of database reads while the database is written to." << std::endl;
+  std::cout << "                         Options: --rows, --duration, --readers, --synchronous, --journal" << std::endl;
+  std::cout << "  database-write         Throughput and latency of inserts and updates as single statements, prepared" << std::endl;
+  std::cout << "                         statements, in a transaction and in a savepoint." << std::endl;
+  std::cout << "                         Options: --rows, --operations, --mode, --synchronous, --journal" << std::endl;
+  std::cout << "  ipc-broadcast          Events per second fanned out to IPC clients, encoding the request per client and" << std::endl;
+  std::cout << "                         once for all clients." << std::endl;
+  std::cout << "                         Options: --clients, --duration" << std::endl;
+  std::cout << "  rpc-read               Throughput of reading and assembling large JSON-RPC and binary RPC requests with a" << std::endl;
+  std::cout << "                         fixed 1 KiB and an adaptive read buffer." << std::endl;
+  std::cout << "                         Options: --size, --duration" << std::endl;
+  std::cout << std::endl << "Options:" << std::endl;
+  std::cout << "  --rows=N               Number of parameters in the database before the benchmark starts (default 10000)." << std::endl;
+  std::cout << "  --operations=N         Number of inserts and updates per run (default 10000)." << std::endl;
+  std::cout << "  --mode=MODE            One of all, statement, prepared, transaction or savepoint (default all)." << std::endl;
+  std::cout << "  --duration=N           Duration of a run in seconds (default 5)." << std::endl;
+  std::cout << "  --readers=N            Number of reading threads (default 4)." << std::endl;
+  std::cout << "  --clients=N            Number of connected IPC clients (default 50)." << std::endl;
+  std::cout << "  --size=N               Size in bytes of the data in a request (default 2097152)." << std::endl;
+  std::cout << "  --synchronous=BOOL     Sets \"PRAGMA synchronous\" to FULL or OFF (default true)." << std::endl;
+  std::cout << "  --journal=MODE         One of wal, delete or memory (default wal)." << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2 || std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+    printHelp();
+    return argc < 2 ? 1 : 0;
+  }
+
+  std::string benchmark(argv[1]);
+  BenchmarkOptions options(argc, argv, 2);
+  if (!options.isValid()) {
+    printHelp();
+    return 1;
+  }
+
+  if (benchmark == "database-read-latency") {
+    DatabaseBenchmark databaseBenchmark(options);
+    return databaseBenchmark.readLatency();
+  }
+  if (benchmark == "database-write") {
+    DatabaseBenchmark databaseBenchmark(options);
+    return databaseBenchmark.write();
+  }
+  if (benchmark == "ipc-broadcast") {
+    IpcBroadcastBenchmark ipcBroadcastBenchmark(options);
+    return ipcBroadcastBenchmark.run();
+  }
+  if (benchmark == "rpc-read") {
+    RpcReadBenchmark rpcReadBenchmark(options);
+    return rpcReadBenchmark.run();
+  }
+
+  std::cerr << "Unknown benchmark: " << benchmark << std::endl;
+  printHelp();
+  return 1;
+}
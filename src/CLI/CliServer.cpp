@@ -553,6 +553,8 @@ BaseLib::PVariable CliServer::generalCommand(std::string &command) {
                    << std::endl;
       stringStream << "debuglevel (dl)      Changes the debug level" << std::endl;
       stringStream << "events (ev)          Prints variable updates to the standard output" << std::endl;
+      stringStream << "batchstats (bst)     Prints the number, sizes and latencies of JSON-RPC batches" << std::endl;
+      stringStream << "eventbus (eb)        Prints queue sizes, dropped events and lag of all event consumers" << std::endl;
       stringStream << "lifetick (lt)        Checks the lifeticks of all components." << std::endl;
       stringStream << "rpcservers (rpc)     Lists all active RPC servers" << std::endl;
       stringStream << "rpcclients (rcl)     Lists all active RPC clients" << std::endl;
@@ -778,6 +780,7 @@ BaseLib::PVariable CliServer::generalCommand(std::string &command) {
 
       GD::bl->db->deleteAllRoles();
       GD::bl->db->createDefaultRoles();
+      GD::aclCache.invalidate();
 
       stringStream << "Recreating roles... Please check the Homegear log for errors." << std::endl;
       return std::make_shared<BaseLib::Variable>(stringStream.str());
@@ -956,6 +959,17 @@ BaseLib::PVariable CliServer::generalCommand(std::string &command) {
       load1->structValue->insert(load2->structValue->begin(), load2->structValue->end());
       stringStream << BaseLib::Rpc::JsonEncoder::encode(GD::nodeBlueServer->getLoad()) << std::endl;
       return std::make_shared<BaseLib::Variable>(stringStream.str());
+    } else if (BaseLib::HelperFunctions::checkCliCommand(command, "eventbus", "eb", "", 0, arguments, showHelp)) {
+      stringStream << BaseLib::Rpc::JsonEncoder::encode(GD::familyController->getEventBusStatistics()) << std::endl;
+      return std::make_shared<BaseLib::Variable>(stringStream.str());
+    } else if (BaseLib::HelperFunctions::checkCliCommand(command, "batchstats", "bst", "", 0, arguments, showHelp)) {
+      auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      for (auto &server: GD::rpcServers) {
+        if (!server.second->isRunning()) continue;
+        statistics->structValue->emplace(server.second->getInfo()->name, server.second->getStatistics());
+      }
+      stringStream << BaseLib::Rpc::JsonEncoder::encode(statistics) << std::endl;
+      return std::make_shared<BaseLib::Variable>(stringStream.str());
     } else if (BaseLib::HelperFunctions::checkCliCommand(command, "nodeproctimes", "npt", "", 0, arguments, showHelp)) {
       stringStream << BaseLib::Rpc::JsonEncoder::encode(GD::nodeBlueServer->getNodeProcessingTimes()) << std::endl;
       return std::make_shared<BaseLib::Variable>(stringStream.str());
@@ -0,0 +1,198 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "DataCache.h"
+
+namespace Homegear {
+
+DataCache::DataCache(size_t maxSize) {
+  _maxSize = maxSize == 0 ? 1 : maxSize;
+}
+
+void DataCache::setMaxSize(size_t maxSize) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  _maxSize = maxSize == 0 ? 1 : maxSize;
+  evict();
+}
+
+DataCache::ComponentEntry &DataCache::touch(const std::string &component) {
+  auto componentIterator = _components.find(component);
+  if (componentIterator != _components.end()) {
+    if (componentIterator->second.lruPosition != _lru.begin()) _lru.splice(_lru.begin(), _lru, componentIterator->second.lruPosition);
+    return componentIterator->second;
+  }
+
+  _lru.push_front(component);
+  auto &entry = _components[component];
+  entry.lruPosition = _lru.begin();
+  _size++;
+  return entry;
+}
+
+void DataCache::evict() {
+  auto lruIterator = _lru.end();
+  while (_size > _maxSize && lruIterator != _lru.begin()) {
+    --lruIterator;
+    if (lruIterator == _lru.begin()) break;
+    if (_pendingWrites.find(*lruIterator) != _pendingWrites.end()) continue;
+    auto oldestIterator = _components.find(*lruIterator);
+    if (oldestIterator != _components.end()) {
+      _size -= oldestIterator->second.values.size() + 1;
+      _components.erase(oldestIterator);
+      _evictions++;
+    }
+    lruIterator = _lru.erase(lruIterator);
+  }
+}
+
+DataCache::LookupResult DataCache::get(const std::string &component, const std::string &key, BaseLib::PVariable &value) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  auto componentIterator = _components.find(component);
+  if (componentIterator == _components.end()) {
+    _misses++;
+    return LookupResult::miss;
+  }
+
+  auto &entry = componentIterator->second;
+  auto valueIterator = entry.values.find(key);
+  if (valueIterator == entry.values.end()) {
+    if (!entry.complete) {
+      _misses++;
+      return LookupResult::miss;
+    }
+  } else if (valueIterator->second) {
+    if (entry.lruPosition != _lru.begin()) _lru.splice(_lru.begin(), _lru, entry.lruPosition);
+    _hits++;
+    value = valueIterator->second;
+    return LookupResult::hit;
+  }
+
+  if (entry.lruPosition != _lru.begin()) _lru.splice(_lru.begin(), _lru, entry.lruPosition);
+  _negativeHits++;
+  return LookupResult::negativeHit;
+}
+
+bool DataCache::getComponent(const std::string &component, std::map<std::string, BaseLib::PVariable> &values) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  auto componentIterator = _components.find(component);
+  if (componentIterator == _components.end() || !componentIterator->second.complete) {
+    _misses++;
+    return false;
+  }
+
+  auto &entry = componentIterator->second;
+  if (entry.lruPosition != _lru.begin()) _lru.splice(_lru.begin(), _lru, entry.lruPosition);
+  _hits++;
+  for (auto &value: entry.values) {
+    if (value.second) values.emplace(value.first, value.second);
+  }
+  return true;
+}
+
+void DataCache::fill(const std::string &component, const std::string &key, const BaseLib::PVariable &value) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  if (_pendingWrites.find(component) != _pendingWrites.end() && _components.find(component) == _components.end()) return;
+  auto &entry = touch(component);
+  if (entry.values.emplace(key, value).second) _size++;
+  evict();
+}
+
+void DataCache::fillComponent(const std::string &component, std::map<std::string, BaseLib::PVariable> &values) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  if (values.size() >= _maxSize) return; //Would evict everything else.
+  if (_pendingWrites.find(component) != _pendingWrites.end() && _components.find(component) == _components.end()) return;
+  auto &entry = touch(component);
+  for (auto &value: values) {
+    if (entry.values.emplace(value.first, value.second).second) _size++;
+  }
+  entry.complete = true;
+  values.clear();
+  for (auto &value: entry.values) {
+    if (value.second) values.emplace(value.first, value.second);
+  }
+  evict();
+}
+
+void DataCache::set(const std::string &component, const std::string &key, const BaseLib::PVariable &value) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  _pendingWrites[component]++;
+  auto &entry = touch(component);
+  auto result = entry.values.emplace(key, value);
+  if (result.second) _size++;
+  else result.first->second = value;
+  evict();
+}
+
+void DataCache::erase(const std::string &component, const std::string &key) {
+  set(component, key, BaseLib::PVariable());
+}
+
+void DataCache::eraseComponent(const std::string &component) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  _pendingWrites[component]++;
+  auto &entry = touch(component);
+  _size -= entry.values.size();
+  entry.values.clear();
+  entry.complete = true;
+  evict();
+}
+
+void DataCache::invalidate(const std::string &component) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  auto componentIterator = _components.find(component);
+  if (componentIterator == _components.end()) return;
+  _size -= componentIterator->second.values.size() + 1;
+  _lru.erase(componentIterator->second.lruPosition);
+  _components.erase(componentIterator);
+}
+
+void DataCache::endWrite(const std::string &component) {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  auto pendingWritesIterator = _pendingWrites.find(component);
+  if (pendingWritesIterator == _pendingWrites.end()) return;
+  if (pendingWritesIterator->second <= 1) {
+    _pendingWrites.erase(pendingWritesIterator);
+    evict();
+  } else pendingWritesIterator->second--;
+}
+
+void DataCache::clear() {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  _components.clear();
+  _lru.clear();
+  _size = 0;
+}
+
+size_t DataCache::size() {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  return _size;
+}
+
+}
@@ -0,0 +1,187 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef DATACACHE_H_
+#define DATACACHE_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Homegear {
+
+/**
+ * Size bounded cache for key value data stored per component, like node data (component = node ID) or metadata
+ * (component = peer ID). Next to values the cache stores negative entries for keys known not to exist. A component
+ * loaded with all its keys is marked complete, so lookups of missing keys and of the whole component are answered
+ * without touching the database. When more than "maxSize" entries are cached, the least recently used components are
+ * evicted.
+ *
+ * Every set(), erase() and eraseComponent() needs to be followed by endWrite() once the write was committed to the
+ * database. Until then the component is not evicted and values read from the database are not cached for it, as the
+ * database might still return the old value.
+ *
+ * The class is thread safe. Cached values are shared with the callers and must not be modified.
+ */
+class DataCache {
+ public:
+  enum class LookupResult {
+    miss,
+    hit,
+    negativeHit
+  };
+
+  explicit DataCache(size_t maxSize = 100000);
+  virtual ~DataCache() = default;
+
+  void setMaxSize(size_t maxSize);
+
+  /**
+   * Looks up one key.
+   *
+   * @param component The component.
+   * @param key The key.
+   * @param[out] value The cached value. Only set on "hit".
+   * @return "hit" when the value is cached, "negativeHit" when the key is known not to exist and "miss" when the
+   * database needs to be queried.
+   */
+  LookupResult get(const std::string &component, const std::string &key, BaseLib::PVariable &value);
+
+  /**
+   * Looks up all keys of a component.
+   *
+   * @param component The component.
+   * @param[out] values All existing keys and their values.
+   * @return True when the component is cached completely.
+   */
+  bool getComponent(const std::string &component, std::map<std::string, BaseLib::PVariable> &values);
+
+  /**
+   * Stores a value read from the database. Doesn't overwrite an entry set in the meantime. Ignored when the component
+   * isn't cached and has writes that are not committed yet.
+   *
+   * @param value The value or nullptr when the key doesn't exist.
+   */
+  void fill(const std::string &component, const std::string &key, const BaseLib::PVariable &value);
+
+  /**
+   * Stores all keys of a component read from the database and marks the component complete. Entries set in the
+   * meantime are kept and copied to "values". Ignored when the component isn't cached and has writes that are not
+   * committed yet.
+   */
+  void fillComponent(const std::string &component, std::map<std::string, BaseLib::PVariable> &values);
+
+  /**
+   * Stores a written value.
+   */
+  void set(const std::string &component, const std::string &key, const BaseLib::PVariable &value);
+
+  /**
+   * Marks a deleted key as not existing.
+   */
+  void erase(const std::string &component, const std::string &key);
+
+  /**
+   * Marks a component whose keys were all deleted as complete and empty.
+   */
+  void eraseComponent(const std::string &component);
+
+  /**
+   * Removes everything known about a component, e. g. when its rows were changed outside of the cache.
+   */
+  void invalidate(const std::string &component);
+
+  /**
+   * Signals that a write started by set(), erase() or eraseComponent() was committed to the database.
+   */
+  void endWrite(const std::string &component);
+
+  void clear();
+
+  size_t size();
+  uint64_t hits() const { return _hits; }
+  uint64_t negativeHits() const { return _negativeHits; }
+  uint64_t misses() const { return _misses; }
+  uint64_t evictions() const { return _evictions; }
+ private:
+  struct ComponentEntry {
+    /**
+     * Values of nullptr are negative entries.
+     */
+    std::map<std::string, BaseLib::PVariable> values;
+
+    /**
+     * All keys of the component are cached. Keys not in "values" don't exist.
+     */
+    bool complete = false;
+
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  std::mutex _cacheMutex;
+  size_t _maxSize = 100000;
+  size_t _size = 0;
+  std::atomic<uint64_t> _hits{0};
+  std::atomic<uint64_t> _negativeHits{0};
+  std::atomic<uint64_t> _misses{0};
+  std::atomic<uint64_t> _evictions{0};
+
+  /**
+   * Most recently used components first.
+   */
+  std::list<std::string> _lru;
+  std::unordered_map<std::string, ComponentEntry> _components;
+
+  /**
+   * Number of writes per component that are not committed to the database yet.
+   */
+  std::unordered_map<std::string, uint32_t> _pendingWrites;
+
+  /**
+   * Returns the entry of "component", creates it if necessary and marks it as most recently used. _cacheMutex must be
+   * locked.
+   */
+  ComponentEntry &touch(const std::string &component);
+
+  /**
+   * Evicts the least recently used components until the cache fits into _maxSize again. The most recently used
+   * component and components with pending writes are never evicted. _cacheMutex must be locked.
+   */
+  void evict();
+};
+
+}
+
+#endif
@@ -34,10 +34,32 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <memory>
 
 namespace Homegear {
 
+namespace {
+/**
+ * Columns: peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value. Requires
+ * parametersUniqueIndex (see createUpsertIndexes()).
+ */
+const std::string kPeerParameterUpsert
+    ("INSERT INTO parameters (peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES(?, ?, ?, ?, ?, ?, ?) ON CONFLICT(peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName) DO UPDATE SET value=excluded.value");
+
+/**
+ * Node data ending in "password" or "private_key" is only returned to trusted servers.
+ */
+bool isSecretNodeDataKey(std::string key) {
+  BaseLib::HelperFunctions::toLower(key);
+  return (key.size() >= 8 && key.compare(key.size() - 8, 8, "password") == 0) || (key.size() >= 11 && key.compare(key.size() - 11, 11, "private_key") == 0);
+}
+
+BaseLib::PVariable obfuscateNodeData(const BaseLib::PVariable &value) {
+  return value->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
+}
+}
+
 DatabaseController::DatabaseController() : IQueue(GD::bl.get(), 1, 100000) {
 }
 
@@ -48,8 +70,17 @@ DatabaseController::~DatabaseController() {
 void DatabaseController::dispose() {
   if (_disposing) return;
   _disposing = true;
+  {
+    std::lock_guard<std::mutex> maintenanceGuard(_maintenanceMutex);
+    _stopMaintenanceThread = true;
+  }
+  _maintenanceConditionVariable.notify_all();
+  _db.abortOnlineBackup();
+  GD::bl->threadManager.join(_maintenanceThread);
   stopQueue(0);
+  commitPendingWrites();
   _db.dispose();
+  _nodeData.clear();
   _metadata.clear();
 }
 
@@ -62,7 +93,17 @@ void DatabaseController::init() {
   _rpcDecoder = std::make_unique<BaseLib::Rpc::RpcDecoder>(GD::bl.get(), false, false);
   _rpcEncoder = std::make_unique<BaseLib::Rpc::RpcEncoder>(GD::bl.get(), false, true);
 
+  _nodeData.setMaxSize(GD::tuningSettings.databaseDataCacheSize());
+  _metadata.setMaxSize(GD::tuningSettings.databaseDataCacheSize());
+
+  _groupCommit = GD::tuningSettings.databaseGroupCommit();
+  _groupCommitMaxBatchSize = GD::tuningSettings.databaseGroupCommitMaxBatchSize();
+  _groupCommitMaxLatency = GD::tuningSettings.databaseGroupCommitMaxLatency();
+  if (_groupCommit) GD::out.printInfo("Info: Database group commit is enabled (maximum batch size: " + std::to_string(_groupCommitMaxBatchSize) + ", maximum latency: " + std::to_string(_groupCommitMaxLatency) + " ms).");
+
   startQueue(0, true, 1, 0, SCHED_OTHER);
+
+  GD::bl->threadManager.start(_maintenanceThread, true, &DatabaseController::maintenanceThread, this);
 }
 
 //General
@@ -75,14 +116,87 @@ void DatabaseController::open(const std::string &databasePath,
                               const std::string &backupPath,
                               const std::string &factoryBackupPath,
                               const std::string &backupFilename) {
+  _db.setFactoryDatabaseTables(GD::tuningSettings.factoryDatabaseTables());
+  _db.setReadConnectionCount(GD::tuningSettings.databaseReadConnections());
   _db.init(databasePath, databaseFilename, factoryDatabasePath, databaseSynchronous, databaseMemoryJournal, databaseWALJournal, backupPath, factoryBackupPath, backupFilename);
 }
 
 void DatabaseController::hotBackup() {
-  _db.hotBackup(false);
+  //Only fall back to the blocking backup when the online backup failed, not when it was skipped (e. g. because the
+  //maintenance thread is creating one right now).
+  if (!_db.isOpen() || _db.onlineBackup(GD::tuningSettings.databaseBackupPagesPerStep(), GD::tuningSettings.databaseBackupStepInterval()) == SQLite3::OnlineBackupResult::failed) _db.hotBackup(false);
   _db.hotBackup(true);
 }
 
+void DatabaseController::maintenanceThread() {
+  try {
+    int64_t lastBackup = BaseLib::HelperFunctions::getTime();
+    while (true) {
+      {
+        std::unique_lock<std::mutex> maintenanceGuard(_maintenanceMutex);
+        int64_t backupInterval = (int64_t)GD::tuningSettings.databaseBackupInterval() * 1000;
+        if (backupInterval > 0) {
+          int64_t waitTime = std::max((int64_t)0, lastBackup + backupInterval - BaseLib::HelperFunctions::getTime());
+          _maintenanceConditionVariable.wait_for(maintenanceGuard, std::chrono::milliseconds(waitTime), [&] { return _stopMaintenanceThread || _backupRequested; });
+        } else {
+          _maintenanceConditionVariable.wait(maintenanceGuard, [&] { return _stopMaintenanceThread || _backupRequested; });
+        }
+        if (_stopMaintenanceThread) return;
+        if (!_backupRequested && (backupInterval <= 0 || BaseLib::HelperFunctions::getTime() - lastBackup < backupInterval)) continue;
+        _backupRequested = false;
+      }
+
+      if (_db.isOpen()) _db.onlineBackup(GD::tuningSettings.databaseBackupPagesPerStep(), GD::tuningSettings.databaseBackupStepInterval());
+      lastBackup = BaseLib::HelperFunctions::getTime();
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool DatabaseController::startBackup() {
+  try {
+    if (_db.onlineBackupRunning()) return false;
+    {
+      std::lock_guard<std::mutex> maintenanceGuard(_maintenanceMutex);
+      if (_stopMaintenanceThread) return false;
+      _backupRequested = true;
+    }
+    _maintenanceConditionVariable.notify_all();
+    return true;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+BaseLib::PVariable DatabaseController::getBackupStatus() {
+  try {
+    auto status = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    bool running = _db.onlineBackupRunning();
+    status->structValue->emplace("running", std::make_shared<BaseLib::Variable>(running));
+    if (running) {
+      int32_t pageCount = _db.onlineBackupPageCount();
+      int32_t remainingPages = _db.onlineBackupRemainingPages();
+      status->structValue->emplace("startTime", std::make_shared<BaseLib::Variable>(_db.onlineBackupStartTime()));
+      status->structValue->emplace("pageCount", std::make_shared<BaseLib::Variable>(pageCount));
+      status->structValue->emplace("remainingPages", std::make_shared<BaseLib::Variable>(remainingPages));
+      status->structValue->emplace("progress", std::make_shared<BaseLib::Variable>(pageCount > 0 ? (double)(pageCount - remainingPages) / (double)pageCount : 0.0));
+      status->structValue->emplace("elapsedTime", std::make_shared<BaseLib::Variable>(BaseLib::HelperFunctions::getTime() - _db.onlineBackupStartTime()));
+    }
+    status->structValue->emplace("lastBackupTime", std::make_shared<BaseLib::Variable>(_db.lastOnlineBackupTime()));
+    status->structValue->emplace("lastBackupDuration", std::make_shared<BaseLib::Variable>(_db.onlineBackupDuration()));
+    status->structValue->emplace("lastBackupSuccessful", std::make_shared<BaseLib::Variable>(_db.lastOnlineBackupSuccessful()));
+    return status;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 void DatabaseController::initializeDatabase() {
   try {
     _db.executeCommand("CREATE TABLE IF NOT EXISTS homegearVariables (variableID INTEGER PRIMARY KEY UNIQUE, variableIndex INTEGER NOT NULL, integerValue INTEGER, stringValue TEXT, binaryValue BLOB)", false);
@@ -140,6 +254,8 @@ void DatabaseController::initializeDatabase() {
     _db.executeCommand("CREATE INDEX IF NOT EXISTS uiNotificationsIndex ON uiElements (id)", false);
     _db.executeCommand("CREATE TABLE IF NOT EXISTS variableProfiles (id INTEGER PRIMARY KEY UNIQUE, translations BLOB, profile BLOB)", false);
     _db.executeCommand("CREATE INDEX IF NOT EXISTS variableProfilesIndex ON variableProfiles (id)", false);
+    createUpsertIndexes(false);
+    createUpsertIndexes(true);
 
     //{{{ Create default groups
     {
@@ -347,6 +463,10 @@ void DatabaseController::initializeDatabase() {
 
     createDefaultRoles();
 
+    for (int32_t i = (int32_t)StructureType::buildings; i <= (int32_t)StructureType::roles; i++) {
+      loadStructure((StructureType)i);
+    }
+
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(0));
     auto result = _db.executeCommand("SELECT 1 FROM homegearVariables WHERE variableIndex=?", data, false);
@@ -355,7 +475,7 @@ void DatabaseController::initializeDatabase() {
       data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
       data.push_back(std::make_shared<BaseLib::Database::DataColumn>(0));
       data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
-      data.push_back(std::make_shared<BaseLib::Database::DataColumn>("0.8.5"));
+      data.push_back(std::make_shared<BaseLib::Database::DataColumn>("0.8.6"));
       data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
       _db.executeCommand("INSERT INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data, false);
 
@@ -406,8 +526,109 @@ void DatabaseController::initializeDatabase() {
 void DatabaseController::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry> &entry) {
   std::shared_ptr<QueueEntry> queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
   if (!queueEntry) return;
-  _db.executeWriteCommand(queueEntry->getEntry(), false);
-  _db.executeWriteCommand(queueEntry->getEntry(), true);
+  if (!queueEntry->getRowKey().empty()) {
+    //From now on new writes to this row need to be queued again.
+    std::lock_guard<std::mutex> queuedRowWritesGuard(_queuedRowWritesMutex);
+    auto queuedRowWriteIterator = _queuedRowWrites.find(queueEntry->getRowKey());
+    if (queuedRowWriteIterator != _queuedRowWrites.end() && queuedRowWriteIterator->second == queueEntry->getEntry()) _queuedRowWrites.erase(queuedRowWriteIterator);
+  }
+  if (!_groupCommit) {
+    _db.executeWriteCommand(queueEntry->getEntry(), false);
+    _db.executeWriteCommand(queueEntry->getEntry(), true);
+    if (queueEntry->getWrittenCallback()) queueEntry->getWrittenCallback()();
+    return;
+  }
+
+  auto &command = queueEntry->getEntry();
+  if (!command) return;
+  //The batch transaction replaces queued savepoints. Don't commit while a queued savepoint is open, so everything between
+  //"SAVEPOINT" and "RELEASE" still is written atomically.
+  if (command->first.compare(0, 10, "SAVEPOINT ") == 0) _queuedSavepointDepth++;
+  else if (command->first.compare(0, 8, "RELEASE ") == 0) {
+    if (_queuedSavepointDepth > 0) _queuedSavepointDepth--;
+  } else {
+    if (_pendingWrites.empty()) _pendingWritesTime = BaseLib::HelperFunctions::getTime();
+    _pendingWrites.emplace_back(command);
+  }
+  if (queueEntry->getWrittenCallback()) _pendingWriteCallbacks.emplace_back(queueEntry->getWrittenCallback());
+
+  if (_queuedSavepointDepth > 0 || _pendingWrites.empty()) return;
+  if (_pendingWrites.size() >= _groupCommitMaxBatchSize || queueSize(0) == 0 || BaseLib::HelperFunctions::getTime() - _pendingWritesTime >= (int64_t)_groupCommitMaxLatency) {
+    commitPendingWrites();
+  }
+}
+
+void DatabaseController::enqueueWrite(std::shared_ptr<BaseLib::IQueueEntry> &entry) {
+  auto queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
+  auto table = queueEntry && queueEntry->getEntry() ? getWriteTable(queueEntry->getEntry()->first) : std::string();
+  if (!table.empty()) {
+    //Row writes to this table queued after this write must not be merged into row writes queued before it. Otherwise a
+    //later row write would overtake this one (e.g. "REPLACE", "DELETE ... WHERE peerID=?", "REPLACE" of the same row).
+    //Writes to other tables and savepoints don't affect the rows.
+    std::string rowKeyPrefix = table + ':';
+    std::lock_guard<std::mutex> queuedRowWritesGuard(_queuedRowWritesMutex);
+    for (auto queuedRowWriteIterator = _queuedRowWrites.begin(); queuedRowWriteIterator != _queuedRowWrites.end();) {
+      if (queuedRowWriteIterator->first.compare(0, rowKeyPrefix.size(), rowKeyPrefix) == 0) queuedRowWriteIterator = _queuedRowWrites.erase(queuedRowWriteIterator);
+      else ++queuedRowWriteIterator;
+    }
+  }
+  if (!enqueue(0, entry)) {
+    if (queueEntry && queueEntry->getWrittenCallback()) queueEntry->getWrittenCallback()();
+  }
+}
+
+std::string DatabaseController::getWriteTable(const std::string &command) {
+  static const std::array<std::string, 5> kPrefixes{"INSERT OR REPLACE INTO ", "REPLACE INTO ", "INSERT INTO ", "DELETE FROM ", "UPDATE "};
+  for (auto &prefix : kPrefixes) {
+    if (command.compare(0, prefix.size(), prefix) != 0) continue;
+    auto tableEnd = command.find_first_of(" (", prefix.size());
+    return command.substr(prefix.size(), tableEnd == std::string::npos ? std::string::npos : tableEnd - prefix.size());
+  }
+  return "";
+}
+
+void DatabaseController::enqueueRowWrite(const std::string &table, uint64_t rowId, const std::string &command, BaseLib::Database::DataRow &data) {
+  std::string rowKey = table + ':' + std::to_string(rowId);
+  std::shared_ptr<QueueEntry> queueEntry;
+  {
+    std::lock_guard<std::mutex> queuedRowWritesGuard(_queuedRowWritesMutex);
+    auto queuedRowWriteIterator = _queuedRowWrites.find(rowKey);
+    if (queuedRowWriteIterator != _queuedRowWrites.end() && queuedRowWriteIterator->second->first == command) {
+      queuedRowWriteIterator->second->second = data;
+      _coalescedWrites++;
+      return;
+    }
+    queueEntry = std::make_shared<QueueEntry>(command, data, rowKey);
+    _queuedRowWrites[rowKey] = queueEntry->getEntry();
+  }
+
+  //Don't hold _queuedRowWritesMutex here, as enqueue() blocks when the queue is full.
+  std::shared_ptr<BaseLib::IQueueEntry> entry = queueEntry;
+  if (!enqueue(0, entry)) {
+    std::lock_guard<std::mutex> queuedRowWritesGuard(_queuedRowWritesMutex);
+    auto queuedRowWriteIterator = _queuedRowWrites.find(rowKey);
+    if (queuedRowWriteIterator != _queuedRowWrites.end() && queuedRowWriteIterator->second == queueEntry->getEntry()) _queuedRowWrites.erase(queuedRowWriteIterator);
+  }
+}
+
+void DatabaseController::commitPendingWrites() {
+  try {
+    if (_pendingWrites.empty() && _pendingWriteCallbacks.empty()) return;
+    if (!_pendingWrites.empty()) {
+      _db.executeWriteCommands(_pendingWrites, false);
+      _db.executeWriteCommands(_pendingWrites, true);
+      _groupCommitCount++;
+      _groupCommitWrites += _pendingWrites.size();
+      _pendingWrites.clear();
+    }
+    for (auto &callback : _pendingWriteCallbacks) {
+      callback();
+    }
+    _pendingWriteCallbacks.clear();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
 }
 
 bool DatabaseController::convertDatabase(const std::string &databasePath,
@@ -438,7 +659,7 @@ bool DatabaseController::convertDatabase(const std::string &databasePath,
       int64_t versionId = result->at(0).at(0)->intValue;
       std::string version = result->at(0).at(3)->textValue;
 
-      static const std::string kCurrentVersion("0.8.5");
+      static const std::string kCurrentVersion("0.8.6");
 
       if (version == kCurrentVersion) return false; //Up to date
       /*if(version == "0.0.7")
@@ -981,6 +1202,22 @@ bool DatabaseController::convertDatabase(const std::string &databasePath,
 
         version = "0.8.5";
       }
+      if (version == "0.8.5") {
+        GD::out.printMessage("Converting database from version " + version + " to version 0.8.6...");
+
+        createUpsertIndexes(factoryDatabase);
+
+        data.clear();
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(versionId));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(0));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
+        //Don't forget to set new version in initializeDatabase!!!
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>("0.8.6"));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
+        _db.executeWriteCommand("REPLACE INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data, factoryDatabase);
+
+        version = "0.8.6";
+      }
 
       if (version != kCurrentVersion) {
         GD::out.printCritical("Critical: Unknown database version: " + version);
@@ -999,6 +1236,56 @@ bool DatabaseController::convertDatabase(const std::string &databasePath,
   return true;
 }
 
+void DatabaseController::createUpsertIndexes(bool factoryDatabase) {
+  try {
+    struct UpsertIndex {
+      std::string table;
+      std::string name;
+      std::string columns;
+    };
+    static const std::vector<UpsertIndex> kUpsertIndexes{
+        {"parameters", "parametersUniqueIndex", "peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName"},
+        {"peerVariables", "peerVariablesUniqueIndex", "peerID, variableIndex"},
+        {"deviceVariables", "deviceVariablesUniqueIndex", "deviceID, variableIndex"},
+        {"licenseVariables", "licenseVariablesUniqueIndex", "moduleID, variableIndex"}
+    };
+
+    for (auto &upsertIndex : kUpsertIndexes) {
+      BaseLib::Database::DataRow data;
+      data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::string("table")));
+      data.push_back(std::make_shared<BaseLib::Database::DataColumn>(upsertIndex.table));
+      if (_db.executeCommand("SELECT 1 FROM sqlite_master WHERE type=? AND name=?", data, factoryDatabase)->empty()) continue;
+      data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(std::string("index"));
+      data.at(1) = std::make_shared<BaseLib::Database::DataColumn>(upsertIndex.name);
+      if (!_db.executeCommand("SELECT 1 FROM sqlite_master WHERE type=? AND name=?", data, factoryDatabase)->empty()) continue;
+
+      if (upsertIndex.table == "parameters") {
+        //NULL values are distinct in unique indexes, so ON CONFLICT would never match rows without remote peer.
+        _db.executeCommand("UPDATE parameters SET remotePeer=0 WHERE remotePeer IS NULL", factoryDatabase);
+        _db.executeCommand("UPDATE parameters SET remoteChannel=0 WHERE remoteChannel IS NULL", factoryDatabase);
+      }
+      std::string idColumn = (upsertIndex.table == "parameters" ? "parameterID" : "variableID");
+      std::string duplicatesCondition = " WHERE " + idColumn + " NOT IN (SELECT MAX(" + idColumn + ") FROM " + upsertIndex.table + " GROUP BY " + upsertIndex.columns + ")";
+      auto duplicateCount = _db.executeCommand("SELECT COUNT(*) FROM " + upsertIndex.table + duplicatesCondition, factoryDatabase);
+      if (!duplicateCount->empty() && !duplicateCount->at(0).empty() && duplicateCount->at(0).at(0)->intValue > 0) {
+        //Keep the duplicates, so they can be restored manually.
+        std::string backupTable = upsertIndex.table + "Duplicates";
+        _db.executeCommand("CREATE TABLE IF NOT EXISTS " + backupTable + " AS SELECT * FROM " + upsertIndex.table + " WHERE 0", factoryDatabase);
+        _db.executeCommand("INSERT INTO " + backupTable + " SELECT * FROM " + upsertIndex.table + duplicatesCondition, factoryDatabase);
+        _db.executeCommand("DELETE FROM " + upsertIndex.table + duplicatesCondition, factoryDatabase);
+        GD::out.printWarning("Warning: Removed " + std::to_string(duplicateCount->at(0).at(0)->intValue) + " duplicate rows from table " + upsertIndex.table + ". Only the latest row per " + upsertIndex.columns + " was kept. The removed rows were moved to table " + backupTable + ".");
+      }
+      _db.executeCommand("CREATE UNIQUE INDEX IF NOT EXISTS " + upsertIndex.name + " ON " + upsertIndex.table + " (" + upsertIndex.columns + ")", factoryDatabase);
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+
 bool DatabaseController::enableMaintenanceMode() {
   try {
     GD::bl->maintenanceMode = true;
@@ -1042,14 +1329,38 @@ void DatabaseController::createSavepointAsynchronous(std::string &name) {
   if (GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Creating savepoint (asynchronous) " + name);
   BaseLib::Database::DataRow data;
   std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("SAVEPOINT " + name, data);
-  enqueue(0, entry);
+  enqueueWrite(entry);
 }
 
 void DatabaseController::releaseSavepointAsynchronous(std::string &name) {
   if (GD::bl->debugLevel > 5) GD::out.printDebug("Debug: Releasing savepoint (asynchronous) " + name);
   BaseLib::Database::DataRow data;
   std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("RELEASE " + name, data);
-  enqueue(0, entry);
+  enqueueWrite(entry);
+}
+
+BaseLib::PVariable DatabaseController::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    statistics->structValue->emplace("statementCacheHits", std::make_shared<BaseLib::Variable>(_db.statementCacheHits()));
+    statistics->structValue->emplace("statementCacheMisses", std::make_shared<BaseLib::Variable>(_db.statementCacheMisses()));
+    statistics->structValue->emplace("groupCommits", std::make_shared<BaseLib::Variable>(_groupCommitCount.load()));
+    statistics->structValue->emplace("groupCommitWrites", std::make_shared<BaseLib::Variable>(_groupCommitWrites.load()));
+    statistics->structValue->emplace("coalescedWrites", std::make_shared<BaseLib::Variable>(_coalescedWrites.load()));
+    statistics->structValue->emplace("readConnectionCommands", std::make_shared<BaseLib::Variable>(_db.readConnectionCommands()));
+    for (auto &cache: std::array<std::pair<std::string, DataCache *>, 2>{std::make_pair(std::string("nodeDataCache"), &_nodeData), std::make_pair(std::string("metadataCache"), &_metadata)}) {
+      statistics->structValue->emplace(cache.first + "Size", std::make_shared<BaseLib::Variable>((uint64_t)cache.second->size()));
+      statistics->structValue->emplace(cache.first + "Hits", std::make_shared<BaseLib::Variable>(cache.second->hits()));
+      statistics->structValue->emplace(cache.first + "NegativeHits", std::make_shared<BaseLib::Variable>(cache.second->negativeHits()));
+      statistics->structValue->emplace(cache.first + "Misses", std::make_shared<BaseLib::Variable>(cache.second->misses()));
+      statistics->structValue->emplace(cache.first + "Evictions", std::make_shared<BaseLib::Variable>(cache.second->evictions()));
+    }
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 //End general
 
@@ -1076,7 +1387,7 @@ void DatabaseController::setHomegearVariableString(HomegearVariables::Enum id, s
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(value));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   } else {
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(result->at(0).at(0)->intValue));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>((uint64_t)id));
@@ -1085,7 +1396,7 @@ void DatabaseController::setHomegearVariableString(HomegearVariables::Enum id, s
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(value));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>());
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO homegearVariables VALUES(?, ?, ?, ?, ?)", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   }
 }
 //End Homegear variables
@@ -1169,13 +1480,13 @@ BaseLib::PVariable DatabaseController::setData(std::string &component, std::stri
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(component));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(key));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM data WHERE component=? AND key=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     std::vector<char> encodedValue;
     _rpcEncoder->encodeResponse(value, encodedValue);
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(encodedValue));
     entry = std::make_shared<QueueEntry>("INSERT INTO data VALUES(?, ?, ?)", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tVoid);
   }
@@ -1207,7 +1518,7 @@ BaseLib::PVariable DatabaseController::deleteData(std::string &component, std::s
       command.append(" AND key=?");
     }
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tVoid);
   }
@@ -1597,16 +1908,122 @@ void DatabaseController::removeUiNotification(uint64_t databaseId) {
 }
 //}}}
 
+//{{{ Structure model
+void DatabaseController::loadStructure(StructureType type) {
+  try {
+    static const std::array<std::string, 6> kCommands{
+        "SELECT id, translations, metadata, stories, buildingParts FROM buildings",
+        "SELECT id, translations, metadata FROM buildingParts",
+        "SELECT id, translations, metadata, rooms FROM stories",
+        "SELECT id, translations, metadata FROM rooms",
+        "SELECT id, translations, metadata FROM categories",
+        "SELECT id, translations, metadata FROM roles"
+    };
+
+    std::map<uint64_t, PStructureElement> elements;
+    auto rows = _db.executeCommand(kCommands.at((int32_t)type), false);
+    for (auto &row: *rows) {
+      auto element = getStructureElementFromRow(type, row.second);
+      elements.emplace(element->id, element);
+    }
+
+    std::lock_guard<std::shared_timed_mutex> structureGuard(_structureMutex);
+    _structure.at((int32_t)type).swap(elements);
+    _structureVersion++;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+
+void DatabaseController::reloadStructureElement(StructureType type, uint64_t id) {
+  try {
+    static const std::array<std::string, 6> kCommands{
+        "SELECT id, translations, metadata, stories, buildingParts FROM buildings WHERE id=?",
+        "SELECT id, translations, metadata FROM buildingParts WHERE id=?",
+        "SELECT id, translations, metadata, rooms FROM stories WHERE id=?",
+        "SELECT id, translations, metadata FROM rooms WHERE id=?",
+        "SELECT id, translations, metadata FROM categories WHERE id=?",
+        "SELECT id, translations, metadata FROM roles WHERE id=?"
+    };
+
+    BaseLib::Database::DataRow data;
+    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(id));
+    auto rows = _db.executeCommand(kCommands.at((int32_t)type), data, false);
+    if (rows->empty()) {
+      eraseStructureElement(type, id);
+      return;
+    }
+
+    auto element = getStructureElementFromRow(type, rows->begin()->second);
+    std::lock_guard<std::shared_timed_mutex> structureGuard(_structureMutex);
+    _structure.at((int32_t)type)[id] = element;
+    _structureVersion++;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+
+void DatabaseController::eraseStructureElement(StructureType type, uint64_t id) {
+  std::lock_guard<std::shared_timed_mutex> structureGuard(_structureMutex);
+  _structure.at((int32_t)type).erase(id);
+  _structureVersion++;
+}
+
+DatabaseController::PStructureElement DatabaseController::getStructureElement(StructureType type, uint64_t id) {
+  std::shared_lock<std::shared_timed_mutex> structureGuard(_structureMutex);
+  auto &elements = _structure.at((int32_t)type);
+  auto elementIterator = elements.find(id);
+  if (elementIterator == elements.end()) return PStructureElement();
+  return elementIterator->second;
+}
+
+std::vector<DatabaseController::PStructureElement> DatabaseController::getStructureElements(StructureType type) {
+  std::vector<PStructureElement> result;
+  std::shared_lock<std::shared_timed_mutex> structureGuard(_structureMutex);
+  auto &elements = _structure.at((int32_t)type);
+  result.reserve(elements.size());
+  for (auto &element: elements) {
+    result.emplace_back(element.second);
+  }
+  return result;
+}
+
+DatabaseController::PStructureElement DatabaseController::getStructureElementFromRow(StructureType type, std::map<uint32_t, std::shared_ptr<BaseLib::Database::DataColumn>> &row) {
+  auto element = std::make_shared<StructureElement>();
+  element->id = (uint64_t)row.at(0)->intValue;
+  auto &translations = row.at(1)->binaryValue;
+  auto &metadata = row.at(2)->binaryValue;
+  element->translations = translations ? _rpcDecoder->decodeResponse(*translations) : std::make_shared<BaseLib::Variable>();
+  element->metadata = metadata ? _rpcDecoder->decodeResponse(*metadata) : std::make_shared<BaseLib::Variable>();
+  element->hasMetadata = metadata && !metadata->empty();
+  if (type == StructureType::buildings) {
+    element->stories = row.at(3)->textValue;
+    element->buildingParts = row.at(4)->textValue;
+  } else if (type == StructureType::stories) {
+    element->rooms = row.at(3)->textValue;
+  }
+  return element;
+}
+//}}}
+
 //{{{ Buildings
 BaseLib::PVariable DatabaseController::addBuildingPartToBuilding(uint64_t buildingId, uint64_t buildingPartId) {
   try {
     if (!buildingPartExists(buildingPartId)) return BaseLib::Variable::createError(-2, "Unknown building part.");
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT buildingParts FROM buildings WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building.");
 
-    std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(element->buildingParts, ',');
     bool containsBuildingPart = false;
 
     std::ostringstream buildingPartStream;
@@ -1621,6 +2038,7 @@ BaseLib::PVariable DatabaseController::addBuildingPartToBuilding(uint64_t buildi
       data.push_front(std::make_shared<BaseLib::Database::DataColumn>(buildingPartString));
       _db.executeCommand("UPDATE buildings SET buildingParts=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE buildings SET buildingParts=? WHERE id=?", data, true);
+      reloadStructureElement(StructureType::buildings, buildingId);
     }
 
     return std::make_shared<BaseLib::Variable>();
@@ -1639,10 +2057,10 @@ BaseLib::PVariable DatabaseController::addStoryToBuilding(uint64_t buildingId, u
     if (!storyExists(storyId)) return BaseLib::Variable::createError(-2, "Unknown story.");
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT stories FROM buildings WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building.");
 
-    std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(element->stories, ',');
     bool containsStory = false;
 
     std::ostringstream storyStream;
@@ -1657,6 +2075,7 @@ BaseLib::PVariable DatabaseController::addStoryToBuilding(uint64_t buildingId, u
       data.push_front(std::make_shared<BaseLib::Database::DataColumn>(storyString));
       _db.executeCommand("UPDATE buildings SET stories=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE buildings SET stories=? WHERE id=?", data, true);
+      reloadStructureElement(StructureType::buildings, buildingId);
     }
 
     return std::make_shared<BaseLib::Variable>();
@@ -1689,6 +2108,7 @@ BaseLib::PVariable DatabaseController::createBuilding(BaseLib::PVariable transla
     uint64_t result = _db.executeWriteCommand("REPLACE INTO buildings VALUES(?, ?, ?, ?, ?)", data, false);
     data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
     _db.executeWriteCommand("REPLACE INTO buildings VALUES(?, ?, ?, ?, ?)", data, true);
+    reloadStructureElement(StructureType::buildings, result);
 
     return std::make_shared<BaseLib::Variable>(result);
   }
@@ -1705,10 +2125,11 @@ BaseLib::PVariable DatabaseController::deleteBuilding(uint64_t buildingId) {
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    if (_db.executeCommand("SELECT id FROM buildings WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    if (!getStructureElement(StructureType::buildings, buildingId)) return BaseLib::Variable::createError(-1, "Unknown building.");
 
     _db.executeWriteCommand("DELETE FROM buildings WHERE id=?", data, false);
     _db.executeWriteCommand("DELETE FROM buildings WHERE id=?", data, true);
+    eraseStructureElement(StructureType::buildings, buildingId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -1723,13 +2144,11 @@ BaseLib::PVariable DatabaseController::deleteBuilding(uint64_t buildingId) {
 
 BaseLib::PVariable DatabaseController::getBuildingPartsInBuilding(BaseLib::PRpcClientInfo clientInfo, uint64_t buildingId, bool checkAcls) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT buildingParts FROM buildings WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building.");
     std::multimap<int32_t, uint64_t> sortedBuildingParts;
     int32_t pos = 0;
-    std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(element->buildingParts, ',');
     for (auto &getBuildingPartString: buildingPartStrings) {
       auto buildingPart = (uint64_t)BaseLib::Math::getNumber64(getBuildingPartString);
       if (buildingPart != 0) {
@@ -1758,13 +2177,11 @@ BaseLib::PVariable DatabaseController::getBuildingPartsInBuilding(BaseLib::PRpcC
 
 BaseLib::PVariable DatabaseController::getStoriesInBuilding(BaseLib::PRpcClientInfo clientInfo, uint64_t buildingId, bool checkAcls) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT stories FROM buildings WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building.");
     std::multimap<int32_t, uint64_t> sortedStories;
     int32_t pos = 0;
-    std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(element->stories, ',');
     for (auto &storyString: storyStrings) {
       auto story = (uint64_t)BaseLib::Math::getNumber64(storyString);
       if (story != 0) {
@@ -1793,13 +2210,10 @@ BaseLib::PVariable DatabaseController::getStoriesInBuilding(BaseLib::PRpcClientI
 
 BaseLib::PVariable DatabaseController::getBuildingMetadata(uint64_t buildingId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    auto rows = _db.executeCommand("SELECT metadata FROM buildings WHERE id=?", data, false);
-
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown story.");
 
-    return _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    return std::make_shared<BaseLib::Variable>(*element->metadata);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -1815,11 +2229,11 @@ BaseLib::PVariable DatabaseController::getBuildings(std::string languageCode) {
     std::multimap<int32_t, BaseLib::PVariable> sortedBuildings;
     int32_t buildingPos = 0;
 
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, stories, buildingParts, metadata FROM buildings", false);
-    for (auto &row: *rows) {
+    auto elements = getStructureElements(StructureType::buildings);
+    for (auto &element: elements) {
       BaseLib::PVariable building = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      building->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-      BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+      building->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(element->id));
+      BaseLib::PVariable translations = std::make_shared<BaseLib::Variable>(*element->translations);
       if (languageCode.empty()) building->structValue->emplace("TRANSLATIONS", translations);
       else {
         auto translationIterator = translations->structValue->find(languageCode);
@@ -1844,7 +2258,7 @@ BaseLib::PVariable DatabaseController::getBuildings(std::string languageCode) {
       {
         std::multimap<int32_t, uint64_t> sortedStories;
         int32_t storyPos = 0;
-        std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(row.second.at(2)->textValue, ',');
+        std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(element->stories, ',');
         for (auto &storyString: storyStrings) {
           if (storyString.empty()) continue;
           auto story = (uint64_t)BaseLib::Math::getNumber64(storyString);
@@ -1866,7 +2280,7 @@ BaseLib::PVariable DatabaseController::getBuildings(std::string languageCode) {
       {
         std::multimap<int32_t, uint64_t> sortedBuildingParts;
         int32_t buildingPartPos = 0;
-        std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(row.second.at(3)->textValue, ',');
+        std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(element->buildingParts, ',');
         for (auto &buildingPartString: buildingPartStrings) {
           if (buildingPartString.empty()) continue;
           auto buildingPart = (uint64_t)BaseLib::Math::getNumber64(buildingPartString);
@@ -1885,8 +2299,8 @@ BaseLib::PVariable DatabaseController::getBuildings(std::string languageCode) {
         building->structValue->emplace("BUILDING_PARTS", buildingParts);
       }
 
-      if (!row.second.at(4)->binaryValue->empty()) {
-        BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(4)->binaryValue);
+      if (element->hasMetadata) {
+        BaseLib::PVariable metadata = std::make_shared<BaseLib::Variable>(*element->metadata);
         building->structValue->emplace("METADATA", metadata);
 
         auto positionIterator = metadata->structValue->find("position");
@@ -1917,10 +2331,10 @@ BaseLib::PVariable DatabaseController::getBuildings(std::string languageCode) {
 BaseLib::PVariable DatabaseController::removeBuildingPartFromBuildings(uint64_t buildingPartId) {
   try {
     if (buildingPartId == 0) return std::make_shared<BaseLib::Variable>(false);
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, buildingParts FROM buildings", false);
+    auto elements = getStructureElements(StructureType::buildings);
 
-    for (auto &i: *rows) {
-      std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(i.second.at(1)->textValue, ',');
+    for (auto &element: elements) {
+      std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(element->buildingParts, ',');
       bool containsBuildingPart = false;
 
       std::ostringstream buildingPartStream;
@@ -1934,9 +2348,10 @@ BaseLib::PVariable DatabaseController::removeBuildingPartFromBuildings(uint64_t
         std::string buildingPartString = buildingPartStream.str();
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingPartString));
-        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(i.second.at(0)->intValue));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(element->id));
         _db.executeCommand("UPDATE buildings SET buildingParts=? WHERE id=?", data, false);
         _db.executeCommand("UPDATE buildings SET buildingParts=? WHERE id=?", data, true);
+        reloadStructureElement(StructureType::buildings, element->id);
       }
     }
 
@@ -1956,10 +2371,10 @@ BaseLib::PVariable DatabaseController::removeBuildingPartFromBuilding(uint64_t b
     if (buildingPartId == 0) return BaseLib::Variable::createError(-2, "Invalid story ID.");
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT buildingParts FROM buildings WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building.");
 
-    std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> buildingPartStrings = BaseLib::HelperFunctions::splitAll(element->buildingParts, ',');
     bool containsBuildingPart = false;
 
     std::ostringstream buildingPartStream;
@@ -1974,6 +2389,7 @@ BaseLib::PVariable DatabaseController::removeBuildingPartFromBuilding(uint64_t b
       data.push_front(std::make_shared<BaseLib::Database::DataColumn>(buildingPartString));
       _db.executeCommand("UPDATE buildings SET buildingParts=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE buildings SET buildingParts=? WHERE id=?", data, true);
+      reloadStructureElement(StructureType::buildings, buildingId);
     }
 
     return std::make_shared<BaseLib::Variable>();
@@ -1990,10 +2406,10 @@ BaseLib::PVariable DatabaseController::removeBuildingPartFromBuilding(uint64_t b
 BaseLib::PVariable DatabaseController::removeStoryFromBuildings(uint64_t storyId) {
   try {
     if (storyId == 0) return std::make_shared<BaseLib::Variable>(false);
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, stories FROM buildings", false);
+    auto elements = getStructureElements(StructureType::buildings);
 
-    for (auto &i: *rows) {
-      std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(i.second.at(1)->textValue, ',');
+    for (auto &element: elements) {
+      std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(element->stories, ',');
       bool containsStory = false;
 
       std::ostringstream storyStream;
@@ -2007,9 +2423,10 @@ BaseLib::PVariable DatabaseController::removeStoryFromBuildings(uint64_t storyId
         std::string storyString = storyStream.str();
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyString));
-        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(i.second.at(0)->intValue));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(element->id));
         _db.executeCommand("UPDATE buildings SET stories=? WHERE id=?", data, false);
         _db.executeCommand("UPDATE buildings SET stories=? WHERE id=?", data, true);
+        reloadStructureElement(StructureType::buildings, element->id);
       }
     }
 
@@ -2029,10 +2446,10 @@ BaseLib::PVariable DatabaseController::removeStoryFromBuilding(uint64_t building
     if (storyId == 0) return BaseLib::Variable::createError(-2, "Invalid story ID.");
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT stories FROM buildings WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    auto element = getStructureElement(StructureType::buildings, buildingId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building.");
 
-    std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> storyStrings = BaseLib::HelperFunctions::splitAll(element->stories, ',');
     bool containsStory = false;
 
     std::ostringstream storyStream;
@@ -2047,6 +2464,7 @@ BaseLib::PVariable DatabaseController::removeStoryFromBuilding(uint64_t building
       data.push_front(std::make_shared<BaseLib::Database::DataColumn>(storyString));
       _db.executeCommand("UPDATE buildings SET stories=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE buildings SET stories=? WHERE id=?", data, true);
+      reloadStructureElement(StructureType::buildings, buildingId);
     }
 
     return std::make_shared<BaseLib::Variable>();
@@ -2062,9 +2480,7 @@ BaseLib::PVariable DatabaseController::removeStoryFromBuilding(uint64_t building
 
 bool DatabaseController::buildingExists(uint64_t buildingId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    return !_db.executeCommand("SELECT id FROM buildings WHERE id=?", data, false)->empty();
+    return (bool)getStructureElement(StructureType::buildings, buildingId);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2079,7 +2495,7 @@ BaseLib::PVariable DatabaseController::setBuildingMetadata(uint64_t buildingId,
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    if (_db.executeCommand("SELECT id FROM buildings WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    if (!getStructureElement(StructureType::buildings, buildingId)) return BaseLib::Variable::createError(-1, "Unknown building.");
 
     std::vector<char> metadataBlob;
     _rpcEncoder->encodeResponse(metadata, metadataBlob);
@@ -2087,6 +2503,7 @@ BaseLib::PVariable DatabaseController::setBuildingMetadata(uint64_t buildingId,
     data.push_front(std::make_shared<BaseLib::Database::DataColumn>(metadataBlob));
     _db.executeCommand("UPDATE buildings SET metadata=? WHERE id=?", data, false);
     _db.executeCommand("UPDATE buildings SET metadata=? WHERE id=?", data, true);
+    reloadStructureElement(StructureType::buildings, buildingId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2103,7 +2520,7 @@ BaseLib::PVariable DatabaseController::updateBuilding(uint64_t buildingId, BaseL
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingId));
-    if (_db.executeCommand("SELECT id FROM buildings WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown building.");
+    if (!getStructureElement(StructureType::buildings, buildingId)) return BaseLib::Variable::createError(-1, "Unknown building.");
 
     std::vector<char> translationsBlob;
     _rpcEncoder->encodeResponse(translations, translationsBlob);
@@ -2119,6 +2536,7 @@ BaseLib::PVariable DatabaseController::updateBuilding(uint64_t buildingId, BaseL
       _db.executeCommand("UPDATE buildings SET translations=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE buildings SET translations=? WHERE id=?", data, true);
     }
+    reloadStructureElement(StructureType::buildings, buildingId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2149,6 +2567,7 @@ BaseLib::PVariable DatabaseController::createBuildingPart(BaseLib::PVariable tra
     uint64_t result = _db.executeWriteCommand("REPLACE INTO buildingParts VALUES(?, ?, ?)", data, false);
     data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
     _db.executeWriteCommand("REPLACE INTO buildingParts VALUES(?, ?, ?)", data, true);
+    reloadStructureElement(StructureType::buildingParts, result);
 
     return std::make_shared<BaseLib::Variable>(result);
   }
@@ -2165,10 +2584,11 @@ BaseLib::PVariable DatabaseController::deleteBuildingPart(uint64_t buildingPartI
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingPartId));
-    if (_db.executeCommand("SELECT id FROM buildingParts WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown building part.");
+    if (!getStructureElement(StructureType::buildingParts, buildingPartId)) return BaseLib::Variable::createError(-1, "Unknown building part.");
 
     _db.executeWriteCommand("DELETE FROM buildingParts WHERE id=?", data, false);
     _db.executeWriteCommand("DELETE FROM buildingParts WHERE id=?", data, true);
+    eraseStructureElement(StructureType::buildingParts, buildingPartId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2183,13 +2603,10 @@ BaseLib::PVariable DatabaseController::deleteBuildingPart(uint64_t buildingPartI
 
 BaseLib::PVariable DatabaseController::getBuildingPartMetadata(uint64_t buildingPartId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingPartId));
-    auto rows = _db.executeCommand("SELECT metadata FROM buildingParts WHERE id=?", data, false);
-
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown building part.");
+    auto element = getStructureElement(StructureType::buildingParts, buildingPartId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown building part.");
 
-    return _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    return std::make_shared<BaseLib::Variable>(*element->metadata);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2205,12 +2622,12 @@ BaseLib::PVariable DatabaseController::getBuildingParts(BaseLib::PRpcClientInfo
     std::multimap<int32_t, BaseLib::PVariable> sortedBuildingParts;
     int32_t buildingPartPos = 0;
 
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM buildingParts", false);
-    for (auto &row: *rows) {
-      if (checkAcls && !clientInfo->acls->checkBuildingPartReadAccess(row.second.at(0)->intValue)) continue;
+    auto elements = getStructureElements(StructureType::buildingParts);
+    for (auto &element: elements) {
+      if (checkAcls && !clientInfo->acls->checkBuildingPartReadAccess(element->id)) continue;
       BaseLib::PVariable buildingPart = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      buildingPart->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-      BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+      buildingPart->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(element->id));
+      BaseLib::PVariable translations = std::make_shared<BaseLib::Variable>(*element->translations);
       if (languageCode.empty()) buildingPart->structValue->emplace("TRANSLATIONS", translations);
       else {
         auto translationIterator = translations->structValue->find(languageCode);
@@ -2232,8 +2649,8 @@ BaseLib::PVariable DatabaseController::getBuildingParts(BaseLib::PRpcClientInfo
         }
       }
 
-      if (!row.second.at(2)->binaryValue->empty()) {
-        BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+      if (element->hasMetadata) {
+        BaseLib::PVariable metadata = std::make_shared<BaseLib::Variable>(*element->metadata);
         buildingPart->structValue->emplace("METADATA", metadata);
 
         auto positionIterator = metadata->structValue->find("position");
@@ -2263,9 +2680,7 @@ BaseLib::PVariable DatabaseController::getBuildingParts(BaseLib::PRpcClientInfo
 
 bool DatabaseController::buildingPartExists(uint64_t buildingPartId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingPartId));
-    return !_db.executeCommand("SELECT id FROM buildingParts WHERE id=?", data, false)->empty();
+    return (bool)getStructureElement(StructureType::buildingParts, buildingPartId);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2280,7 +2695,7 @@ BaseLib::PVariable DatabaseController::setBuildingPartMetadata(uint64_t building
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingPartId));
-    if (_db.executeCommand("SELECT id FROM buildingParts WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown building part.");
+    if (!getStructureElement(StructureType::buildingParts, buildingPartId)) return BaseLib::Variable::createError(-1, "Unknown building part.");
 
     std::vector<char> metadataBlob;
     _rpcEncoder->encodeResponse(metadata, metadataBlob);
@@ -2288,6 +2703,7 @@ BaseLib::PVariable DatabaseController::setBuildingPartMetadata(uint64_t building
     data.push_front(std::make_shared<BaseLib::Database::DataColumn>(metadataBlob));
     _db.executeCommand("UPDATE buildingParts SET metadata=? WHERE id=?", data, false);
     _db.executeCommand("UPDATE buildingParts SET metadata=? WHERE id=?", data, true);
+    reloadStructureElement(StructureType::buildingParts, buildingPartId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2304,7 +2720,7 @@ BaseLib::PVariable DatabaseController::updateBuildingPart(uint64_t buildingPartI
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(buildingPartId));
-    if (_db.executeCommand("SELECT id FROM buildingParts WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown building part.");
+    if (!getStructureElement(StructureType::buildingParts, buildingPartId)) return BaseLib::Variable::createError(-1, "Unknown building part.");
 
     std::vector<char> translationsBlob;
     _rpcEncoder->encodeResponse(translations, translationsBlob);
@@ -2320,6 +2736,7 @@ BaseLib::PVariable DatabaseController::updateBuildingPart(uint64_t buildingPartI
       _db.executeCommand("UPDATE buildingParts SET translations=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE buildingParts SET translations=? WHERE id=?", data, true);
     }
+    reloadStructureElement(StructureType::buildingParts, buildingPartId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2339,10 +2756,10 @@ BaseLib::PVariable DatabaseController::addRoomToStory(uint64_t storyId, uint64_t
     if (!roomExists(roomId)) return BaseLib::Variable::createError(-2, "Unknown room.");
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT rooms FROM stories WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    auto element = getStructureElement(StructureType::stories, storyId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown story.");
 
-    std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(element->rooms, ',');
     bool containsRoom = false;
 
     std::ostringstream roomStream;
@@ -2357,6 +2774,7 @@ BaseLib::PVariable DatabaseController::addRoomToStory(uint64_t storyId, uint64_t
       data.push_front(std::make_shared<BaseLib::Database::DataColumn>(roomString));
       _db.executeCommand("UPDATE stories SET rooms=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE stories SET rooms=? WHERE id=?", data, true);
+      reloadStructureElement(StructureType::stories, storyId);
     }
 
     return std::make_shared<BaseLib::Variable>();
@@ -2388,6 +2806,7 @@ BaseLib::PVariable DatabaseController::createStory(BaseLib::PVariable translatio
     uint64_t result = _db.executeWriteCommand("REPLACE INTO stories VALUES(?, ?, ?, ?)", data, false);
     data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
     _db.executeWriteCommand("REPLACE INTO stories VALUES(?, ?, ?, ?)", data, true);
+    reloadStructureElement(StructureType::stories, result);
 
     return std::make_shared<BaseLib::Variable>(result);
   }
@@ -2404,10 +2823,11 @@ BaseLib::PVariable DatabaseController::deleteStory(uint64_t storyId) {
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    if (_db.executeCommand("SELECT id FROM stories WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    if (!getStructureElement(StructureType::stories, storyId)) return BaseLib::Variable::createError(-1, "Unknown story.");
 
     _db.executeWriteCommand("DELETE FROM stories WHERE id=?", data, false);
     _db.executeWriteCommand("DELETE FROM stories WHERE id=?", data, true);
+    eraseStructureElement(StructureType::stories, storyId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2422,13 +2842,11 @@ BaseLib::PVariable DatabaseController::deleteStory(uint64_t storyId) {
 
 BaseLib::PVariable DatabaseController::getRoomsInStory(BaseLib::PRpcClientInfo clientInfo, uint64_t storyId, bool checkAcls) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT rooms FROM stories WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    auto element = getStructureElement(StructureType::stories, storyId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown story.");
     std::multimap<int32_t, uint64_t> sortedRooms;
     int32_t pos = 0;
-    std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(element->rooms, ',');
     for (auto &roomString: roomStrings) {
       auto room = (uint64_t)BaseLib::Math::getNumber64(roomString);
       if (checkAcls && !clientInfo->acls->checkRoomReadAccess(room)) continue;
@@ -2458,13 +2876,10 @@ BaseLib::PVariable DatabaseController::getRoomsInStory(BaseLib::PRpcClientInfo c
 
 BaseLib::PVariable DatabaseController::getStoryMetadata(uint64_t storyId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    auto rows = _db.executeCommand("SELECT metadata FROM stories WHERE id=?", data, false);
+    auto element = getStructureElement(StructureType::stories, storyId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown story.");
 
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
-
-    return _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    return std::make_shared<BaseLib::Variable>(*element->metadata);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2480,11 +2895,11 @@ BaseLib::PVariable DatabaseController::getStories(std::string languageCode) {
     std::multimap<int32_t, BaseLib::PVariable> sortedStories;
     int32_t storyPos = 0;
 
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, rooms, metadata FROM stories", false);
-    for (auto &row: *rows) {
+    auto elements = getStructureElements(StructureType::stories);
+    for (auto &element: elements) {
       BaseLib::PVariable story = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      story->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-      BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+      story->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(element->id));
+      BaseLib::PVariable translations = std::make_shared<BaseLib::Variable>(*element->translations);
       if (languageCode.empty()) story->structValue->emplace("TRANSLATIONS", translations);
       else {
         auto translationIterator = translations->structValue->find(languageCode);
@@ -2508,7 +2923,7 @@ BaseLib::PVariable DatabaseController::getStories(std::string languageCode) {
 
       std::multimap<int32_t, uint64_t> sortedRooms;
       int32_t roomPos = 0;
-      std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(row.second.at(2)->textValue, ',');
+      std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(element->rooms, ',');
       for (auto &roomString: roomStrings) {
         if (roomString.empty()) continue;
         auto room = (uint64_t)BaseLib::Math::getNumber64(roomString);
@@ -2526,8 +2941,8 @@ BaseLib::PVariable DatabaseController::getStories(std::string languageCode) {
       }
       story->structValue->emplace("ROOMS", rooms);
 
-      if (!row.second.at(3)->binaryValue->empty()) {
-        BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(3)->binaryValue);
+      if (element->hasMetadata) {
+        BaseLib::PVariable metadata = std::make_shared<BaseLib::Variable>(*element->metadata);
         story->structValue->emplace("METADATA", metadata);
 
         auto positionIterator = metadata->structValue->find("position");
@@ -2558,10 +2973,10 @@ BaseLib::PVariable DatabaseController::getStories(std::string languageCode) {
 BaseLib::PVariable DatabaseController::removeRoomFromStories(uint64_t roomId) {
   try {
     if (roomId == 0) return std::make_shared<BaseLib::Variable>(false);
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, rooms FROM stories", false);
+    auto elements = getStructureElements(StructureType::stories);
 
-    for (auto &i: *rows) {
-      std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(i.second.at(1)->textValue, ',');
+    for (auto &element: elements) {
+      std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(element->rooms, ',');
       bool containsRoom = false;
 
       std::ostringstream roomStream;
@@ -2575,9 +2990,10 @@ BaseLib::PVariable DatabaseController::removeRoomFromStories(uint64_t roomId) {
         std::string roomString = roomStream.str();
         BaseLib::Database::DataRow data;
         data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomString));
-        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(i.second.at(0)->intValue));
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(element->id));
         _db.executeCommand("UPDATE stories SET rooms=? WHERE id=?", data, false);
         _db.executeCommand("UPDATE stories SET rooms=? WHERE id=?", data, true);
+        reloadStructureElement(StructureType::stories, element->id);
       }
     }
 
@@ -2597,10 +3013,10 @@ BaseLib::PVariable DatabaseController::removeRoomFromStory(uint64_t storyId, uin
     if (roomId == 0) return BaseLib::Variable::createError(-2, "Invalid room ID.");
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT rooms FROM stories WHERE id=?", data, false);
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    auto element = getStructureElement(StructureType::stories, storyId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown story.");
 
-    std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(rows->at(0).at(0)->textValue, ',');
+    std::vector<std::string> roomStrings = BaseLib::HelperFunctions::splitAll(element->rooms, ',');
     bool containsRoom = false;
 
     std::ostringstream roomStream;
@@ -2615,6 +3031,7 @@ BaseLib::PVariable DatabaseController::removeRoomFromStory(uint64_t storyId, uin
       data.push_front(std::make_shared<BaseLib::Database::DataColumn>(roomString));
       _db.executeCommand("UPDATE stories SET rooms=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE stories SET rooms=? WHERE id=?", data, true);
+      reloadStructureElement(StructureType::stories, storyId);
     }
 
     return std::make_shared<BaseLib::Variable>();
@@ -2630,9 +3047,7 @@ BaseLib::PVariable DatabaseController::removeRoomFromStory(uint64_t storyId, uin
 
 bool DatabaseController::storyExists(uint64_t storyId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    return !_db.executeCommand("SELECT id FROM stories WHERE id=?", data, false)->empty();
+    return (bool)getStructureElement(StructureType::stories, storyId);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2647,7 +3062,7 @@ BaseLib::PVariable DatabaseController::setStoryMetadata(uint64_t storyId, BaseLi
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    if (_db.executeCommand("SELECT id FROM stories WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    if (!getStructureElement(StructureType::stories, storyId)) return BaseLib::Variable::createError(-1, "Unknown story.");
 
     std::vector<char> metadataBlob;
     _rpcEncoder->encodeResponse(metadata, metadataBlob);
@@ -2655,6 +3070,7 @@ BaseLib::PVariable DatabaseController::setStoryMetadata(uint64_t storyId, BaseLi
     data.push_front(std::make_shared<BaseLib::Database::DataColumn>(metadataBlob));
     _db.executeCommand("UPDATE stories SET metadata=? WHERE id=?", data, false);
     _db.executeCommand("UPDATE stories SET metadata=? WHERE id=?", data, true);
+    reloadStructureElement(StructureType::stories, storyId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2671,7 +3087,7 @@ BaseLib::PVariable DatabaseController::updateStory(uint64_t storyId, BaseLib::PV
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(storyId));
-    if (_db.executeCommand("SELECT id FROM stories WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown story.");
+    if (!getStructureElement(StructureType::stories, storyId)) return BaseLib::Variable::createError(-1, "Unknown story.");
 
     std::vector<char> translationsBlob;
     _rpcEncoder->encodeResponse(translations, translationsBlob);
@@ -2687,6 +3103,7 @@ BaseLib::PVariable DatabaseController::updateStory(uint64_t storyId, BaseLib::PV
       _db.executeCommand("UPDATE stories SET translations=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE stories SET translations=? WHERE id=?", data, true);
     }
+    reloadStructureElement(StructureType::stories, storyId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2717,6 +3134,7 @@ BaseLib::PVariable DatabaseController::createRoom(BaseLib::PVariable translation
     uint64_t result = _db.executeWriteCommand("REPLACE INTO rooms VALUES(?, ?, ?)", data, false);
     data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
     _db.executeWriteCommand("REPLACE INTO rooms VALUES(?, ?, ?)", data, true);
+    reloadStructureElement(StructureType::rooms, result);
 
     return std::make_shared<BaseLib::Variable>(result);
   }
@@ -2733,10 +3151,11 @@ BaseLib::PVariable DatabaseController::deleteRoom(uint64_t roomId) {
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomId));
-    if (_db.executeCommand("SELECT id FROM rooms WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown room.");
+    if (!getStructureElement(StructureType::rooms, roomId)) return BaseLib::Variable::createError(-1, "Unknown room.");
 
     _db.executeWriteCommand("DELETE FROM rooms WHERE id=?", data, false);
     _db.executeWriteCommand("DELETE FROM rooms WHERE id=?", data, true);
+    eraseStructureElement(StructureType::rooms, roomId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2751,13 +3170,10 @@ BaseLib::PVariable DatabaseController::deleteRoom(uint64_t roomId) {
 
 std::string DatabaseController::getRoomName(BaseLib::PRpcClientInfo clientInfo, uint64_t roomId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomId));
-    auto rows = _db.executeCommand("SELECT translations FROM rooms WHERE id=?", data, false);
-
-    if (rows->empty()) return "";
+    auto element = getStructureElement(StructureType::rooms, roomId);
+    if (!element) return "";
 
-    auto translations = _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    auto &translations = element->translations;
     auto language = clientInfo->language;
     if (language.empty()) language = "en";
 
@@ -2790,13 +3206,10 @@ std::string DatabaseController::getRoomName(BaseLib::PRpcClientInfo clientInfo,
 
 BaseLib::PVariable DatabaseController::getRoomMetadata(uint64_t roomId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomId));
-    auto rows = _db.executeCommand("SELECT metadata FROM rooms WHERE id=?", data, false);
+    auto element = getStructureElement(StructureType::rooms, roomId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown room.");
 
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown room.");
-
-    return _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    return std::make_shared<BaseLib::Variable>(*element->metadata);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2812,12 +3225,12 @@ BaseLib::PVariable DatabaseController::getRooms(BaseLib::PRpcClientInfo clientIn
     std::multimap<int32_t, BaseLib::PVariable> sortedRooms;
     int32_t pos = 0;
 
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM rooms", false);
-    for (auto &row: *rows) {
-      if (checkAcls && !clientInfo->acls->checkRoomReadAccess(row.second.at(0)->intValue)) continue;
+    auto elements = getStructureElements(StructureType::rooms);
+    for (auto &element: elements) {
+      if (checkAcls && !clientInfo->acls->checkRoomReadAccess(element->id)) continue;
       BaseLib::PVariable room = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      room->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-      BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+      room->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(element->id));
+      BaseLib::PVariable translations = std::make_shared<BaseLib::Variable>(*element->translations);
       if (languageCode.empty()) room->structValue->emplace("TRANSLATIONS", translations);
       else {
         auto translationIterator = translations->structValue->find(languageCode);
@@ -2838,8 +3251,8 @@ BaseLib::PVariable DatabaseController::getRooms(BaseLib::PRpcClientInfo clientIn
           }
         }
       }
-      if (!row.second.at(2)->binaryValue->empty()) {
-        BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+      if (element->hasMetadata) {
+        BaseLib::PVariable metadata = std::make_shared<BaseLib::Variable>(*element->metadata);
         room->structValue->emplace("METADATA", metadata);
 
         auto positionIterator = metadata->structValue->find("position");
@@ -2869,9 +3282,7 @@ BaseLib::PVariable DatabaseController::getRooms(BaseLib::PRpcClientInfo clientIn
 
 bool DatabaseController::roomExists(uint64_t roomId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomId));
-    return !_db.executeCommand("SELECT id FROM rooms WHERE id=?", data, false)->empty();
+    return (bool)getStructureElement(StructureType::rooms, roomId);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2886,7 +3297,7 @@ BaseLib::PVariable DatabaseController::setRoomMetadata(uint64_t roomId, BaseLib:
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomId));
-    if (_db.executeCommand("SELECT id FROM rooms WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown room.");
+    if (!getStructureElement(StructureType::rooms, roomId)) return BaseLib::Variable::createError(-1, "Unknown room.");
 
     std::vector<char> metadataBlob;
     _rpcEncoder->encodeResponse(metadata, metadataBlob);
@@ -2894,6 +3305,7 @@ BaseLib::PVariable DatabaseController::setRoomMetadata(uint64_t roomId, BaseLib:
     data.push_front(std::make_shared<BaseLib::Database::DataColumn>(metadataBlob));
     _db.executeCommand("UPDATE rooms SET metadata=? WHERE id=?", data, false);
     _db.executeCommand("UPDATE rooms SET metadata=? WHERE id=?", data, true);
+    reloadStructureElement(StructureType::rooms, roomId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2910,7 +3322,7 @@ BaseLib::PVariable DatabaseController::updateRoom(uint64_t roomId, BaseLib::PVar
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roomId));
-    if (_db.executeCommand("SELECT id FROM rooms WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown room.");
+    if (!getStructureElement(StructureType::rooms, roomId)) return BaseLib::Variable::createError(-1, "Unknown room.");
 
     std::vector<char> translationsBlob;
     _rpcEncoder->encodeResponse(translations, translationsBlob);
@@ -2926,6 +3338,7 @@ BaseLib::PVariable DatabaseController::updateRoom(uint64_t roomId, BaseLib::PVar
       _db.executeCommand("UPDATE rooms SET translations=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE rooms SET translations=? WHERE id=?", data, true);
     }
+    reloadStructureElement(StructureType::rooms, roomId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2956,6 +3369,7 @@ BaseLib::PVariable DatabaseController::createCategory(BaseLib::PVariable transla
     uint64_t result = _db.executeWriteCommand("REPLACE INTO categories VALUES(?, ?, ?)", data, false);
     data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
     _db.executeWriteCommand("REPLACE INTO categories VALUES(?, ?, ?)", data, true);
+    reloadStructureElement(StructureType::categories, result);
 
     return std::make_shared<BaseLib::Variable>(result);
   }
@@ -2972,10 +3386,11 @@ BaseLib::PVariable DatabaseController::deleteCategory(uint64_t categoryId) {
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(categoryId));
-    if (_db.executeCommand("SELECT id FROM categories WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown category.");
+    if (!getStructureElement(StructureType::categories, categoryId)) return BaseLib::Variable::createError(-1, "Unknown category.");
 
     _db.executeWriteCommand("DELETE FROM categories WHERE id=?", data, false);
     _db.executeWriteCommand("DELETE FROM categories WHERE id=?", data, true);
+    eraseStructureElement(StructureType::categories, categoryId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -2993,12 +3408,12 @@ BaseLib::PVariable DatabaseController::getCategories(BaseLib::PRpcClientInfo cli
     std::multimap<int32_t, BaseLib::PVariable> sortedCategories;
     int32_t pos = 0;
 
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM categories", false);
-    for (auto &row: *rows) {
-      if (checkAcls && !clientInfo->acls->checkCategoryReadAccess(row.second.at(0)->intValue)) continue;
+    auto elements = getStructureElements(StructureType::categories);
+    for (auto &element: elements) {
+      if (checkAcls && !clientInfo->acls->checkCategoryReadAccess(element->id)) continue;
       BaseLib::PVariable category = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      category->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-      BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+      category->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(element->id));
+      BaseLib::PVariable translations = std::make_shared<BaseLib::Variable>(*element->translations);
       if (languageCode.empty()) category->structValue->emplace("TRANSLATIONS", translations);
       else {
         auto translationIterator = translations->structValue->find(languageCode);
@@ -3019,8 +3434,8 @@ BaseLib::PVariable DatabaseController::getCategories(BaseLib::PRpcClientInfo cli
           }
         }
       }
-      if (!row.second.at(2)->binaryValue->empty()) {
-        BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+      if (element->hasMetadata) {
+        BaseLib::PVariable metadata = std::make_shared<BaseLib::Variable>(*element->metadata);
         category->structValue->emplace("METADATA", metadata);
 
         auto positionIterator = metadata->structValue->find("position");
@@ -3050,13 +3465,10 @@ BaseLib::PVariable DatabaseController::getCategories(BaseLib::PRpcClientInfo cli
 
 BaseLib::PVariable DatabaseController::getCategoryMetadata(uint64_t categoryId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(categoryId));
-    auto rows = _db.executeCommand("SELECT metadata FROM categories WHERE id=?", data, false);
-
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown category.");
+    auto element = getStructureElement(StructureType::categories, categoryId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown category.");
 
-    return _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    return std::make_shared<BaseLib::Variable>(*element->metadata);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3069,9 +3481,7 @@ BaseLib::PVariable DatabaseController::getCategoryMetadata(uint64_t categoryId)
 
 bool DatabaseController::categoryExists(uint64_t categoryId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(categoryId));
-    return !_db.executeCommand("SELECT id FROM categories WHERE id=?", data, false)->empty();
+    return (bool)getStructureElement(StructureType::categories, categoryId);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3086,7 +3496,7 @@ BaseLib::PVariable DatabaseController::setCategoryMetadata(uint64_t categoryId,
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(categoryId));
-    if (_db.executeCommand("SELECT id FROM categories WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown category.");
+    if (!getStructureElement(StructureType::categories, categoryId)) return BaseLib::Variable::createError(-1, "Unknown category.");
 
     std::vector<char> metadataBlob;
     _rpcEncoder->encodeResponse(metadata, metadataBlob);
@@ -3094,6 +3504,7 @@ BaseLib::PVariable DatabaseController::setCategoryMetadata(uint64_t categoryId,
     data.push_front(std::make_shared<BaseLib::Database::DataColumn>(metadataBlob));
     _db.executeCommand("UPDATE categories SET metadata=? WHERE id=?", data, false);
     _db.executeCommand("UPDATE categories SET metadata=? WHERE id=?", data, true);
+    reloadStructureElement(StructureType::categories, categoryId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -3110,7 +3521,7 @@ BaseLib::PVariable DatabaseController::updateCategory(uint64_t categoryId, BaseL
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(categoryId));
-    if (_db.executeCommand("SELECT id FROM categories WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown category.");
+    if (!getStructureElement(StructureType::categories, categoryId)) return BaseLib::Variable::createError(-1, "Unknown category.");
 
     std::vector<char> translationsBlob;
     _rpcEncoder->encodeResponse(translations, translationsBlob);
@@ -3126,6 +3537,7 @@ BaseLib::PVariable DatabaseController::updateCategory(uint64_t categoryId, BaseL
       _db.executeCommand("UPDATE categories SET translations=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE categories SET translations=? WHERE id=?", data, true);
     }
+    reloadStructureElement(StructureType::categories, categoryId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -3222,6 +3634,8 @@ void DatabaseController::createDefaultRoles() {
 
               createRoleInternal(id, translationsIterator->second, metadata);
             }
+
+            loadStructure(StructureType::roles);
           }
           catch (std::exception &ex) {
             GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3272,6 +3686,7 @@ BaseLib::PVariable DatabaseController::createRole(BaseLib::PVariable translation
     uint64_t result = _db.executeWriteCommand("REPLACE INTO roles VALUES(?, ?, ?)", data, false);
     data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
     _db.executeWriteCommand("REPLACE INTO roles VALUES(?, ?, ?)", data, true);
+    reloadStructureElement(StructureType::roles, result);
 
     return std::make_shared<BaseLib::Variable>(result);
   }
@@ -3288,10 +3703,11 @@ BaseLib::PVariable DatabaseController::deleteRole(uint64_t roleId) {
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roleId));
-    if (_db.executeCommand("SELECT id FROM roles WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown role.");
+    if (!getStructureElement(StructureType::roles, roleId)) return BaseLib::Variable::createError(-1, "Unknown role.");
 
     _db.executeWriteCommand("DELETE FROM roles WHERE id=?", data, false);
     _db.executeWriteCommand("DELETE FROM roles WHERE id=?", data, true);
+    eraseStructureElement(StructureType::roles, roleId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -3312,6 +3728,8 @@ void DatabaseController::deleteAllRoles() {
     _db.executeCommand("CREATE TABLE IF NOT EXISTS roles (id INTEGER PRIMARY KEY UNIQUE, translations BLOB, metadata BLOB)", true);
     _db.executeCommand("CREATE INDEX IF NOT EXISTS rolesIndex ON roles (id)", false);
     _db.executeCommand("CREATE INDEX IF NOT EXISTS rolesIndex ON roles (id)", true);
+
+    loadStructure(StructureType::roles);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3323,12 +3741,12 @@ BaseLib::PVariable DatabaseController::getRoles(BaseLib::PRpcClientInfo clientIn
     std::multimap<int32_t, BaseLib::PVariable> sortedRoles;
     int32_t pos = 0;
 
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT id, translations, metadata FROM roles", false);
-    for (auto &row: *rows) {
-      if (checkAcls && !clientInfo->acls->checkRoleReadAccess(row.second.at(0)->intValue)) continue;
+    auto elements = getStructureElements(StructureType::roles);
+    for (auto &element: elements) {
+      if (checkAcls && !clientInfo->acls->checkRoleReadAccess(element->id)) continue;
       BaseLib::PVariable role = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      role->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(row.second.at(0)->intValue));
-      BaseLib::PVariable translations = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
+      role->structValue->emplace("ID", std::make_shared<BaseLib::Variable>(element->id));
+      BaseLib::PVariable translations = std::make_shared<BaseLib::Variable>(*element->translations);
       if (languageCode.empty()) role->structValue->emplace("TRANSLATIONS", translations);
       else {
         auto translationIterator = translations->structValue->find(languageCode);
@@ -3349,8 +3767,8 @@ BaseLib::PVariable DatabaseController::getRoles(BaseLib::PRpcClientInfo clientIn
           }
         }
       }
-      if (!row.second.at(2)->binaryValue->empty()) {
-        BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*row.second.at(2)->binaryValue);
+      if (element->hasMetadata) {
+        BaseLib::PVariable metadata = std::make_shared<BaseLib::Variable>(*element->metadata);
         role->structValue->emplace("METADATA", metadata);
 
         auto positionIterator = metadata->structValue->find("position");
@@ -3380,13 +3798,10 @@ BaseLib::PVariable DatabaseController::getRoles(BaseLib::PRpcClientInfo clientIn
 
 BaseLib::PVariable DatabaseController::getRoleMetadata(uint64_t roleId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roleId));
-    auto rows = _db.executeCommand("SELECT metadata FROM roles WHERE id=?", data, false);
-
-    if (rows->empty()) return BaseLib::Variable::createError(-1, "Unknown role.");
+    auto element = getStructureElement(StructureType::roles, roleId);
+    if (!element) return BaseLib::Variable::createError(-1, "Unknown role.");
 
-    return _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
+    return std::make_shared<BaseLib::Variable>(*element->metadata);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3399,9 +3814,7 @@ BaseLib::PVariable DatabaseController::getRoleMetadata(uint64_t roleId) {
 
 bool DatabaseController::roleExists(uint64_t roleId) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roleId));
-    return !_db.executeCommand("SELECT id FROM roles WHERE id=?", data, false)->empty();
+    return (bool)getStructureElement(StructureType::roles, roleId);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3416,7 +3829,7 @@ BaseLib::PVariable DatabaseController::setRoleMetadata(uint64_t roleId, BaseLib:
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roleId));
-    if (_db.executeCommand("SELECT id FROM roles WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown role.");
+    if (!getStructureElement(StructureType::roles, roleId)) return BaseLib::Variable::createError(-1, "Unknown role.");
 
     std::vector<char> metadataBlob;
     _rpcEncoder->encodeResponse(metadata, metadataBlob);
@@ -3424,6 +3837,7 @@ BaseLib::PVariable DatabaseController::setRoleMetadata(uint64_t roleId, BaseLib:
     data.push_front(std::make_shared<BaseLib::Database::DataColumn>(metadataBlob));
     _db.executeCommand("UPDATE roles SET metadata=? WHERE id=?", data, false);
     _db.executeCommand("UPDATE roles SET metadata=? WHERE id=?", data, true);
+    reloadStructureElement(StructureType::roles, roleId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -3440,7 +3854,7 @@ BaseLib::PVariable DatabaseController::updateRole(uint64_t roleId, BaseLib::PVar
   try {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(roleId));
-    if (_db.executeCommand("SELECT id FROM roles WHERE id=?", data, false)->empty()) return BaseLib::Variable::createError(-1, "Unknown role.");
+    if (!getStructureElement(StructureType::roles, roleId)) return BaseLib::Variable::createError(-1, "Unknown role.");
 
     std::vector<char> translationsBlob;
     _rpcEncoder->encodeResponse(translations, translationsBlob);
@@ -3456,6 +3870,7 @@ BaseLib::PVariable DatabaseController::updateRole(uint64_t roleId, BaseLib::PVar
       _db.executeCommand("UPDATE roles SET translations=? WHERE id=?", data, false);
       _db.executeCommand("UPDATE roles SET translations=? WHERE id=?", data, true);
     }
+    reloadStructureElement(StructureType::roles, roleId);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -3494,59 +3909,47 @@ BaseLib::PVariable DatabaseController::getNodeData(const std::string &node, cons
   try {
     BaseLib::PVariable value;
 
-    bool obfuscate = false;
-
-    //Only return passwords if request comes from FlowsServer
-    std::string lowerCharKey = key;
-    BaseLib::HelperFunctions::toLower(lowerCharKey);
-    if (!requestFromTrustedServer && lowerCharKey.size() >= 8 && (lowerCharKey.compare(lowerCharKey.size() - 8, 8, "password") == 0 || (lowerCharKey.size() >= 11 && lowerCharKey.compare(lowerCharKey.size() - 11, 11, "private_key") == 0)))
-      obfuscate = true;
-
-    if (!key.empty()) {
-      std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-      auto componentIterator = _nodeData.find(node);
-      if (componentIterator != _nodeData.end()) {
-        auto keyIterator = componentIterator->second.find(key);
-        if (keyIterator != componentIterator->second.end()) {
-          value = keyIterator->second;
-          if (obfuscate) value = value->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
-          return value;
+    if (key.empty()) {
+      std::map<std::string, BaseLib::PVariable> values;
+      if (!_nodeData.getComponent(node, values)) {
+        BaseLib::Database::DataRow data;
+        data.push_back(std::make_shared<BaseLib::Database::DataColumn>(node));
+        std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT key, value FROM nodeData WHERE node=?", data, false);
+        for (auto &row: *rows) {
+          if (row.second.size() < 2) continue;
+          values.emplace(row.second.at(0)->textValue, _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue));
         }
+        _nodeData.fillComponent(node, values);
       }
-    }
-
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(node));
-    std::string command;
-    if (!key.empty()) {
-      command = "SELECT value FROM nodeData WHERE node=? AND key=?";
-      data.push_back(std::make_shared<BaseLib::Database::DataColumn>(key));
-    } else command = "SELECT key, value FROM nodeData WHERE node=?";
-
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand(command, data, false);
-    if (rows->empty() || rows->at(0).empty()) return std::make_shared<BaseLib::Variable>();
+      if (values.empty()) return std::make_shared<BaseLib::Variable>();
 
-    if (key.empty()) {
       value = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      for (auto &row: *rows) {
-        std::string innerKey = row.second.at(0)->textValue;
-        lowerCharKey = innerKey;
-        BaseLib::HelperFunctions::toLower(lowerCharKey);
-        BaseLib::PVariable innerValue;
+      for (auto &entry: values) {
         //Only return passwords if request comes from FlowsServer
-        innerValue = _rpcDecoder->decodeResponse(*row.second.at(1)->binaryValue);
-        if (!requestFromTrustedServer && lowerCharKey.size() >= 8 && (lowerCharKey.compare(lowerCharKey.size() - 8, 8, "password") == 0 || (lowerCharKey.size() >= 11 && lowerCharKey.compare(lowerCharKey.size() - 11, 11, "private_key") == 0))) {
-          innerValue = innerValue->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
-        }
-        value->structValue->emplace(innerKey, innerValue);
+        if (!requestFromTrustedServer && isSecretNodeDataKey(entry.first)) value->structValue->emplace(entry.first, obfuscateNodeData(entry.second));
+        else value->structValue->emplace(entry.first, entry.second);
       }
-    } else {
+      return value;
+    }
+
+    auto lookupResult = _nodeData.get(node, key, value);
+    if (lookupResult == DataCache::LookupResult::negativeHit) return std::make_shared<BaseLib::Variable>();
+    else if (lookupResult == DataCache::LookupResult::miss) {
+      BaseLib::Database::DataRow data;
+      data.push_back(std::make_shared<BaseLib::Database::DataColumn>(node));
+      data.push_back(std::make_shared<BaseLib::Database::DataColumn>(key));
+      std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT value FROM nodeData WHERE node=? AND key=?", data, false);
+      if (rows->empty() || rows->at(0).empty()) {
+        _nodeData.fill(node, key, BaseLib::PVariable());
+        return std::make_shared<BaseLib::Variable>();
+      }
+
       value = _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
-      std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-      _nodeData[node][key] = value;
+      _nodeData.fill(node, key, value);
     }
 
-    if (obfuscate) value = value->stringValue.empty() ? std::make_shared<BaseLib::Variable>(std::string()) : std::make_shared<BaseLib::Variable>(std::string("*"));
+    //Only return passwords if request comes from FlowsServer
+    if (!requestFromTrustedServer && isSecretNodeDataKey(key)) value = obfuscateNodeData(value);
     return value;
   }
   catch (const std::exception &ex) {
@@ -3578,22 +3981,21 @@ BaseLib::PVariable DatabaseController::setNodeData(const std::string &node, cons
       return BaseLib::Variable::createError(-32500, "Reached limit of 1000000 data entries. Please delete data before adding new entries.");
     }
 
-    {
-      std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-      _nodeData[node][key] = value;
-    }
+    _nodeData.set(node, key, value);
 
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(node));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(key));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM nodeData WHERE node=? AND key=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     std::vector<char> encodedValue;
     _rpcEncoder->encodeResponse(value, encodedValue);
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(encodedValue));
-    entry = std::make_shared<QueueEntry>("INSERT INTO nodeData VALUES(?, ?, ?)", data);
-    enqueue(0, entry);
+    auto insertEntry = std::make_shared<QueueEntry>("INSERT INTO nodeData VALUES(?, ?, ?)", data);
+    insertEntry->setWrittenCallback([this, node]() { _nodeData.endWrite(node); });
+    entry = insertEntry;
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tVoid);
   }
@@ -3608,14 +4010,8 @@ BaseLib::PVariable DatabaseController::setNodeData(const std::string &node, cons
 
 BaseLib::PVariable DatabaseController::deleteNodeData(const std::string &node, const std::string &key) {
   try {
-    {
-      std::lock_guard<std::mutex> dataGuard(_nodeDataMutex);
-      if (key.empty()) _nodeData.erase(node);
-      else {
-        auto dataIterator = _nodeData.find(node);
-        if (dataIterator != _nodeData.end()) dataIterator->second.erase(key);
-      }
-    }
+    if (key.empty()) _nodeData.eraseComponent(node);
+    else _nodeData.erase(node, key);
 
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(node));
@@ -3624,8 +4020,10 @@ BaseLib::PVariable DatabaseController::deleteNodeData(const std::string &node, c
       data.push_back(std::make_shared<BaseLib::Database::DataColumn>(key));
       command.append(" AND key=?");
     }
-    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-    enqueue(0, entry);
+    auto queueEntry = std::make_shared<QueueEntry>(command, data);
+    queueEntry->setWrittenCallback([this, node]() { _nodeData.endWrite(node); });
+    std::shared_ptr<BaseLib::IQueueEntry> entry = queueEntry;
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tVoid);
   }
@@ -3642,17 +4040,23 @@ BaseLib::PVariable DatabaseController::deleteNodeData(const std::string &node, c
 //Metadata
 BaseLib::PVariable DatabaseController::getAllMetadata(BaseLib::PRpcClientInfo clientInfo, std::shared_ptr<BaseLib::Systems::Peer> peer, bool checkAcls) {
   try {
-    BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(peer->getID())));
-
-    std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT dataID, serializedObject FROM metadata WHERE objectID=?", data, false);
+    std::string objectId = std::to_string(peer->getID());
+    std::map<std::string, BaseLib::PVariable> values;
+    if (!_metadata.getComponent(objectId, values)) {
+      BaseLib::Database::DataRow data;
+      data.push_back(std::make_shared<BaseLib::Database::DataColumn>(objectId));
+      std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT dataID, serializedObject FROM metadata WHERE objectID=?", data, false);
+      for (auto &i: *rows) {
+        if (i.second.size() < 2) continue;
+        values.emplace(i.second.at(0)->textValue, _rpcDecoder->decodeResponse(*i.second.at(1)->binaryValue));
+      }
+      _metadata.fillComponent(objectId, values);
+    }
 
     BaseLib::PVariable metadataStruct(new BaseLib::Variable(BaseLib::VariableType::tStruct));
-    for (auto &i: *rows) {
-      if (i.second.size() < 2) continue;
-      if (checkAcls && !clientInfo->acls->checkVariableReadAccess(peer, -2, i.second.at(0)->textValue)) continue;
-      BaseLib::PVariable metadata = _rpcDecoder->decodeResponse(*i.second.at(1)->binaryValue);
-      metadataStruct->structValue->insert(BaseLib::StructElement(i.second.at(0)->textValue, metadata));
+    for (auto &i: values) {
+      if (checkAcls && !clientInfo->acls->checkVariableReadAccess(peer, -2, i.first)) continue;
+      metadataStruct->structValue->insert(BaseLib::StructElement(i.first, i.second));
     }
 
     return metadataStruct;
@@ -3671,29 +4075,24 @@ BaseLib::PVariable DatabaseController::getMetadata(uint64_t peerID, std::string
     if (dataID.size() > 250) return BaseLib::Variable::createError(-32602, "dataID has more than 250 characters.");
 
     BaseLib::PVariable metadata;
+    std::string objectId = std::to_string(peerID);
 
-    {
-      std::lock_guard<std::mutex> metadataGuard(_metadataMutex);
-      auto peerIterator = _metadata.find(peerID);
-      if (peerIterator != _metadata.end()) {
-        auto dataIterator = peerIterator->second.find(dataID);
-        if (dataIterator != peerIterator->second.end()) {
-          metadata = dataIterator->second;
-          return metadata;
-        }
-      }
-    }
+    auto lookupResult = _metadata.get(objectId, dataID, metadata);
+    if (lookupResult == DataCache::LookupResult::hit) return metadata;
+    else if (lookupResult == DataCache::LookupResult::negativeHit) return std::make_shared<BaseLib::Variable>();
 
     BaseLib::Database::DataRow data;
-    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(peerID)));
+    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(objectId));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(dataID));
 
     std::shared_ptr<BaseLib::Database::DataTable> rows = _db.executeCommand("SELECT serializedObject FROM metadata WHERE objectID=? AND dataID=?", data, false);
-    if (rows->empty() || rows->at(0).empty()) return std::make_shared<BaseLib::Variable>();
+    if (rows->empty() || rows->at(0).empty()) {
+      _metadata.fill(objectId, dataID, BaseLib::PVariable());
+      return std::make_shared<BaseLib::Variable>();
+    }
 
     metadata = _rpcDecoder->decodeResponse(*rows->at(0).at(0)->binaryValue);
-    std::lock_guard<std::mutex> metadataGuard(_metadataMutex);
-    _metadata[peerID][dataID] = metadata;
+    _metadata.fill(objectId, dataID, metadata);
     return metadata;
   }
   catch (const std::exception &ex) {
@@ -3723,23 +4122,22 @@ BaseLib::PVariable DatabaseController::setMetadata(BaseLib::PRpcClientInfo clien
       return BaseLib::Variable::createError(-32500, "Reached limit of 1000000 metadata entries. Please delete metadata before adding new entries.");
     }
 
-    {
-      std::lock_guard<std::mutex> metadataGuard(_metadataMutex);
-      _metadata[peerID][dataID] = metadata;
-    }
+    _metadata.set(std::to_string(peerID), dataID, metadata);
 
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(peerID)));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(dataID));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM metadata WHERE objectID=? AND dataID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     std::vector<char> value;
     _rpcEncoder->encodeResponse(metadata, value);
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(value));
 
-    entry = std::make_shared<QueueEntry>("INSERT INTO metadata VALUES(?, ?, ?)", data);
-    enqueue(0, entry);
+    auto insertEntry = std::make_shared<QueueEntry>("INSERT INTO metadata VALUES(?, ?, ?)", data);
+    insertEntry->setWrittenCallback([this, peerID]() { _metadata.endWrite(std::to_string(peerID)); });
+    entry = insertEntry;
+    enqueueWrite(entry);
 
     std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>{dataID});
     std::shared_ptr<std::vector<BaseLib::PVariable>> values(new std::vector<BaseLib::PVariable>{metadata});
@@ -3766,14 +4164,8 @@ BaseLib::PVariable DatabaseController::deleteMetadata(uint64_t peerID, std::stri
   try {
     if (dataID.size() > 250) return BaseLib::Variable::createError(-32602, "dataID has more than 250 characters.");
 
-    {
-      std::lock_guard<std::mutex> metadataGuard(_metadataMutex);
-      if (dataID.empty()) {
-        if (_metadata.find(peerID) != _metadata.end()) _metadata.erase(peerID);
-      } else {
-        if (_metadata.find(peerID) != _metadata.end() && _metadata[peerID].find(dataID) != _metadata[peerID].end()) _metadata[peerID].erase(dataID);
-      }
-    }
+    if (dataID.empty()) _metadata.eraseComponent(std::to_string(peerID));
+    else _metadata.erase(std::to_string(peerID), dataID);
 
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(peerID)));
@@ -3782,8 +4174,10 @@ BaseLib::PVariable DatabaseController::deleteMetadata(uint64_t peerID, std::stri
       data.push_back(std::make_shared<BaseLib::Database::DataColumn>(dataID));
       command.append(" AND dataID=?");
     }
-    std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-    enqueue(0, entry);
+    auto queueEntry = std::make_shared<QueueEntry>(command, data);
+    queueEntry->setWrittenCallback([this, peerID]() { _metadata.endWrite(std::to_string(peerID)); });
+    std::shared_ptr<BaseLib::IQueueEntry> entry = queueEntry;
+    enqueueWrite(entry);
 
     std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>{dataID});
     std::shared_ptr<std::vector<BaseLib::PVariable>> values(new std::vector<BaseLib::PVariable>());
@@ -3820,7 +4214,7 @@ void DatabaseController::deleteSystemVariable(std::string &variableId) {
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(variableId));
     std::string command("DELETE FROM systemVariables WHERE variableID=?");
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -3837,6 +4231,16 @@ std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getAllSystemVa
   return std::shared_ptr<BaseLib::Database::DataTable>();
 }
 
+void DatabaseController::getAllSystemVariables(const RowCallback &callback) {
+  try {
+    BaseLib::Database::DataRow data;
+    _db.executeCommand("SELECT variableID, serializedObject, room, categories, roles, flags FROM systemVariables", data, callback, false);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getSystemVariable(const std::string &variableId) {
   try {
     if (variableId.size() > 250) return std::shared_ptr<BaseLib::Database::DataTable>();
@@ -3959,7 +4363,7 @@ BaseLib::PVariable DatabaseController::setSystemVariable(std::string &variableId
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(flags));
 
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("INSERT OR REPLACE INTO systemVariables(variableID, serializedObject, room, categories, roles, flags) VALUES(?, ?, ?, ?, ?, ?)", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -4369,7 +4773,7 @@ BaseLib::PVariable DatabaseController::deleteUserData(uint64_t userId, const std
       command.append(" AND key=?");
     }
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(command, data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tVoid);
   }
@@ -4466,13 +4870,13 @@ BaseLib::PVariable DatabaseController::setUserData(uint64_t userId, const std::s
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(component));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(key));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM userData WHERE userID=? AND component=? AND key=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     std::vector<char> encodedValue;
     _rpcEncoder->encodeResponse(value, encodedValue);
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(encodedValue));
     entry = std::make_shared<QueueEntry>("INSERT INTO userData VALUES(?, ?, ?, ?)", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tVoid);
   }
@@ -4733,7 +5137,7 @@ void DatabaseController::deleteFamily(int32_t familyId) {
   BaseLib::Database::DataRow data;
   data.push_back(std::make_shared<BaseLib::Database::DataColumn>(familyId));
   std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=?", data);
-  enqueue(0, entry);
+  enqueueWrite(entry);
 }
 
 void DatabaseController::saveFamilyVariableAsynchronous(int32_t familyId, BaseLib::Database::DataRow &data) {
@@ -4745,18 +5149,15 @@ void DatabaseController::saveFamilyVariableAsynchronous(int32_t familyId, BaseLi
       }
       switch (data.at(0)->dataType) {
         case BaseLib::Database::DataColumn::DataType::INTEGER: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE familyVariables SET integerValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("familyVariables", data.at(1)->intValue, "UPDATE familyVariables SET integerValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::TEXT: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE familyVariables SET stringValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("familyVariables", data.at(1)->intValue, "UPDATE familyVariables SET stringValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::BLOB: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE familyVariables SET binaryValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("familyVariables", data.at(1)->intValue, "UPDATE familyVariables SET binaryValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::NODATA:GD::out.printError("Error: Tried to store data of type NODATA in family variable table.");
@@ -4769,10 +5170,10 @@ void DatabaseController::saveFamilyVariableAsynchronous(int32_t familyId, BaseLi
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
             "INSERT OR REPLACE INTO familyVariables (variableID, familyID, variableIndex, variableName, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM familyVariables WHERE familyID=? AND variableIndex=? AND variableName=?), ?, ?, ?, ?, ?, ?)",
             data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
       } else if (data.size() == 7 && data.at(0)->intValue != 0) {
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO familyVariables VALUES(?, ?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
       } else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
     }
   }
@@ -4808,16 +5209,16 @@ void DatabaseController::deleteFamilyVariable(BaseLib::Database::DataRow &data)
         return;
       }
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE variableID=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 2 && data.at(1)->dataType == BaseLib::Database::DataColumn::DataType::Enum::INTEGER) {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=? AND variableIndex=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 2 && data.at(1)->dataType == BaseLib::Database::DataColumn::DataType::Enum::TEXT) {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=? AND variableName=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 3) {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM familyVariables WHERE familyID=? AND variableIndex=? AND variableName=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     }
   }
   catch (const std::exception &ex) {
@@ -4851,9 +5252,9 @@ void DatabaseController::deleteDevice(uint64_t id) {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(id));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM devices WHERE deviceID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("DELETE FROM deviceVariables WHERE deviceID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -4896,18 +5297,15 @@ void DatabaseController::saveDeviceVariableAsynchronous(BaseLib::Database::DataR
       }
       switch (data.at(0)->dataType) {
         case BaseLib::Database::DataColumn::DataType::INTEGER: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE deviceVariables SET integerValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("deviceVariables", data.at(1)->intValue, "UPDATE deviceVariables SET integerValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::TEXT: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE deviceVariables SET stringValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("deviceVariables", data.at(1)->intValue, "UPDATE deviceVariables SET stringValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::BLOB: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE deviceVariables SET binaryValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("deviceVariables", data.at(1)->intValue, "UPDATE deviceVariables SET binaryValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::NODATA:GD::out.printError("Error: Tried to store data of type NODATA in variable table.");
@@ -4918,13 +5316,15 @@ void DatabaseController::saveDeviceVariableAsynchronous(BaseLib::Database::DataR
     } else {
       if (data.size() == 5) {
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-            "INSERT OR REPLACE INTO deviceVariables (variableID, deviceID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM deviceVariables WHERE deviceID=" + std::to_string(data.at(0)->intValue)
-                + " AND variableIndex=" + std::to_string(data.at(1)->intValue) + "), ?, ?, ?, ?, ?)",
+            "INSERT INTO deviceVariables (deviceID, variableIndex, integerValue, stringValue, binaryValue) VALUES(?, ?, ?, ?, ?) ON CONFLICT(deviceID, variableIndex) DO UPDATE SET integerValue=excluded.integerValue, stringValue=excluded.stringValue, binaryValue=excluded.binaryValue",
             data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
       } else if (data.size() == 6 && data.at(0)->intValue != 0) {
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO deviceVariables VALUES(?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        //Not "REPLACE". It would silently delete other rows conflicting with deviceVariablesUniqueIndex.
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
+            "INSERT INTO deviceVariables VALUES(?, ?, ?, ?, ?, ?) ON CONFLICT(variableID) DO UPDATE SET deviceID=excluded.deviceID, variableIndex=excluded.variableIndex, integerValue=excluded.integerValue, stringValue=excluded.stringValue, binaryValue=excluded.binaryValue",
+            data);
+        enqueueWrite(entry);
       } else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
     }
   }
@@ -4941,7 +5341,7 @@ void DatabaseController::deletePeers(int32_t deviceID) {
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(deviceID));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM peers WHERE parent=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -4982,6 +5382,7 @@ std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getDeviceVaria
   }
   return std::shared_ptr<BaseLib::Database::DataTable>();
 }
+
 //End device
 
 //Peer
@@ -4989,13 +5390,13 @@ void DatabaseController::deletePeer(uint64_t id) {
   try {
     BaseLib::Database::DataRow data({std::make_shared<BaseLib::Database::DataColumn>(id)});
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("DELETE FROM peerVariables WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("DELETE FROM peers WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("DELETE FROM serviceMessages WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -5023,14 +5424,15 @@ uint64_t DatabaseController::savePeer(uint64_t id, uint32_t parentID, int32_t ad
 
 uint64_t DatabaseController::savePeerParameterSynchronous(BaseLib::Database::DataRow &data) {
   if (data.size() == 7) {
-    data.push_front(data.at(5));
-    auto command = "REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES((SELECT parameterID FROM parameters WHERE peerID=" + std::to_string(data.at(1)->intValue)
-        + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND remotePeer=" + std::to_string(data.at(4)->intValue) + " AND remoteChannel="
-        + std::to_string(data.at(5)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?, ?)";
-    uint64_t result = _db.executeWriteCommand(command, data, false);
-    if (result == 0) throw BaseLib::Exception("Error saving peer parameter to database. See previous errors in log for more information.");
-    data.at(0) = std::make_shared<BaseLib::Database::DataColumn>(result);
-    _db.executeWriteCommand(command, data, true);
+    //The row ID returned by executeWriteCommand() is not updated when the upsert updates an existing row, so the ID is
+    //read back using the unique index.
+    _db.executeWriteCommand(kPeerParameterUpsert, data, false);
+    BaseLib::Database::DataRow keyData(data.begin(), data.begin() + 6);
+    auto rows = _db.executeCommand("SELECT parameterID FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND remotePeer=? AND remoteChannel=? AND parameterName=?", keyData, false);
+    if (rows->empty() || rows->begin()->second.empty()) throw BaseLib::Exception("Error saving peer parameter to database. See previous errors in log for more information.");
+    uint64_t result = rows->begin()->second.at(0)->intValue;
+    _db.executeWriteCommand(kPeerParameterUpsert, data, true);
+    data.push_front(std::make_shared<BaseLib::Database::DataColumn>(result));
     return result;
   } else GD::out.printError("Error: The number of columns is invalid.");
   return 0;
@@ -5043,27 +5445,22 @@ void DatabaseController::savePeerParameterAsynchronous(BaseLib::Database::DataRo
         GD::out.printError("Error: Could not save peer parameter. Parameter ID is \"0\".");
         return;
       }
-      std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET value=? WHERE parameterID=?", data);
-      enqueue(0, entry);
+      enqueueRowWrite("parameters", data.at(1)->intValue, "UPDATE parameters SET value=? WHERE parameterID=?", data);
     } else {
       if (data.size() == 6) {
-        data.push_front(data.at(3));
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-            "INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value, specialType) VALUES((SELECT parameterID FROM parameters WHERE peerID="
-                + std::to_string(data.at(1)->intValue) + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?)",
+            "INSERT INTO parameters (peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value, specialType) VALUES(?, ?, ?, 0, 0, ?, ?, ?) ON CONFLICT(peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName) DO UPDATE SET value=excluded.value, specialType=excluded.specialType",
             data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
       } else if (data.size() == 7) {
-        data.push_front(data.at(5));
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-            "INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES((SELECT parameterID FROM parameters WHERE peerID=" + std::to_string(data.at(1)->intValue)
-                + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND remotePeer=" + std::to_string(data.at(4)->intValue) + " AND remoteChannel="
-                + std::to_string(data.at(5)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?, ?)",
-            data);
-        enqueue(0, entry);
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(kPeerParameterUpsert, data);
+        enqueueWrite(entry);
       } else if (data.size() == 8 && data.at(0)->intValue != 0) {
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES(?, ?, ?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        //Not "REPLACE". It would silently delete other rows conflicting with parametersUniqueIndex.
+        enqueueRowWrite("parameters",
+                        data.at(0)->intValue,
+                        "INSERT INTO parameters (parameterID, peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value) VALUES(?, ?, ?, ?, ?, ?, ?, ?) ON CONFLICT(parameterID) DO UPDATE SET peerID=excluded.peerID, parameterSetType=excluded.parameterSetType, peerChannel=excluded.peerChannel, remotePeer=excluded.remotePeer, remoteChannel=excluded.remoteChannel, parameterName=excluded.parameterName, value=excluded.value",
+                        data);
       } else GD::out.printError("Error: Either parameterID is 0 or the number of columns is invalid.");
     }
   }
@@ -5082,12 +5479,10 @@ void DatabaseController::saveSpecialPeerParameterAsynchronous(BaseLib::Database:
       return;
     }
 
-    data.push_front(data.at(3));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-        "INSERT OR REPLACE INTO parameters (parameterID, peerID, parameterSetType, peerChannel, parameterName, value, specialType, metadata, roles) VALUES((SELECT parameterID FROM parameters WHERE peerID=" + std::to_string(data.at(1)->intValue)
-            + " AND parameterSetType=" + std::to_string(data.at(2)->intValue) + " AND peerChannel=" + std::to_string(data.at(3)->intValue) + " AND parameterName=?), ?, ?, ?, ?, ?, ?, ?, ?)",
+        "INSERT INTO parameters (peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName, value, specialType, metadata, roles) VALUES(?, ?, ?, 0, 0, ?, ?, ?, ?, ?) ON CONFLICT(peerID, parameterSetType, peerChannel, remotePeer, remoteChannel, parameterName) DO UPDATE SET value=excluded.value, specialType=excluded.specialType, metadata=excluded.metadata, roles=excluded.roles",
         data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -5104,8 +5499,7 @@ void DatabaseController::savePeerParameterRoomAsynchronous(BaseLib::Database::Da
         GD::out.printError("Error: Could not save room of peer parameter. Parameter ID is \"0\".");
         return;
       }
-      std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET room=? WHERE parameterID=?", data);
-      enqueue(0, entry);
+      enqueueRowWrite("parameters", data.at(1)->intValue, "UPDATE parameters SET room=? WHERE parameterID=?", data);
     }
   }
   catch (const std::exception &ex) {
@@ -5123,8 +5517,7 @@ void DatabaseController::savePeerParameterBuildingPartAsynchronous(BaseLib::Data
         GD::out.printError("Error: Could not save building part of peer parameter. Parameter ID is \"0\".");
         return;
       }
-      std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET buildingPart=? WHERE parameterID=?", data);
-      enqueue(0, entry);
+      enqueueRowWrite("parameters", data.at(1)->intValue, "UPDATE parameters SET buildingPart=? WHERE parameterID=?", data);
     }
   }
   catch (const std::exception &ex) {
@@ -5142,8 +5535,7 @@ void DatabaseController::savePeerParameterCategoriesAsynchronous(BaseLib::Databa
         GD::out.printError("Error: Could not save categories of peer parameter. Parameter ID is \"0\".");
         return;
       }
-      std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET categories=? WHERE parameterID=?", data);
-      enqueue(0, entry);
+      enqueueRowWrite("parameters", data.at(1)->intValue, "UPDATE parameters SET categories=? WHERE parameterID=?", data);
     }
   }
   catch (const std::exception &ex) {
@@ -5161,8 +5553,7 @@ void DatabaseController::savePeerParameterRolesAsynchronous(BaseLib::Database::D
         GD::out.printError("Error: Could not save roles of peer parameter. Parameter ID is \"0\".");
         return;
       }
-      std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE parameters SET roles=? WHERE parameterID=?", data);
-      enqueue(0, entry);
+      enqueueRowWrite("parameters", data.at(1)->intValue, "UPDATE parameters SET roles=? WHERE parameterID=?", data);
     }
   }
   catch (const std::exception &ex) {
@@ -5182,18 +5573,15 @@ void DatabaseController::savePeerVariableAsynchronous(BaseLib::Database::DataRow
       }
       switch (data.at(0)->dataType) {
         case BaseLib::Database::DataColumn::DataType::INTEGER: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET integerValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("peerVariables", data.at(1)->intValue, "UPDATE peerVariables SET integerValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::TEXT: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET stringValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("peerVariables", data.at(1)->intValue, "UPDATE peerVariables SET stringValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::BLOB: {
-          std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET binaryValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueRowWrite("peerVariables", data.at(1)->intValue, "UPDATE peerVariables SET binaryValue=? WHERE variableID=?", data);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::NODATA:GD::out.printError("Error: Tried to store data of type NODATA in peer variable table.");
@@ -5204,13 +5592,15 @@ void DatabaseController::savePeerVariableAsynchronous(BaseLib::Database::DataRow
     } else {
       if (data.size() == 5) {
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-            "INSERT OR REPLACE INTO peerVariables (variableID, peerID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM peerVariables WHERE peerID=" + std::to_string(data.at(0)->intValue) + " AND variableIndex="
-                + std::to_string(data.at(1)->intValue) + "), ?, ?, ?, ?, ?)",
+            "INSERT INTO peerVariables (peerID, variableIndex, integerValue, stringValue, binaryValue) VALUES(?, ?, ?, ?, ?) ON CONFLICT(peerID, variableIndex) DO UPDATE SET integerValue=excluded.integerValue, stringValue=excluded.stringValue, binaryValue=excluded.binaryValue",
             data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
       } else if (data.size() == 6 && data.at(0)->intValue != 0) {
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO peerVariables VALUES(?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        //Not "REPLACE". It would silently delete other rows conflicting with peerVariablesUniqueIndex.
+        enqueueRowWrite("peerVariables",
+                        data.at(0)->intValue,
+                        "INSERT INTO peerVariables VALUES(?, ?, ?, ?, ?, ?) ON CONFLICT(variableID) DO UPDATE SET peerID=excluded.peerID, variableIndex=excluded.variableIndex, integerValue=excluded.integerValue, stringValue=excluded.stringValue, binaryValue=excluded.binaryValue",
+                        data);
       } else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
     }
   }
@@ -5224,6 +5614,9 @@ void DatabaseController::savePeerVariableAsynchronous(BaseLib::Database::DataRow
 
 std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPeerParameters(uint64_t peerID) {
   try {
+    auto preloadedPeerData = getPreloadedPeerData(peerID, false);
+    if (preloadedPeerData) return preloadedPeerData;
+
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(peerID));
     std::shared_ptr<BaseLib::Database::DataTable> result = _db.executeCommand("SELECT * FROM parameters WHERE peerID=?", data, false);
@@ -5240,6 +5633,9 @@ std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPeerParamet
 
 std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPeerVariables(uint64_t peerID) {
   try {
+    auto preloadedPeerData = getPreloadedPeerData(peerID, true);
+    if (preloadedPeerData) return preloadedPeerData;
+
     BaseLib::Database::DataRow data;
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(peerID));
     std::shared_ptr<BaseLib::Database::DataTable> result = _db.executeCommand("SELECT * FROM peerVariables WHERE peerID=?", data, false);
@@ -5254,6 +5650,109 @@ std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPeerVariabl
   return std::shared_ptr<BaseLib::Database::DataTable>();
 }
 
+void DatabaseController::preloadPeerData(int32_t familyId) {
+  try {
+    std::vector<uint64_t> peerIds;
+    BaseLib::Database::DataRow data;
+    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(familyId));
+    _db.executeCommand("SELECT peerID FROM peers WHERE parent IN (SELECT deviceID FROM devices WHERE deviceFamily=?)", data, [&](const DatabaseRow &row) {
+      peerIds.push_back((uint64_t)row.getInteger(0));
+      return true;
+    }, false);
+    if (peerIds.empty()) return;
+    std::sort(peerIds.begin(), peerIds.end());
+
+    std::lock_guard<std::mutex> preloadedPeerDataGuard(_preloadedPeerDataMutex);
+    _preloadedPeerData[familyId].peerIds = std::move(peerIds);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+std::shared_ptr<BaseLib::Database::DataTable> DatabaseController::getPreloadedPeerData(uint64_t peerId, bool variables) {
+  try {
+    int32_t familyId = -1;
+    std::vector<uint64_t> batch;
+    {
+      std::lock_guard<std::mutex> preloadedPeerDataGuard(_preloadedPeerDataMutex);
+      for (auto &familyPeerData : _preloadedPeerData) {
+        auto &peerDataTables = variables ? familyPeerData.second.variables : familyPeerData.second.parameters;
+        auto preloadedIterator = peerDataTables.find(peerId);
+        if (preloadedIterator != peerDataTables.end()) {
+          auto result = std::move(preloadedIterator->second);
+          peerDataTables.erase(preloadedIterator);
+          return result;
+        }
+
+        auto &peerIds = familyPeerData.second.peerIds;
+        auto peerIdIterator = std::lower_bound(peerIds.begin(), peerIds.end(), peerId);
+        if (peerIdIterator != peerIds.end() && *peerIdIterator == peerId) {
+          familyId = familyPeerData.first;
+          batch.assign(peerIdIterator, peerIdIterator + std::min((size_t)std::distance(peerIdIterator, peerIds.end()), kPeerDataBatchSize));
+          break;
+        }
+      }
+    }
+    if (batch.empty()) return std::shared_ptr<BaseLib::Database::DataTable>();
+
+    //Peers without rows need an (empty) entry, too. Otherwise they'd be queried one by one again.
+    PeerDataTables peerDataTables;
+    for (auto batchPeerId : batch) {
+      peerDataTables.emplace(batchPeerId, std::make_shared<BaseLib::Database::DataTable>());
+    }
+
+    //The range can contain peers of other families. addPeerDataRow() skips their rows.
+    BaseLib::Database::DataRow data;
+    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(batch.front()));
+    data.push_back(std::make_shared<BaseLib::Database::DataColumn>(batch.back()));
+    _db.executeCommand(std::string("SELECT * FROM ") + (variables ? "peerVariables" : "parameters") + " WHERE peerID>=? AND peerID<=?", data, [&](const DatabaseRow &row) {
+      addPeerDataRow(row, peerDataTables);
+      return true;
+    }, false);
+
+    auto result = std::move(peerDataTables.at(peerId));
+    peerDataTables.erase(peerId);
+
+    std::lock_guard<std::mutex> preloadedPeerDataGuard(_preloadedPeerDataMutex);
+    auto familyIterator = _preloadedPeerData.find(familyId);
+    if (familyIterator != _preloadedPeerData.end()) {
+      //Rows of the previous batch which haven't been requested are freed. Requesting them reads a new batch.
+      if (variables) familyIterator->second.variables = std::move(peerDataTables);
+      else familyIterator->second.parameters = std::move(peerDataTables);
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return std::shared_ptr<BaseLib::Database::DataTable>();
+}
+
+void DatabaseController::clearPreloadedPeerData(int32_t familyId) {
+  try {
+    std::lock_guard<std::mutex> preloadedPeerDataGuard(_preloadedPeerDataMutex);
+    _preloadedPeerData.erase(familyId);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void DatabaseController::addPeerDataRow(const DatabaseRow &row, PeerDataTables &peerDataTables) {
+  auto peerDataIterator = peerDataTables.find((uint64_t)row.getInteger(1));
+  if (peerDataIterator == peerDataTables.end()) return;
+  auto &peerDataTable = *peerDataIterator->second;
+  auto &dataRow = peerDataTable[peerDataTable.size()];
+  int32_t columnCount = row.size();
+  for (int32_t i = 0; i < columnCount; i++) {
+    dataRow[i] = row.getColumn(i);
+  }
+}
+
 void DatabaseController::deletePeerParameter(uint64_t peerID, BaseLib::Database::DataRow &data) {
   try {
     if (data.size() == 2) {
@@ -5262,16 +5761,16 @@ void DatabaseController::deletePeerParameter(uint64_t peerID, BaseLib::Database:
         return;
       }
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterID=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 4) {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND parameterName=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 5) {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND remotePeer=? AND remoteChannel=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("DELETE FROM parameters WHERE peerID=? AND parameterSetType=? AND peerChannel=? AND parameterName=? AND remotePeer=? AND remoteChannel=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     }
   }
   catch (const std::exception &ex) {
@@ -5305,24 +5804,22 @@ bool DatabaseController::setPeerID(uint64_t oldPeerID, uint64_t newPeerID) {
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(newPeerID));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(oldPeerID));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peers SET peerID=? WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("UPDATE parameters SET peerID=? WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("UPDATE peerVariables SET peerID=? WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET peerID=? WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
-    {
-      std::lock_guard<std::mutex> metadataGuard(_metadataMutex);
-      _metadata.erase(oldPeerID);
-    }
+    _metadata.invalidate(std::to_string(oldPeerID));
+    _metadata.invalidate(std::to_string(newPeerID));
 
     data.clear();
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(newPeerID)));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(std::to_string(oldPeerID)));
     entry = std::make_shared<QueueEntry>("UPDATE metadata SET objectID=? WHERE objectID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
     return true;
   }
   catch (const std::exception &ex) {
@@ -5344,7 +5841,7 @@ bool DatabaseController::setPeerSerialNumber(uint64_t peer_id, const std::string
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(serial_number));
     data.push_back(std::make_shared<BaseLib::Database::DataColumn>(peer_id));
     std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE peers SET serialNumber=? WHERE peerID=?", data);
-    enqueue(0, entry);
+    enqueueWrite(entry);
 
     return true;
   }
@@ -5385,17 +5882,17 @@ void DatabaseController::saveServiceMessageAsynchronous(uint64_t peerID, BaseLib
       switch (data.at(1)->dataType) {
         case BaseLib::Database::DataColumn::DataType::INTEGER: {
           std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, integerValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueWrite(entry);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::TEXT: {
           std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, message=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueWrite(entry);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::BLOB: {
           std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, binaryData=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueWrite(entry);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::NODATA:GD::out.printError("Error: Tried to store data of type NODATA in service message table.");
@@ -5409,16 +5906,17 @@ void DatabaseController::saveServiceMessageAsynchronous(uint64_t peerID, BaseLib
         return;
       }
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE serviceMessages SET timestamp=?, integerValue=?, message=?, binaryData=? WHERE variableID=?", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 10) {
+      data.push_front(data.at(2));
+      data.push_front(data.at(2));
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-          "INSERT OR REPLACE INTO serviceMessages (variableID, familyID, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData, priority) VALUES((SELECT variableID FROM serviceMessages WHERE peerID="
-              + std::to_string(data.at(1)->intValue) + " AND messageID=" + std::to_string(data.at(2)->intValue) + "), ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+          "INSERT OR REPLACE INTO serviceMessages (variableID, familyID, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData, priority) VALUES((SELECT variableID FROM serviceMessages WHERE peerID=? AND messageID=?), ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
           data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else if (data.size() == 11 && data.at(0)->intValue != 0) {
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO serviceMessages VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
   }
   catch (const std::exception &ex) {
@@ -5432,11 +5930,12 @@ void DatabaseController::saveServiceMessageAsynchronous(uint64_t peerID, BaseLib
 void DatabaseController::saveGlobalServiceMessageAsynchronous(BaseLib::Database::DataRow &data) {
   try {
     if (data.size() == 13) {
+      data.push_front(data.at(4));
+      data.push_front(data.at(3));
       std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-          "INSERT OR REPLACE INTO serviceMessages (variableID, familyID, interface, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData, priority) VALUES((SELECT variableID FROM serviceMessages WHERE familyID="
-              + std::to_string(data.at(2)->intValue) + " AND messageID=" + std::to_string(data.at(4)->intValue) + " AND messageSubID=? AND message=?), ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+          "INSERT OR REPLACE INTO serviceMessages (variableID, familyID, interface, peerID, messageID, messageSubID, timestamp, integerValue, message, variables, binaryData, priority) VALUES((SELECT variableID FROM serviceMessages WHERE familyID=? AND messageID=? AND messageSubID=? AND message=?), ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
           data);
-      enqueue(0, entry);
+      enqueueWrite(entry);
     } else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
   }
   catch (const std::exception &ex) {
@@ -5504,17 +6003,17 @@ void DatabaseController::saveLicenseVariable(int32_t moduleId, BaseLib::Database
       switch (data.at(0)->dataType) {
         case BaseLib::Database::DataColumn::DataType::INTEGER: {
           std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE licenseVariables SET integerValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueWrite(entry);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::TEXT: {
           std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE licenseVariables SET stringValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueWrite(entry);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::BLOB: {
           std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("UPDATE licenseVariables SET binaryValue=? WHERE variableID=?", data);
-          enqueue(0, entry);
+          enqueueWrite(entry);
         }
           break;
         case BaseLib::Database::DataColumn::DataType::NODATA:GD::out.printError("Error: Tried to store data of type NODATA in license module variable table.");
@@ -5525,13 +6024,14 @@ void DatabaseController::saveLicenseVariable(int32_t moduleId, BaseLib::Database
     } else {
       if (data.size() == 5) {
         std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
-            "INSERT OR REPLACE INTO licenseVariables (variableID, moduleID, variableIndex, integerValue, stringValue, binaryValue) VALUES((SELECT variableID FROM licenseVariables WHERE moduleID=" + std::to_string(data.at(0)->intValue)
-                + " AND variableIndex=" + std::to_string(data.at(1)->intValue) + "), ?, ?, ?, ?, ?)",
+            "INSERT INTO licenseVariables (moduleID, variableIndex, integerValue, stringValue, binaryValue) VALUES(?, ?, ?, ?, ?) ON CONFLICT(moduleID, variableIndex) DO UPDATE SET integerValue=excluded.integerValue, stringValue=excluded.stringValue, binaryValue=excluded.binaryValue",
             data);
-        enqueue(0, entry);
+        enqueueWrite(entry);
       } else if (data.size() == 6 && data.at(0)->intValue != 0) {
-        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>("REPLACE INTO licenseVariables VALUES(?, ?, ?, ?, ?, ?)", data);
-        enqueue(0, entry);
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<QueueEntry>(
+            "INSERT INTO licenseVariables VALUES(?, ?, ?, ?, ?, ?) ON CONFLICT(variableID) DO UPDATE SET moduleID=excluded.moduleID, variableIndex=excluded.variableIndex, integerValue=excluded.integerValue, stringValue=excluded.stringValue, binaryValue=excluded.binaryValue",
+            data);
+        enqueueWrite(entry);
       } else GD::out.printError("Error: Either variableID is 0 or the number of columns is invalid.");
     }
   }
@@ -33,10 +33,13 @@
 
 #include <homegear-base/BaseLib.h>
 #include "SQLite3.h"
+#include "DataCache.h"
 
 #include <thread>
 #include <condition_variable>
 #include <atomic>
+#include <array>
+#include <shared_mutex>
 
 namespace Homegear {
 
@@ -46,12 +49,28 @@ class DatabaseController : public BaseLib::Database::IDatabaseController, public
    public:
     QueueEntry(const std::string &command, BaseLib::Database::DataRow &data) { _entry = std::make_shared<std::pair<std::string, BaseLib::Database::DataRow>>(command, data); };
 
+    QueueEntry(const std::string &command, BaseLib::Database::DataRow &data, const std::string &rowKey) : QueueEntry(command, data) { _rowKey = rowKey; };
+
     ~QueueEntry() override = default;;
 
     std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> &getEntry() { return _entry; }
 
+    /**
+     * Key of the written row ("<table>:<row ID>") for writes that can be coalesced. Empty otherwise.
+     */
+    const std::string &getRowKey() { return _rowKey; }
+
+    /**
+     * Called once the write was committed to the database (or could not be queued).
+     */
+    void setWrittenCallback(std::function<void()> callback) { _writtenCallback = std::move(callback); }
+
+    const std::function<void()> &getWrittenCallback() { return _writtenCallback; }
+
    private:
     std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> _entry;
+    std::string _rowKey;
+    std::function<void()> _writtenCallback;
   };
 
   DatabaseController();
@@ -84,6 +103,23 @@ class DatabaseController : public BaseLib::Database::IDatabaseController, public
   void createSavepointAsynchronous(std::string &name) override;
 
   void releaseSavepointAsynchronous(std::string &name) override;
+
+  /**
+   * Returns database statistics like the hits and misses of the prepared statement cache.
+   */
+  BaseLib::PVariable getStatistics();
+
+  /**
+   * Starts a database backup in the maintenance thread. Returns immediately.
+   *
+   * @return Returns false when a backup is already running.
+   */
+  bool startBackup();
+
+  /**
+   * Returns the progress of the running or the duration of the last online backup.
+   */
+  BaseLib::PVariable getBackupStatus();
   // }}}
 
   // {{{ Homegear variables
@@ -115,6 +151,12 @@ class DatabaseController : public BaseLib::Database::IDatabaseController, public
   void removeUiNotification(uint64_t databaseId) override;
   // }}}
 
+  /**
+   * Returns a number that is increased on every change of a building, building part, story, room, category or role.
+   * Clients can compare it to the number of their last request to find out if they need to reload any of these.
+   */
+  uint64_t getStructureVersion() const { return _structureVersion; }
+
   // {{{ Buildings
   BaseLib::PVariable addBuildingPartToBuilding(uint64_t buildingId, uint64_t buildingPartId) override;
 
@@ -268,6 +310,12 @@ class DatabaseController : public BaseLib::Database::IDatabaseController, public
 
   std::shared_ptr<BaseLib::Database::DataTable> getAllSystemVariables() override;
 
+  /**
+   * Like getAllSystemVariables(), but passes the rows to "callback" one by one instead of collecting them. "callback"
+   * is called while the query holds the database, so it must not block (see RowCallback).
+   */
+  void getAllSystemVariables(const RowCallback &callback);
+
   std::shared_ptr<BaseLib::Database::DataTable> getSystemVariable(const std::string &variableId) override;
 
   std::shared_ptr<BaseLib::Database::DataTable> getSystemVariablesInRoom(uint64_t roomId) override;
@@ -390,6 +438,20 @@ class DatabaseController : public BaseLib::Database::IDatabaseController, public
 
   std::shared_ptr<BaseLib::Database::DataTable> getPeerVariables(uint64_t peerID) override;
 
+  /**
+   * Reads the IDs of all peers of a family. Until clearPreloadedPeerData() is called, getPeerParameters() and
+   * getPeerVariables() read the rows of the requested peer and the next kPeerDataBatchSize - 1 peers of the family with
+   * one query and return the others' rows on their next call. Family modules get peer data through BaseLib's
+   * IDatabaseController, which returns a DataTable per peer, so the rows can't be streamed into the peers. Batches keep
+   * the number of queries low without holding the rows of the whole family in memory.
+   */
+  void preloadPeerData(int32_t familyId);
+
+  /**
+   * Frees the peer IDs and remaining rows of one family. Families loaded at the same time are not affected.
+   */
+  void clearPreloadedPeerData(int32_t familyId);
+
   void deletePeerParameter(uint64_t peerID, BaseLib::Database::DataRow &data) override;
 
   bool peerExists(uint64_t peerId) override;
@@ -444,11 +506,171 @@ class DatabaseController : public BaseLib::Database::IDatabaseController, public
   std::mutex _dataMutex;
   std::unordered_map<std::string, std::map<std::string, BaseLib::PVariable>> _data;
 
-  std::mutex _nodeDataMutex;
-  std::unordered_map<std::string, std::map<std::string, BaseLib::PVariable>> _nodeData;
+  DataCache _nodeData;
+  DataCache _metadata;
+
+  // {{{ Group commit
+  bool _groupCommit = false;
+  uint32_t _groupCommitMaxBatchSize = 1000;
+  uint32_t _groupCommitMaxLatency = 100;
+  std::atomic<uint64_t> _groupCommitCount{0};
+  std::atomic<uint64_t> _groupCommitWrites{0};
+
+  /**
+   * Writes not committed yet. Only accessed by the queue processing thread.
+   */
+  std::vector<std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>> _pendingWrites;
+  /**
+   * Written callbacks of the entries in _pendingWrites. Only accessed by the queue processing thread.
+   */
+  std::vector<std::function<void()>> _pendingWriteCallbacks;
+  int64_t _pendingWritesTime = 0;
+  int32_t _queuedSavepointDepth = 0;
+
+  void commitPendingWrites();
+  // }}}
+
+  // {{{ Write coalescing
+  std::mutex _queuedRowWritesMutex;
+  /**
+   * Most recent queued and not yet processed write per row key.
+   */
+  std::unordered_map<std::string, std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>> _queuedRowWrites;
+  std::atomic<uint64_t> _coalescedWrites{0};
+
+  /**
+   * Queues a write that is not keyed by row (deletes, savepoints, multi-row updates, ...). Row writes to the same table
+   * queued before it are not coalesced with row writes queued after it.
+   */
+  void enqueueWrite(std::shared_ptr<BaseLib::IQueueEntry> &entry);
 
-  std::mutex _metadataMutex;
-  std::unordered_map<uint64_t, std::map<std::string, BaseLib::PVariable>> _metadata;
+  /**
+   * Returns the table an INSERT, REPLACE, UPDATE or DELETE statement writes to or an empty string for other statements.
+   */
+  static std::string getWriteTable(const std::string &command);
+
+  /**
+   * Queues a write to a single row identified by "table" and "rowId". When the last queued write to that row has the
+   * same command, hasn't been processed yet and no write to "table" not keyed by row was queued since, its data is
+   * replaced instead of queueing a new write (last writer wins).
+   */
+  void enqueueRowWrite(const std::string &table, uint64_t rowId, const std::string &command, BaseLib::Database::DataRow &data);
+  // }}}
+
+  // {{{ Maintenance
+  std::thread _maintenanceThread;
+  std::mutex _maintenanceMutex;
+  std::condition_variable _maintenanceConditionVariable;
+  bool _stopMaintenanceThread = false;
+  bool _backupRequested = false;
+
+  /**
+   * Runs periodic database maintenance like the online backup (see "databaseBackupInterval" in tuning.conf).
+   */
+  void maintenanceThread();
+  // }}}
+
+  // {{{ Peer data preloading
+  typedef std::unordered_map<uint64_t, std::shared_ptr<BaseLib::Database::DataTable>> PeerDataTables;
+
+  static constexpr size_t kPeerDataBatchSize = 256;
+
+  struct PreloadedPeerData {
+    /**
+     * Sorted IDs of all peers of the family.
+     */
+    std::vector<uint64_t> peerIds;
+    /**
+     * Rows of the current parameter batch that haven't been requested yet.
+     */
+    PeerDataTables parameters;
+    /**
+     * Rows of the current variable batch that haven't been requested yet.
+     */
+    PeerDataTables variables;
+  };
+
+  std::mutex _preloadedPeerDataMutex;
+  /**
+   * Preloaded peer IDs and rows by family ID.
+   */
+  std::unordered_map<int32_t, PreloadedPeerData> _preloadedPeerData;
+
+  /**
+   * Returns the preloaded rows of a peer from "parameters" or "peerVariables". Reads the next batch if the peer belongs
+   * to a family being loaded, but its rows are not in the current batch. Returns nullptr if the peer doesn't belong to
+   * such a family.
+   */
+  std::shared_ptr<BaseLib::Database::DataTable> getPreloadedPeerData(uint64_t peerId, bool variables);
+
+  /**
+   * Adds a row of the parameters or peerVariables table to the DataTable of its peer (column 1).
+   */
+  static void addPeerDataRow(const DatabaseRow &row, PeerDataTables &peerDataTables);
+  // }}}
+
+  // {{{ Structure model
+  enum class StructureType : int32_t {
+    buildings = 0,
+    buildingParts = 1,
+    stories = 2,
+    rooms = 3,
+    categories = 4,
+    roles = 5
+  };
+
+  /**
+   * One row of the buildings, buildingParts, stories, rooms, categories or roles table with decoded BLOBs. Elements are
+   * not modified after they have been added to _structure, so they and their variables can be used without holding
+   * _structureMutex. Don't modify them and only hand out copies of their variables.
+   */
+  struct StructureElement {
+    uint64_t id = 0;
+    BaseLib::PVariable translations;
+    BaseLib::PVariable metadata;
+    bool hasMetadata = false;
+    std::string stories; //Buildings only
+    std::string buildingParts; //Buildings only
+    std::string rooms; //Stories only
+  };
+  typedef std::shared_ptr<const StructureElement> PStructureElement;
+
+  /**
+   * In-memory copy of the structure tables. Read methods and existence checks are served from here. Every write to
+   * one of these tables needs to be followed by reloadStructureElement(), eraseStructureElement() or loadStructure().
+   */
+  std::shared_timed_mutex _structureMutex;
+  std::array<std::map<uint64_t, PStructureElement>, 6> _structure;
+  std::atomic<uint64_t> _structureVersion{0};
+
+  /**
+   * Reads all rows of a structure table into _structure.
+   */
+  void loadStructure(StructureType type);
+
+  /**
+   * Reads one row of a structure table into _structure after it has been written to.
+   */
+  void reloadStructureElement(StructureType type, uint64_t id);
+
+  void eraseStructureElement(StructureType type, uint64_t id);
+
+  PStructureElement getStructureElement(StructureType type, uint64_t id);
+
+  /**
+   * Returns all elements of a structure table ordered by ID.
+   */
+  std::vector<PStructureElement> getStructureElements(StructureType type);
+
+  PStructureElement getStructureElementFromRow(StructureType type, std::map<uint32_t, std::shared_ptr<BaseLib::Database::DataColumn>> &row);
+  // }}}
+
+  /**
+   * Creates the unique indexes the upserts of parameters, peerVariables, deviceVariables and licenseVariables rely on.
+   * Unset remote peers and remote channels are set to "0" and duplicate rows are removed first, as the index can't be
+   * created otherwise.
+   */
+  void createUpsertIndexes(bool factoryDatabase);
 
   void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry> &entry) override;
 };
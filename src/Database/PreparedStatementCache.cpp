@@ -0,0 +1,114 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "PreparedStatementCache.h"
+
+namespace Homegear {
+
+PreparedStatementCache::PreparedStatementCache(size_t maxSize) {
+  _maxSize = maxSize == 0 ? 1 : maxSize;
+}
+
+PreparedStatementCache::~PreparedStatementCache() {
+  clear();
+}
+
+sqlite3_stmt *PreparedStatementCache::get(sqlite3 *database, const std::string &command, int32_t &result, bool cache) {
+  result = SQLITE_OK;
+  if (!cache) {
+    sqlite3_stmt *statement = nullptr;
+    result = sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr);
+    if (result || !statement) {
+      if (statement) sqlite3_finalize(statement);
+      return nullptr;
+    }
+    _uncachedStatements.emplace(statement);
+    return statement;
+  }
+
+  auto statementIterator = _statements.find(command);
+  if (statementIterator != _statements.end()) {
+    _hits++;
+    if (statementIterator->second.lruPosition != _lru.begin()) _lru.splice(_lru.begin(), _lru, statementIterator->second.lruPosition);
+    return statementIterator->second.statement;
+  }
+
+  _misses++;
+  sqlite3_stmt *statement = nullptr;
+  result = sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr);
+  if (result || !statement) {
+    //An empty command succeeds without returning a statement.
+    if (statement) sqlite3_finalize(statement);
+    return nullptr;
+  }
+
+  while (_statements.size() >= _maxSize && !_lru.empty()) {
+    auto oldestIterator = _statements.find(_lru.back());
+    if (oldestIterator != _statements.end()) {
+      sqlite3_finalize(oldestIterator->second.statement);
+      _statements.erase(oldestIterator);
+    }
+    _lru.pop_back();
+  }
+
+  _lru.push_front(command);
+  CacheEntry entry;
+  entry.statement = statement;
+  entry.lruPosition = _lru.begin();
+  _statements.emplace(command, entry);
+
+  return statement;
+}
+
+void PreparedStatementCache::release(sqlite3_stmt *statement) {
+  if (!statement) return;
+  auto uncachedIterator = _uncachedStatements.find(statement);
+  if (uncachedIterator != _uncachedStatements.end()) {
+    _uncachedStatements.erase(uncachedIterator);
+    sqlite3_finalize(statement);
+    return;
+  }
+  sqlite3_reset(statement);
+  sqlite3_clear_bindings(statement);
+}
+
+void PreparedStatementCache::clear() {
+  for (auto &statement : _statements) {
+    sqlite3_finalize(statement.second.statement);
+  }
+  _statements.clear();
+  _lru.clear();
+  for (auto statement : _uncachedStatements) {
+    sqlite3_finalize(statement);
+  }
+  _uncachedStatements.clear();
+}
+
+}
@@ -0,0 +1,107 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef PREPAREDSTATEMENTCACHE_H_
+#define PREPAREDSTATEMENTCACHE_H_
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <sqlite3.h>
+
+namespace Homegear {
+
+/**
+ * Caches compiled SQLite statements of one database connection keyed by their SQL text. Statements are reset and
+ * rebound on reuse instead of being compiled again. When the cache is full, the least recently used statement is
+ * finalized.
+ *
+ * The class is not thread safe. All calls must be protected by the mutex guarding the database connection.
+ */
+class PreparedStatementCache {
+ public:
+  explicit PreparedStatementCache(size_t maxSize = 500);
+  virtual ~PreparedStatementCache();
+
+  /**
+   * Returns a prepared statement for "command". The statement stays owned by the cache and needs to be handed back
+   * with release() after use.
+   *
+   * @param database The database connection to prepare the statement on.
+   * @param command The SQL statement.
+   * @param[out] result The SQLite result code of the prepare call. Only set when the statement was not cached.
+   * @param cache Set to false for SQL without bound parameters. Such SQL is usually built dynamically (e.g. savepoint
+   * names or IDs embedded in the command) and would only evict frequently used statements. The statement is prepared
+   * without caching it then and finalized by release().
+   * @return The statement or nullptr on error.
+   */
+  sqlite3_stmt *get(sqlite3 *database, const std::string &command, int32_t &result, bool cache = true);
+
+  /**
+   * Resets the statement and clears its bindings so it can be reused. Statements not cached are finalized.
+   */
+  void release(sqlite3_stmt *statement);
+
+  /**
+   * Finalizes all cached statements. Needs to be called before the database connection is closed.
+   */
+  void clear();
+
+  size_t size() const { return _statements.size(); }
+  uint64_t hits() const { return _hits; }
+  uint64_t misses() const { return _misses; }
+ private:
+  struct CacheEntry {
+    sqlite3_stmt *statement = nullptr;
+    std::list<std::string>::iterator lruPosition;
+  };
+
+  size_t _maxSize = 500;
+  std::atomic<uint64_t> _hits{0};
+  std::atomic<uint64_t> _misses{0};
+
+  /**
+   * Most recently used commands first.
+   */
+  std::list<std::string> _lru;
+  std::unordered_map<std::string, CacheEntry> _statements;
+
+  /**
+   * Statements returned by get() without caching them. They are finalized on release().
+   */
+  std::unordered_set<sqlite3_stmt *> _uncachedStatements;
+};
+
+}
+
+#endif
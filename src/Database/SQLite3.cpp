@@ -86,10 +86,12 @@ void SQLite3::init(const std::string &databasePath,
 }
 
 SQLite3::~SQLite3() {
+  abortOnlineBackup();
   closeDatabase(true);
 }
 
 void SQLite3::dispose() {
+  abortOnlineBackup();
   closeDatabase(true);
   closeFactoryDatabase(true);
 }
@@ -111,6 +113,7 @@ void SQLite3::hotBackup(bool factoryDatabase) {
       }
       databasePath = _databasePath;
       backupPath = _backupPath;
+      abortOnlineBackup();
     }
     std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
     bool databaseWasOpen = false;
@@ -145,20 +148,7 @@ void SQLite3::hotBackup(bool factoryDatabase) {
       } else {
         if (!backupPath.empty() && !_backupFilename.empty()) {
           GD::out.printInfo(std::string("Info: Backing up ") + (factoryDatabase ? "factory " : "") + "database...");
-          if (GD::bl->settings.databaseMaxBackups() > 1) {
-            if (BaseLib::Io::fileExists(backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1))) {
-              if (!BaseLib::Io::deleteFile(backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1))) {
-                GD::out.printError("Error: Cannot delete file: " + backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1));
-              }
-            }
-            for (int32_t i = GD::bl->settings.databaseMaxBackups() - 2; i >= 0; i--) {
-              if (BaseLib::Io::fileExists(backupPath + _backupFilename + std::to_string(i))) {
-                if (!BaseLib::Io::moveFile(backupPath + _backupFilename + std::to_string(i), backupPath + _backupFilename + std::to_string(i + 1))) {
-                  GD::out.printError("Error: Cannot move file: " + backupPath + _backupFilename + std::to_string(i));
-                }
-              }
-            }
-          }
+          rotateBackups(backupPath);
           if (GD::bl->settings.databaseMaxBackups() > 0) {
             if (!GD::bl->io.copyFile(databasePath + _databaseFilename, backupPath + _backupFilename + '0')) {
               GD::out.printError("Error: Cannot copy file: " + backupPath + _backupFilename + '0');
@@ -200,6 +190,148 @@ void SQLite3::hotBackup(bool factoryDatabase) {
   }
 }
 
+void SQLite3::rotateBackups(const std::string &backupPath) {
+  try {
+    if (GD::bl->settings.databaseMaxBackups() > 1) {
+      if (BaseLib::Io::fileExists(backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1))) {
+        if (!BaseLib::Io::deleteFile(backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1))) {
+          GD::out.printError("Error: Cannot delete file: " + backupPath + _backupFilename + std::to_string(GD::bl->settings.databaseMaxBackups() - 1));
+        }
+      }
+      for (int32_t i = GD::bl->settings.databaseMaxBackups() - 2; i >= 0; i--) {
+        if (BaseLib::Io::fileExists(backupPath + _backupFilename + std::to_string(i))) {
+          if (!BaseLib::Io::moveFile(backupPath + _backupFilename + std::to_string(i), backupPath + _backupFilename + std::to_string(i + 1))) {
+            GD::out.printError("Error: Cannot move file: " + backupPath + _backupFilename + std::to_string(i));
+          }
+        }
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void SQLite3::abortOnlineBackup() {
+  _abortOnlineBackup = true;
+  std::lock_guard<std::mutex> onlineBackupGuard(_onlineBackupMutex);
+  _abortOnlineBackup = false;
+}
+
+SQLite3::OnlineBackupResult SQLite3::onlineBackup(int32_t pagesPerStep, int32_t stepInterval) {
+  std::unique_lock<std::mutex> onlineBackupGuard(_onlineBackupMutex, std::try_to_lock);
+  if (!onlineBackupGuard.owns_lock()) {
+    GD::out.printInfo("Info: Not starting database backup, because another backup is running.");
+    return OnlineBackupResult::skipped;
+  }
+  sqlite3 *backupDatabase = nullptr;
+  sqlite3_backup *backup = nullptr;
+  try {
+    if (_databasePath.empty() || _databaseFilename.empty() || _backupPath.empty() || _backupFilename.empty()) {
+      GD::out.printError("Error: Can't backup database: backupPath or backupFilename is empty.");
+      return OnlineBackupResult::failed;
+    }
+    if (GD::bl->settings.databaseMaxBackups() == 0) return OnlineBackupResult::skipped;
+    if (pagesPerStep <= 0) pagesPerStep = -1;
+
+    std::string tempFilename = _backupPath + _backupFilename + ".tmp";
+    if (BaseLib::Io::fileExists(tempFilename) && !BaseLib::Io::deleteFile(tempFilename)) {
+      GD::out.printError("Error: Cannot delete file: " + tempFilename);
+      return OnlineBackupResult::failed;
+    }
+    int32_t result = sqlite3_open(tempFilename.c_str(), &backupDatabase);
+    if (result || !backupDatabase) {
+      GD::out.printError("Error: Can't create database backup file " + tempFilename + ": " + std::string(sqlite3_errmsg(backupDatabase)));
+      if (backupDatabase) sqlite3_close(backupDatabase);
+      return OnlineBackupResult::failed;
+    }
+
+    {
+      std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+      if (_database) backup = sqlite3_backup_init(backupDatabase, "main", _database, "main");
+    }
+    if (!backup) {
+      GD::out.printError("Error: Can't start database backup: " + std::string(sqlite3_errmsg(backupDatabase)));
+      sqlite3_close(backupDatabase);
+      return OnlineBackupResult::failed;
+    }
+
+    GD::out.printInfo("Info: Backing up database...");
+    _onlineBackupStartTime = BaseLib::HelperFunctions::getTime();
+    _onlineBackupPageCount = 0;
+    _onlineBackupRemainingPages = 0;
+    _onlineBackupRunning = true;
+    //The lock is only held while copying one step. sqlite3_backup_step() picks up changes made through _database
+    //between the steps, so writes don't need to wait for the whole backup.
+    do {
+      {
+        std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+        result = sqlite3_backup_step(backup, pagesPerStep);
+        _onlineBackupPageCount = sqlite3_backup_pagecount(backup);
+        _onlineBackupRemainingPages = sqlite3_backup_remaining(backup);
+      }
+      if (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+        //Don't spin while the source database is locked by another connection.
+        int32_t sleepTime = (result != SQLITE_OK && stepInterval < 10) ? 10 : stepInterval;
+        if (sleepTime > 0) std::this_thread::sleep_for(std::chrono::milliseconds(sleepTime));
+      }
+    } while (!_abortOnlineBackup && (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED));
+
+    {
+      std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+      sqlite3_backup_finish(backup);
+    }
+    backup = nullptr;
+    //sqlite3_backup_finish() sets the error of the last step on the destination connection.
+    std::string backupError = std::string(sqlite3_errmsg(backupDatabase));
+    sqlite3_close(backupDatabase);
+    backupDatabase = nullptr;
+
+    _onlineBackupDuration = BaseLib::HelperFunctions::getTime() - _onlineBackupStartTime;
+    _onlineBackupRunning = false;
+    _lastOnlineBackupTime = BaseLib::HelperFunctions::getTime();
+
+    if (result != SQLITE_DONE) {
+      _lastOnlineBackupSuccessful = false;
+      BaseLib::Io::deleteFile(tempFilename);
+      if (_abortOnlineBackup) {
+        GD::out.printInfo("Info: Database backup was aborted.");
+        return OnlineBackupResult::skipped;
+      }
+      GD::out.printError("Error: Database backup failed: " + backupError);
+      return OnlineBackupResult::failed;
+    }
+
+    if (!checkIntegrity(tempFilename)) {
+      GD::out.printError("Error: Integrity check on database backup failed. Keeping previous backups.");
+      _lastOnlineBackupSuccessful = false;
+      BaseLib::Io::deleteFile(tempFilename);
+      return OnlineBackupResult::failed;
+    }
+
+    rotateBackups(_backupPath);
+    if (!BaseLib::Io::moveFile(tempFilename, _backupPath + _backupFilename + '0')) {
+      GD::out.printError("Error: Cannot move file: " + tempFilename);
+      _lastOnlineBackupSuccessful = false;
+      return OnlineBackupResult::failed;
+    }
+    _lastOnlineBackupSuccessful = true;
+    GD::out.printInfo("Info: Database backup finished in " + std::to_string(_onlineBackupDuration) + " ms.");
+    return OnlineBackupResult::success;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  if (backup) {
+    std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
+    sqlite3_backup_finish(backup);
+  }
+  if (backupDatabase) sqlite3_close(backupDatabase);
+  _onlineBackupRunning = false;
+  _lastOnlineBackupSuccessful = false;
+  return OnlineBackupResult::failed;
+}
+
 bool SQLite3::enableMaintenanceMode() {
   try {
     GD::out.printInfo("Enabling maintenance mode...");
@@ -249,6 +381,32 @@ bool SQLite3::disableMaintenanceMode() {
   return false;
 }
 
+void SQLite3::setFactoryDatabaseTables(const std::unordered_set<std::string> &tables) {
+  _factoryDatabaseTables = tables;
+}
+
+std::string SQLite3::getTableName(const std::string &command) {
+  //Only handles the statements used by DatabaseController.
+  size_t position = std::string::npos;
+  if (command.compare(0, 7, "UPDATE ") == 0) position = 7;
+  else if (command.compare(0, 12, "DELETE FROM ") == 0) position = 12;
+  else if (command.compare(0, 12, "INSERT INTO ") == 0) position = 12;
+  else if (command.compare(0, 13, "REPLACE INTO ") == 0) position = 13;
+  else if (command.compare(0, 23, "INSERT OR REPLACE INTO ") == 0) position = 23;
+  if (position == std::string::npos) return "";
+  size_t endPosition = command.find_first_of(" (", position);
+  std::string tableName = command.substr(position, endPosition == std::string::npos ? std::string::npos : endPosition - position);
+  BaseLib::HelperFunctions::toLower(tableName);
+  return tableName;
+}
+
+bool SQLite3::writeToFactoryDatabase(const std::string &command) {
+  if (!_factoryDatabaseOpen) return false;
+  if (_factoryDatabaseTables.empty()) return true;
+  auto tableName = getTableName(command);
+  return tableName.empty() || _factoryDatabaseTables.find(tableName) != _factoryDatabaseTables.end();
+}
+
 bool SQLite3::checkIntegrity(const std::string &databasePath) {
   sqlite3 *database = nullptr;
   try {
@@ -267,7 +425,7 @@ bool SQLite3::checkIntegrity(const std::string &databasePath) {
       return false;
     }
     try {
-      getDataRows(statement, integrityResult);
+      getDataRows(database, statement, integrityResult);
     }
     catch (const std::exception &ex) {
       sqlite3_close(database);
@@ -345,7 +503,7 @@ void SQLite3::openDatabase(bool lockMutex) {
       if (errorMessage) {
         GD::out.printError("Can't execute \"PRAGMA journal_mode=WAL\": " + std::string(errorMessage));
         sqlite3_free(errorMessage);
-      }
+      } else openReadConnections();
     }
   }
   catch (const std::exception &ex) {
@@ -370,6 +528,7 @@ void SQLite3::openFactoryDatabase(bool lockMutex) {
       return;
     }
     sqlite3_extended_result_codes(_factoryDatabase, 1);
+    _factoryDatabaseOpen = true;
 
     if (!_databaseSynchronous) {
       sqlite3_exec(_factoryDatabase, "PRAGMA synchronous=OFF", nullptr, nullptr, &errorMessage);
@@ -419,6 +578,7 @@ void SQLite3::closeDatabase(bool lockMutex) {
     if (!_database) return;
     std::unique_lock<std::mutex> databaseGuard(_databaseMutex, std::defer_lock);
     if (lockMutex) databaseGuard.lock();
+    closeReadConnections();
     GD::out.printInfo("Closing database...");
     char *errorMessage = nullptr;
     sqlite3_exec(_database, "COMMIT", nullptr, nullptr, &errorMessage); //Release all savepoints
@@ -437,6 +597,8 @@ void SQLite3::closeDatabase(bool lockMutex) {
       GD::out.printError("Error: Can't execute \"PRAGMA journal_mode = DELETE\": " + std::string(errorMessage));
       sqlite3_free(errorMessage);
     }
+    _writeTransactionOpen = false;
+    _statementCache.clear();
     sqlite3_close(_database);
     _database = nullptr;
   }
@@ -471,6 +633,8 @@ void SQLite3::closeFactoryDatabase(bool lockMutex) {
       GD::out.printError("Error: Can't execute \"PRAGMA journal_mode = DELETE\": " + std::string(errorMessage));
       sqlite3_free(errorMessage);
     }
+    _factoryDatabaseOpen = false;
+    _factoryStatementCache.clear();
     sqlite3_close(_factoryDatabase);
     _factoryDatabase = nullptr;
   }
@@ -479,39 +643,142 @@ void SQLite3::closeFactoryDatabase(bool lockMutex) {
   }
 }
 
-void SQLite3::getDataRows(sqlite3_stmt *statement, std::shared_ptr<BaseLib::Database::DataTable> &dataRows) {
-  int32_t result;
-  int32_t row = 0;
-  while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
-    for (int32_t i = 0; i < sqlite3_column_count(statement); i++) {
-      std::shared_ptr<BaseLib::Database::DataColumn> col(new BaseLib::Database::DataColumn());
-      col->index = i;
-      int32_t columnType = sqlite3_column_type(statement, i);
-      if (columnType == SQLITE_INTEGER) {
-        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::INTEGER;
-        col->intValue = sqlite3_column_int64(statement, i);
-      } else if (columnType == SQLITE_FLOAT) {
-        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::FLOAT;
-        col->floatValue = sqlite3_column_double(statement, i);
-      } else if (columnType == SQLITE_BLOB) {
-        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::BLOB;
-        char *binaryData = (char *)sqlite3_column_blob(statement, i);
-        int32_t size = sqlite3_column_bytes(statement, i);
-        if (size > 0) col->binaryValue.reset(new std::vector<char>(binaryData, binaryData + size));
-      } else if (columnType == SQLITE_NULL) {
-        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::NODATA;
-      } else if (columnType == SQLITE_TEXT) //or SQLITE3_TEXT. As we are not using SQLite version 2 it doesn't matter
-      {
-        col->dataType = BaseLib::Database::DataColumn::DataType::Enum::TEXT;
-        col->textValue = std::string((const char *)sqlite3_column_text(statement, i));
+void SQLite3::openReadConnections() {
+  try {
+    if (_readConnectionCount == 0) return;
+    std::lock_guard<std::shared_timed_mutex> readConnectionsGuard(_readConnectionsMutex);
+    if (!_readConnections.empty()) return;
+    std::string fullDatabasePath = _databasePath + _databaseFilename;
+    _readConnections.reserve(_readConnectionCount);
+    for (uint32_t i = 0; i < _readConnectionCount; i++) {
+      auto readConnection = std::make_unique<ReadConnection>();
+      int result = sqlite3_open_v2(fullDatabasePath.c_str(), &readConnection->database, SQLITE_OPEN_READONLY, nullptr);
+      if (result || !readConnection->database) {
+        GD::out.printError("Error: Can't open read only database connection: " + std::string(sqlite3_errmsg(readConnection->database)));
+        if (readConnection->database) sqlite3_close(readConnection->database);
+        break;
       }
-      if (i == 0) dataRows->insert(std::pair<uint32_t, std::map<uint32_t, std::shared_ptr<BaseLib::Database::DataColumn>>>(row, std::map<uint32_t, std::shared_ptr<BaseLib::Database::DataColumn>>()));
-      dataRows->at(row)[i] = col;
+      sqlite3_extended_result_codes(readConnection->database, 1);
+      //Readers only block during WAL recovery or a restarting checkpoint.
+      sqlite3_busy_timeout(readConnection->database, 5000);
+      _readConnections.emplace_back(std::move(readConnection));
+    }
+    GD::out.printInfo("Info: Opened " + std::to_string(_readConnections.size()) + " read only database connections.");
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void SQLite3::closeReadConnections() {
+  try {
+    std::lock_guard<std::shared_timed_mutex> readConnectionsGuard(_readConnectionsMutex);
+    for (auto &readConnection : _readConnections) {
+      std::lock_guard<std::mutex> readConnectionGuard(readConnection->mutex);
+      readConnection->statementCache.clear();
+      sqlite3_close(readConnection->database);
+      readConnection->database = nullptr;
+    }
+    _readConnections.clear();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void SQLite3::updateWriteTransactionState(sqlite3 *database) {
+  if (database == _database) _writeTransactionOpen = (sqlite3_get_autocommit(_database) == 0);
+}
+
+bool SQLite3::executeReadCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, const RowCallback &callback) {
+  std::shared_lock<std::shared_timed_mutex> readConnectionsGuard(_readConnectionsMutex, std::try_to_lock);
+  if (!readConnectionsGuard.owns_lock() || _readConnections.empty()) return false;
+
+  //While the writing connection has an open transaction (i. e. a savepoint), its changes are only visible to itself.
+  if (_writeTransactionOpen) return false;
+
+  //Prefer an idle connection. Wait for the next one in turn, when all of them are busy.
+  uint32_t index = _nextReadConnection++ % _readConnections.size();
+  std::unique_lock<std::mutex> readConnectionGuard;
+  for (uint32_t i = 0; i < _readConnections.size(); i++) {
+    auto &readConnection = _readConnections.at((index + i) % _readConnections.size());
+    readConnectionGuard = std::unique_lock<std::mutex>(readConnection->mutex, std::try_to_lock);
+    if (readConnectionGuard.owns_lock()) {
+      index = (index + i) % _readConnections.size();
+      break;
     }
-    row++;
+  }
+  if (!readConnectionGuard.owns_lock()) readConnectionGuard = std::unique_lock<std::mutex>(_readConnections.at(index)->mutex);
+  auto &readConnection = _readConnections.at(index);
+  _readConnectionCommands++;
+
+  int32_t result = SQLITE_OK;
+  sqlite3_stmt *statement = readConnection->statementCache.get(readConnection->database, command, result, !dataToEscape.empty());
+  if (!statement) {
+    GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(readConnection->database)));
+    return true;
+  }
+  if (!bindData(statement, dataToEscape)) {
+    GD::out.printError("Error binding data: " + std::string(sqlite3_errmsg(readConnection->database)));
+  }
+  try {
+    getDataRows(readConnection->database, statement, callback);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  readConnection->statementCache.release(statement);
+  return true;
+}
+
+std::shared_ptr<BaseLib::Database::DataColumn> DatabaseRow::getColumn(int32_t index) const {
+  auto column = std::make_shared<BaseLib::Database::DataColumn>();
+  column->index = index;
+  int32_t columnType = sqlite3_column_type(_statement, index);
+  if (columnType == SQLITE_INTEGER) {
+    column->dataType = BaseLib::Database::DataColumn::DataType::Enum::INTEGER;
+    column->intValue = sqlite3_column_int64(_statement, index);
+  } else if (columnType == SQLITE_FLOAT) {
+    column->dataType = BaseLib::Database::DataColumn::DataType::Enum::FLOAT;
+    column->floatValue = sqlite3_column_double(_statement, index);
+  } else if (columnType == SQLITE_BLOB) {
+    column->dataType = BaseLib::Database::DataColumn::DataType::Enum::BLOB;
+    size_t size = 0;
+    const char *binaryData = getBlob(index, size);
+    if (size > 0) column->binaryValue = std::make_shared<std::vector<char>>(binaryData, binaryData + size);
+  } else if (columnType == SQLITE_NULL) {
+    column->dataType = BaseLib::Database::DataColumn::DataType::Enum::NODATA;
+  } else if (columnType == SQLITE_TEXT) //or SQLITE3_TEXT. As we are not using SQLite version 2 it doesn't matter
+  {
+    column->dataType = BaseLib::Database::DataColumn::DataType::Enum::TEXT;
+    column->textValue = std::string((const char *)sqlite3_column_text(_statement, index));
+  }
+  return column;
+}
+
+void SQLite3::getDataRows(sqlite3 *database, sqlite3_stmt *statement, const RowCallback &callback) {
+  int32_t result;
+  DatabaseRow row(statement);
+  while ((result = sqlite3_step(statement)) == SQLITE_ROW) {
+    if (!callback(row)) return;
   }
   if (result != SQLITE_DONE) {
-    throw BaseLib::Exception("Can't execute command (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(_database)));
+    throw BaseLib::Exception("Can't execute command (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(database)));
+  }
+}
+
+void SQLite3::getDataRows(sqlite3 *database, sqlite3_stmt *statement, std::shared_ptr<BaseLib::Database::DataTable> &dataRows) {
+  getDataRows(database, statement, [&dataRows](const DatabaseRow &row) {
+    appendDataRow(row, *dataRows);
+    return true;
+  });
+}
+
+void SQLite3::appendDataRow(const DatabaseRow &row, BaseLib::Database::DataTable &dataRows) {
+  auto &dataRow = dataRows[dataRows.size()];
+  int32_t columnCount = row.size();
+  for (int32_t i = 0; i < columnCount; i++) {
+    dataRow[i] = row.getColumn(i);
   }
 }
 
@@ -550,8 +817,14 @@ bool SQLite3::bindData(sqlite3_stmt *statement, BaseLib::Database::DataRow &data
 }
 
 uint64_t SQLite3::executeWriteCommand(const std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>> &command, bool factoryDatabase) {
+  if (!command) return 0;
+  return executeWriteCommand(command->first, command->second, factoryDatabase);
+}
+
+uint64_t SQLite3::executeWriteCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, bool factoryDatabase) {
   try {
-    if (!command) return 0;
+    //Checked before locking the mutex, as the factory database is only open in maintenance mode.
+    if (factoryDatabase && !writeToFactoryDatabase(command)) return 0;
     std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
     if (!_database) {
       GD::out.printError("Error: Could not write to database. No database handle.");
@@ -559,33 +832,10 @@ uint64_t SQLite3::executeWriteCommand(const std::shared_ptr<std::pair<std::strin
     }
     if (factoryDatabase && !_factoryDatabase) return 0;
 
-    auto database = factoryDatabase ? _factoryDatabase : _database;
-
-    sqlite3_stmt *statement = nullptr;
-    int32_t result = sqlite3_prepare_v2(database, command->first.c_str(), -1, &statement, nullptr);
-    if (result) {
-      GD::out.printError("Can't execute command \"" + command->first + "\": " + std::string(sqlite3_errmsg(database)));
-      return 0;
-    }
-    if (!command->second.empty()) {
-      if (!bindData(statement, command->second)) {
-        GD::out.printError("Error binding data: " + std::string(sqlite3_errmsg(database)));
-      }
-    }
-    result = sqlite3_step(statement);
-    if (result != SQLITE_DONE) {
-      GD::out.printError("Can't execute command: " + std::string(sqlite3_errmsg(database)));
-      return 0;
-    }
-    sqlite3_clear_bindings(statement);
-    result = sqlite3_finalize(statement);
-    if (result) {
-      GD::out.printError("Can't execute command \"" + command->first + "\": " + std::string(sqlite3_errmsg(database)));
-      return 0;
-    }
-    uint64_t rowID = sqlite3_last_insert_rowid(database);
-
-    return rowID;
+    if (factoryDatabase) return executeWriteCommand(_factoryDatabase, _factoryStatementCache, command, dataToEscape);
+    uint64_t rowId = executeWriteCommand(_database, _statementCache, command, dataToEscape);
+    updateWriteTransactionState(_database);
+    return rowId;
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -596,42 +846,46 @@ uint64_t SQLite3::executeWriteCommand(const std::shared_ptr<std::pair<std::strin
   return 0;
 }
 
-uint64_t SQLite3::executeWriteCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, bool factoryDatabase) {
+void SQLite3::executeWriteCommands(const std::vector<std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>> &commands, bool factoryDatabase) {
   try {
+    if (commands.empty()) return;
+    if (factoryDatabase && !_factoryDatabaseOpen) return;
     std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
     if (!_database) {
       GD::out.printError("Error: Could not write to database. No database handle.");
-      return 0;
+      return;
     }
-    if (factoryDatabase && !_factoryDatabase) return 0;
+    if (factoryDatabase && !_factoryDatabase) return;
 
     auto database = factoryDatabase ? _factoryDatabase : _database;
+    auto &statementCache = factoryDatabase ? _factoryStatementCache : _statementCache;
 
-    sqlite3_stmt *statement = nullptr;
-    int32_t result = sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr);
-    if (result) {
-      GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
-      return 0;
-    }
-    if (!dataToEscape.empty()) {
-      if (!bindData(statement, dataToEscape)) {
-        GD::out.printError("Error binding data: " + std::string(sqlite3_errmsg(database)));
+    //Don't start a transaction when one is active already (i. e. a synchronous savepoint). The commands become part of it then.
+    bool transaction = sqlite3_get_autocommit(database) != 0;
+    if (transaction) {
+      char *errorMessage = nullptr;
+      sqlite3_exec(database, "BEGIN IMMEDIATE", nullptr, nullptr, &errorMessage);
+      if (errorMessage) {
+        GD::out.printError("Error: Can't execute \"BEGIN IMMEDIATE\": " + std::string(errorMessage));
+        sqlite3_free(errorMessage);
+        transaction = false;
       }
     }
-    result = sqlite3_step(statement);
-    if (result != SQLITE_DONE) {
-      GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
-      return 0;
-    }
-    sqlite3_clear_bindings(statement);
-    result = sqlite3_finalize(statement);
-    if (result) {
-      GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
-      return 0;
+
+    for (auto &command : commands) {
+      if (!command || (factoryDatabase && !writeToFactoryDatabase(command->first))) continue;
+      executeWriteCommand(database, statementCache, command->first, command->second);
     }
-    uint64_t rowID = sqlite3_last_insert_rowid(database);
 
-    return rowID;
+    if (transaction) {
+      char *errorMessage = nullptr;
+      sqlite3_exec(database, "COMMIT", nullptr, nullptr, &errorMessage);
+      if (errorMessage) {
+        GD::out.printError("Error: Can't execute \"COMMIT\": " + std::string(errorMessage));
+        sqlite3_free(errorMessage);
+      }
+    }
+    updateWriteTransactionState(database);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -639,336 +893,89 @@ uint64_t SQLite3::executeWriteCommand(const std::string &command, BaseLib::Datab
   catch (...) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
   }
-  return 0;
 }
 
-std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, bool factoryDatabase) {
-  auto dataRows = std::make_shared<BaseLib::Database::DataTable>();
-  try {
-    std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
-    if (!_database) {
-      GD::out.printError("Error: Could not write to database. No database handle.");
-      return dataRows;
-    }
-    if (factoryDatabase && !_factoryDatabase) return dataRows;
-
-    auto database = factoryDatabase ? _factoryDatabase : _database;
-
-    sqlite3_stmt *statement = nullptr;
-    int32_t result = sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr);
-    if (result) {
-      GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
-      return dataRows;
-    }
+uint64_t SQLite3::executeWriteCommand(sqlite3 *database, PreparedStatementCache &statementCache, const std::string &command, BaseLib::Database::DataRow &dataToEscape) {
+  //There is no try/catch block on purpose! Needs to be called with _databaseMutex locked.
+  int32_t result = SQLITE_OK;
+  sqlite3_stmt *statement = statementCache.get(database, command, result, !dataToEscape.empty());
+  if (!statement) {
+    GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
+    return 0;
+  }
+  if (!dataToEscape.empty()) {
     if (!bindData(statement, dataToEscape)) {
       GD::out.printError("Error binding data: " + std::string(sqlite3_errmsg(database)));
     }
-    try {
-      getDataRows(statement, dataRows);
-    }
-    catch (const std::exception &ex) {
-      if (command.compare(0, 7, "RELEASE") == 0) {
-        GD::out.printInfo(std::string("Info: ") + ex.what());
-        sqlite3_clear_bindings(statement);
-        return dataRows;
-      } else GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    sqlite3_clear_bindings(statement);
-    result = sqlite3_finalize(statement);
-    if (result) GD::out.printError("Can't execute command \"" + command + "\" (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(database)));
   }
-  catch (const std::exception &ex) {
-    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  result = sqlite3_step(statement);
+  if (result != SQLITE_DONE) {
+    GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
+    statementCache.release(statement);
+    return 0;
   }
-  return dataRows;
+  statementCache.release(statement);
+  uint64_t rowID = sqlite3_last_insert_rowid(database);
+
+  return rowID;
 }
 
-std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(const std::string &command, bool factoryDatabase) {
-  auto dataRows = std::make_shared<BaseLib::Database::DataTable>();
+void SQLite3::executeCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, const RowCallback &callback, bool factoryDatabase) {
   try {
+    if (!factoryDatabase && command.compare(0, 7, "SELECT ") == 0 && executeReadCommand(command, dataToEscape, callback)) return;
+    //Writes to the factory database are filtered like in executeWriteCommand().
+    if (factoryDatabase && !writeToFactoryDatabase(command)) return;
+
     std::lock_guard<std::mutex> databaseGuard(_databaseMutex);
     if (!_database) {
       GD::out.printError("Error: Could not write to database. No database handle.");
-      return dataRows;
+      return;
     }
-    if (factoryDatabase && !_factoryDatabase) return dataRows;
+    if (factoryDatabase && !_factoryDatabase) return;
 
     auto database = factoryDatabase ? _factoryDatabase : _database;
+    auto &statementCache = factoryDatabase ? _factoryStatementCache : _statementCache;
 
-    sqlite3_stmt *statement = nullptr;
-    int32_t result = sqlite3_prepare_v2(database, command.c_str(), -1, &statement, nullptr);
-    if (result) {
+    int32_t result = SQLITE_OK;
+    sqlite3_stmt *statement = statementCache.get(database, command, result, !dataToEscape.empty());
+    if (!statement) {
       GD::out.printError("Can't execute command \"" + command + "\": " + std::string(sqlite3_errmsg(database)));
-      return dataRows;
+      return;
+    }
+    if (!bindData(statement, dataToEscape)) {
+      GD::out.printError("Error binding data: " + std::string(sqlite3_errmsg(database)));
     }
     try {
-      getDataRows(statement, dataRows);
+      getDataRows(database, statement, callback);
     }
     catch (const std::exception &ex) {
       if (command.compare(0, 7, "RELEASE") == 0) {
         GD::out.printInfo(std::string("Info: ") + ex.what());
-        sqlite3_clear_bindings(statement);
-        return dataRows;
+        statementCache.release(statement);
+        updateWriteTransactionState(database);
+        return;
       } else GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    sqlite3_clear_bindings(statement);
-    result = sqlite3_finalize(statement);
-    if (result) {
-      GD::out.printError("Can't execute command \"" + command + "\" (Error-no.: " + std::to_string(result) + "): " + std::string(sqlite3_errmsg(database)));
-      return dataRows;
-    }
+    statementCache.release(statement);
+    updateWriteTransactionState(database);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
+}
+
+std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, bool factoryDatabase) {
+  auto dataRows = std::make_shared<BaseLib::Database::DataTable>();
+  executeCommand(command, dataToEscape, [&dataRows](const DatabaseRow &row) {
+    appendDataRow(row, *dataRows);
+    return true;
+  }, factoryDatabase);
   return dataRows;
 }
 
-/*
-void SQLite3::benchmark1()
-{
-	//Duration for REPLACE in ms: 17836
-	//Duration for UPDATE in ms: 14973
-	std::vector<uint8_t> value({0});
-	int64_t startTime = HelperFunctions::getTime();
-	std::map<uint32_t, uint32_t> ids;
-	for(uint32_t i = 0; i < 10000; ++i)
-	{
-		DataRow data;
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-		value[0] = (i % 256);
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-		ids[i] = executeWriteCommand("REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", data);
-	}
-	int64_t duration = HelperFunctions::getTime() - startTime;
-	std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-	startTime = HelperFunctions::getTime();
-	for(uint32_t i = 0; i < 10000; ++i)
-	{
-		DataRow data;
-		value[0] = (i % 256);
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-		data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-		executeWriteCommand("UPDATE parameters SET value=? WHERE parameterID=?", data);
-	}
-	duration = HelperFunctions::getTime() - startTime;
-	std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-	executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-}
-
-void SQLite3::benchmark2()
-{
-	try
-	{
-		//Duration for REPLACE in ms: 17002
-		//Duration for UPDATE in ms: 14391
-		sqlite3_stmt* statement = nullptr;
-		int32_t result = sqlite3_prepare_v2(_database, "REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, NULL);
-		if(result)
-		{
-			throw(Exception("Can't execute command: " + std::string(sqlite3_errmsg(_database))));
-		}
-		std::vector<uint8_t> value({0});
-		int64_t startTime = HelperFunctions::getTime();
-		std::map<uint32_t, uint32_t> ids;
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		statement = nullptr;
-		sqlite3_prepare_v2(_database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, NULL);
-		int64_t duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-		startTime = HelperFunctions::getTime();
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-		executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-	}
-	catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(const Exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-}
-
-void SQLite3::benchmark3()
-{
-	try
-	{
-		sqlite3_stmt* statement = nullptr;
-		int32_t result = sqlite3_prepare_v2(_database, "REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, NULL);
-		if(result)
-		{
-			throw(Exception("Can't execute command: " + std::string(sqlite3_errmsg(_database))));
-		}
-		std::vector<uint8_t> value({0});
-		executeCommand("BEGIN IMMEDIATE TRANSACTION");
-		int64_t startTime = HelperFunctions::getTime();
-		std::map<uint32_t, uint32_t> ids;
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		statement = nullptr;
-		executeCommand("COMMIT TRANSACTION");
-		int64_t duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-		sqlite3_prepare_v2(_database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, NULL);
-		executeCommand("BEGIN IMMEDIATE TRANSACTION");
-		startTime = HelperFunctions::getTime();
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		executeCommand("COMMIT TRANSACTION");
-		duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-		executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-	}
-	catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(const Exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
-}
-
-void SQLite3::benchmark4()
-{
-	try
-	{
-		sqlite3_stmt* statement = nullptr;
-		int32_t result = sqlite3_prepare_v2(_database, "REPLACE INTO parameters VALUES(?, ?, ?, ?, ?, ?, ?, ?)", -1, &statement, NULL);
-		if(result)
-		{
-			throw(Exception("Can't execute command: " + std::string(sqlite3_errmsg(_database))));
-		}
-		std::vector<uint8_t> value({0});
-		executeCommand("SAVEPOINT peerConfig");
-		int64_t startTime = HelperFunctions::getTime();
-		std::map<uint32_t, uint32_t> ids;
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(10000000)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(1)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(2)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn()));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn("TEST" + std::to_string(i))));
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		statement = nullptr;
-		executeCommand("RELEASE peerConfig");
-		int64_t duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for REPLACE in ms: " << duration << std::endl;
-		sqlite3_prepare_v2(_database, "UPDATE parameters SET value=? WHERE parameterID=?", -1, &statement, NULL);
-		executeCommand("SAVEPOINT peerConfig");
-		startTime = HelperFunctions::getTime();
-		for(uint32_t i = 0; i < 10000; ++i)
-		{
-			DataRow data;
-			value[0] = (i % 256);
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(value)));
-			data.push_back(std::shared_ptr<DataColumn>(new DataColumn(ids[i])));
-			bindData(statement, data);
-			ids[i] = sqlite3_step(statement);
-			sqlite3_clear_bindings(statement);
-			sqlite3_reset(statement);
-		}
-		sqlite3_finalize(statement);
-		executeCommand("RELEASE peerConfig");
-		duration = HelperFunctions::getTime() - startTime;
-		std::cerr << "Duration for UPDATE in ms: " << duration << std::endl;
-		executeCommand("DELETE FROM parameters WHERE peerID=10000000");
-	}
-	catch(const std::exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(const Exception& ex)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    catch(...)
-    {
-        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
-    }
+std::shared_ptr<BaseLib::Database::DataTable> SQLite3::executeCommand(const std::string &command, bool factoryDatabase) {
+  BaseLib::Database::DataRow dataToEscape;
+  return executeCommand(command, dataToEscape, factoryDatabase);
 }
-*/
 
 }
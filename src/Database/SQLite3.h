@@ -32,34 +32,151 @@
 #define SQLITE3_H_
 
 #include "homegear-base/Database/DatabaseTypes.h"
+#include "PreparedStatementCache.h"
 
+#include <atomic>
+#include <functional>
 #include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_set>
 
 #include <sqlite3.h>
 
 namespace Homegear {
 
+/**
+ * Gives access to the current row of a query. The values are read directly from the statement, so nothing is
+ * allocated for a row unless the caller copies a value. Only valid within the row callback.
+ */
+class DatabaseRow {
+ public:
+  explicit DatabaseRow(sqlite3_stmt *statement) : _statement(statement) {}
+
+  int32_t size() const { return sqlite3_column_count(_statement); }
+
+  bool isNull(int32_t index) const { return sqlite3_column_type(_statement, index) == SQLITE_NULL; }
+
+  int64_t getInteger(int32_t index) const { return sqlite3_column_int64(_statement, index); }
+
+  double getFloat(int32_t index) const { return sqlite3_column_double(_statement, index); }
+
+  std::string getText(int32_t index) const {
+    auto text = (const char *)sqlite3_column_text(_statement, index);
+    return text ? std::string(text, (size_t)sqlite3_column_bytes(_statement, index)) : std::string();
+  }
+
+  /**
+   * Returns a pointer to the data of a BLOB column. The pointer is only valid within the row callback.
+   */
+  const char *getBlob(int32_t index, size_t &size) const {
+    auto data = (const char *)sqlite3_column_blob(_statement, index);
+    size = data ? (size_t)sqlite3_column_bytes(_statement, index) : 0;
+    return data;
+  }
+
+  /**
+   * Copies the column into a DataColumn as returned by the DataTable based methods.
+   */
+  std::shared_ptr<BaseLib::Database::DataColumn> getColumn(int32_t index) const;
+ private:
+  sqlite3_stmt *_statement = nullptr;
+};
+
+/**
+ * Called for every row of a query. Return false to stop reading further rows. The database is locked while the
+ * callback runs, so it must neither access the database nor block (e. g. on network I/O).
+ */
+typedef std::function<bool(const DatabaseRow &row)> RowCallback;
+
 class SQLite3 {
  public:
+  enum class OnlineBackupResult : int32_t {
+    success = 0,
+    /**
+     * No backup was made on purpose: another backup is running, backups are disabled ("databaseMaxBackups" is 0) or
+     * the backup was aborted by abortOnlineBackup().
+     */
+    skipped = 1,
+    failed = 2
+  };
+
   SQLite3();
   SQLite3(const std::string &databasePath, const std::string &databaseFilename, const std::string &factoryDatabasePath, bool databaseSynchronous, bool databaseMemoryJournal, bool databaseWALJournal);
   virtual ~SQLite3();
   void dispose();
   void init(const std::string &databasePath, const std::string &databaseFilename, const std::string &factoryDatabasePath, bool databaseSynchronous, bool databaseMemoryJournal, bool databaseWALJournal, const std::string &backupPath = "", const std::string &factoryDatabaseBackupPath = "", const std::string &backupFilename = "");
   void hotBackup(bool factoryDatabase);
+
+  /**
+   * Creates a backup of the main database while it is in use. Only "pagesPerStep" pages are copied while the database
+   * is locked. Between the steps the lock is released for "stepInterval" milliseconds. Unlike hotBackup() the database
+   * is not closed and no integrity check is done.
+   *
+   * @return Returns "failed" only when creating the backup failed. Callers can fall back to hotBackup() then.
+   */
+  OnlineBackupResult onlineBackup(int32_t pagesPerStep, int32_t stepInterval);
+
+  /**
+   * Stops a running online backup and waits for it to finish.
+   */
+  void abortOnlineBackup();
   bool enableMaintenanceMode();
   bool disableMaintenanceMode();
   uint64_t executeWriteCommand(const std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>& command, bool factoryDatabase);
   uint64_t executeWriteCommand(const std::string& command, BaseLib::Database::DataRow &dataToEscape, bool factoryDatabase);
+
+  /**
+   * Executes all commands in one transaction. When a transaction is already active (e. g. because of a savepoint),
+   * the commands are executed within that transaction.
+   */
+  void executeWriteCommands(const std::vector<std::shared_ptr<std::pair<std::string, BaseLib::Database::DataRow>>> &commands, bool factoryDatabase);
   std::shared_ptr<BaseLib::Database::DataTable> executeCommand(const std::string& command, bool factoryDatabase);
   std::shared_ptr<BaseLib::Database::DataTable> executeCommand(const std::string& command, BaseLib::Database::DataRow &dataToEscape, bool factoryDatabase);
+
+  /**
+   * Executes a command and passes the resulting rows one by one to "callback" instead of collecting them in a
+   * DataTable.
+   */
+  void executeCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, const RowCallback &callback, bool factoryDatabase);
   bool isOpen() { return _database != nullptr; }
-  /*void benchmark1();
-  void benchmark2();
-  void benchmark3();
-  void benchmark4();*/
+
+  /**
+   * Restricts writes to the factory database to the given tables. The names need to be trimmed and lower case (see
+   * TuningSettings). When "tables" is empty, all writes are applied to the factory database. Commands not referring to
+   * a table (e. g. savepoints) are always applied. Needs to be called before the database is used.
+   */
+  void setFactoryDatabaseTables(const std::unordered_set<std::string> &tables);
+
+  /**
+   * Sets the number of read only connections. When the WAL journal is enabled, SELECT statements are executed on these
+   * connections in parallel to the writing connection. Needs to be called before init().
+   */
+  void setReadConnectionCount(uint32_t count) { _readConnectionCount = count; }
+
+  // {{{ Statistics
+  uint64_t statementCacheHits() const { return _statementCache.hits() + _factoryStatementCache.hits(); }
+  uint64_t statementCacheMisses() const { return _statementCache.misses() + _factoryStatementCache.misses(); }
+  uint64_t readConnectionCommands() const { return _readConnectionCommands; }
+  // }}}
+
+  // {{{ Online backup status
+  bool onlineBackupRunning() const { return _onlineBackupRunning; }
+  int32_t onlineBackupPageCount() const { return _onlineBackupPageCount; }
+  int32_t onlineBackupRemainingPages() const { return _onlineBackupRemainingPages; }
+  int64_t onlineBackupStartTime() const { return _onlineBackupStartTime; }
+  int64_t onlineBackupDuration() const { return _onlineBackupDuration; }
+  int64_t lastOnlineBackupTime() const { return _lastOnlineBackupTime; }
+  bool lastOnlineBackupSuccessful() const { return _lastOnlineBackupSuccessful; }
+  // }}}
  protected:
  private:
+  struct ReadConnection {
+    std::mutex mutex;
+    sqlite3 *database = nullptr;
+    PreparedStatementCache statementCache;
+  };
+
   std::string _databasePath;
   std::string _databaseFilename;
   std::string _factoryDatabasePath;
@@ -71,14 +188,70 @@ class SQLite3 {
   bool _databaseWALJournal = true;
   sqlite3 *_database = nullptr;
   sqlite3 *_factoryDatabase = nullptr;
+  std::atomic_bool _factoryDatabaseOpen{false};
+  std::unordered_set<std::string> _factoryDatabaseTables;
   std::mutex _databaseMutex;
+  PreparedStatementCache _statementCache;
+  PreparedStatementCache _factoryStatementCache;
+
+  // {{{ Read connections
+  uint32_t _readConnectionCount = 0;
+  /**
+   * Locked exclusively to open or close the read connections and shared while one of them is used.
+   */
+  std::shared_timed_mutex _readConnectionsMutex;
+  std::vector<std::unique_ptr<ReadConnection>> _readConnections;
+  std::atomic<uint32_t> _nextReadConnection{0};
+  std::atomic<uint64_t> _readConnectionCommands{0};
+  /**
+   * True while the writing connection has an open transaction. Only set by the writer with _databaseMutex locked.
+   */
+  std::atomic_bool _writeTransactionOpen{false};
+  // }}}
+
+  // {{{ Online backup
+  /**
+   * Held while an online backup is running.
+   */
+  std::mutex _onlineBackupMutex;
+  std::atomic_bool _abortOnlineBackup{false};
+  std::atomic_bool _onlineBackupRunning{false};
+  std::atomic<int32_t> _onlineBackupPageCount{0};
+  std::atomic<int32_t> _onlineBackupRemainingPages{0};
+  std::atomic<int64_t> _onlineBackupStartTime{0};
+  std::atomic<int64_t> _onlineBackupDuration{0};
+  std::atomic<int64_t> _lastOnlineBackupTime{0};
+  std::atomic_bool _lastOnlineBackupSuccessful{false};
+  // }}}
 
   bool checkIntegrity(const std::string &databasePath);
+  void rotateBackups(const std::string &backupPath);
   void openDatabase(bool lockMutex);
   void openFactoryDatabase(bool lockMutex);
   void closeDatabase(bool lockMutex);
   void closeFactoryDatabase(bool lockMutex);
-  void getDataRows(sqlite3_stmt *statement, std::shared_ptr<BaseLib::Database::DataTable> &dataRows);
+  void openReadConnections();
+  void closeReadConnections();
+
+  /**
+   * Executes a SELECT statement on one of the read connections.
+   *
+   * @return Returns false when no read connection can be used. The command needs to be executed on the writing
+   * connection then.
+   */
+  bool executeReadCommand(const std::string &command, BaseLib::Database::DataRow &dataToEscape, const RowCallback &callback);
+
+  /**
+   * Updates _writeTransactionOpen after a command was executed on "database". Needs to be called with _databaseMutex
+   * locked.
+   */
+  void updateWriteTransactionState(sqlite3 *database);
+  bool writeToFactoryDatabase(const std::string &command);
+  static std::string getTableName(const std::string &command);
+  uint64_t executeWriteCommand(sqlite3 *database, PreparedStatementCache &statementCache, const std::string &command, BaseLib::Database::DataRow &dataToEscape);
+  static void getDataRows(sqlite3 *database, sqlite3_stmt *statement, const RowCallback &callback);
+  static void getDataRows(sqlite3 *database, sqlite3_stmt *statement, std::shared_ptr<BaseLib::Database::DataTable> &dataRows);
+  static void appendDataRow(const DatabaseRow &row, BaseLib::Database::DataTable &dataRows);
   static bool bindData(sqlite3_stmt *statement, BaseLib::Database::DataRow &dataToEscape);
 };
 
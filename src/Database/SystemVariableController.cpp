@@ -85,6 +85,50 @@ BaseLib::Role SystemVariableController::parseRoleString(const std::string &roleS
   return {roleId, direction, invert, scale, scaleInfo};
 }
 
+BaseLib::Database::PSystemVariable SystemVariableController::getFromRow(const DatabaseRow &row) {
+  try {
+    if (row.size() < 6) return BaseLib::Database::PSystemVariable();
+
+    auto name = row.getText(0);
+
+    {
+      std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
+      auto systemVariableIterator = _systemVariables.find(name);
+      if (systemVariableIterator != _systemVariables.end()) return systemVariableIterator->second;
+    }
+
+    auto systemVariable = std::make_shared<BaseLib::Database::SystemVariable>();
+    systemVariable->name = name;
+    size_t valueSize = 0;
+    const char *value = row.getBlob(1, valueSize);
+    std::vector<char> serializedValue(value, value + valueSize);
+    systemVariable->value = _rpcDecoder->decodeResponse(serializedValue);
+    systemVariable->room = (uint64_t)row.getInteger(2);
+
+    std::vector<std::string> categoryStrings = BaseLib::HelperFunctions::splitAll(row.getText(3), ',');
+    for (auto &categoryString : categoryStrings) {
+      uint64_t category = BaseLib::Math::getUnsignedNumber64(categoryString);
+      if (category != 0) systemVariable->categories.emplace(category);
+    }
+
+    std::vector<std::string> roleStrings = BaseLib::HelperFunctions::splitAll(row.getText(4), ',');
+    for (auto &roleString : roleStrings) {
+      auto role = parseRoleString(roleString);
+      if (role.id != 0) systemVariable->roles.emplace(role.id, role);
+    }
+
+    systemVariable->flags = (int32_t)row.getInteger(5);
+
+    std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
+    _systemVariables.emplace(systemVariable->name, systemVariable);
+    return systemVariable;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Database::PSystemVariable();
+}
+
 BaseLib::PVariable SystemVariableController::erase(std::string &variableId) {
   try {
     if (variableId.size() > 250) return BaseLib::Variable::createError(-32602, "variableId has more than 250 characters.");
@@ -123,92 +167,80 @@ BaseLib::PVariable SystemVariableController::erase(std::string &variableId) {
   return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
-BaseLib::PVariable SystemVariableController::getAll(BaseLib::PRpcClientInfo clientInfo, bool returnRoomsCategoriesRolesFlags, bool checkAcls) {
-  try {
-    auto rows = GD::bl->db->getAllSystemVariables();
-    if (!rows) return BaseLib::Variable::createError(-1, "Could not read from database.");
-
-    BaseLib::PVariable systemVariableStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+BaseLib::PVariable SystemVariableController::getAllElement(const BaseLib::Database::PSystemVariable &systemVariable, bool returnRoomsCategoriesRolesFlags) {
+  if (!returnRoomsCategoriesRolesFlags) return systemVariable->value;
 
-    { //Insert special variables
-      for (auto &specialSystemVariable : _specialSystemVariables) {
-        BaseLib::Database::PSystemVariable systemVariable;
-
-        {
-          std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-          auto systemVariableIterator = _systemVariables.find(specialSystemVariable);
-          if (systemVariableIterator != _systemVariables.end()) systemVariable = systemVariableIterator->second;
-        }
+  BaseLib::PVariable element = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
 
-        if (systemVariable && (!checkAcls || (checkAcls && clientInfo->acls->checkSystemVariableReadAccess(systemVariable)))) {
-          if (returnRoomsCategoriesRolesFlags) {
-            BaseLib::PVariable element = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  if (systemVariable->room != 0) element->structValue->emplace("ROOM", std::make_shared<BaseLib::Variable>(systemVariable->room));
 
-            if (systemVariable->room != 0) element->structValue->emplace("ROOM", std::make_shared<BaseLib::Variable>(systemVariable->room));
+  BaseLib::PVariable categoriesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+  categoriesArray->arrayValue->reserve(systemVariable->categories.size());
+  for (auto category : systemVariable->categories) {
+    if (category != 0) categoriesArray->arrayValue->push_back(std::make_shared<BaseLib::Variable>(category));
+  }
+  if (!categoriesArray->arrayValue->empty()) element->structValue->emplace("CATEGORIES", categoriesArray);
+
+  BaseLib::PVariable rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+  rolesArray->arrayValue->reserve(systemVariable->roles.size());
+  for (auto role : systemVariable->roles) {
+    auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
+    roleStruct->structValue->emplace("direction", std::make_shared<BaseLib::Variable>((int32_t)role.second.direction));
+    if (role.second.invert) roleStruct->structValue->emplace("invert", std::make_shared<BaseLib::Variable>(role.second.invert));
+    rolesArray->arrayValue->emplace_back(std::move(roleStruct));
+  }
+  if (!rolesArray->arrayValue->empty()) element->structValue->emplace("ROLES", rolesArray);
 
-            BaseLib::PVariable categoriesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-            categoriesArray->arrayValue->reserve(systemVariable->categories.size());
-            for (auto category : systemVariable->categories) {
-              if (category != 0) categoriesArray->arrayValue->push_back(std::make_shared<BaseLib::Variable>(category));
-            }
-            if (!categoriesArray->arrayValue->empty()) element->structValue->emplace("CATEGORIES", categoriesArray);
-
-            BaseLib::PVariable rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-            rolesArray->arrayValue->reserve(systemVariable->roles.size());
-            for (auto role : systemVariable->roles) {
-              auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-              roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
-              roleStruct->structValue->emplace("direction", std::make_shared<BaseLib::Variable>((int32_t)role.second.direction));
-              if (role.second.invert) roleStruct->structValue->emplace("invert", std::make_shared<BaseLib::Variable>(role.second.invert));
-              rolesArray->arrayValue->emplace_back(std::move(roleStruct));
-            }
-            if (!rolesArray->arrayValue->empty()) element->structValue->emplace("ROLES", rolesArray);
+  if (systemVariable->flags > 0) element->structValue->emplace("FLAGS", std::make_shared<BaseLib::Variable>(systemVariable->flags));
 
-            if (systemVariable->flags > 0) element->structValue->emplace("FLAGS", std::make_shared<BaseLib::Variable>(systemVariable->flags));
+  element->structValue->emplace("VALUE", systemVariable->value);
 
-            element->structValue->emplace("VALUE", systemVariable->value);
+  return element;
+}
 
-            systemVariableStruct->structValue->insert(BaseLib::StructElement(systemVariable->name, element));
-          } else systemVariableStruct->structValue->insert(BaseLib::StructElement(systemVariable->name, systemVariable->value));
-        }
-      }
-    }
+BaseLib::PVariable SystemVariableController::getAll(BaseLib::PRpcClientInfo clientInfo, bool returnRoomsCategoriesRolesFlags, bool checkAcls) {
+  BaseLib::PVariable systemVariableStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  auto result = getAll(clientInfo, returnRoomsCategoriesRolesFlags, checkAcls, [&](const std::string &name, const BaseLib::PVariable &value) {
+    systemVariableStruct->structValue->emplace(name, value);
+    return true;
+  });
+  if (result->errorStruct) return result;
+  return systemVariableStruct;
+}
 
-    for (auto i = rows->begin(); i != rows->end(); ++i) {
-      if (i->second.size() < 4) continue;
+BaseLib::PVariable SystemVariableController::getAll(BaseLib::PRpcClientInfo clientInfo, bool returnRoomsCategoriesRolesFlags, bool checkAcls, const SystemVariableCallback &callback) {
+  try {
+    auto databaseController = dynamic_cast<DatabaseController *>(GD::bl->db.get());
+    if (!databaseController) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
+    //Special variables are returned first. Rows with the same name are skipped.
+    std::unordered_set<std::string> returnedSpecialSystemVariables;
+    for (auto &specialSystemVariable : _specialSystemVariables) {
       BaseLib::Database::PSystemVariable systemVariable;
 
       {
         std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-        auto systemVariableIterator = _systemVariables.find(i->second.at(0)->textValue);
+        auto systemVariableIterator = _systemVariables.find(specialSystemVariable);
         if (systemVariableIterator != _systemVariables.end()) systemVariable = systemVariableIterator->second;
       }
 
-      if (!systemVariable) {
-        systemVariable = std::make_shared<BaseLib::Database::SystemVariable>();
-        systemVariable->name = i->second.at(0)->textValue;
-        systemVariable->value = _rpcDecoder->decodeResponse(*i->second.at(1)->binaryValue);
-        systemVariable->room = (uint64_t)i->second.at(2)->intValue;
-
-        std::vector<std::string> categoryStrings = BaseLib::HelperFunctions::splitAll(i->second.at(3)->textValue, ',');
-        for (auto &categoryString : categoryStrings) {
-          uint64_t category = BaseLib::Math::getUnsignedNumber64(categoryString);
-          if (category != 0) systemVariable->categories.emplace(category);
-        }
-
-        std::vector<std::string> roleStrings = BaseLib::HelperFunctions::splitAll(i->second.at(4)->textValue, ',');
-        for (auto &roleString : roleStrings) {
-          auto role = parseRoleString(roleString);
-          if (role.id != 0) systemVariable->roles.emplace(role.id, role);
-        }
-
-        systemVariable->flags = (int32_t)i->second.at(5)->intValue;
-
-        std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-        _systemVariables.emplace(systemVariable->name, systemVariable);
+      if (systemVariable && (!checkAcls || (checkAcls && clientInfo->acls->checkSystemVariableReadAccess(systemVariable)))) {
+        returnedSpecialSystemVariables.emplace(systemVariable->name);
+        if (!callback(systemVariable->name, getAllElement(systemVariable, returnRoomsCategoriesRolesFlags))) return std::make_shared<BaseLib::Variable>();
       }
+    }
+
+    //"callback" might write to a socket, so it must not be called while the query holds the database. Only the (cached)
+    //system variables are collected, the elements are created afterwards.
+    std::vector<BaseLib::Database::PSystemVariable> systemVariables;
+    databaseController->getAllSystemVariables([&](const DatabaseRow &row) {
+      auto systemVariable = getFromRow(row);
+      if (systemVariable) systemVariables.emplace_back(std::move(systemVariable));
+      return true;
+    });
 
+    for (auto &systemVariable : systemVariables) {
       if (checkAcls && !clientInfo->acls->checkSystemVariableReadAccess(systemVariable)) continue;
 
       if (systemVariable->flags != -1 && (systemVariable->flags & 2)) {
@@ -218,38 +250,12 @@ BaseLib::PVariable SystemVariableController::getAll(BaseLib::PRpcClientInfo clie
         }
       }
 
-      if (returnRoomsCategoriesRolesFlags) {
-        BaseLib::PVariable element = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      if (returnedSpecialSystemVariables.find(systemVariable->name) != returnedSpecialSystemVariables.end()) continue;
 
-        if (systemVariable->room != 0) element->structValue->emplace("ROOM", std::make_shared<BaseLib::Variable>(systemVariable->room));
-
-        BaseLib::PVariable categoriesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-        categoriesArray->arrayValue->reserve(systemVariable->categories.size());
-        for (auto category : systemVariable->categories) {
-          if (category != 0) categoriesArray->arrayValue->push_back(std::make_shared<BaseLib::Variable>(category));
-        }
-        if (!categoriesArray->arrayValue->empty()) element->structValue->emplace("CATEGORIES", categoriesArray);
-
-        BaseLib::PVariable rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-        rolesArray->arrayValue->reserve(systemVariable->roles.size());
-        for (auto role : systemVariable->roles) {
-          auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-          roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
-          roleStruct->structValue->emplace("direction", std::make_shared<BaseLib::Variable>((int32_t)role.second.direction));
-          if (role.second.invert) roleStruct->structValue->emplace("invert", std::make_shared<BaseLib::Variable>(role.second.invert));
-          rolesArray->arrayValue->emplace_back(std::move(roleStruct));
-        }
-        if (!rolesArray->arrayValue->empty()) element->structValue->emplace("ROLES", rolesArray);
-
-        if (systemVariable->flags > 0) element->structValue->emplace("FLAGS", std::make_shared<BaseLib::Variable>(systemVariable->flags));
-
-        element->structValue->emplace("VALUE", systemVariable->value);
-
-        systemVariableStruct->structValue->insert(BaseLib::StructElement(systemVariable->name, element));
-      } else systemVariableStruct->structValue->insert(BaseLib::StructElement(systemVariable->name, systemVariable->value));
+      if (!callback(systemVariable->name, getAllElement(systemVariable, returnRoomsCategoriesRolesFlags))) break;
     }
 
-    return systemVariableStruct;
+    return std::make_shared<BaseLib::Variable>();
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -626,60 +632,29 @@ uint64_t SystemVariableController::getRoomInternal(std::string &variableId) {
 
 BaseLib::PVariable SystemVariableController::getVariablesInCategory(BaseLib::PRpcClientInfo clientInfo, uint64_t categoryId, bool checkAcls) {
   try {
-    auto rows = GD::bl->db->getAllSystemVariables();
-    if (!rows) return BaseLib::Variable::createError(-1, "Could not read from database.");
+    auto databaseController = dynamic_cast<DatabaseController *>(GD::bl->db.get());
+    if (!databaseController) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
     BaseLib::PVariable systemVariableArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-    systemVariableArray->arrayValue->reserve(rows->size());
-    if (rows->empty()) return systemVariableArray;
-    for (auto i = rows->begin(); i != rows->end(); ++i) {
-      if (i->second.size() < 4) continue;
-
-      BaseLib::Database::PSystemVariable systemVariable;
-
-      {
-        std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-        auto systemVariableIterator = _systemVariables.find(i->second.at(0)->textValue);
-        if (systemVariableIterator != _systemVariables.end()) systemVariable = systemVariableIterator->second;
-      }
-
-      if (!systemVariable) {
-        systemVariable = std::make_shared<BaseLib::Database::SystemVariable>();
-        systemVariable->name = i->second.at(0)->textValue;
-        systemVariable->value = _rpcDecoder->decodeResponse(*i->second.at(1)->binaryValue);
-        systemVariable->room = (uint64_t)i->second.at(2)->intValue;
-
-        std::vector<std::string> categoryStrings = BaseLib::HelperFunctions::splitAll(i->second.at(3)->textValue, ',');
-        for (auto &categoryString : categoryStrings) {
-          uint64_t category = BaseLib::Math::getUnsignedNumber64(categoryString);
-          if (category != 0) systemVariable->categories.emplace(category);
-        }
-
-        std::vector<std::string> roleStrings = BaseLib::HelperFunctions::splitAll(i->second.at(4)->textValue, ',');
-        for (auto &roleString : roleStrings) {
-          auto role = parseRoleString(roleString);
-          if (role.id != 0) systemVariable->roles.emplace(role.id, role);
-        }
-
-        systemVariable->flags = (int32_t)i->second.at(5)->intValue;
-
-        std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-        _systemVariables.emplace(systemVariable->name, systemVariable);
-      }
+    databaseController->getAllSystemVariables([&](const DatabaseRow &row) {
+      auto systemVariable = getFromRow(row);
+      if (!systemVariable) return true;
 
-      if (checkAcls && !clientInfo->acls->checkSystemVariableReadAccess(systemVariable)) continue;
+      if (checkAcls && !clientInfo->acls->checkSystemVariableReadAccess(systemVariable)) return true;
 
       if (systemVariable->flags != -1 && (systemVariable->flags & 2)) {
         auto &source = clientInfo->initInterfaceId;
         if (source != "homegear" && source != "scriptEngine" && source != "ipcServer" && source != "nodeBlue") {
-          continue;
+          return true;
         }
       }
 
       if ((systemVariable->categories.empty() && categoryId == 0) || systemVariable->categories.find(categoryId) != systemVariable->categories.end()) {
         systemVariableArray->arrayValue->push_back(std::make_shared<BaseLib::Variable>(systemVariable->name));
       }
-    }
+
+      return true;
+    });
 
     return systemVariableArray;
   }
@@ -691,52 +666,20 @@ BaseLib::PVariable SystemVariableController::getVariablesInCategory(BaseLib::PRp
 
 BaseLib::PVariable SystemVariableController::getVariablesInRole(BaseLib::PRpcClientInfo clientInfo, uint64_t roleId, bool checkAcls) {
   try {
-    auto rows = GD::bl->db->getAllSystemVariables();
-    if (!rows) return BaseLib::Variable::createError(-1, "Could not read from database.");
+    auto databaseController = dynamic_cast<DatabaseController *>(GD::bl->db.get());
+    if (!databaseController) return BaseLib::Variable::createError(-1, "Could not read from database.");
 
     BaseLib::PVariable systemVariableStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-    if (rows->empty()) return systemVariableStruct;
-    for (auto i = rows->begin(); i != rows->end(); ++i) {
-      if (i->second.size() < 4) continue;
-
-      BaseLib::Database::PSystemVariable systemVariable;
-
-      {
-        std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-        auto systemVariableIterator = _systemVariables.find(i->second.at(0)->textValue);
-        if (systemVariableIterator != _systemVariables.end()) systemVariable = systemVariableIterator->second;
-      }
+    databaseController->getAllSystemVariables([&](const DatabaseRow &row) {
+      auto systemVariable = getFromRow(row);
+      if (!systemVariable) return true;
 
-      if (!systemVariable) {
-        systemVariable = std::make_shared<BaseLib::Database::SystemVariable>();
-        systemVariable->name = i->second.at(0)->textValue;
-        systemVariable->value = _rpcDecoder->decodeResponse(*i->second.at(1)->binaryValue);
-        systemVariable->room = (uint64_t)i->second.at(2)->intValue;
-
-        std::vector<std::string> categoryStrings = BaseLib::HelperFunctions::splitAll(i->second.at(3)->textValue, ',');
-        for (auto &categoryString : categoryStrings) {
-          uint64_t category = BaseLib::Math::getUnsignedNumber64(categoryString);
-          if (category != 0) systemVariable->categories.emplace(category);
-        }
-
-        std::vector<std::string> roleStrings = BaseLib::HelperFunctions::splitAll(i->second.at(4)->textValue, ',');
-        for (auto &roleString : roleStrings) {
-          auto role = parseRoleString(roleString);
-          if (role.id != 0) systemVariable->roles.emplace(role.id, role);
-        }
-
-        systemVariable->flags = (int32_t)i->second.at(5)->intValue;
-
-        std::lock_guard<std::mutex> systemVariableGuard(_systemVariableMutex);
-        _systemVariables.emplace(systemVariable->name, systemVariable);
-      }
-
-      if (checkAcls && !clientInfo->acls->checkSystemVariableReadAccess(systemVariable)) continue;
+      if (checkAcls && !clientInfo->acls->checkSystemVariableReadAccess(systemVariable)) return true;
 
       if (systemVariable->flags != -1 && (systemVariable->flags & 2)) {
         auto &source = clientInfo->initInterfaceId;
         if (source != "homegear" && source != "scriptEngine" && source != "ipcServer" && source != "nodeBlue") {
-          continue;
+          return true;
         }
       }
 
@@ -749,7 +692,9 @@ BaseLib::PVariable SystemVariableController::getVariablesInRole(BaseLib::PRpcCli
         }
         systemVariableStruct->structValue->emplace(systemVariable->name, entry);
       }
-    }
+
+      return true;
+    });
 
     return systemVariableStruct;
   }
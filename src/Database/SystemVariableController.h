@@ -32,6 +32,7 @@
 #define HOMEGEAR_SYSTEMVARIABLECONTROLLER_H
 
 #include <homegear-base/BaseLib.h>
+#include "SQLite3.h"
 
 namespace Homegear {
 
@@ -45,7 +46,24 @@ class SystemVariableController {
   std::unique_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
 
   BaseLib::Role parseRoleString(const std::string &roleString);
+
+  /**
+   * Returns the cached system variable of a row returned by DatabaseController::getAllSystemVariables(). When it is
+   * not cached yet, it is created from the row and added to the cache.
+   */
+  BaseLib::Database::PSystemVariable getFromRow(const DatabaseRow &row);
+
+  /**
+   * Returns the value or, with "returnRoomsCategoriesRolesFlags", the struct returned by getAll() for a system
+   * variable.
+   */
+  static BaseLib::PVariable getAllElement(const BaseLib::Database::PSystemVariable &systemVariable, bool returnRoomsCategoriesRolesFlags);
  public:
+  /**
+   * Receives the name and value of a system variable. Return false to stop the iteration.
+   */
+  typedef std::function<bool(const std::string &name, const BaseLib::PVariable &value)> SystemVariableCallback;
+
   SystemVariableController();
 
   BaseLib::PVariable erase(std::string &variableId);
@@ -78,6 +96,14 @@ class SystemVariableController {
 
   BaseLib::PVariable getAll(BaseLib::PRpcClientInfo clientInfo, bool returnRoomsCategoriesRolesFlags, bool checkAcls);
 
+  /**
+   * Like getAll() above, but passes the system variables to "callback" one by one instead of collecting their
+   * elements. "callback" is called after the database query finished, so it may block (e. g. on a socket write).
+   *
+   * @return Returns an error struct on errors and a void variable otherwise.
+   */
+  BaseLib::PVariable getAll(BaseLib::PRpcClientInfo clientInfo, bool returnRoomsCategoriesRolesFlags, bool checkAcls, const SystemVariableCallback &callback);
+
   bool hasCategory(std::string &variableId, uint64_t categoryId);
 
   bool hasRole(std::string &variableId, uint64_t roleId);
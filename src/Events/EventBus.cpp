@@ -0,0 +1,306 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "EventBus.h"
+#include "../GD/GD.h"
+
+namespace Homegear {
+
+namespace {
+/**
+ * Set in the dispatch threads. Events published by a consumer (e. g. a Node-BLUE flow setting a variable) must never
+ * wait for queue space, because the waiting thread might be the one that needs to empty the queue.
+ */
+thread_local bool isDispatchThread = false;
+}
+
+EventBus::EventBus() = default;
+
+EventBus::~EventBus() {
+  stop();
+}
+
+void EventBus::addConsumer(const std::string &name, uint32_t eventTypes, EventHandler handler) {
+  try {
+    if (_running) {
+      GD::out.printError("Error: Can't add consumer " + name + " to running event bus.");
+      return;
+    }
+    auto consumer = std::make_unique<Consumer>();
+    consumer->name = name;
+    consumer->eventTypes = eventTypes;
+    consumer->handler = std::move(handler);
+    _consumers.emplace_back(std::move(consumer));
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void EventBus::start(uint32_t threadCount, uint32_t queueSize, OverflowPolicy overflowPolicy) {
+  try {
+    stop();
+    if (threadCount == 0) {
+      GD::out.printInfo("Info: Event bus is disabled. Events are delivered on the threads of the device families.");
+      return;
+    }
+
+    _queueSize = queueSize > 0 ? queueSize : 1;
+    _overflowPolicy = overflowPolicy;
+    _stopThreads = false;
+    _running = true;
+
+    _dispatchThreads.resize(threadCount);
+    for (auto &thread : _dispatchThreads) {
+      GD::bl->threadManager.start(thread, true, &EventBus::dispatchThread, this);
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void EventBus::stop() {
+  try {
+    {
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      if (!_running || _stopThreads) return;
+      _stopThreads = true;
+    }
+    //The dispatch threads only exit when all queues are empty. Publishers keep queueing until then, so events are not
+    //delivered synchronously while older ones are still queued.
+    _eventConditionVariable.notify_all();
+    for (auto &thread : _dispatchThreads) {
+      GD::bl->threadManager.join(thread);
+    }
+    _dispatchThreads.clear();
+
+    //Events published after the last dispatch thread exited.
+    std::vector<std::pair<Consumer *, std::deque<PEvent>>> remainingEvents;
+    {
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      _running = false;
+      for (auto &consumer : _consumers) {
+        if (!consumer->queue.empty()) remainingEvents.emplace_back(consumer.get(), std::move(consumer->queue));
+        consumer->queue.clear();
+        consumer->scheduled = false;
+      }
+      _readyConsumers.clear();
+    }
+    _spaceConditionVariable.notify_all();
+
+    for (auto &consumerEvents : remainingEvents) {
+      for (auto &event : consumerEvents.second) {
+        deliver(*consumerEvents.first, event);
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void EventBus::publish(const PEvent &event) {
+  try {
+    if (!event) return;
+    event->time = BaseLib::HelperFunctions::getTime();
+
+    uint32_t scheduledConsumers = 0;
+    {
+      std::unique_lock<std::mutex> queueGuard(_queueMutex);
+      if (!_running) {
+        queueGuard.unlock();
+        for (auto &consumer : _consumers) {
+          if (consumer->eventTypes & (uint32_t)event->type) deliver(*consumer, event);
+        }
+        return;
+      }
+
+      for (size_t i = 0; i < _consumers.size(); i++) {
+        auto &consumer = _consumers[i];
+        if (!(consumer->eventTypes & (uint32_t)event->type)) continue;
+
+        if (consumer->queue.size() >= _queueSize) {
+          if (_overflowPolicy == OverflowPolicy::dropNewest) {
+            consumer->dropped++;
+            continue;
+          } else if (_overflowPolicy == OverflowPolicy::block && !isDispatchThread) {
+            Consumer *fullConsumer = consumer.get();
+            _spaceConditionVariable.wait_for(queueGuard, std::chrono::milliseconds(kMaxBlockTime), [&] { return fullConsumer->queue.size() < _queueSize || !_running; });
+            if (!_running) {
+              //The bus was stopped while waiting. The consumers handled so far got the event through stop().
+              queueGuard.unlock();
+              for (; i < _consumers.size(); i++) {
+                if (_consumers[i]->eventTypes & (uint32_t)event->type) deliver(*_consumers[i], event);
+              }
+              return;
+            }
+          }
+
+          //Drop oldest. This is also done when a waiting publisher timed out.
+          while (consumer->queue.size() >= _queueSize) {
+            consumer->queue.pop_front();
+            consumer->dropped++;
+          }
+        }
+
+        consumer->queue.push_back(event);
+        consumer->published++;
+        if (!consumer->scheduled) {
+          consumer->scheduled = true;
+          _readyConsumers.push_back(consumer.get());
+          scheduledConsumers++;
+        }
+      }
+    }
+
+    if (scheduledConsumers == 1) _eventConditionVariable.notify_one();
+    else if (scheduledConsumers > 1) _eventConditionVariable.notify_all();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void EventBus::deliver(Consumer &consumer, const PEvent &event) {
+  try {
+    consumer.handler(event);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Error in event handler of " + consumer.name + ": " + ex.what());
+  }
+}
+
+void EventBus::dispatchThread() {
+  isDispatchThread = true;
+  std::vector<PEvent> batch;
+  batch.reserve(kMaxBatchSize);
+
+  while (true) {
+    Consumer *consumer = nullptr;
+    try {
+      {
+        std::unique_lock<std::mutex> queueGuard(_queueMutex);
+        _eventConditionVariable.wait(queueGuard, [&] { return !_readyConsumers.empty() || _stopThreads; });
+        //When stopping, the remaining events are processed first.
+        if (_readyConsumers.empty()) break;
+        consumer = _readyConsumers.front();
+        _readyConsumers.pop_front();
+
+        size_t count = std::min(consumer->queue.size(), kMaxBatchSize);
+        for (size_t i = 0; i < count; i++) {
+          batch.emplace_back(std::move(consumer->queue.front()));
+          consumer->queue.pop_front();
+        }
+      }
+      if (_overflowPolicy == OverflowPolicy::block) _spaceConditionVariable.notify_all();
+
+      int64_t lag = 0;
+      int64_t maxLag = 0;
+      for (auto &event : batch) {
+        lag = BaseLib::HelperFunctions::getTime() - event->time;
+        if (lag > maxLag) maxLag = lag;
+        deliver(*consumer, event);
+      }
+
+      bool reschedule = false;
+      {
+        std::lock_guard<std::mutex> queueGuard(_queueMutex);
+        consumer->processed += batch.size();
+        consumer->lag = lag;
+        if (maxLag > consumer->maxLag) consumer->maxLag = maxLag;
+        if (consumer->queue.empty()) consumer->scheduled = false;
+        else {
+          //Append to the end, so other consumers are not starved by a busy one.
+          _readyConsumers.push_back(consumer);
+          reschedule = true;
+        }
+      }
+      if (reschedule) _eventConditionVariable.notify_one();
+      batch.clear();
+    }
+    catch (const std::exception &ex) {
+      GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+      batch.clear();
+      if (consumer) {
+        std::lock_guard<std::mutex> queueGuard(_queueMutex);
+        if (consumer->queue.empty()) consumer->scheduled = false;
+        else _readyConsumers.push_back(consumer);
+      }
+    }
+  }
+}
+
+BaseLib::PVariable EventBus::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    statistics->structValue->emplace("running", std::make_shared<BaseLib::Variable>((bool)_running));
+    statistics->structValue->emplace("dispatchThreads", std::make_shared<BaseLib::Variable>((uint64_t)_dispatchThreads.size()));
+    statistics->structValue->emplace("queueSize", std::make_shared<BaseLib::Variable>((uint64_t)_queueSize));
+    statistics->structValue->emplace("overflowPolicy", std::make_shared<BaseLib::Variable>(overflowPolicyToString(_overflowPolicy)));
+
+    auto consumers = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    int64_t time = BaseLib::HelperFunctions::getTime();
+    std::lock_guard<std::mutex> queueGuard(_queueMutex);
+    for (auto &consumer : _consumers) {
+      auto consumerStatistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      consumerStatistics->structValue->emplace("queued", std::make_shared<BaseLib::Variable>((uint64_t)consumer->queue.size()));
+      consumerStatistics->structValue->emplace("published", std::make_shared<BaseLib::Variable>(consumer->published));
+      consumerStatistics->structValue->emplace("processed", std::make_shared<BaseLib::Variable>(consumer->processed));
+      consumerStatistics->structValue->emplace("dropped", std::make_shared<BaseLib::Variable>(consumer->dropped));
+      consumerStatistics->structValue->emplace("lag", std::make_shared<BaseLib::Variable>(consumer->lag));
+      consumerStatistics->structValue->emplace("maxLag", std::make_shared<BaseLib::Variable>(consumer->maxLag));
+      consumerStatistics->structValue->emplace("oldestQueued", std::make_shared<BaseLib::Variable>(consumer->queue.empty() ? (int64_t)0 : time - consumer->queue.front()->time));
+      consumers->structValue->emplace(consumer->name, consumerStatistics);
+    }
+    statistics->structValue->emplace("consumers", consumers);
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+EventBus::OverflowPolicy EventBus::overflowPolicyFromString(const std::string &value) {
+  std::string policy = value;
+  BaseLib::HelperFunctions::toLower(policy);
+  if (policy == "dropnewest") return OverflowPolicy::dropNewest;
+  else if (policy == "block") return OverflowPolicy::block;
+  return OverflowPolicy::dropOldest;
+}
+
+std::string EventBus::overflowPolicyToString(OverflowPolicy value) {
+  if (value == OverflowPolicy::dropNewest) return "dropNewest";
+  else if (value == OverflowPolicy::block) return "block";
+  return "dropOldest";
+}
+
+}
@@ -0,0 +1,190 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_EVENTBUS_H_
+#define HOMEGEAR_EVENTBUS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Homegear {
+
+/**
+ * Decouples the threads of the device families from the event consumers (Node-BLUE, script engine, IPC, RPC clients,
+ * ...).
+ *
+ * Every consumer has its own bounded queue. Publishing an event appends it to the queues of all consumers interested in
+ * the event type. A pool of dispatch threads empties the queues. Each consumer is processed by at most one thread at a
+ * time, so a consumer receives its events in the order they were published. When a queue is full, the overflow policy
+ * of the bus decides whether the oldest event is dropped, the new event is dropped or the publishing thread waits. A
+ * waiting publisher gives up after kMaxBlockTime and drops the oldest event, as the consumer might wait for the
+ * publishing thread itself (e. g. a flow sending a packet through the device family that published the event).
+ */
+class EventBus {
+ public:
+  enum class EventType : uint32_t {
+    /**
+     * Variable updates of peers (IFamilyEventSink::onEvent).
+     */
+    variable = 1,
+    /**
+     * Variable updates for RPC event servers (IFamilyEventSink::onRPCEvent).
+     */
+    rpc = 2,
+    serviceMessage = 4
+  };
+
+  enum class OverflowPolicy {
+    dropOldest,
+    dropNewest,
+    block
+  };
+
+  struct Event {
+    EventType type = EventType::variable;
+    /**
+     * Time the event was published in milliseconds.
+     */
+    int64_t time = 0;
+    std::string source;
+    uint64_t peerId = 0;
+    int32_t channel = -1;
+    std::string deviceAddress;
+    std::shared_ptr<std::vector<std::string>> variables;
+    std::shared_ptr<std::vector<BaseLib::PVariable>> values;
+    BaseLib::PServiceMessage serviceMessage;
+  };
+  typedef std::shared_ptr<Event> PEvent;
+  typedef std::function<void(const PEvent &event)> EventHandler;
+
+  EventBus();
+  virtual ~EventBus();
+
+  /**
+   * Registers a consumer. Consumers can only be added while the bus is stopped.
+   *
+   * @param name The name of the consumer used in the statistics.
+   * @param eventTypes Bitmask of the event types (see EventType) the consumer wants to receive.
+   * @param handler Called from one of the dispatch threads for every event.
+   */
+  void addConsumer(const std::string &name, uint32_t eventTypes, EventHandler handler);
+
+  /**
+   * Starts the dispatch threads.
+   *
+   * @param threadCount Number of dispatch threads. When "0" the bus is not started and events are delivered by the
+   *                    publishing thread.
+   * @param queueSize Maximum number of events per consumer queue.
+   */
+  void start(uint32_t threadCount, uint32_t queueSize, OverflowPolicy overflowPolicy);
+
+  /**
+   * Processes all queued events and stops the dispatch threads. Events published while stopping are queued and
+   * processed, too.
+   */
+  void stop();
+
+  bool running() const { return _running; }
+
+  /**
+   * Queues an event for all consumers interested in its type. When the bus is not running, the consumers are called
+   * directly.
+   */
+  void publish(const PEvent &event);
+
+  /**
+   * Returns the queue size, number of published, processed and dropped events and the lag of every consumer. "lag" is
+   * the time in milliseconds the last processed event waited in the queue, "oldestQueued" the age of the oldest event
+   * still in the queue.
+   */
+  BaseLib::PVariable getStatistics();
+
+  static OverflowPolicy overflowPolicyFromString(const std::string &value);
+  static std::string overflowPolicyToString(OverflowPolicy value);
+ private:
+  /**
+   * Maximum number of events a dispatch thread takes from one consumer queue before it moves on to the next consumer.
+   */
+  static constexpr size_t kMaxBatchSize = 100;
+
+  /**
+   * Maximum time in milliseconds a publisher waits for queue space with OverflowPolicy::block.
+   */
+  static constexpr int64_t kMaxBlockTime = 1000;
+
+  struct Consumer {
+    std::string name;
+    uint32_t eventTypes = 0;
+    EventHandler handler;
+    std::deque<PEvent> queue;
+    /**
+     * True while the consumer is in "_readyConsumers" or processed by a dispatch thread.
+     */
+    bool scheduled = false;
+    uint64_t published = 0;
+    uint64_t processed = 0;
+    uint64_t dropped = 0;
+    int64_t lag = 0;
+    int64_t maxLag = 0;
+  };
+
+  std::atomic_bool _running{false};
+  std::atomic_bool _stopThreads{false};
+  uint32_t _queueSize = 10000;
+  OverflowPolicy _overflowPolicy = OverflowPolicy::block;
+
+  std::vector<std::unique_ptr<Consumer>> _consumers;
+
+  std::mutex _queueMutex;
+  std::condition_variable _eventConditionVariable;
+  std::condition_variable _spaceConditionVariable;
+  std::deque<Consumer *> _readyConsumers;
+
+  std::vector<std::thread> _dispatchThreads;
+
+  EventBus(const EventBus &);
+  EventBus &operator=(const EventBus &);
+
+  void dispatchThread();
+
+  void deliver(Consumer &consumer, const PEvent &event);
+};
+
+}
+
+#endif
@@ -162,7 +162,15 @@ void FamilyController::onRemoveWebserverEventHandler(std::map<int32_t, BaseLib::
 
 void FamilyController::onRPCEvent(std::string source, uint64_t id, int32_t channel, std::string deviceAddress, std::shared_ptr<std::vector<std::string>> valueKeys, std::shared_ptr<std::vector<BaseLib::PVariable>> values) {
   try {
-    GD::rpcClient->broadcastEvent(source, id, channel, deviceAddress, valueKeys, values);
+    auto event = std::make_shared<EventBus::Event>();
+    event->type = EventBus::EventType::rpc;
+    event->source = std::move(source);
+    event->peerId = id;
+    event->channel = channel;
+    event->deviceAddress = std::move(deviceAddress);
+    event->variables = std::move(valueKeys);
+    event->values = std::move(values);
+    _eventBus.publish(event);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -180,6 +188,13 @@ void FamilyController::onRPCUpdateDevice(uint64_t id, int32_t channel, std::stri
 
 void FamilyController::onRPCNewDevices(std::vector<uint64_t> &ids, BaseLib::PVariable deviceDescriptions) {
   try {
+    clearMissingPeers();
+    for (auto id : ids) {
+      uint64_t generation = _peerIndexGeneration;
+      auto peer = findPeer(id);
+      if (peer) addToPeerIndex(id, peer, generation);
+    }
+    GD::aclCache.invalidate();
     GD::rpcClient->broadcastNewDevices(ids, deviceDescriptions);
   }
   catch (const std::exception &ex) {
@@ -189,6 +204,8 @@ void FamilyController::onRPCNewDevices(std::vector<uint64_t> &ids, BaseLib::PVar
 
 void FamilyController::onRPCDeleteDevices(std::vector<uint64_t> &ids, BaseLib::PVariable deviceAddresses, BaseLib::PVariable deviceInfo) {
   try {
+    removeFromPeerIndex(ids);
+    GD::aclCache.invalidate();
     GD::rpcClient->broadcastDeleteDevices(ids, deviceAddresses, deviceInfo);
   }
   catch (const std::exception &ex) {
@@ -198,12 +215,14 @@ void FamilyController::onRPCDeleteDevices(std::vector<uint64_t> &ids, BaseLib::P
 
 void FamilyController::onEvent(std::string source, uint64_t peerID, int32_t channel, std::shared_ptr<std::vector<std::string>> variables, std::shared_ptr<std::vector<BaseLib::PVariable>> values) {
   try {
-    if (GD::nodeBlueServer) GD::nodeBlueServer->broadcastEvent(source, peerID, channel, variables, values);
-#ifndef NO_SCRIPTENGINE
-    if (GD::scriptEngineServer) GD::scriptEngineServer->broadcastEvent(source, peerID, channel, variables, values);
-#endif
-    if (GD::ipcServer) GD::ipcServer->broadcastEvent(source, peerID, channel, variables, values);
-    if (GD::variableProfileManager) GD::variableProfileManager->variableEvent(source, peerID, channel, variables, values);
+    auto event = std::make_shared<EventBus::Event>();
+    event->type = EventBus::EventType::variable;
+    event->source = std::move(source);
+    event->peerId = peerID;
+    event->channel = channel;
+    event->variables = std::move(variables);
+    event->values = std::move(values);
+    _eventBus.publish(event);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -212,12 +231,10 @@ void FamilyController::onEvent(std::string source, uint64_t peerID, int32_t chan
 
 void FamilyController::onServiceMessageEvent(const BaseLib::PServiceMessage &serviceMessage) {
   try {
-    if (GD::nodeBlueServer) GD::nodeBlueServer->broadcastServiceMessage(serviceMessage);
-#ifndef NO_SCRIPTENGINE
-    if (GD::scriptEngineServer) GD::scriptEngineServer->broadcastServiceMessage(serviceMessage);
-#endif
-    if (GD::ipcServer) GD::ipcServer->broadcastServiceMessage(serviceMessage);
-    GD::rpcClient->broadcastServiceMessage(serviceMessage);
+    auto event = std::make_shared<EventBus::Event>();
+    event->type = EventBus::EventType::serviceMessage;
+    event->serviceMessage = serviceMessage;
+    _eventBus.publish(event);
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -420,7 +437,8 @@ int32_t FamilyController::loadModule(const std::string &filename) {
         _moduleLoadersMutex.unlock();
         return -4;
       }
-      family->load();
+      loadFamily(family);
+      rebuildPeerIndex();
       family->physicalInterfaces()->startListening();
       family->homegearStarted();
     } else {
@@ -461,6 +479,8 @@ int32_t FamilyController::unloadModule(const std::string &filename) {
         std::lock_guard<std::mutex> familiesGuard(_familiesMutex);
         family->lock();
       }
+      //Locked families are skipped by findPeer(), so the index can be rebuilt without the peers of this family right away.
+      rebuildPeerIndex();
 
       family->homegearShuttingDown();
       family->physicalInterfaces()->stopListening();
@@ -511,12 +531,70 @@ void FamilyController::init() {
     std::vector<uint64_t> groups{7};
     _dummyClientInfo->acls->fromGroups(groups);
     _dummyClientInfo->user = "SYSTEM (7)";
+
+    // {{{ Event consumers
+    const uint32_t variableEvents = (uint32_t)EventBus::EventType::variable;
+    const uint32_t rpcEvents = (uint32_t)EventBus::EventType::rpc;
+    const uint32_t serviceMessages = (uint32_t)EventBus::EventType::serviceMessage;
+
+    _eventBus.addConsumer("nodeBlue", variableEvents | serviceMessages, [](const EventBus::PEvent &event) {
+      if (!GD::nodeBlueServer) return;
+      if (event->type == EventBus::EventType::serviceMessage) GD::nodeBlueServer->broadcastServiceMessage(event->serviceMessage);
+      else GD::nodeBlueServer->broadcastEvent(event->source, event->peerId, event->channel, event->variables, event->values);
+    });
+#ifndef NO_SCRIPTENGINE
+    _eventBus.addConsumer("scriptEngine", variableEvents | serviceMessages, [](const EventBus::PEvent &event) {
+      if (!GD::scriptEngineServer) return;
+      if (event->type == EventBus::EventType::serviceMessage) GD::scriptEngineServer->broadcastServiceMessage(event->serviceMessage);
+      else GD::scriptEngineServer->broadcastEvent(event->source, event->peerId, event->channel, event->variables, event->values);
+    });
+#endif
+    _eventBus.addConsumer("ipc", variableEvents | serviceMessages, [](const EventBus::PEvent &event) {
+      if (!GD::ipcServer) return;
+      if (event->type == EventBus::EventType::serviceMessage) GD::ipcServer->broadcastServiceMessage(event->serviceMessage);
+      else GD::ipcServer->broadcastEvent(event->source, event->peerId, event->channel, event->variables, event->values);
+    });
+    _eventBus.addConsumer("variableProfiles", variableEvents, [](const EventBus::PEvent &event) {
+      if (GD::variableProfileManager) GD::variableProfileManager->variableEvent(event->source, event->peerId, event->channel, event->variables, event->values);
+    });
+    _eventBus.addConsumer("history", variableEvents, [](const EventBus::PEvent &event) {
+      if (GD::historyStore) GD::historyStore->variableEvent(event->peerId, event->channel, event->variables, event->values);
+    });
+    //Also publishes to MQTT (see Rpc::Client::broadcastEvent()).
+    _eventBus.addConsumer("rpcClient", rpcEvents | serviceMessages, [](const EventBus::PEvent &event) {
+      if (!GD::rpcClient) return;
+      if (event->type == EventBus::EventType::serviceMessage) GD::rpcClient->broadcastServiceMessage(event->serviceMessage);
+      else GD::rpcClient->broadcastEvent(event->source, event->peerId, event->channel, event->deviceAddress, event->variables, event->values);
+    });
+    // }}}
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
+void FamilyController::startEventBus() {
+  try {
+    _eventBus.start(GD::tuningSettings.eventBusThreads(), GD::tuningSettings.eventBusQueueSize(), EventBus::overflowPolicyFromString(GD::tuningSettings.eventBusOverflowPolicy()));
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void FamilyController::stopEventBus() {
+  try {
+    _eventBus.stop();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+BaseLib::PVariable FamilyController::getEventBusStatistics() {
+  return _eventBus.getStatistics();
+}
+
 void FamilyController::loadModules() {
   _moduleLoadersMutex.lock();
   try {
@@ -583,9 +661,22 @@ void FamilyController::load() {
           _moduleLoadersMutex.unlock();
           continue;
         }
-        i->second->load();
+        loadFamily(i->second);
       }
     }
+    rebuildPeerIndex();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void FamilyController::loadFamily(const std::shared_ptr<BaseLib::Systems::DeviceFamily> &family) {
+  try {
+    auto databaseController = dynamic_cast<DatabaseController *>(GD::bl->db.get());
+    if (databaseController) databaseController->preloadPeerData(family->getFamily());
+    family->load();
+    if (databaseController) databaseController->clearPreloadedPeerData(family->getFamily());
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -594,6 +685,8 @@ void FamilyController::load() {
 
 void FamilyController::disposeDeviceFamilies() {
   try {
+    _eventBus.stop();
+    clearPeerIndex();
     std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = getFamilies();
     for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i) {
       if (!i->second) continue;
@@ -611,6 +704,7 @@ void FamilyController::disposeDeviceFamilies() {
 
 void FamilyController::dispose() {
   try {
+    clearPeerIndex();
     _familiesMutex.lock();
     _families.clear();
     _familiesMutex.unlock();
@@ -679,20 +773,167 @@ std::shared_ptr<BaseLib::Systems::DeviceFamily> FamilyController::getFamily(int3
 }
 
 bool FamilyController::peerExists(uint64_t peerId) {
+  return (bool)getPeer(peerId);
+}
+
+// {{{ Peer index
+std::shared_ptr<BaseLib::Systems::Peer> FamilyController::getPeer(uint64_t peerId) {
+  try {
+    if (peerId == 0) return std::shared_ptr<BaseLib::Systems::Peer>();
+
+    auto peerIndex = std::atomic_load(&_peerIndex);
+    if (peerIndex) {
+      auto peerIterator = peerIndex->find(peerId);
+      if (peerIterator != peerIndex->end()) {
+        auto peer = peerIterator->second.lock();
+        //The ID check catches ID changes the index wasn't notified about.
+        if (peer && peer->getID() == peerId) return peer;
+      }
+    }
+
+    if (isMissingPeer(peerId)) return std::shared_ptr<BaseLib::Systems::Peer>();
+
+    uint64_t generation = _peerIndexGeneration;
+    uint64_t missingPeersGeneration = getMissingPeersGeneration();
+    auto peer = findPeer(peerId);
+    if (peer) addToPeerIndex(peerId, peer, generation);
+    else addMissingPeer(peerId, missingPeersGeneration);
+    return peer;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return std::shared_ptr<BaseLib::Systems::Peer>();
+}
+
+void FamilyController::peerIdChanged(uint64_t oldPeerId, uint64_t newPeerId) {
+  try {
+    std::vector<uint64_t> peerIds{oldPeerId};
+    removeFromPeerIndex(peerIds);
+    clearMissingPeers();
+    uint64_t generation = _peerIndexGeneration;
+    auto peer = findPeer(newPeerId);
+    if (peer) addToPeerIndex(newPeerId, peer, generation);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+std::shared_ptr<BaseLib::Systems::Peer> FamilyController::findPeer(uint64_t peerId) {
   try {
     std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = getFamilies();
     for (auto &family : families) {
       if (family.second->locked()) continue;
       std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-      if (central && central->peerExists(peerId)) return true;
+      if (!central) continue;
+      auto peer = central->getPeer(peerId);
+      if (peer) return peer;
     }
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
+  return std::shared_ptr<BaseLib::Systems::Peer>();
+}
+
+void FamilyController::rebuildPeerIndex() {
+  try {
+    auto peerIndex = std::make_shared<PeerIndex>();
+    std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = getFamilies();
+    for (auto &family : families) {
+      if (family.second->locked()) continue;
+      std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
+      if (!central) continue;
+      auto peers = central->getPeers();
+      for (auto &peer : peers) {
+        if (peer) peerIndex->emplace(peer->getID(), peer);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> peerIndexGuard(_peerIndexMutex);
+      _peerIndexGeneration++;
+      std::atomic_store(&_peerIndex, std::shared_ptr<const PeerIndex>(std::move(peerIndex)));
+    }
+    clearMissingPeers();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void FamilyController::clearPeerIndex() {
+  try {
+    std::lock_guard<std::mutex> peerIndexGuard(_peerIndexMutex);
+    _peerIndexGeneration++;
+    std::atomic_store(&_peerIndex, std::shared_ptr<const PeerIndex>());
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void FamilyController::addToPeerIndex(uint64_t peerId, const std::shared_ptr<BaseLib::Systems::Peer> &peer, uint64_t generation) {
+  try {
+    std::lock_guard<std::mutex> peerIndexGuard(_peerIndexMutex);
+    //The index was modified while the peer was searched for. The peer might have been deleted or belong to a family that is being unloaded.
+    if (generation != _peerIndexGeneration) return;
+    auto currentPeerIndex = std::atomic_load(&_peerIndex);
+    auto peerIndex = currentPeerIndex ? std::make_shared<PeerIndex>(*currentPeerIndex) : std::make_shared<PeerIndex>();
+    (*peerIndex)[peerId] = peer;
+    std::atomic_store(&_peerIndex, std::shared_ptr<const PeerIndex>(std::move(peerIndex)));
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void FamilyController::removeFromPeerIndex(const std::vector<uint64_t> &peerIds) {
+  try {
+    std::lock_guard<std::mutex> peerIndexGuard(_peerIndexMutex);
+    _peerIndexGeneration++;
+    auto currentPeerIndex = std::atomic_load(&_peerIndex);
+    if (!currentPeerIndex) return;
+    auto peerIndex = std::make_shared<PeerIndex>(*currentPeerIndex);
+    for (auto peerId : peerIds) {
+      peerIndex->erase(peerId);
+    }
+    std::atomic_store(&_peerIndex, std::shared_ptr<const PeerIndex>(std::move(peerIndex)));
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool FamilyController::isMissingPeer(uint64_t peerId) {
+  std::lock_guard<std::mutex> missingPeersGuard(_missingPeersMutex);
+  auto missingPeerIterator = _missingPeers.find(peerId);
+  if (missingPeerIterator == _missingPeers.end()) return false;
+  if (BaseLib::HelperFunctions::getTime() < missingPeerIterator->second) return true;
+  _missingPeers.erase(missingPeerIterator);
   return false;
 }
 
+uint64_t FamilyController::getMissingPeersGeneration() {
+  std::lock_guard<std::mutex> missingPeersGuard(_missingPeersMutex);
+  return _missingPeersGeneration;
+}
+
+void FamilyController::addMissingPeer(uint64_t peerId, uint64_t generation) {
+  std::lock_guard<std::mutex> missingPeersGuard(_missingPeersMutex);
+  if (generation != _missingPeersGeneration) return;
+  if (_missingPeers.size() >= kMaxMissingPeers) _missingPeers.clear();
+  _missingPeers[peerId] = BaseLib::HelperFunctions::getTime() + kMissingPeerTimeout;
+}
+
+void FamilyController::clearMissingPeers() {
+  std::lock_guard<std::mutex> missingPeersGuard(_missingPeersMutex);
+  _missingPeersGeneration++;
+  _missingPeers.clear();
+}
+// }}}
+
 uint32_t FamilyController::physicalInterfaceCount(int32_t family) {
   uint32_t size = 0;
   try {
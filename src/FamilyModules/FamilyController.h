@@ -32,6 +32,7 @@
 #define SHARED_OBJECT_FAMILY_MODULES_H
 
 #include "FamilyModuleInfo.h"
+#include "../Events/EventBus.h"
 
 #include <homegear-base/BaseLib.h>
 
@@ -141,6 +142,23 @@ class FamilyController : public BaseLib::Systems::IFamilyEventSink {
 
   void init();
 
+  /**
+   * Starts delivering family events asynchronously using the settings "eventBusThreads", "eventBusQueueSize" and
+   * "eventBusOverflowPolicy" in tuning.conf. Until the event bus is started and after it is stopped, events are delivered
+   * on the threads of the device families.
+   */
+  void startEventBus();
+
+  /**
+   * Delivers all queued events and stops the event bus.
+   */
+  void stopEventBus();
+
+  /**
+   * Returns queue sizes, dropped events and lag of all event consumers (see EventBus::getStatistics()).
+   */
+  BaseLib::PVariable getEventBusStatistics();
+
   void loadModules();
 
   void load();
@@ -162,6 +180,20 @@ class FamilyController : public BaseLib::Systems::IFamilyEventSink {
    */
   bool peerExists(uint64_t peerId);
 
+  /**
+   * Returns the peer with the provided ID. Peers are looked up in an ID index, so callers don't need to search all families. Peers not
+   * in the index yet are searched for in all families and added.
+   *
+   * @param peerId The ID of the peer.
+   * @return Returns the peer or nullptr if it doesn't exist.
+   */
+  std::shared_ptr<BaseLib::Systems::Peer> getPeer(uint64_t peerId);
+
+  /**
+   * Updates the peer index after the ID of a peer was changed.
+   */
+  void peerIdChanged(uint64_t oldPeerId, uint64_t newPeerId);
+
   /*
    * Executed when Homegear is fully started.
    */
@@ -195,13 +227,82 @@ class FamilyController : public BaseLib::Systems::IFamilyEventSink {
   std::mutex _familiesMutex;
   std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> _families;
 
+  // {{{ Peer index
+  typedef std::unordered_map<uint64_t, std::weak_ptr<BaseLib::Systems::Peer>> PeerIndex;
+
+  /**
+   * Serializes writers. Readers load the current snapshot with std::atomic_load and never lock.
+   */
+  std::mutex _peerIndexMutex;
+  std::shared_ptr<const PeerIndex> _peerIndex;
+
+  /**
+   * Incremented every time peers are removed from the index or the index is rebuilt. Used to discard the results of family searches which started before.
+   */
+  std::atomic<uint64_t> _peerIndexGeneration{0};
+
+  static constexpr int64_t kMissingPeerTimeout = 5000;
+  static constexpr size_t kMaxMissingPeers = 10000;
+
+  /**
+   * IDs of peers not found in any family and the time (in milliseconds) until which they are considered missing. This
+   * keeps requests for unknown peers from searching all families every time. Cleared when peers are added.
+   */
+  std::mutex _missingPeersMutex;
+  std::unordered_map<uint64_t, int64_t> _missingPeers;
+
+  /**
+   * Incremented every time the missing peers are cleared. Protected by _missingPeersMutex.
+   */
+  uint64_t _missingPeersGeneration = 0;
+  // }}}
+
   std::shared_ptr<BaseLib::RpcClientInfo> _dummyClientInfo;
 
+  EventBus _eventBus;
+
   FamilyController(const FamilyController &);
 
   FamilyController &operator=(const FamilyController &);
 
   void rawPacketEvent(int32_t familyId, const std::string &interfaceId, const BaseLib::PVariable &packet);
+
+  /**
+   * Calls family->load() with the peer data of the family read in advance (see DatabaseController::preloadPeerData()).
+   */
+  void loadFamily(const std::shared_ptr<BaseLib::Systems::DeviceFamily> &family);
+
+  // {{{ Peer index
+  /**
+   * Searches all families for the peer. This is the slow path of getPeer().
+   */
+  std::shared_ptr<BaseLib::Systems::Peer> findPeer(uint64_t peerId);
+
+  /**
+   * Recreates the index from the peers of all loaded families.
+   */
+  void rebuildPeerIndex();
+
+  /**
+   * Empties the index. Needs to be called before family modules are unloaded, because the index references memory owned by the modules.
+   */
+  void clearPeerIndex();
+
+  void addToPeerIndex(uint64_t peerId, const std::shared_ptr<BaseLib::Systems::Peer> &peer, uint64_t generation);
+
+  void removeFromPeerIndex(const std::vector<uint64_t> &peerIds);
+
+  bool isMissingPeer(uint64_t peerId);
+
+  uint64_t getMissingPeersGeneration();
+
+  /**
+   * Marks a peer as missing unless peers were added after "generation" was retrieved.
+   */
+  void addMissingPeer(uint64_t peerId, uint64_t generation);
+
+  void clearMissingPeers();
+  // }}}
 };
 
 }
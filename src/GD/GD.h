@@ -42,9 +42,13 @@
 #include "../VariableProfiles/VariableProfileManager.h"
 #include "../RPC/RpcServer.h"
 #include "../RPC/Client.h"
+#include "../RPC/AclCache.h"
+#include "../RPC/MulticallExecutor.h"
 #include "../MQTT/Mqtt.h"
 #include "../IpcLogger.h"
+#include "../TuningSettings.h"
 #include "../Database/SystemVariableController.h"
+#include "../History/HistoryStore.h"
 #include <homegear-base/BaseLib.h>
 
 #include <vector>
@@ -87,6 +91,9 @@ class GD {
   static std::unique_ptr<NodeBlue::NodeBlueServer> nodeBlueServer;
   static BaseLib::Rpc::ServerInfo serverInfo;
   static Rpc::ClientSettings clientSettings;
+  static Rpc::AclCache aclCache;
+  static std::unique_ptr<Rpc::MulticallExecutor> multicallExecutor;
+  static TuningSettings tuningSettings;
   static int32_t rpcLogLevel;
   static std::map<int32_t, std::unique_ptr<BaseLib::Licensing::Licensing>> licensingModules;
   static std::unique_ptr<UPnP> uPnP;
@@ -94,6 +101,7 @@ class GD {
   static std::unique_ptr<UiController> uiController;
   static std::unique_ptr<VariableProfileManager> variableProfileManager;
   static std::unique_ptr<SystemVariableController> systemVariableController;
+  static std::unique_ptr<HistoryStore> historyStore;
   static std::unique_ptr<IpcLogger> ipcLogger;
 };
 
@@ -0,0 +1,186 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "HistoryBlock.h"
+
+#include <cstring>
+
+namespace Homegear {
+
+namespace {
+inline uint64_t zigzagEncode(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+inline void appendVarint(std::vector<uint8_t> &data, uint64_t value) {
+  while (value >= 0x80) {
+    data.push_back((uint8_t)(value | 0x80));
+    value >>= 7;
+  }
+  data.push_back((uint8_t)value);
+}
+
+inline bool readVarint(const uint8_t *&position, const uint8_t *end, uint64_t &value) {
+  value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7) {
+    if (position >= end) return false;
+    uint8_t byte = *position++;
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+inline bool readValue(const uint8_t *&position, const uint8_t *end, uint64_t &lastValue, double &value) {
+  if (position >= end) return false;
+  uint8_t control = *position++;
+  if (control != 0) {
+    uint32_t leadingBytes = (control >> 3) & 7;
+    uint32_t trailingBytes = control & 7;
+    if (leadingBytes + trailingBytes > 7 || position + (8 - leadingBytes - trailingBytes) > end) return false;
+    uint64_t xorValue = 0;
+    for (uint32_t i = trailingBytes; i < 8 - leadingBytes; i++) {
+      xorValue |= (uint64_t)*position++ << (8 * i);
+    }
+    lastValue ^= xorValue;
+  }
+  std::memcpy(&value, &lastValue, sizeof(double));
+  return true;
+}
+}
+
+HistoryBlockEncoder::HistoryBlockEncoder(bool aggregated) {
+  _aggregated = aggregated;
+  clear();
+}
+
+void HistoryBlockEncoder::clear() {
+  _header = HistoryBlockHeader();
+  _header.magic = _aggregated ? kAggregatedMagic : kRawMagic;
+  _data.clear();
+  _lastTime = 0;
+  _lastDelta = 0;
+  _lastValues.fill(0);
+}
+
+void HistoryBlockEncoder::appendValue(uint32_t column, double value) {
+  uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(double));
+  uint64_t xorValue = bits ^ _lastValues[column];
+  _lastValues[column] = bits;
+  if (xorValue == 0) {
+    _data.push_back(0);
+    return;
+  }
+
+  uint32_t leadingBytes = (uint32_t)__builtin_clzll(xorValue) / 8;
+  uint32_t trailingBytes = (uint32_t)__builtin_ctzll(xorValue) / 8;
+  _data.push_back((uint8_t)(0x80 | (leadingBytes << 3) | trailingBytes));
+  for (uint32_t i = trailingBytes; i < 8 - leadingBytes; i++) {
+    _data.push_back((uint8_t)(xorValue >> (8 * i)));
+  }
+}
+
+void HistoryBlockEncoder::append(const HistorySample &sample) {
+  if (_header.count == 0) {
+    appendVarint(_data, zigzagEncode(sample.time));
+    _header.minTime = sample.time;
+    _header.maxTime = sample.time;
+  } else {
+    int64_t delta = sample.time - _lastTime;
+    appendVarint(_data, zigzagEncode(delta - _lastDelta));
+    _lastDelta = delta;
+    if (sample.time < _header.minTime) _header.minTime = sample.time;
+    if (sample.time > _header.maxTime) _header.maxTime = sample.time;
+  }
+  _lastTime = sample.time;
+
+  appendValue(0, sample.value);
+  if (_aggregated) {
+    appendValue(1, sample.min);
+    appendValue(2, sample.max);
+    appendValue(3, (double)sample.count);
+  }
+
+  _header.count++;
+  _header.size = _data.size();
+}
+
+std::vector<uint8_t> HistoryBlockEncoder::serialize(uint32_t seriesId) const {
+  HistoryBlockHeader header = _header;
+  header.seriesId = seriesId;
+  std::vector<uint8_t> result(sizeof(HistoryBlockHeader) + _data.size());
+  std::memcpy(result.data(), &header, sizeof(HistoryBlockHeader));
+  if (!_data.empty()) std::memcpy(result.data() + sizeof(HistoryBlockHeader), _data.data(), _data.size());
+  return result;
+}
+
+bool HistoryBlockDecoder::decode(const HistoryBlockHeader &header, const uint8_t *data, const std::function<void(const HistorySample &sample)> &callback) {
+  bool aggregated = (header.magic == HistoryBlockEncoder::kAggregatedMagic);
+  if (!aggregated && header.magic != HistoryBlockEncoder::kRawMagic) return false;
+
+  const uint8_t *position = data;
+  const uint8_t *end = data + header.size;
+  int64_t lastTime = 0;
+  int64_t lastDelta = 0;
+  std::array<uint64_t, 4> lastValues{};
+  HistorySample sample;
+  for (uint32_t i = 0; i < header.count; i++) {
+    uint64_t encodedTime = 0;
+    if (!readVarint(position, end, encodedTime)) return false;
+    if (i == 0) sample.time = zigzagDecode(encodedTime);
+    else {
+      lastDelta += zigzagDecode(encodedTime);
+      sample.time = lastTime + lastDelta;
+    }
+    lastTime = sample.time;
+
+    if (!readValue(position, end, lastValues[0], sample.value)) return false;
+    if (aggregated) {
+      double count = 0;
+      if (!readValue(position, end, lastValues[1], sample.min) || !readValue(position, end, lastValues[2], sample.max) || !readValue(position, end, lastValues[3], count)) return false;
+      sample.count = (uint32_t)count;
+    } else {
+      sample.min = sample.value;
+      sample.max = sample.value;
+      sample.count = 1;
+    }
+
+    callback(sample);
+  }
+
+  return true;
+}
+
+}
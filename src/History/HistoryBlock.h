@@ -0,0 +1,113 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_HISTORYBLOCK_H_
+#define HOMEGEAR_HISTORYBLOCK_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Homegear {
+
+struct HistorySample {
+  int64_t time = 0;
+  double value = 0;
+  double min = 0;
+  double max = 0;
+  uint32_t count = 1;
+};
+
+/**
+ * Header of one block in a history segment file. The header is followed by "size" bytes of compressed samples of one
+ * series.
+ */
+struct HistoryBlockHeader {
+  uint32_t magic = 0;
+  uint32_t seriesId = 0;
+  uint32_t count = 0;
+  uint32_t size = 0;
+  int64_t minTime = 0;
+  int64_t maxTime = 0;
+};
+static_assert(sizeof(HistoryBlockHeader) == 32, "Unexpected size of HistoryBlockHeader.");
+
+/**
+ * Compresses samples of one series. Timestamps are stored as zigzag encoded varints of the delta of deltas. Values are
+ * XORed with the previous value of the same column and only the significant bytes of the result are stored. Raw blocks
+ * contain one column (the value), aggregated blocks (created by downsampling) four columns: average, minimum, maximum
+ * and count.
+ */
+class HistoryBlockEncoder {
+ public:
+  static constexpr uint32_t kRawMagic = 0x52484748; //HGHR
+  static constexpr uint32_t kAggregatedMagic = 0x41484748; //HGHA
+
+  explicit HistoryBlockEncoder(bool aggregated);
+
+  void append(const HistorySample &sample);
+  void clear();
+
+  uint32_t count() const { return _header.count; }
+
+  /**
+   * Returns the header followed by the compressed samples.
+   */
+  std::vector<uint8_t> serialize(uint32_t seriesId) const;
+ private:
+  bool _aggregated = false;
+  HistoryBlockHeader _header;
+  std::vector<uint8_t> _data;
+  int64_t _lastTime = 0;
+  int64_t _lastDelta = 0;
+  std::array<uint64_t, 4> _lastValues{};
+
+  void appendValue(uint32_t column, double value);
+};
+
+class HistoryBlockDecoder {
+ public:
+  HistoryBlockDecoder() = delete;
+
+  /**
+   * Decodes one block.
+   *
+   * @param header The header of the block.
+   * @param data The compressed samples following the header.
+   * @param callback Called for every sample in stored order.
+   * @return False when the block is corrupt.
+   */
+  static bool decode(const HistoryBlockHeader &header, const uint8_t *data, const std::function<void(const HistorySample &sample)> &callback);
+};
+
+}
+
+#endif
@@ -0,0 +1,636 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "HistoryStore.h"
+#include "../GD/GD.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Homegear {
+
+namespace {
+/**
+ * Columns: series ID (uint32), peer ID (uint64), channel (int32), variable name length (uint16), variable name.
+ */
+constexpr size_t kSeriesIndexRecordSize = 18;
+
+constexpr uint32_t kMaxAggregateIntervals = 100000;
+
+struct Aggregate {
+  double sum = 0;
+  double min = 0;
+  double max = 0;
+  uint32_t count = 0;
+
+  void add(const HistorySample &sample) {
+    if (count == 0 || sample.min < min) min = sample.min;
+    if (count == 0 || sample.max > max) max = sample.max;
+    sum += sample.value * sample.count;
+    count += sample.count;
+  }
+};
+
+bool writeAll(int fileDescriptor, const uint8_t *data, size_t size) {
+  while (size > 0) {
+    ssize_t bytesWritten = write(fileDescriptor, data, size);
+    if (bytesWritten == -1) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += bytesWritten;
+    size -= bytesWritten;
+  }
+  return true;
+}
+}
+
+HistoryStore::HistoryStore() = default;
+
+HistoryStore::~HistoryStore() {
+  stop();
+}
+
+std::string HistoryStore::getSegmentPath(int64_t start, bool downsampled) const {
+  return _path + std::to_string(start) + (downsampled ? ".dseg" : ".hseg");
+}
+
+void HistoryStore::start() {
+  try {
+    stop();
+
+    if (!GD::tuningSettings.historyEnabled()) return;
+    _segmentDuration = (int64_t)GD::tuningSettings.historySegmentDuration() * 1000;
+    _retention = (int64_t)GD::tuningSettings.historyRetention() * 86400000;
+    _downsamplingAge = (int64_t)GD::tuningSettings.historyDownsamplingAge() * 86400000;
+    _downsamplingInterval = (int64_t)GD::tuningSettings.historyDownsamplingInterval() * 1000;
+    _flushInterval = (int64_t)GD::tuningSettings.historyFlushInterval() * 1000;
+    _path = GD::bl->settings.dataPath() + "history/";
+
+    if (!GD::bl->io.directoryExists(_path) && !GD::bl->io.createDirectory(_path, S_IRWXU | S_IRWXG)) {
+      GD::out.printError("Error: Could not create history directory \"" + _path + "\". History is disabled.");
+      return;
+    }
+
+    loadSeriesIndex();
+    if (_seriesIndexFd == -1) return;
+    loadSegments();
+
+    _enabled = true;
+    _stopMaintenanceThread = false;
+    GD::bl->threadManager.start(_maintenanceThread, true, &HistoryStore::maintenanceThread, this);
+    GD::out.printInfo("Info: History is enabled (" + std::to_string(_seriesById.size()) + " series, " + std::to_string(_segments.size()) + " segments).");
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HistoryStore::stop() {
+  try {
+    if (!_stopMaintenanceThread) {
+      {
+        std::lock_guard<std::mutex> maintenanceGuard(_maintenanceMutex);
+        _stopMaintenanceThread = true;
+      }
+      _maintenanceConditionVariable.notify_all();
+      GD::bl->threadManager.join(_maintenanceThread);
+    }
+
+    if (!_enabled) return;
+    flush();
+    _enabled = false;
+
+    std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+    if (_currentSegmentFd != -1) close(_currentSegmentFd);
+    _currentSegmentFd = -1;
+    _currentSegmentStart = -1;
+    if (_seriesIndexFd != -1) close(_seriesIndexFd);
+    _seriesIndexFd = -1;
+    _seriesByVariable.clear();
+    _seriesById.clear();
+    std::lock_guard<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+    _segments.clear();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HistoryStore::loadSeriesIndex() {
+  std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+  _seriesByVariable.clear();
+  _seriesById.clear();
+  _nextSeriesId = 1;
+
+  std::string path = _path + "series.idx";
+  _seriesIndexFd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (_seriesIndexFd == -1) {
+    GD::out.printError("Error: Could not open \"" + path + "\": " + std::string(strerror(errno)) + ". History is disabled.");
+    return;
+  }
+
+  std::vector<uint8_t> content;
+  struct stat fileInfo{};
+  if (fstat(_seriesIndexFd, &fileInfo) == 0 && fileInfo.st_size > 0) {
+    content.resize(fileInfo.st_size);
+    if (pread(_seriesIndexFd, content.data(), content.size(), 0) != (ssize_t)content.size()) {
+      GD::out.printError("Error: Could not read \"" + path + "\". History is disabled.");
+      close(_seriesIndexFd);
+      _seriesIndexFd = -1;
+      return;
+    }
+  }
+
+  size_t position = 0;
+  while (position + kSeriesIndexRecordSize <= content.size()) {
+    auto series = std::make_shared<Series>();
+    uint16_t nameLength = 0;
+    std::memcpy(&series->id, content.data() + position, 4);
+    std::memcpy(&series->peerId, content.data() + position + 4, 8);
+    std::memcpy(&series->channel, content.data() + position + 12, 4);
+    std::memcpy(&nameLength, content.data() + position + 16, 2);
+    if (position + kSeriesIndexRecordSize + nameLength > content.size()) break;
+    series->variable.assign((const char *)content.data() + position + kSeriesIndexRecordSize, nameLength);
+    position += kSeriesIndexRecordSize + nameLength;
+
+    _seriesByVariable[series->peerId][series->channel][series->variable] = series;
+    _seriesById[series->id] = series;
+    if (series->id >= _nextSeriesId) _nextSeriesId = series->id + 1;
+  }
+
+  //Remove incomplete record written during a crash, so new records are appended at a valid position.
+  if (position != content.size() && ftruncate(_seriesIndexFd, position) == -1) {
+    GD::out.printWarning("Warning: Could not truncate \"" + path + "\": " + std::string(strerror(errno)));
+  }
+  lseek(_seriesIndexFd, 0, SEEK_END);
+}
+
+void HistoryStore::loadSegments() {
+  std::lock_guard<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+  _segments.clear();
+
+  auto files = BaseLib::Io::getFiles(_path);
+  for (auto &file: files) {
+    if (file.size() > 4 && file.compare(file.size() - 4, 4, ".tmp") == 0) {
+      //Left over from an interrupted downsampling.
+      BaseLib::Io::deleteFile(_path + file);
+      continue;
+    }
+
+    bool raw = (file.size() > 5 && file.compare(file.size() - 5, 5, ".hseg") == 0);
+    bool downsampled = (file.size() > 5 && file.compare(file.size() - 5, 5, ".dseg") == 0);
+    if (!raw && !downsampled) continue;
+    int64_t start = BaseLib::Math::getNumber64(file.substr(0, file.size() - 5));
+
+    auto &segment = _segments[start];
+    segment.start = start;
+    if (raw) segment.raw = true;
+    else segment.downsampled = true;
+  }
+
+  for (auto &segment: _segments) {
+    if (segment.second.raw && segment.second.downsampled) {
+      //Downsampling was interrupted after the aggregated segment was written.
+      BaseLib::Io::deleteFile(getSegmentPath(segment.first, false));
+      segment.second.raw = false;
+    }
+  }
+}
+
+HistoryStore::PSeries HistoryStore::getSeries(uint64_t peerId, int32_t channel, const std::string &variable, bool create) {
+  auto peerIterator = _seriesByVariable.find(peerId);
+  if (peerIterator != _seriesByVariable.end()) {
+    auto channelIterator = peerIterator->second.find(channel);
+    if (channelIterator != peerIterator->second.end()) {
+      auto variableIterator = channelIterator->second.find(variable);
+      if (variableIterator != channelIterator->second.end()) return variableIterator->second;
+    }
+  }
+  if (!create || variable.size() > 0xFFFF) return PSeries();
+
+  auto series = std::make_shared<Series>();
+  series->id = _nextSeriesId++;
+  series->peerId = peerId;
+  series->channel = channel;
+  series->variable = variable;
+
+  std::vector<uint8_t> record(kSeriesIndexRecordSize + variable.size());
+  auto nameLength = (uint16_t)variable.size();
+  std::memcpy(record.data(), &series->id, 4);
+  std::memcpy(record.data() + 4, &series->peerId, 8);
+  std::memcpy(record.data() + 12, &series->channel, 4);
+  std::memcpy(record.data() + 16, &nameLength, 2);
+  if (!variable.empty()) std::memcpy(record.data() + kSeriesIndexRecordSize, variable.data(), variable.size());
+  if (!writeAll(_seriesIndexFd, record.data(), record.size())) {
+    GD::out.printError("Error: Could not write to history series index: " + std::string(strerror(errno)));
+    return PSeries();
+  }
+
+  _seriesByVariable[peerId][channel][variable] = series;
+  _seriesById[series->id] = series;
+  return series;
+}
+
+void HistoryStore::variableEvent(uint64_t peerId, int32_t channel, const std::shared_ptr<std::vector<std::string>> &variables, const BaseLib::PArray &values) {
+  try {
+    if (!_enabled || !variables || !values || variables->size() != values->size()) return;
+
+    HistorySample sample;
+    sample.time = BaseLib::HelperFunctions::getTime();
+    int64_t segmentStart = sample.time - (sample.time % _segmentDuration);
+
+    std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+    if (!_enabled) return;
+    for (uint32_t i = 0; i < variables->size(); i++) {
+      auto &value = values->at(i);
+      if (!value) continue;
+      if (value->type == BaseLib::VariableType::tBoolean) sample.value = value->booleanValue ? 1 : 0;
+      else if (value->type == BaseLib::VariableType::tInteger) sample.value = value->integerValue;
+      else if (value->type == BaseLib::VariableType::tInteger64) sample.value = value->integerValue64;
+      else if (value->type == BaseLib::VariableType::tFloat) sample.value = value->floatValue;
+      else continue;
+      sample.min = sample.value;
+      sample.max = sample.value;
+
+      auto series = getSeries(peerId, channel, variables->at(i), true);
+      if (!series) continue;
+      if (series->blockSegment != segmentStart) {
+        flushBlock(*series);
+        series->blockSegment = segmentStart;
+      }
+      series->block.append(sample);
+      if (series->block.count() >= kMaxSamplesPerBlock) flushBlock(*series);
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HistoryStore::flushBlock(Series &series) {
+  if (series.block.count() == 0) return;
+  appendToSegment(series.blockSegment, series.block.serialize(series.id));
+  series.block.clear();
+}
+
+void HistoryStore::appendToSegment(int64_t segmentStart, const std::vector<uint8_t> &data) {
+  int fileDescriptor = -1;
+  bool closeFile = false;
+  if (segmentStart == _currentSegmentStart && _currentSegmentFd != -1) fileDescriptor = _currentSegmentFd;
+  else {
+    {
+      std::lock_guard<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+      auto &segment = _segments[segmentStart];
+      segment.start = segmentStart;
+      segment.raw = true;
+    }
+
+    std::string path = getSegmentPath(segmentStart, false);
+    fileDescriptor = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (fileDescriptor == -1) {
+      GD::out.printError("Error: Could not open \"" + path + "\": " + std::string(strerror(errno)));
+      return;
+    }
+
+    if (segmentStart > _currentSegmentStart) {
+      if (_currentSegmentFd != -1) close(_currentSegmentFd);
+      _currentSegmentFd = fileDescriptor;
+      _currentSegmentStart = segmentStart;
+    } else closeFile = true;
+  }
+
+  if (!writeAll(fileDescriptor, data.data(), data.size())) GD::out.printError("Error: Could not write to history segment: " + std::string(strerror(errno)));
+  if (closeFile) close(fileDescriptor);
+}
+
+void HistoryStore::flush() {
+  try {
+    std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+    for (auto &series: _seriesById) {
+      flushBlock(*series.second);
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HistoryStore::maintenanceThread() {
+  try {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> maintenanceGuard(_maintenanceMutex);
+        _maintenanceConditionVariable.wait_for(maintenanceGuard, std::chrono::milliseconds(_flushInterval), [&] { return (bool)_stopMaintenanceThread; });
+        if (_stopMaintenanceThread) return;
+      }
+
+      flush();
+      deleteOldSegments();
+      downsampleSegments();
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HistoryStore::deleteOldSegments() {
+  try {
+    if (_retention <= 0) return;
+    int64_t end = BaseLib::HelperFunctions::getTime() - _retention;
+
+    std::lock_guard<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+    for (auto segmentIterator = _segments.begin(); segmentIterator != _segments.end() && segmentIterator->first + _segmentDuration <= end;) {
+      if (segmentIterator->second.raw) BaseLib::Io::deleteFile(getSegmentPath(segmentIterator->first, false));
+      if (segmentIterator->second.downsampled) BaseLib::Io::deleteFile(getSegmentPath(segmentIterator->first, true));
+      segmentIterator = _segments.erase(segmentIterator);
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HistoryStore::downsampleSegments() {
+  try {
+    if (_downsamplingAge <= 0) return;
+    //Blocks of a segment can still be flushed up to one flush interval after the segment ended.
+    int64_t end = BaseLib::HelperFunctions::getTime() - std::max(_downsamplingAge, 2 * _flushInterval);
+
+    std::vector<int64_t> segments;
+    {
+      std::shared_lock<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+      for (auto &segment: _segments) {
+        if (segment.first + _segmentDuration > end) break;
+        if (segment.second.raw && !segment.second.downsampled) segments.push_back(segment.first);
+      }
+    }
+
+    for (auto start: segments) {
+      if (_stopMaintenanceThread) return;
+      if (!downsampleSegment(start)) GD::out.printWarning("Warning: Could not downsample history segment " + getSegmentPath(start, false) + ".");
+    }
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool HistoryStore::downsampleSegment(int64_t start) {
+  //Series ID, interval start
+  std::map<uint32_t, std::map<int64_t, Aggregate>> aggregates;
+  {
+    std::shared_lock<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+    if (!readSegment(getSegmentPath(start, false), SIZE_MAX, 0, [&](uint32_t seriesId, const HistoryBlockHeader &header, const uint8_t *data) {
+      auto &seriesAggregates = aggregates[seriesId];
+      HistoryBlockDecoder::decode(header, data, [&](const HistorySample &sample) {
+        int64_t intervalStart = std::max(start, sample.time - (sample.time % _downsamplingInterval));
+        seriesAggregates[intervalStart].add(sample);
+      });
+    })) {
+      return false;
+    }
+  }
+
+  std::vector<uint8_t> content;
+  HistoryBlockEncoder block(true);
+  for (auto &seriesAggregates: aggregates) {
+    for (auto &aggregate: seriesAggregates.second) {
+      if (aggregate.second.count == 0) continue;
+      HistorySample sample;
+      sample.time = aggregate.first;
+      sample.value = aggregate.second.sum / aggregate.second.count;
+      sample.min = aggregate.second.min;
+      sample.max = aggregate.second.max;
+      sample.count = aggregate.second.count;
+      block.append(sample);
+      if (block.count() >= kMaxSamplesPerBlock) {
+        auto data = block.serialize(seriesAggregates.first);
+        content.insert(content.end(), data.begin(), data.end());
+        block.clear();
+      }
+    }
+    if (block.count() > 0) {
+      auto data = block.serialize(seriesAggregates.first);
+      content.insert(content.end(), data.begin(), data.end());
+      block.clear();
+    }
+  }
+
+  std::string path = getSegmentPath(start, true);
+  std::string tempPath = path + ".tmp";
+  int fileDescriptor = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fileDescriptor == -1) return false;
+  bool result = writeAll(fileDescriptor, content.data(), content.size()) && fdatasync(fileDescriptor) == 0;
+  close(fileDescriptor);
+  if (!result) {
+    BaseLib::Io::deleteFile(tempPath);
+    return false;
+  }
+
+  std::lock_guard<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+  if (rename(tempPath.c_str(), path.c_str()) == -1) {
+    BaseLib::Io::deleteFile(tempPath);
+    return false;
+  }
+  BaseLib::Io::deleteFile(getSegmentPath(start, false));
+  auto segmentIterator = _segments.find(start);
+  if (segmentIterator != _segments.end()) {
+    segmentIterator->second.raw = false;
+    segmentIterator->second.downsampled = true;
+  }
+  return true;
+}
+
+bool HistoryStore::readSegment(const std::string &path, size_t size, uint32_t seriesId, const std::function<void(uint32_t seriesId, const HistoryBlockHeader &header, const uint8_t *data)> &callback) {
+  int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor == -1) return false;
+  bool result = readSegment(fileDescriptor, path, size, seriesId, callback);
+  close(fileDescriptor);
+  return result;
+}
+
+bool HistoryStore::readSegment(int fileDescriptor, const std::string &path, size_t size, uint32_t seriesId, const std::function<void(uint32_t seriesId, const HistoryBlockHeader &header, const uint8_t *data)> &callback) {
+  struct stat fileInfo{};
+  if (fstat(fileDescriptor, &fileInfo) == -1) return false;
+  size = std::min(size, (size_t)fileInfo.st_size);
+  if (size == 0 || !callback) return true;
+
+  void *mappedFile = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  if (mappedFile == MAP_FAILED) return false;
+  madvise(mappedFile, size, MADV_SEQUENTIAL);
+
+  auto data = (const uint8_t *)mappedFile;
+  size_t position = 0;
+  while (position + sizeof(HistoryBlockHeader) <= size) {
+    HistoryBlockHeader header;
+    std::memcpy(&header, data + position, sizeof(HistoryBlockHeader));
+    if (header.magic != HistoryBlockEncoder::kRawMagic && header.magic != HistoryBlockEncoder::kAggregatedMagic) {
+      GD::out.printWarning("Warning: History segment \"" + path + "\" is corrupt at position " + std::to_string(position) + ".");
+      break;
+    }
+    if (position + sizeof(HistoryBlockHeader) + header.size > size) break; //Incomplete block
+    if (seriesId == 0 || header.seriesId == seriesId) callback(header.seriesId, header, data + position + sizeof(HistoryBlockHeader));
+    position += sizeof(HistoryBlockHeader) + header.size;
+  }
+
+  munmap(mappedFile, size);
+  return true;
+}
+
+bool HistoryStore::getSamples(uint64_t peerId, int32_t channel, const std::string &variable, int64_t startTime, int64_t endTime, std::vector<HistorySample> &samples) {
+  uint32_t seriesId = 0;
+  std::vector<uint8_t> openBlock;
+  struct SegmentFile {
+    std::string path;
+    int fileDescriptor = -1;
+    size_t size = 0;
+  };
+  std::vector<SegmentFile> files;
+
+  {
+    //All writes to segment files happen while _seriesMutex is locked, so the file sizes and the open block are consistent.
+    std::lock_guard<std::mutex> seriesGuard(_seriesMutex);
+    auto series = getSeries(peerId, channel, variable, false);
+    if (!series) return false;
+    seriesId = series->id;
+    if (series->block.count() > 0) openBlock = series->block.serialize(seriesId);
+
+    //Only the files are opened while _segmentsMutex is locked. Open files can still be read after they were replaced or
+    //deleted, so the (slow) reading doesn't block the maintenance thread.
+    std::shared_lock<std::shared_timed_mutex> segmentsGuard(_segmentsMutex);
+    for (auto segmentIterator = _segments.lower_bound(startTime - _segmentDuration + 1); segmentIterator != _segments.end() && segmentIterator->first <= endTime; ++segmentIterator) {
+      for (auto downsampled: {false, true}) {
+        if ((downsampled && !segmentIterator->second.downsampled) || (!downsampled && !segmentIterator->second.raw)) continue;
+        SegmentFile file;
+        file.path = getSegmentPath(segmentIterator->first, downsampled);
+        file.fileDescriptor = open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file.fileDescriptor == -1) continue;
+        struct stat fileInfo{};
+        if (fstat(file.fileDescriptor, &fileInfo) == -1) {
+          close(file.fileDescriptor);
+          continue;
+        }
+        file.size = (size_t)fileInfo.st_size;
+        files.emplace_back(std::move(file));
+      }
+    }
+  }
+
+  auto addSample = [&](const HistorySample &sample) {
+    if (sample.time >= startTime && sample.time <= endTime) samples.push_back(sample);
+  };
+  auto decodeBlock = [&](uint32_t blockSeriesId, const HistoryBlockHeader &header, const uint8_t *data) {
+    if (header.maxTime < startTime || header.minTime > endTime) return;
+    HistoryBlockDecoder::decode(header, data, addSample);
+  };
+
+  for (auto &file: files) {
+    readSegment(file.fileDescriptor, file.path, file.size, seriesId, decodeBlock);
+    close(file.fileDescriptor);
+  }
+
+  if (!openBlock.empty()) {
+    HistoryBlockHeader header;
+    std::memcpy(&header, openBlock.data(), sizeof(HistoryBlockHeader));
+    decodeBlock(seriesId, header, openBlock.data() + sizeof(HistoryBlockHeader));
+  }
+
+  std::stable_sort(samples.begin(), samples.end(), [](const HistorySample &a, const HistorySample &b) { return a.time < b.time; });
+  return true;
+}
+
+BaseLib::PVariable HistoryStore::getVariableHistory(uint64_t peerId, int32_t channel, const std::string &variable, int64_t startTime, int64_t endTime, uint32_t maxValues) {
+  try {
+    if (!_enabled) return BaseLib::Variable::createError(-1, "History is disabled.");
+    if (endTime < startTime) return BaseLib::Variable::createError(-32602, "endTime is smaller than startTime.");
+
+    std::vector<HistorySample> samples;
+    getSamples(peerId, channel, variable, startTime, endTime, samples);
+    //Return the most recent samples.
+    if (maxValues > 0 && samples.size() > maxValues) samples.erase(samples.begin(), samples.end() - maxValues);
+
+    auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    result->arrayValue->reserve(samples.size());
+    for (auto &sample: samples) {
+      auto entry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      entry->structValue->emplace("TIME", std::make_shared<BaseLib::Variable>(sample.time));
+      entry->structValue->emplace("VALUE", std::make_shared<BaseLib::Variable>(sample.value));
+      result->arrayValue->emplace_back(entry);
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable HistoryStore::getVariableHistoryAggregate(uint64_t peerId, int32_t channel, const std::string &variable, int64_t startTime, int64_t endTime, int64_t interval) {
+  try {
+    if (!_enabled) return BaseLib::Variable::createError(-1, "History is disabled.");
+    if (endTime < startTime) return BaseLib::Variable::createError(-32602, "endTime is smaller than startTime.");
+    if (interval <= 0) return BaseLib::Variable::createError(-32602, "interval needs to be greater than 0.");
+    if ((endTime - startTime) / interval >= kMaxAggregateIntervals) return BaseLib::Variable::createError(-32602, "Too many intervals. The maximum is " + std::to_string(kMaxAggregateIntervals) + ".");
+
+    std::vector<HistorySample> samples;
+    getSamples(peerId, channel, variable, startTime, endTime, samples);
+
+    std::map<int64_t, Aggregate> aggregates;
+    for (auto &sample: samples) {
+      aggregates[startTime + ((sample.time - startTime) / interval) * interval].add(sample);
+    }
+
+    auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    result->arrayValue->reserve(aggregates.size());
+    for (auto &aggregate: aggregates) {
+      auto entry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      entry->structValue->emplace("TIME", std::make_shared<BaseLib::Variable>(aggregate.first));
+      entry->structValue->emplace("MIN", std::make_shared<BaseLib::Variable>(aggregate.second.min));
+      entry->structValue->emplace("MAX", std::make_shared<BaseLib::Variable>(aggregate.second.max));
+      entry->structValue->emplace("AVERAGE", std::make_shared<BaseLib::Variable>(aggregate.second.sum / aggregate.second.count));
+      entry->structValue->emplace("COUNT", std::make_shared<BaseLib::Variable>((int64_t)aggregate.second.count));
+      result->arrayValue->emplace_back(entry);
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
@@ -0,0 +1,190 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_HISTORYSTORE_H_
+#define HOMEGEAR_HISTORYSTORE_H_
+
+#include "HistoryBlock.h"
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace Homegear {
+
+/**
+ * Append only time series store for numeric variable values.
+ *
+ * Samples are collected per series (peer ID, channel, variable) in memory and appended as compressed blocks to segment
+ * files covering a fixed time span ("<start>.hseg" in "<dataPath>/history/"). Blocks are flushed when they are full,
+ * when the series moves to the next segment and every "historyFlushInterval" seconds. Queries map the segment files
+ * into memory. Segments older than the retention time are deleted, segments older than the downsampling age are
+ * replaced by aggregated segments ("<start>.dseg") containing one average, minimum, maximum and count per series and
+ * downsampling interval.
+ *
+ * The series IDs are stored in "series.idx".
+ */
+class HistoryStore {
+ public:
+  HistoryStore();
+  virtual ~HistoryStore();
+
+  bool enabled() const { return _enabled; }
+
+  void start();
+  void stop();
+
+  /**
+   * Stores all numeric values of an event.
+   */
+  void variableEvent(uint64_t peerId, int32_t channel, const std::shared_ptr<std::vector<std::string>> &variables, const BaseLib::PArray &values);
+
+  /**
+   * Returns the samples of one variable between "startTime" and "endTime" (both in milliseconds, inclusive) in
+   * chronological order.
+   *
+   * @param maxValues Maximum number of returned samples. When there are more, the most recent ones are returned. "0"
+   * means no limit.
+   * @return An array of structs with the elements "TIME" and "VALUE".
+   */
+  BaseLib::PVariable getVariableHistory(uint64_t peerId, int32_t channel, const std::string &variable, int64_t startTime, int64_t endTime, uint32_t maxValues);
+
+  /**
+   * Returns the minimum, maximum, average and number of samples of one variable per "interval" milliseconds between
+   * "startTime" and "endTime". Intervals without samples are omitted.
+   *
+   * @return An array of structs with the elements "TIME", "MIN", "MAX", "AVERAGE" and "COUNT".
+   */
+  BaseLib::PVariable getVariableHistoryAggregate(uint64_t peerId, int32_t channel, const std::string &variable, int64_t startTime, int64_t endTime, int64_t interval);
+ private:
+  static constexpr uint32_t kMaxSamplesPerBlock = 1024;
+
+  struct Series {
+    uint32_t id = 0;
+    uint64_t peerId = 0;
+    int32_t channel = -1;
+    std::string variable;
+    /**
+     * Start of the segment the samples in "block" belong to.
+     */
+    int64_t blockSegment = -1;
+    HistoryBlockEncoder block{false};
+  };
+  typedef std::shared_ptr<Series> PSeries;
+
+  struct Segment {
+    int64_t start = 0;
+    bool raw = false;
+    bool downsampled = false;
+  };
+
+  std::atomic_bool _enabled{false};
+  std::string _path;
+  int64_t _segmentDuration = 3600000;
+  int64_t _retention = 0;
+  int64_t _downsamplingAge = 0;
+  int64_t _downsamplingInterval = 300000;
+  int64_t _flushInterval = 60000;
+
+  /**
+   * Protects the series, their open blocks and all writes to segment files.
+   */
+  std::mutex _seriesMutex;
+  uint32_t _nextSeriesId = 1;
+  int _seriesIndexFd = -1;
+  /**
+   * Peer ID, channel, variable
+   */
+  std::unordered_map<uint64_t, std::unordered_map<int32_t, std::unordered_map<std::string, PSeries>>> _seriesByVariable;
+  std::unordered_map<uint32_t, PSeries> _seriesById;
+  int64_t _currentSegmentStart = -1;
+  int _currentSegmentFd = -1;
+
+  /**
+   * Held shared while segment files are opened for reading and exclusively while segments are added, replaced or
+   * deleted.
+   */
+  std::shared_timed_mutex _segmentsMutex;
+  std::map<int64_t, Segment> _segments;
+
+  std::atomic_bool _stopMaintenanceThread{true};
+  std::mutex _maintenanceMutex;
+  std::condition_variable _maintenanceConditionVariable;
+  std::thread _maintenanceThread;
+
+  std::string getSegmentPath(int64_t start, bool downsampled) const;
+  void loadSeriesIndex();
+  void loadSegments();
+  PSeries getSeries(uint64_t peerId, int32_t channel, const std::string &variable, bool create);
+
+  /**
+   * Appends the open block of "series" to its segment file. _seriesMutex must be locked.
+   */
+  void flushBlock(Series &series);
+
+  /**
+   * Appends "data" to the raw segment file starting at "segmentStart". _seriesMutex must be locked.
+   */
+  void appendToSegment(int64_t segmentStart, const std::vector<uint8_t> &data);
+
+  void flush();
+  void maintenanceThread();
+  void deleteOldSegments();
+  void downsampleSegments();
+  bool downsampleSegment(int64_t start);
+
+  /**
+   * Reads all blocks of one segment file up to "size" bytes.
+   *
+   * @param seriesId Only blocks of this series are decoded. "0" decodes all blocks.
+   * @return False when the file could not be read.
+   */
+  bool readSegment(const std::string &path, size_t size, uint32_t seriesId, const std::function<void(uint32_t seriesId, const HistoryBlockHeader &header, const uint8_t *data)> &callback);
+
+  /**
+   * Like readSegment() above, but reads from an open file. The file descriptor is not closed.
+   */
+  bool readSegment(int fileDescriptor, const std::string &path, size_t size, uint32_t seriesId, const std::function<void(uint32_t seriesId, const HistoryBlockHeader &header, const uint8_t *data)> &callback);
+
+  /**
+   * Collects all samples of a series between "startTime" and "endTime" sorted by time.
+   */
+  bool getSamples(uint64_t peerId, int32_t channel, const std::string &variable, int64_t startTime, int64_t endTime, std::vector<HistorySample> &samples);
+};
+
+}
+
+#endif
@@ -40,6 +40,7 @@
 #include "../RPC/RpcMethods/NodeBlueRpcMethods.h"
 #include "../RPC/RpcMethods/MaintenanceRpcMethods.h"
 #include "../RPC/RpcMethods/BuildingPartRpcMethods.h"
+#include "../RPC/RpcMethods/HistoryRpcMethods.h"
 
 namespace Homegear {
 
@@ -264,6 +265,11 @@ IpcServer::IpcServer() : IQueue(GD::bl.get(), 3, 100000) {
     _rpcMethods.emplace("updateCategory", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUpdateCategory()));
   }
 
+  { // History
+    _rpcMethods.emplace("getVariableHistory", std::make_shared<RpcMethods::RPCGetVariableHistory>());
+    _rpcMethods.emplace("getVariableHistoryAggregate", std::make_shared<RpcMethods::RPCGetVariableHistoryAggregate>());
+  }
+
   { // System variables
     _rpcMethods.emplace("addRoleToSystemVariable", std::static_pointer_cast<BaseLib::Rpc::RpcMethod>(std::make_shared<Rpc::RPCAddRoleToSystemVariable>()));
     _rpcMethods.emplace("getSystemVariablesInRole", std::static_pointer_cast<BaseLib::Rpc::RpcMethod>(std::make_shared<Rpc::RPCGetSystemVariablesInRole>()));
@@ -333,6 +339,8 @@ IpcServer::IpcServer() : IQueue(GD::bl.get(), 3, 100000) {
   { // Maintenance
     _rpcMethods.emplace("enableMaintenanceMode", std::make_shared<RpcMethods::RpcEnableMaintenanceMode>());
     _rpcMethods.emplace("disableMaintenanceMode", std::make_shared<RpcMethods::RpcDisableMaintenanceMode>());
+    _rpcMethods.emplace("startDatabaseBackup", std::make_shared<RpcMethods::RpcStartDatabaseBackup>());
+    _rpcMethods.emplace("getDatabaseBackupStatus", std::make_shared<RpcMethods::RpcGetDatabaseBackupStatus>());
   }
 
   _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(PIpcClientData &clientData, int32_t scriptId, BaseLib::PArray &parameters)>>("getHomegearPid",
@@ -595,13 +603,7 @@ void IpcServer::broadcastEvent(std::string &source, uint64_t id, int32_t channel
     if (!_dummyClientInfo->acls->checkEventServerMethodAccess("event")) return;
 
     if (_dummyClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet()) {
-      std::shared_ptr<BaseLib::Systems::Peer> peer;
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (auto &family : families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) peer = central->getPeer(id);
-        if (peer) break;
-      }
+      std::shared_ptr<BaseLib::Systems::Peer> peer = GD::familyController->getPeer(id);
 
       if (!peer) return;
 
@@ -613,12 +615,12 @@ void IpcServer::broadcastEvent(std::string &source, uint64_t id, int32_t channel
         if (id == 0) {
           if (_dummyClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesReadSet()) {
             auto systemVariable = GD::systemVariableController->getInternal(variables->at(i));
-            if (systemVariable && _dummyClientInfo->acls->checkSystemVariableReadAccess(systemVariable)) {
+            if (systemVariable && GD::aclCache.checkSystemVariableReadAccess(_dummyClientInfo->acls, systemVariable)) {
               newVariables->push_back(variables->at(i));
               newValues->push_back(values->at(i));
             }
           }
-        } else if (peer && _dummyClientInfo->acls->checkVariableReadAccess(peer, channel, variables->at(i))) {
+        } else if (peer && GD::aclCache.checkVariableReadAccess(_dummyClientInfo->acls, peer, channel, variables->at(i))) {
           newVariables->push_back(variables->at(i));
           newValues->push_back(values->at(i));
         }
@@ -636,6 +638,7 @@ void IpcServer::broadcastEvent(std::string &source, uint64_t id, int32_t channel
         clients.push_back(client.second);
       }
     }
+    if (clients.empty()) return;
 
     auto parameters = std::make_shared<BaseLib::Array>();
     parameters->reserve(5);
@@ -645,8 +648,14 @@ void IpcServer::broadcastEvent(std::string &source, uint64_t id, int32_t channel
     parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
     parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
 
+    //Encoded once for all clients. Only the packet ID is written per client.
+    auto broadcastRequest = std::make_shared<const Rpc::BroadcastRequest>(*_rpcEncoder, "broadcastEvent", BaseLib::Array{std::make_shared<BaseLib::Variable>(parameters)});
+    if (!broadcastRequest->isValid()) broadcastRequest.reset();
+
     for (auto &client : clients) {
-      std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(client, "broadcastEvent", parameters);
+      std::shared_ptr<BaseLib::IQueueEntry> queueEntry;
+      if (broadcastRequest) queueEntry = std::make_shared<QueueEntry>(client, broadcastRequest, parameters);
+      else queueEntry = std::make_shared<QueueEntry>(client, "broadcastEvent", parameters);
       if (!enqueue(2, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC method call \"broadcastEvent\". Queue is full.");
     }
   }
@@ -661,17 +670,11 @@ void IpcServer::broadcastServiceMessage(const BaseLib::PServiceMessage &serviceM
     if (!_dummyClientInfo->acls->checkEventServerMethodAccess("serviceMessage")) return;
 
     if (serviceMessage->peerId > 0 && _dummyClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet()) {
-      std::shared_ptr<BaseLib::Systems::Peer> peer;
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (auto &family : families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) peer = central->getPeer(serviceMessage->peerId);
-        if (peer) break;
-      }
+      std::shared_ptr<BaseLib::Systems::Peer> peer = GD::familyController->getPeer(serviceMessage->peerId);
 
       if (!peer) return;
 
-      if (!_dummyClientInfo->acls->checkVariableReadAccess(peer, serviceMessage->channel, serviceMessage->variable)) {
+      if (!GD::aclCache.checkVariableReadAccess(_dummyClientInfo->acls, peer, serviceMessage->channel, serviceMessage->variable)) {
         return;
       }
     }
@@ -778,13 +781,8 @@ void IpcServer::broadcastUpdateDevice(uint64_t id, int32_t channel, int32_t hint
 
     if (!_dummyClientInfo->acls->checkEventServerMethodAccess("updateDevice")) return;
     if (_dummyClientInfo->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet()) {
-      std::shared_ptr<BaseLib::Systems::Peer> peer;
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
-        if (central) peer = central->getPeer(id);
-        if (!peer || !_dummyClientInfo->acls->checkDeviceReadAccess(peer)) return;
-      }
+      auto peer = GD::familyController->getPeer(id);
+      if (!peer || !_dummyClientInfo->acls->checkDeviceReadAccess(peer)) return;
     }
 
     std::vector<PIpcClientData> clients;
@@ -1104,6 +1102,8 @@ void IpcServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueue
           }
         }
         BaseLib::PVariable result = _rpcMethods.at(methodName)->invoke(_dummyClientInfo, parameters->at(2)->arrayValue);
+        GD::aclCache.rpcMethodInvoked(methodName);
+        if (GD::nodeBlueServer) GD::nodeBlueServer->rpcMethodInvoked(methodName);
         if (GD::bl->debugLevel >= 5) {
           _out.printDebug("Response: ");
           result->print(true, false);
@@ -1134,7 +1134,7 @@ void IpcServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueue
       }
     } else if (index == 2 && queueEntry->type == QueueEntry::QueueEntryType::broadcast) //Second queue for sending packets. Response is processed by first queue
     {
-      BaseLib::PVariable response = sendRequest(queueEntry->clientData, queueEntry->methodName, queueEntry->parameters);
+      BaseLib::PVariable response = sendRequest(queueEntry->clientData, queueEntry->methodName, queueEntry->parameters, queueEntry->broadcastRequest);
       if (response->errorStruct) {
         _out.printError("Error calling \"" + queueEntry->methodName + "\" on client " + std::to_string(queueEntry->clientData->id) + ": " + response->structValue->at("faultString")->stringValue);
       }
@@ -1171,7 +1171,24 @@ BaseLib::PVariable IpcServer::send(const PIpcClientData &clientData, const std::
   return BaseLib::PVariable(new BaseLib::Variable());
 }
 
-BaseLib::PVariable IpcServer::sendRequest(const PIpcClientData &clientData, const std::string &methodName, const BaseLib::PArray &parameters) {
+BaseLib::PVariable IpcServer::send(const PIpcClientData &clientData, const Rpc::BroadcastRequest &broadcastRequest, int32_t packetId) {
+  try {
+    std::lock_guard<std::mutex> sendGuard(clientData->sendMutex);
+    if (!broadcastRequest.send(clientData->fileDescriptor->descriptor, packetId)) {
+      if (clientData->fileDescriptor->descriptor != -1) GD::out.printError("Could not send data to client: " + std::to_string(clientData->fileDescriptor->descriptor));
+      return BaseLib::Variable::createError(-32500, "Unknown application error.");
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::PVariable(new BaseLib::Variable());
+}
+
+BaseLib::PVariable IpcServer::sendRequest(const PIpcClientData &clientData, const std::string &methodName, const BaseLib::PArray &parameters, const Rpc::PBroadcastRequest &broadcastRequest) {
   try {
     if (methodName.empty() || !clientData) {
       _out.printError("Error: Invalid input to sendRequest().");
@@ -1186,9 +1203,11 @@ BaseLib::PVariable IpcServer::sendRequest(const PIpcClientData &clientData, cons
       std::lock_guard<std::mutex> packetIdGuard(_packetIdMutex);
       packetId = _currentPacketId++;
     }
-    BaseLib::PArray array(new BaseLib::Array{std::make_shared<BaseLib::Variable>(packetId), std::make_shared<BaseLib::Variable>(parameters)});
     std::vector<char> data;
-    _rpcEncoder->encodeRequest(methodName, array, data);
+    if (!broadcastRequest) {
+      BaseLib::PArray array(new BaseLib::Array{std::make_shared<BaseLib::Variable>(packetId), std::make_shared<BaseLib::Variable>(parameters)});
+      _rpcEncoder->encodeRequest(methodName, array, data);
+    }
 
     PIpcResponse response;
     {
@@ -1201,9 +1220,12 @@ BaseLib::PVariable IpcServer::sendRequest(const PIpcClientData &clientData, cons
       return BaseLib::Variable::createError(-32500, "Unknown application error.");
     }
 
-    if (GD::ipcLogger->enabled()) GD::ipcLogger->log(IpcModule::ipc, packetId, clientData->pid, IpcLoggerPacketDirection::toClient, data);
+    if (GD::ipcLogger->enabled()) {
+      if (broadcastRequest) broadcastRequest->getData(packetId, data);
+      GD::ipcLogger->log(IpcModule::ipc, packetId, clientData->pid, IpcLoggerPacketDirection::toClient, data);
+    }
 
-    BaseLib::PVariable result = send(clientData, data);
+    BaseLib::PVariable result = broadcastRequest ? send(clientData, *broadcastRequest, packetId) : send(clientData, data);
     if (result->errorStruct) {
       std::lock_guard<std::mutex> responseGuard(clientData->rpcResponsesMutex);
       clientData->rpcResponses.erase(packetId);
@@ -32,6 +32,7 @@
 #define IPCSERVER_H_
 
 #include "IpcClientData.h"
+#include "../RPC/BroadcastRequest.h"
 
 #include <homegear-base/BaseLib.h>
 
@@ -103,6 +104,14 @@ class IpcServer : public BaseLib::IQueue {
       this->parameters = parameters;
     }
 
+    QueueEntry(PIpcClientData &clientData, const Rpc::PBroadcastRequest &broadcastRequest, BaseLib::PArray &parameters) {
+      type = QueueEntryType::broadcast;
+      this->clientData = clientData;
+      this->methodName = broadcastRequest->getMethodName();
+      this->parameters = parameters;
+      this->broadcastRequest = broadcastRequest;
+    }
+
     ~QueueEntry() override = default;
 
     QueueEntryType type = QueueEntryType::defaultType;
@@ -115,6 +124,10 @@ class IpcServer : public BaseLib::IQueue {
     // {{{ broadcast
     std::string methodName;
     BaseLib::PArray parameters;
+    /**
+     * Set when the request was encoded once for all clients.
+     */
+    Rpc::PBroadcastRequest broadcastRequest;
     // }}}
   };
 
@@ -155,7 +168,12 @@ class IpcServer : public BaseLib::IQueue {
 
   BaseLib::PVariable send(const PIpcClientData &clientData, const std::vector<char> &data);
 
-  BaseLib::PVariable sendRequest(const PIpcClientData &clientData, const std::string &methodName, const BaseLib::PArray &parameters);
+  /**
+   * Sends the shared encoded request of a broadcast with the packet ID of this client.
+   */
+  BaseLib::PVariable send(const PIpcClientData &clientData, const Rpc::BroadcastRequest &broadcastRequest, int32_t packetId);
+
+  BaseLib::PVariable sendRequest(const PIpcClientData &clientData, const std::string &methodName, const BaseLib::PArray &parameters, const Rpc::PBroadcastRequest &broadcastRequest = Rpc::PBroadcastRequest());
 
   void sendResponse(PIpcClientData &clientData, BaseLib::PVariable &scriptId, BaseLib::PVariable &packetId, BaseLib::PVariable &variable);
 
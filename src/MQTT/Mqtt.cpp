@@ -1015,23 +1015,16 @@ void Mqtt::queueMessage(const std::string &source, uint64_t peerId, int32_t chan
 
     bool checkAcls = _dummyClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet();
     std::shared_ptr<BaseLib::Systems::Peer> peer;
-    if (checkAcls && peerId != 0) {
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin(); i != families.end(); ++i) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
-        if (central) peer = central->getPeer(peerId);
-        if (peer) break;
-      }
-    }
+    if (checkAcls && peerId != 0) peer = GD::familyController->getPeer(peerId);
 
     for (int32_t i = 0; i < (signed)keys.size(); i++) {
       if (checkAcls) {
         if (peerId == 0) {
           if (_dummyClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesReadSet()) {
             auto systemVariable = GD::systemVariableController->getInternal(keys.at(i));
-            if (!systemVariable || !_dummyClientInfo->acls->checkSystemVariableReadAccess(systemVariable)) continue;
+            if (!systemVariable || !GD::aclCache.checkSystemVariableReadAccess(_dummyClientInfo->acls, systemVariable)) continue;
           }
-        } else if (!peer || !_dummyClientInfo->acls->checkVariableReadAccess(peer, channel, keys.at(i))) continue;
+        } else if (!peer || !GD::aclCache.checkVariableReadAccess(_dummyClientInfo->acls, peer, channel, keys.at(i))) continue;
       }
 
       bool retain = keys.at(i).compare(0, 5, "PRESS") != 0;
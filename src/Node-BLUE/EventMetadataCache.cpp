@@ -0,0 +1,157 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "EventMetadataCache.h"
+#include "../GD/GD.h"
+
+namespace Homegear::NodeBlue {
+
+EventMetadataCache::EventMetadataCache() : InvalidatingCache({
+    "setName",
+    // {{{ Rooms
+    "addChannelToRoom", "addDeviceToRoom", "addVariableToRoom", "deleteRoom", "removeChannelFromRoom", "removeDeviceFromRoom", "removeVariableFromRoom",
+    // }}}
+    // {{{ Categories
+    "addCategoryToChannel", "addCategoryToDevice", "addCategoryToVariable", "deleteCategory", "removeCategoryFromChannel", "removeCategoryFromDevice",
+    "removeCategoryFromVariable",
+    // }}}
+    // {{{ Roles
+    "addRoleToVariable", "aggregateRoles", "deleteRole", "removeRoleFromVariable", "updateRole"
+    // }}}
+}) {
+}
+
+BaseLib::PVariable EventMetadataCache::get(const std::shared_ptr<BaseLib::Systems::Peer> &peer, int32_t channel, const std::vector<std::string> &variables) {
+  try {
+    if (!peer) return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+
+    Rpc::VariableCacheKey key;
+    key.peerId = peer->getID();
+    key.channel = channel;
+    if (channel != -1 && !variables.empty()) key.variable = variables.front();
+
+    {
+      std::shared_lock<std::shared_timed_mutex> entriesGuard(_entriesMutex);
+      auto entry = _entries.find(key);
+      if (entry && entry->peer.lock() == peer) return entry->metadata;
+    }
+
+    uint64_t generation = _generation;
+    auto metadata = build(peer, channel, variables);
+
+    std::lock_guard<std::shared_timed_mutex> entriesGuard(_entriesMutex);
+    //Metadata is only stored when no invalidation happened while it was built.
+    if (generation == _generation) _entries.set(key, Entry{peer, metadata});
+    return metadata;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+}
+
+void EventMetadataCache::invalidate() {
+  try {
+    std::lock_guard<std::shared_timed_mutex> entriesGuard(_entriesMutex);
+    _generation++;
+    _entries.clear();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+BaseLib::PVariable EventMetadataCache::build(const std::shared_ptr<BaseLib::Systems::Peer> &peer, int32_t channel, const std::vector<std::string> &variables) {
+  auto metadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  metadata->structValue->emplace("name", std::make_shared<BaseLib::Variable>(peer->getName()));
+  metadata->structValue->emplace("room", std::make_shared<BaseLib::Variable>(peer->getRoom(-1)));
+
+  {
+    auto categories = peer->getCategories(-1);
+    auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    categoryArray->arrayValue->reserve(categories.size());
+    for (auto category : categories) {
+      categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
+    }
+    metadata->structValue->emplace("categories", categoryArray);
+  }
+
+  if (channel == -1) return metadata;
+
+  metadata->structValue->emplace("channelName", std::make_shared<BaseLib::Variable>(peer->getName(channel)));
+  metadata->structValue->emplace("channelRoom", std::make_shared<BaseLib::Variable>(peer->getRoom(channel)));
+
+  {
+    auto categories = peer->getCategories(channel);
+    auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    categoryArray->arrayValue->reserve(categories.size());
+    for (auto category : categories) {
+      categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
+    }
+    metadata->structValue->emplace("channelCategories", categoryArray);
+  }
+
+  auto variableMetadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  metadata->structValue->emplace("variableMetadata", variableMetadata);
+  if (variables.empty()) return metadata;
+
+  //"variableMetadata" always described the first variable of the event only.
+  auto &variable = variables.front();
+  variableMetadata->structValue->emplace("room", std::make_shared<BaseLib::Variable>(peer->getVariableRoom(channel, variable)));
+
+  {
+    auto categories = peer->getVariableCategories(channel, variable);
+    auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    categoryArray->arrayValue->reserve(categories.size());
+    for (auto category : categories) {
+      categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
+    }
+    variableMetadata->structValue->emplace("categories", categoryArray);
+  }
+
+  {
+    auto roles = peer->getVariableRoles(channel, variable);
+    auto rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    for (auto &role : roles) {
+      auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
+      roleStruct->structValue->emplace("direction", std::make_shared<BaseLib::Variable>((int32_t)role.second.direction));
+      if (role.second.invert) {
+        roleStruct->structValue->emplace("invert", std::make_shared<BaseLib::Variable>(role.second.invert));
+      }
+      rolesArray->arrayValue->emplace_back(std::move(roleStruct));
+    }
+    variableMetadata->structValue->emplace("roles", rolesArray);
+  }
+
+  return metadata;
+}
+
+}
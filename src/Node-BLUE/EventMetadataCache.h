@@ -0,0 +1,83 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_EVENTMETADATACACHE_H_
+#define HOMEGEAR_EVENTMETADATACACHE_H_
+
+#include "../RPC/VariableCache.h"
+
+#include <homegear-base/BaseLib.h>
+
+#include <shared_mutex>
+
+namespace Homegear::NodeBlue {
+
+/**
+ * Caches the metadata (names, rooms, categories and roles) sent to flows processes with every variable event.
+ *
+ * The metadata only depends on the peer, the channel and the first variable of the event, so it is built once and then
+ * shared by all events and flows processes. Returned objects must not be modified. Entries are discarded by
+ * invalidate(), which is called after RPC methods changing names or assignments (see rpcMethodInvoked()). Entries of
+ * deleted peers are not used for a new peer with the same ID.
+ */
+class EventMetadataCache : public Rpc::InvalidatingCache {
+ public:
+  EventMetadataCache();
+  ~EventMetadataCache() override = default;
+
+  BaseLib::PVariable get(const std::shared_ptr<BaseLib::Systems::Peer> &peer, int32_t channel, const std::vector<std::string> &variables);
+
+  /**
+   * Discards all cached metadata.
+   */
+  void invalidate() override;
+ private:
+  /**
+   * Maximum number of cached entries. When full, all entries are discarded.
+   */
+  static constexpr size_t kMaxEntries = 10000;
+
+  struct Entry {
+    std::weak_ptr<BaseLib::Systems::Peer> peer;
+    BaseLib::PVariable metadata;
+  };
+
+  std::shared_timed_mutex _entriesMutex;
+  Rpc::BoundedVariableCache<Entry> _entries{kMaxEntries};
+
+  EventMetadataCache(const EventMetadataCache &);
+  EventMetadataCache &operator=(const EventMetadataCache &);
+
+  static BaseLib::PVariable build(const std::shared_ptr<BaseLib::Systems::Peer> &peer, int32_t channel, const std::vector<std::string> &variables);
+};
+
+}
+
+#endif
@@ -848,10 +848,70 @@ void NodeBlueClient::frontendEventLog(const std::string &nodeId, const std::stri
   }
 }
 
+void NodeBlueClient::updatePeerEventSubscription(uint64_t peerId, int32_t channel, const std::string &variable) {
+  try {
+    if (_nodesStopped) return; //The server clears all subscriptions on reset.
+
+    //Updates are serialized and always send the current state, so concurrent changes can't arrive at the server out of order.
+    std::lock_guard<std::mutex> subscriptionUpdateGuard(_eventSubscriptionUpdateMutex);
+    bool subscribe = false;
+    {
+      std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
+      auto peerIterator = _peerSubscriptions.find(peerId);
+      if (peerIterator != _peerSubscriptions.end()) {
+        auto channelIterator = peerIterator->second.find(channel);
+        if (channelIterator != peerIterator->second.end()) {
+          auto variableIterator = channelIterator->second.find(variable);
+          subscribe = variableIterator != channelIterator->second.end() && !variableIterator->second.empty();
+        }
+      }
+    }
+
+    Flows::PArray parameters = std::make_shared<Flows::Array>();
+    parameters->reserve(3);
+    parameters->push_back(std::make_shared<Flows::Variable>(peerId));
+    parameters->push_back(std::make_shared<Flows::Variable>(channel));
+    parameters->push_back(std::make_shared<Flows::Variable>(variable));
+
+    Flows::PVariable result = invoke(subscribe ? "subscribePeerEvents" : "unsubscribePeerEvents", parameters, false);
+    if (result->errorStruct) _out.printError("Error updating peer event subscription: " + result->structValue->at("faultString")->stringValue);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void NodeBlueClient::updateHomegearEventsSubscription() {
+  try {
+    if (_nodesStopped) return;
+
+    std::lock_guard<std::mutex> subscriptionUpdateGuard(_eventSubscriptionUpdateMutex);
+    bool subscribe = false;
+    {
+      std::lock_guard<std::mutex> eventSubscriptionsGuard(_homegearEventSubscriptionsMutex);
+      subscribe = !_homegearEventSubscriptions.empty();
+    }
+
+    Flows::PArray parameters = std::make_shared<Flows::Array>();
+    parameters->push_back(std::make_shared<Flows::Variable>(subscribe));
+
+    Flows::PVariable result = invoke("setHomegearEventsSubscribed", parameters, false);
+    if (result->errorStruct) _out.printError("Error updating Homegear event subscription: " + result->structValue->at("faultString")->stringValue);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 void NodeBlueClient::subscribePeer(const std::string &nodeId, uint64_t peerId, int32_t channel, const std::string &variable) {
   try {
-    std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
-    _peerSubscriptions[peerId][channel][variable].insert(nodeId);
+    bool firstSubscriber = false;
+    {
+      std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
+      auto &nodeIds = _peerSubscriptions[peerId][channel][variable];
+      firstSubscriber = nodeIds.insert(nodeId).second && nodeIds.size() == 1;
+    }
+    if (firstSubscriber) updatePeerEventSubscription(peerId, channel, variable);
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -860,8 +920,13 @@ void NodeBlueClient::subscribePeer(const std::string &nodeId, uint64_t peerId, i
 
 void NodeBlueClient::unsubscribePeer(const std::string &nodeId, uint64_t peerId, int32_t channel, const std::string &variable) {
   try {
-    std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
-    _peerSubscriptions[peerId][channel][variable].erase(nodeId);
+    bool lastSubscriber = false;
+    {
+      std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
+      auto &nodeIds = _peerSubscriptions[peerId][channel][variable];
+      lastSubscriber = nodeIds.erase(nodeId) > 0 && nodeIds.empty();
+    }
+    if (lastSubscriber) updatePeerEventSubscription(peerId, channel, variable);
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -912,8 +977,12 @@ void NodeBlueClient::unsubscribeGlobal(const std::string &nodeId) {
 
 void NodeBlueClient::subscribeHomegearEvents(const std::string &nodeId) {
   try {
-    std::lock_guard<std::mutex> eventSubscriptionsGuard(_homegearEventSubscriptionsMutex);
-    _homegearEventSubscriptions.insert(nodeId);
+    bool firstSubscriber = false;
+    {
+      std::lock_guard<std::mutex> eventSubscriptionsGuard(_homegearEventSubscriptionsMutex);
+      firstSubscriber = _homegearEventSubscriptions.insert(nodeId).second && _homegearEventSubscriptions.size() == 1;
+    }
+    if (firstSubscriber) updateHomegearEventsSubscription();
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -922,8 +991,12 @@ void NodeBlueClient::subscribeHomegearEvents(const std::string &nodeId) {
 
 void NodeBlueClient::unsubscribeHomegearEvents(const std::string &nodeId) {
   try {
-    std::lock_guard<std::mutex> eventSubscriptionsGuard(_homegearEventSubscriptionsMutex);
-    _homegearEventSubscriptions.erase(nodeId);
+    bool lastSubscriber = false;
+    {
+      std::lock_guard<std::mutex> eventSubscriptionsGuard(_homegearEventSubscriptionsMutex);
+      lastSubscriber = _homegearEventSubscriptions.erase(nodeId) > 0 && _homegearEventSubscriptions.empty();
+    }
+    if (lastSubscriber) updateHomegearEventsSubscription();
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -1894,13 +1967,15 @@ Flows::PVariable NodeBlueClient::stopFlow(Flows::PArray &parameters) {
     std::lock_guard<std::mutex> flowsGuard(_flowsMutex);
     auto flowsIterator = _flows.find(parameters->at(0)->integerValue);
     if (flowsIterator == _flows.end()) return Flows::Variable::createError(-100, "Unknown flow.");
+    std::vector<std::tuple<uint64_t, int32_t, std::string>> unsubscribedVariables;
+    bool homegearEventsUnsubscribed = false;
     for (auto &node: flowsIterator->second->nodes) {
       {
         std::lock_guard<std::mutex> peerSubscriptionsGuard(_peerSubscriptionsMutex);
         for (auto &peerId: _peerSubscriptions) {
           for (auto &channel: peerId.second) {
             for (auto &variable: channel.second) {
-              variable.second.erase(node.first);
+              if (variable.second.erase(node.first) > 0 && variable.second.empty()) unsubscribedVariables.emplace_back(peerId.first, channel.first, variable.first);
             }
           }
         }
@@ -1917,11 +1992,15 @@ Flows::PVariable NodeBlueClient::stopFlow(Flows::PArray &parameters) {
       }
       {
         std::lock_guard<std::mutex> eventSubscriptionsGuard(_homegearEventSubscriptionsMutex);
-        _homegearEventSubscriptions.erase(node.first);
+        if (_homegearEventSubscriptions.erase(node.first) > 0 && _homegearEventSubscriptions.empty()) homegearEventsUnsubscribed = true;
       }
       _nodeManager->unloadNode(node.second->id);
     }
     _flows.erase(flowsIterator);
+    for (auto &unsubscribedVariable: unsubscribedVariables) {
+      updatePeerEventSubscription(std::get<0>(unsubscribedVariable), std::get<1>(unsubscribedVariable), std::get<2>(unsubscribedVariable));
+    }
+    if (homegearEventsUnsubscribed) updateHomegearEventsSubscription();
     return std::make_shared<Flows::Variable>();
   }
   catch (const std::exception &ex) {
@@ -170,6 +170,7 @@ class NodeBlueClient : public BaseLib::IQueue {
   std::unordered_map<uint64_t, std::unordered_map<int32_t, std::unordered_map<std::string, std::set<std::string>>>> _peerSubscriptions;
   std::mutex _homegearEventSubscriptionsMutex;
   std::unordered_set<std::string> _homegearEventSubscriptions;
+  std::mutex _eventSubscriptionUpdateMutex;
   std::mutex _statusEventSubscriptionsMutex;
   std::unordered_set<std::string> _statusEventSubscriptions;
   std::mutex _errorEventSubscriptionsMutex;
@@ -212,6 +213,15 @@ class NodeBlueClient : public BaseLib::IQueue {
 
   void frontendEventLog(const std::string &nodeId, const std::string &message);
 
+  /**
+   * Tells the server whether nodes of this process listen to a peer variable, so it only sends matching events.
+   * Called when the first node subscribes to or the last node unsubscribes from a variable. Must not be called
+   * while holding a subscription mutex; the current state is read under the lock and sent after releasing it.
+   */
+  void updatePeerEventSubscription(uint64_t peerId, int32_t channel, const std::string &variable);
+
+  void updateHomegearEventsSubscription();
+
   void subscribePeer(const std::string &nodeId, uint64_t peerId, int32_t channel, const std::string &variable);
 
   void unsubscribePeer(const std::string &nodeId, uint64_t peerId, int32_t channel, const std::string &variable);
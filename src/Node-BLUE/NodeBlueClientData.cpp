@@ -50,6 +50,54 @@ NodeBlueClientData::NodeBlueClientData(std::shared_ptr<BaseLib::FileDescriptor>
 NodeBlueClientData::~NodeBlueClientData() {
 }
 
+// {{{ Event subscriptions
+void NodeBlueClientData::subscribePeer(uint64_t peerId, int32_t channel, const std::string &variable) {
+  std::lock_guard<std::mutex> eventSubscriptionsGuard(_eventSubscriptionsMutex);
+  _peerSubscriptions[peerId][channel].emplace(variable);
+}
+
+void NodeBlueClientData::unsubscribePeer(uint64_t peerId, int32_t channel, const std::string &variable) {
+  std::lock_guard<std::mutex> eventSubscriptionsGuard(_eventSubscriptionsMutex);
+  auto peerIterator = _peerSubscriptions.find(peerId);
+  if (peerIterator == _peerSubscriptions.end()) return;
+  auto channelIterator = peerIterator->second.find(channel);
+  if (channelIterator == peerIterator->second.end()) return;
+  channelIterator->second.erase(variable);
+  if (channelIterator->second.empty()) {
+    peerIterator->second.erase(channelIterator);
+    if (peerIterator->second.empty()) _peerSubscriptions.erase(peerIterator);
+  }
+}
+
+void NodeBlueClientData::setHomegearEventsSubscribed(bool subscribed) {
+  _homegearEventsSubscribed = subscribed;
+}
+
+bool NodeBlueClientData::homegearEventsSubscribed() {
+  return _homegearEventsSubscribed;
+}
+
+bool NodeBlueClientData::eventSubscribed(uint64_t peerId, int32_t channel, const std::vector<std::string> &variables) {
+  if (_homegearEventsSubscribed) return true;
+
+  std::lock_guard<std::mutex> eventSubscriptionsGuard(_eventSubscriptionsMutex);
+  auto peerIterator = _peerSubscriptions.find(peerId);
+  if (peerIterator == _peerSubscriptions.end()) return false;
+  auto channelIterator = peerIterator->second.find(channel);
+  if (channelIterator == peerIterator->second.end()) return false;
+  for (auto &variable : variables) {
+    if (channelIterator->second.find(variable) != channelIterator->second.end()) return true;
+  }
+  return false;
+}
+
+void NodeBlueClientData::clearEventSubscriptions() {
+  std::lock_guard<std::mutex> eventSubscriptionsGuard(_eventSubscriptionsMutex);
+  _peerSubscriptions.clear();
+  _homegearEventsSubscribed = false;
+}
+// }}}
+
 }
 
 }
\ No newline at end of file
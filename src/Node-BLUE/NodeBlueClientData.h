@@ -57,6 +57,34 @@ class NodeBlueClientData {
   std::mutex rpcResponsesMutex;
   std::map<int32_t, PNodeBlueResponseServer> rpcResponses;
   std::condition_variable requestConditionVariable;
+
+  // {{{ Event subscriptions
+  /**
+   * Adds a peer variable at least one node of the flows process listens to.
+   */
+  void subscribePeer(uint64_t peerId, int32_t channel, const std::string &variable);
+
+  void unsubscribePeer(uint64_t peerId, int32_t channel, const std::string &variable);
+
+  /**
+   * Set when at least one node of the flows process listens to all Homegear events.
+   */
+  void setHomegearEventsSubscribed(bool subscribed);
+
+  bool homegearEventsSubscribed();
+
+  /**
+   * Returns true when the flows process needs a variable event of the given peer and channel, i. e. when it is
+   * subscribed to all Homegear events or to at least one of the variables.
+   */
+  bool eventSubscribed(uint64_t peerId, int32_t channel, const std::vector<std::string> &variables);
+
+  void clearEventSubscriptions();
+  // }}}
+ private:
+  std::mutex _eventSubscriptionsMutex;
+  std::unordered_map<uint64_t, std::unordered_map<int32_t, std::unordered_set<std::string>>> _peerSubscriptions;
+  std::atomic_bool _homegearEventsSubscribed{false};
 };
 
 typedef std::shared_ptr<NodeBlueClientData> PNodeBlueClientData;
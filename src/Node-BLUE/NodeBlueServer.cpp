@@ -38,6 +38,7 @@
 #include "../RPC/RpcMethods/MaintenanceRpcMethods.h"
 #include "FlowParser.h"
 #include "../RPC/RpcMethods/BuildingPartRpcMethods.h"
+#include "../RPC/RpcMethods/HistoryRpcMethods.h"
 
 #include <homegear-base/BaseLib.h>
 #include <homegear-base/Managers/ProcessManager.h>
@@ -331,6 +332,11 @@ NodeBlueServer::NodeBlueServer() : IQueue(GD::bl.get(), 3, 100000) {
     _rpcMethods.emplace("updateCategory", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUpdateCategory()));
   }
 
+  { // History
+    _rpcMethods.emplace("getVariableHistory", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new RpcMethods::RPCGetVariableHistory()));
+    _rpcMethods.emplace("getVariableHistoryAggregate", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new RpcMethods::RPCGetVariableHistoryAggregate()));
+  }
+
   { // System variables
     _rpcMethods.emplace("addRoleToSystemVariable",
                         std::static_pointer_cast<BaseLib::Rpc::RpcMethod>(std::make_shared<Rpc::RPCAddRoleToSystemVariable>()));
@@ -426,6 +432,8 @@ NodeBlueServer::NodeBlueServer() : IQueue(GD::bl.get(), 3, 100000) {
   { // Maintenance
     _rpcMethods.emplace("enableMaintenanceMode", std::make_shared<RpcMethods::RpcEnableMaintenanceMode>());
     _rpcMethods.emplace("disableMaintenanceMode", std::make_shared<RpcMethods::RpcDisableMaintenanceMode>());
+    _rpcMethods.emplace("startDatabaseBackup", std::make_shared<RpcMethods::RpcStartDatabaseBackup>());
+    _rpcMethods.emplace("getDatabaseBackupStatus", std::make_shared<RpcMethods::RpcGetDatabaseBackupStatus>());
   }
 
 #ifndef NO_SCRIPTENGINE
@@ -1889,6 +1897,7 @@ bool NodeBlueServer::sendReset() {
         std::lock_guard<std::mutex> processGuard(_processMutex);
         auto processIterator = _processes.find(client->pid);
         if (processIterator != _processes.end()) { processIterator->second->reset(); }
+        client->clearEventSubscriptions();
       }
     }
 
@@ -3112,12 +3121,7 @@ void NodeBlueServer::broadcastEvent(std::string &source,
     std::shared_ptr<BaseLib::Systems::Peer> peer;
 
     if (id != 0 && id != 0x50000001) {
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (auto &family : families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) { peer = central->getPeer(id); }
-        if (peer) { break; }
-      }
+      peer = GD::familyController->getPeer(id);
       if (!peer) { return; }
     }
 
@@ -3130,7 +3134,7 @@ void NodeBlueServer::broadcastEvent(std::string &source,
         if (id == 0) {
           if (_nodeBlueClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesReadSet()) {
             auto systemVariable = GD::systemVariableController->getInternal(variables->at(i));
-            if (systemVariable && _nodeBlueClientInfo->acls->checkSystemVariableReadAccess(systemVariable)) {
+            if (systemVariable && GD::aclCache.checkSystemVariableReadAccess(_nodeBlueClientInfo->acls, systemVariable)) {
               newVariables->push_back(variables->at(i));
               newValues->push_back(values->at(i));
             }
@@ -3142,7 +3146,7 @@ void NodeBlueServer::broadcastEvent(std::string &source,
               newValues->push_back(values->at(i));
             }
           }
-        } else if (peer && _nodeBlueClientInfo->acls->checkVariableReadAccess(peer, channel, variables->at(i))) {
+        } else if (peer && GD::aclCache.checkVariableReadAccess(_nodeBlueClientInfo->acls, peer, channel, variables->at(i))) {
           newVariables->push_back(variables->at(i));
           newValues->push_back(values->at(i));
         }
@@ -3161,113 +3165,27 @@ void NodeBlueServer::broadcastEvent(std::string &source,
       }
     }
 
+    BaseLib::PArray parameters;
     for (auto &client : clients) {
-      auto metadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-      if (peer) {
-        metadata->structValue->emplace("name", std::make_shared<BaseLib::Variable>(peer->getName()));
-        metadata->structValue->emplace("room", std::make_shared<BaseLib::Variable>(peer->getRoom(-1)));
-
-        {
-          auto categories = peer->getCategories(-1);
-          auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-          categoryArray->arrayValue->reserve(categories.size());
-          for (auto category : categories) {
-            categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
-          }
-          metadata->structValue->emplace("categories", categoryArray);
-        }
-
-        if (channel != -1) {
-          metadata->structValue->emplace("channelName", std::make_shared<BaseLib::Variable>(peer->getName(channel)));
-          metadata->structValue->emplace("channelRoom", std::make_shared<BaseLib::Variable>(peer->getRoom(channel)));
-
-          {
-            auto categories = peer->getCategories(channel);
-            auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-            categoryArray->arrayValue->reserve(categories.size());
-            for (auto category : categories) {
-              categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
-            }
-            metadata->structValue->emplace("channelCategories", categoryArray);
-          }
-
-          auto variableMetadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-          metadata->structValue->emplace("variableMetadata", variableMetadata);
-
-          for (auto &variable : *variables) {
-            auto room = peer->getVariableRoom(channel, variable);
-            variableMetadata->structValue->emplace("room", std::make_shared<BaseLib::Variable>(room));
-
-            {
-              auto categories = peer->getVariableCategories(channel, variable);
-              auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-              categoryArray->arrayValue->reserve(categories.size());
-              for (auto category : categories) {
-                categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
-              }
-              variableMetadata->structValue->emplace("categories", categoryArray);
-            }
-
-            {
-              auto roles = peer->getVariableRoles(channel, variable);
-              auto rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-              for (auto &role : roles) {
-                auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-                roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
-                roleStruct->structValue->emplace("direction",
-                                                 std::make_shared<BaseLib::Variable>((int32_t) role.second.direction));
-                if (role.second.invert) {
-                  roleStruct->structValue->emplace("invert",
-                                                   std::make_shared<BaseLib::Variable>(role.second.invert));
-                }
-                rolesArray->arrayValue->emplace_back(std::move(roleStruct));
-              }
-              variableMetadata->structValue->emplace("roles", rolesArray);
-            }
-          }
-        }
-      } else if (id == 0) {
-        //System variables
-        auto variableMetadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-        metadata->structValue->emplace("variableMetadata", variableMetadata);
+      if (!client->eventSubscribed(id, channel, *variables)) { continue; }
 
-        for (auto &variable : *variables) {
-          auto systemVariable = GD::systemVariableController->getInternal(variable);
-          if (!systemVariable) { continue; }
-
-          variableMetadata->structValue->emplace("room", std::make_shared<BaseLib::Variable>(systemVariable->room));
-
-          auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-          categoryArray->arrayValue->reserve(systemVariable->categories.size());
-          for (auto category : systemVariable->categories) {
-            categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
-          }
-          variableMetadata->structValue->emplace("categories", categoryArray);
+      if (!parameters) {
+        //The parameters are identical for all flows processes, so they are built once and shared.
+        BaseLib::PVariable metadata;
+        if (peer) { metadata = _eventMetadataCache.get(peer, channel, *variables); }
+        else if (id == 0) { metadata = getSystemVariableMetadata(*variables); }
+        else { metadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct); }
 
-          auto rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
-          for (auto &role : systemVariable->roles) {
-            auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
-            roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
-            roleStruct->structValue->emplace("direction",
-                                             std::make_shared<BaseLib::Variable>((int32_t) role.second.direction));
-            if (role.second.invert) {
-              roleStruct->structValue->emplace("invert",
-                                               std::make_shared<BaseLib::Variable>(role.second.invert));
-            }
-            rolesArray->arrayValue->emplace_back(std::move(roleStruct));
-          }
-          variableMetadata->structValue->emplace("roles", rolesArray);
-        }
+        parameters = std::make_shared<BaseLib::Array>();
+        parameters->reserve(6);
+        parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
+        parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
+        parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
+        parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
+        parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
+        parameters->emplace_back(metadata);
       }
 
-      auto parameters = std::make_shared<BaseLib::Array>();
-      parameters->reserve(6);
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
-      parameters->emplace_back(metadata);
       std::shared_ptr<BaseLib::IQueueEntry>
           queueEntry = std::make_shared<QueueEntry>(client, "broadcastEvent", parameters);
       if (!enqueue(2, queueEntry)) {
@@ -3284,6 +3202,46 @@ void NodeBlueServer::broadcastEvent(std::string &source,
   }
 }
 
+BaseLib::PVariable NodeBlueServer::getSystemVariableMetadata(const std::vector<std::string> &variables) {
+  auto metadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  try {
+    auto variableMetadata = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    metadata->structValue->emplace("variableMetadata", variableMetadata);
+
+    for (auto &variable : variables) {
+      auto systemVariable = GD::systemVariableController->getInternal(variable);
+      if (!systemVariable) { continue; }
+
+      variableMetadata->structValue->emplace("room", std::make_shared<BaseLib::Variable>(systemVariable->room));
+
+      auto categoryArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+      categoryArray->arrayValue->reserve(systemVariable->categories.size());
+      for (auto category : systemVariable->categories) {
+        categoryArray->arrayValue->emplace_back(std::make_shared<BaseLib::Variable>(category));
+      }
+      variableMetadata->structValue->emplace("categories", categoryArray);
+
+      auto rolesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+      for (auto &role : systemVariable->roles) {
+        auto roleStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        roleStruct->structValue->emplace("id", std::make_shared<BaseLib::Variable>(role.second.id));
+        roleStruct->structValue->emplace("direction",
+                                         std::make_shared<BaseLib::Variable>((int32_t) role.second.direction));
+        if (role.second.invert) {
+          roleStruct->structValue->emplace("invert",
+                                           std::make_shared<BaseLib::Variable>(role.second.invert));
+        }
+        rolesArray->arrayValue->emplace_back(std::move(roleStruct));
+      }
+      variableMetadata->structValue->emplace("roles", rolesArray);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return metadata;
+}
+
 void NodeBlueServer::broadcastFlowVariableEvent(std::string &flowId, std::string &variable, BaseLib::PVariable &value) {
   try {
     if (_shuttingDown || _flowsRestarting) { return; }
@@ -3366,16 +3324,12 @@ void NodeBlueServer::broadcastServiceMessage(const BaseLib::PServiceMessage &ser
     std::shared_ptr<BaseLib::Systems::Peer> peer;
 
     if (serviceMessage->peerId > 0) {
-      auto families = GD::familyController->getFamilies();
-      for (auto &family : families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) { peer = central->getPeer(serviceMessage->peerId); }
-        if (peer) { break; }
-      }
+      peer = GD::familyController->getPeer(serviceMessage->peerId);
       if (!peer) { return; }
     }
 
-    if (checkAcls && peer && !serviceMessage->variable.empty() && !_nodeBlueClientInfo->acls->checkVariableReadAccess(
+    if (checkAcls && peer && !serviceMessage->variable.empty() && !GD::aclCache.checkVariableReadAccess(
+        _nodeBlueClientInfo->acls,
         peer,
         serviceMessage->channel,
         serviceMessage->variable)) {
@@ -3387,7 +3341,7 @@ void NodeBlueServer::broadcastServiceMessage(const BaseLib::PServiceMessage &ser
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3506,7 +3460,7 @@ void NodeBlueServer::broadcastNewDevices(const std::vector<uint64_t> &ids,
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3537,7 +3491,7 @@ void NodeBlueServer::broadcastDeleteDevices(const BaseLib::PVariable &deviceInfo
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3566,13 +3520,8 @@ void NodeBlueServer::broadcastUpdateDevice(uint64_t id, int32_t channel, int32_t
 
     if (!_nodeBlueClientInfo->acls->checkEventServerMethodAccess("updateDevice")) { return; }
     if (_nodeBlueClientInfo->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet()) {
-      std::shared_ptr<BaseLib::Systems::Peer> peer;
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (auto &family : families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) { peer = central->getPeer(id); }
-        if (!peer || !_nodeBlueClientInfo->acls->checkDeviceReadAccess(peer)) { return; }
-      }
+      auto peer = GD::familyController->getPeer(id);
+      if (!peer || !_nodeBlueClientInfo->acls->checkDeviceReadAccess(peer)) { return; }
     }
 
     std::vector<PNodeBlueClientData> clients;
@@ -3580,7 +3529,7 @@ void NodeBlueServer::broadcastUpdateDevice(uint64_t id, int32_t channel, int32_t
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3691,7 +3640,7 @@ void NodeBlueServer::broadcastVariableProfileStateChanged(uint64_t profileId, bo
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3726,7 +3675,7 @@ void NodeBlueServer::broadcastUiNotificationCreated(uint64_t uiNotificationId) {
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3759,7 +3708,7 @@ void NodeBlueServer::broadcastUiNotificationRemoved(uint64_t uiNotificationId) {
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3794,7 +3743,7 @@ void NodeBlueServer::broadcastUiNotificationAction(uint64_t uiNotificationId,
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3832,7 +3781,7 @@ void NodeBlueServer::broadcastRawPacketEvent(int32_t familyId,
       std::lock_guard<std::mutex> stateGuard(_stateMutex);
       clients.reserve(_clients.size());
       for (auto &client : _clients) {
-        if (client.second->closed) { continue; }
+        if (client.second->closed || !client.second->homegearEventsSubscribed()) { continue; }
         clients.push_back(client.second);
       }
     }
@@ -3962,6 +3911,8 @@ void NodeBlueServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::I
 
       BaseLib::PVariable result = _rpcMethods.at(queueEntry->methodName)->invoke(_nodeBlueClientInfo,
                                                                                  queueEntry->parameters->at(3)->arrayValue);
+      GD::aclCache.rpcMethodInvoked(queueEntry->methodName);
+      rpcMethodInvoked(queueEntry->methodName);
       if (GD::bl->debugLevel >= 5) {
         _out.printDebug("Response: ");
         result->print(true, false);
@@ -4403,6 +4354,13 @@ void NodeBlueServer::readClient(PNodeBlueClientData &clientData) {
             if (methodName == "registerFlowsClient" && parameters->size() == 4) {
               BaseLib::PVariable result = registerFlowsClient(clientData, parameters->at(3)->arrayValue);
               sendResponse(clientData, parameters->at(0), parameters->at(1), result);
+            } else if ((methodName == "subscribePeerEvents" || methodName == "unsubscribePeerEvents" || methodName == "setHomegearEventsSubscribed") && parameters->size() == 4) {
+              //Subscription changes are not queued. The queue threads could reorder them and the flows process would miss events.
+              BaseLib::PVariable result;
+              if (methodName == "subscribePeerEvents") result = subscribePeerEvents(clientData, parameters->at(3)->arrayValue);
+              else if (methodName == "unsubscribePeerEvents") result = unsubscribePeerEvents(clientData, parameters->at(3)->arrayValue);
+              else result = setHomegearEventsSubscribed(clientData, parameters->at(3)->arrayValue);
+              if (parameters->at(2)->booleanValue) sendResponse(clientData, parameters->at(0), parameters->at(1), result);
             } else {
               std::shared_ptr<BaseLib::IQueueEntry>
                   queueEntry = std::make_shared<QueueEntry>(clientData, methodName, parameters);
@@ -4825,6 +4783,45 @@ BaseLib::PVariable NodeBlueServer::registerFlowsClient(PNodeBlueClientData &clie
   return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable NodeBlueServer::subscribePeerEvents(PNodeBlueClientData &clientData, BaseLib::PArray &parameters) {
+  try {
+    if (parameters->size() != 3) return BaseLib::Variable::createError(-1, "Method expects exactly three parameters.");
+
+    clientData->subscribePeer((uint64_t)parameters->at(0)->integerValue64, parameters->at(1)->integerValue, parameters->at(2)->stringValue);
+    return std::make_shared<BaseLib::Variable>();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable NodeBlueServer::unsubscribePeerEvents(PNodeBlueClientData &clientData, BaseLib::PArray &parameters) {
+  try {
+    if (parameters->size() != 3) return BaseLib::Variable::createError(-1, "Method expects exactly three parameters.");
+
+    clientData->unsubscribePeer((uint64_t)parameters->at(0)->integerValue64, parameters->at(1)->integerValue, parameters->at(2)->stringValue);
+    return std::make_shared<BaseLib::Variable>();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable NodeBlueServer::setHomegearEventsSubscribed(PNodeBlueClientData &clientData, BaseLib::PArray &parameters) {
+  try {
+    if (parameters->size() != 1) return BaseLib::Variable::createError(-1, "Method expects exactly one parameter.");
+
+    clientData->setHomegearEventsSubscribed(parameters->at(0)->booleanValue);
+    return std::make_shared<BaseLib::Variable>();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable NodeBlueServer::errorEvent(PNodeBlueClientData &clientData, BaseLib::PArray &parameters) {
   try {
     if (parameters->size() != 3) {
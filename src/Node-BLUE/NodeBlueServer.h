@@ -36,6 +36,7 @@
 #include "FlowInfoServer.h"
 #include "NodeManager.h"
 #include "NodeBlueCredentials.h"
+#include "EventMetadataCache.h"
 #include "Node-PINK/Nodepink.h"
 #include "Node-PINK/NodepinkWebsocket.h"
 
@@ -81,6 +82,11 @@ class NodeBlueServer : public BaseLib::IQueue {
 
   void broadcastEvent(std::string &source, uint64_t id, int32_t channel, std::shared_ptr<std::vector<std::string>> &variables, BaseLib::PArray &values);
 
+  /**
+   * Discards cached event metadata when the RPC method might have changed names, rooms, categories or roles.
+   */
+  void rpcMethodInvoked(const std::string &methodName) { _eventMetadataCache.rpcMethodInvoked(methodName); }
+
   void broadcastFlowVariableEvent(std::string &flowId, std::string &variable, BaseLib::PVariable &value);
 
   void broadcastGlobalVariableEvent(std::string &variable, BaseLib::PVariable &value);
@@ -213,6 +219,7 @@ class NodeBlueServer : public BaseLib::IQueue {
   int32_t _currentClientId = 0;
   int64_t _lastGarbageCollection = 0;
   std::shared_ptr<BaseLib::RpcClientInfo> _nodeBlueClientInfo;
+  EventMetadataCache _eventMetadataCache;
   std::map<std::string, std::shared_ptr<BaseLib::Rpc::RpcMethod>> _rpcMethods;
   std::map<std::string, std::function<BaseLib::PVariable(PNodeBlueClientData &clientData, BaseLib::PArray &parameters)>> _localRpcMethods;
   std::mutex _packetIdMutex;
@@ -305,9 +312,17 @@ class NodeBlueServer : public BaseLib::IQueue {
 
   static std::string getNodeBlueFormatFromVariableType(const BaseLib::PVariable &variable);
 
+  BaseLib::PVariable getSystemVariableMetadata(const std::vector<std::string> &variables);
+
   // {{{ RPC methods
   BaseLib::PVariable registerFlowsClient(PNodeBlueClientData &clientData, BaseLib::PArray &parameters);
 
+  BaseLib::PVariable subscribePeerEvents(PNodeBlueClientData &clientData, BaseLib::PArray &parameters);
+
+  BaseLib::PVariable unsubscribePeerEvents(PNodeBlueClientData &clientData, BaseLib::PArray &parameters);
+
+  BaseLib::PVariable setHomegearEventsSubscribed(PNodeBlueClientData &clientData, BaseLib::PArray &parameters);
+
   BaseLib::PVariable errorEvent(PNodeBlueClientData &clientData, BaseLib::PArray &parameters);
 
   BaseLib::PVariable executePhpNode(PNodeBlueClientData &clientData, BaseLib::PArray &parameters);
@@ -0,0 +1,161 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "AclCache.h"
+#include "../GD/GD.h"
+
+namespace Homegear::Rpc {
+
+AclCache::AclCache() : InvalidatingCache({
+    // {{{ Rooms
+    "addChannelToRoom", "addDeviceToRoom", "addSystemVariableToRoom", "addVariableToRoom", "deleteRoom", "removeChannelFromRoom", "removeDeviceFromRoom",
+    "removeSystemVariableFromRoom", "removeVariableFromRoom",
+    // }}}
+    // {{{ Building parts
+    "addChannelToBuildingPart", "addDeviceToBuildingPart", "addVariableToBuildingPart", "deleteBuildingPart", "removeChannelFromBuildingPart",
+    "removeDeviceFromBuildingPart", "removeVariableFromBuildingPart",
+    // }}}
+    // {{{ Categories
+    "addCategoryToChannel", "addCategoryToDevice", "addCategoryToSystemVariable", "addCategoryToVariable", "deleteCategory", "removeCategoryFromChannel",
+    "removeCategoryFromDevice", "removeCategoryFromSystemVariable", "removeCategoryFromVariable",
+    // }}}
+    // {{{ Roles
+    "addRoleToSystemVariable", "addRoleToVariable", "aggregateRoles", "deleteRole", "removeRoleFromSystemVariable", "removeRoleFromVariable", "updateRole",
+    // }}}
+    // {{{ Devices and system variables
+    "addDevice", "createDevice", "deleteDevice", "setId", "deleteSystemVariable"
+    // }}}
+}) {
+}
+
+bool AclCache::checkVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls> &acls, const std::shared_ptr<BaseLib::Systems::Peer> &peer, int32_t channel, const std::string &variable) {
+  try {
+    if (!acls || !peer) return false;
+
+    VariableCacheKey key;
+    key.peerId = peer->getID();
+    key.channel = channel;
+    key.variable = variable;
+    bool result = false;
+    if (get(acls, key, result)) return result;
+
+    uint64_t generation = _generation;
+    result = acls->checkVariableReadAccess(peer, channel, variable);
+    set(acls, key, result, generation);
+    return result;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+bool AclCache::checkSystemVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls> &acls, const BaseLib::Database::PSystemVariable &systemVariable) {
+  try {
+    if (!acls || !systemVariable) return false;
+
+    VariableCacheKey key;
+    key.variable = systemVariable->name;
+    bool result = false;
+    if (get(acls, key, result)) return result;
+
+    uint64_t generation = _generation;
+    result = acls->checkSystemVariableReadAccess(systemVariable);
+    set(acls, key, result, generation);
+    return result;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void AclCache::invalidate() {
+  try {
+    std::lock_guard<std::shared_timed_mutex> decisionsGuard(_decisionsMutex);
+    _validFrom = ++_generation;
+    _decisions.clear();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void AclCache::invalidate(const std::shared_ptr<BaseLib::Security::Acls> &acls) {
+  try {
+    if (!acls) return;
+    std::lock_guard<std::shared_timed_mutex> decisionsGuard(_decisionsMutex);
+    //The entry is kept (or created), so decisions for this ACL object which are being computed right now are not stored.
+    auto &decisions = _decisions[acls.get()];
+    decisions.acls = acls;
+    decisions.decisions.clear();
+    decisions.generation = ++_generation;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool AclCache::get(const std::shared_ptr<BaseLib::Security::Acls> &acls, const VariableCacheKey &key, bool &result) {
+  std::shared_lock<std::shared_timed_mutex> decisionsGuard(_decisionsMutex);
+  auto decisionsIterator = _decisions.find(acls.get());
+  if (decisionsIterator == _decisions.end() || decisionsIterator->second.acls.owner_before(acls) || acls.owner_before(decisionsIterator->second.acls)) return false;
+  auto decision = decisionsIterator->second.decisions.find(key);
+  if (!decision) return false;
+  result = *decision;
+  return true;
+}
+
+void AclCache::set(const std::shared_ptr<BaseLib::Security::Acls> &acls, const VariableCacheKey &key, bool result, uint64_t generation) {
+  std::lock_guard<std::shared_timed_mutex> decisionsGuard(_decisionsMutex);
+  //Assignments changed while the decision was computed.
+  if (generation < _validFrom) return;
+
+  auto decisionsIterator = _decisions.find(acls.get());
+  if (decisionsIterator == _decisions.end()) {
+    //Clients come and go, so remove the decisions of destroyed ACL objects whenever a new one is added.
+    for (auto i = _decisions.begin(); i != _decisions.end();) {
+      if (i->second.acls.expired()) i = _decisions.erase(i);
+      else ++i;
+    }
+    decisionsIterator = _decisions.emplace(acls.get(), Decisions()).first;
+  }
+
+  auto &decisions = decisionsIterator->second;
+  if (decisions.acls.owner_before(acls) || acls.owner_before(decisions.acls)) {
+    //New entry or new ACL object at the address of a destroyed one.
+    decisions.acls = acls;
+    decisions.generation = generation;
+    decisions.decisions.clear();
+  } else if (generation < decisions.generation) return; //The ACL object was reloaded while the decision was computed.
+  decisions.decisions.set(key, result);
+}
+
+}
@@ -0,0 +1,111 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_ACLCACHE_H_
+#define HOMEGEAR_ACLCACHE_H_
+
+#include "VariableCache.h"
+
+#include <homegear-base/BaseLib.h>
+
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Homegear::Rpc {
+
+/**
+ * Remembers the results of variable read access checks for event filtering.
+ *
+ * Acls::checkVariableReadAccess() and Acls::checkSystemVariableReadAccess() evaluate the room, category, role, building
+ * part and device rules of a client for every variable. The results only change when the ACLs of the client or the
+ * assignments of peers, channels, variables and system variables change, so they are cached per ACL object, peer ID,
+ * channel and variable. All decisions are discarded by invalidate(), which is called after RPC methods changing these
+ * assignments (see rpcMethodInvoked()) and when devices are added or removed. Decisions of a single ACL object are
+ * discarded by invalidate(acls) when the ACL object is reloaded.
+ */
+class AclCache : public InvalidatingCache {
+ public:
+  AclCache();
+  ~AclCache() override = default;
+
+  bool checkVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls> &acls, const std::shared_ptr<BaseLib::Systems::Peer> &peer, int32_t channel, const std::string &variable);
+
+  bool checkSystemVariableReadAccess(const std::shared_ptr<BaseLib::Security::Acls> &acls, const BaseLib::Database::PSystemVariable &systemVariable);
+
+  /**
+   * Discards all cached decisions.
+   */
+  void invalidate() override;
+
+  /**
+   * Discards the cached decisions of one ACL object. Needs to be called after the ACL object was reloaded (e. g. by
+   * Acls::fromUser()).
+   */
+  void invalidate(const std::shared_ptr<BaseLib::Security::Acls> &acls);
+ private:
+  /**
+   * Maximum number of decisions cached per ACL object. When full, the decisions of the ACL object are discarded.
+   */
+  static constexpr size_t kMaxDecisions = 100000;
+
+  struct Decisions {
+    /**
+     * Used to detect a new ACL object allocated at the address of a destroyed one.
+     */
+    std::weak_ptr<BaseLib::Security::Acls> acls;
+    /**
+     * Generation at which the decisions were last discarded. Decisions computed before are not stored.
+     */
+    uint64_t generation = 0;
+    BoundedVariableCache<bool> decisions{kMaxDecisions};
+  };
+
+  /**
+   * Generation of the last call to invalidate(). Protected by "_decisionsMutex".
+   */
+  uint64_t _validFrom = 0;
+
+  std::shared_timed_mutex _decisionsMutex;
+  std::unordered_map<BaseLib::Security::Acls *, Decisions> _decisions;
+
+  AclCache(const AclCache &);
+  AclCache &operator=(const AclCache &);
+
+  /**
+   * Returns true and sets "result" when a valid decision is cached.
+   */
+  bool get(const std::shared_ptr<BaseLib::Security::Acls> &acls, const VariableCacheKey &key, bool &result);
+
+  void set(const std::shared_ptr<BaseLib::Security::Acls> &acls, const VariableCacheKey &key, bool result, uint64_t generation);
+};
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "AdaptiveReadBuffer.h"
+
+#include <algorithm>
+
+namespace Homegear::Rpc {
+
+AdaptiveReadBuffer::AdaptiveReadBuffer(size_t initialSize, size_t maxSize) {
+  _initialSize = std::max(initialSize, (size_t)16);
+  _maxSize = std::max(maxSize, _initialSize);
+  _size = _initialSize;
+  _buffer.resize(_size + 1);
+}
+
+void AdaptiveReadBuffer::update(size_t bytesRead) {
+  if (bytesRead >= _size) {
+    _lastFullRead = std::chrono::steady_clock::now();
+    if (_size == _maxSize) return;
+    _size = std::min(_size * 2, _maxSize);
+    //The content doesn't need to be preserved, so don't use resize().
+    _buffer = std::vector<char>(_size + 1);
+  } else if (_size > _initialSize && bytesRead < _size / 4
+      && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _lastFullRead).count() >= kShrinkAfterTime) {
+    shrink();
+  }
+}
+
+void AdaptiveReadBuffer::idle() {
+  if (_size > _initialSize) shrink();
+}
+
+void AdaptiveReadBuffer::shrink() {
+  _size = _initialSize;
+  _buffer = std::vector<char>(_size + 1);
+}
+
+}
@@ -0,0 +1,93 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_ADAPTIVEREADBUFFER_H_
+#define HOMEGEAR_ADAPTIVEREADBUFFER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Homegear::Rpc {
+
+/**
+ * Buffer for socket reads which grows while reads fill it completely, e.g. during the upload of large requests, and
+ * shrinks back to its initial size when the connection becomes idle or reads stay small for a while.
+ */
+class AdaptiveReadBuffer {
+ public:
+  /**
+   * @param initialSize The initial and minimum size in bytes.
+   * @param maxSize The maximum size in bytes.
+   */
+  AdaptiveReadBuffer(size_t initialSize, size_t maxSize);
+  virtual ~AdaptiveReadBuffer() = default;
+
+  /**
+   * Returns the buffer to read into. It has space for one byte more than size(), so the data can be null terminated.
+   */
+  char *data() { return _buffer.data(); }
+
+  /**
+   * The number of bytes to read at most.
+   */
+  size_t size() const { return _size; }
+
+  /**
+   * Adapts the size of the buffer to the number of bytes the last read returned. Call it after the data was processed,
+   * as the buffer might be reallocated.
+   */
+  void update(size_t bytesRead);
+
+  /**
+   * Shrinks the buffer to its initial size. Call it when no more data is available, e.g. on a read timeout or when
+   * the socket would block, so idle connections don't keep a large buffer.
+   */
+  void idle();
+ private:
+  /**
+   * Time in milliseconds since the last read filling the buffer after which a read filling less than a quarter of the
+   * buffer shrinks it to its initial size.
+   */
+  static constexpr int64_t kShrinkAfterTime = 1000;
+
+  size_t _initialSize = 0;
+  size_t _maxSize = 0;
+  size_t _size = 0;
+  std::chrono::steady_clock::time_point _lastFullRead;
+  std::vector<char> _buffer;
+
+  void shrink();
+};
+
+}
+
+#endif
@@ -117,7 +117,9 @@ bool Auth::basicServer(std::shared_ptr<C1Net::TcpSocket> &socket,
   }
   if (User::verify(credentials.first, credentials.second)) {
     userName = credentials.first;
-    if (!acls->fromUser(userName)) {
+    bool aclsLoaded = acls->fromUser(userName);
+    GD::aclCache.invalidate(acls);
+    if (!aclsLoaded) {
       _userName = "";
       throw AuthException("Could not set ACLs.");
     }
@@ -193,7 +195,9 @@ bool Auth::basicServer(std::shared_ptr<C1Net::TcpSocket> &socket,
   }
   if (User::verify(credentials.first, credentials.second)) {
     userName = credentials.first;
-    if (!acls->fromUser(userName)) {
+    bool aclsLoaded = acls->fromUser(userName);
+    GD::aclCache.invalidate(acls);
+    if (!aclsLoaded) {
       _userName = "";
       throw AuthException("Could not set ACLs.");
     }
@@ -245,7 +249,9 @@ bool Auth::basicServer(std::shared_ptr<C1Net::TcpSocket> &socket,
   }
   if (User::verify(websocketUser, websocketPassword)) {
     userName = websocketUser;
-    if (!acls->fromUser(websocketUser)) {
+    bool aclsLoaded = acls->fromUser(websocketUser);
+    GD::aclCache.invalidate(acls);
+    if (!aclsLoaded) {
       userName = "";
       throw AuthException("Could not set ACLs.");
     }
@@ -291,7 +297,9 @@ bool Auth::sessionServer(std::shared_ptr<C1Net::TcpSocket> &socket,
             "User's " + webSocketUser + " group is not in the list of valid groups in /etc/homegear/rpcservers.conf.");
       }
       userName = webSocketUser;
-      if (!acls->fromUser(userName)) {
+      bool aclsLoaded = acls->fromUser(userName);
+      GD::aclCache.invalidate(acls);
+      if (!aclsLoaded) {
         userName = "";
         throw AuthException("Could not set ACLs (user: " + userName + ")");
       }
@@ -362,7 +370,9 @@ bool Auth::certificateServer(C1Net::PTcpSocket &socket, std::string &userName, s
     }
   }
 
-  if (!acls->fromUser(userName)) {
+  bool aclsLoaded = acls->fromUser(userName);
+  GD::aclCache.invalidate(acls);
+  if (!aclsLoaded) {
     userName = "";
     error = "Error getting ACLs for client or the user doesn't exist. User (= common name or distinguished name): "
         + certUserName;
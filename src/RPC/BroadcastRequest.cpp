@@ -0,0 +1,128 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "BroadcastRequest.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace Homegear::Rpc {
+
+BroadcastRequest::BroadcastRequest(BaseLib::Rpc::RpcEncoder &encoder, const std::string &methodName, const BaseLib::Array &request) : _methodName(methodName) {
+  auto array = std::make_shared<BaseLib::Array>();
+  array->reserve(request.size() + 1);
+  array->emplace_back(std::make_shared<BaseLib::Variable>(kPacketIdPlaceholder));
+  array->insert(array->end(), request.begin(), request.end());
+  encoder.encodeRequest(methodName, array, _data);
+
+  //Binary RPC: "Bin", flags, packet length, method name length, method name, parameter count, type of the first
+  //parameter and its value. Integers are big endian. The flags are 0 for requests without header.
+  size_t typeOffset = 4 + 4 + 4 + methodName.size() + 4;
+  if (_data.size() < typeOffset + 4 || _data.at(0) != 'B' || _data.at(1) != 'i' || _data.at(2) != 'n' || _data.at(3) != 0) return;
+  uint32_t type = ((uint32_t)(uint8_t)_data.at(typeOffset) << 24) | ((uint32_t)(uint8_t)_data.at(typeOffset + 1) << 16) | ((uint32_t)(uint8_t)_data.at(typeOffset + 2) << 8) | (uint8_t)_data.at(typeOffset + 3);
+  size_t size = 0;
+  if (type == (uint32_t)BaseLib::VariableType::tInteger) size = 4;
+  else if (type == (uint32_t)BaseLib::VariableType::tInteger64) size = 8;
+  else return;
+  if (_data.size() < typeOffset + 4 + size) return;
+
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value = (value << 8) | (uint8_t)_data.at(typeOffset + 4 + i);
+  }
+  if (value != (uint64_t)kPacketIdPlaceholder) return;
+
+  _packetIdOffset = typeOffset + 4;
+  _packetIdSize = size;
+}
+
+size_t BroadcastRequest::encodePacketId(int32_t packetId, char *buffer) const {
+  //Sign extended like the encoder does for 64 bit integers.
+  auto value = (uint64_t)(int64_t)packetId;
+  for (size_t i = 0; i < _packetIdSize; i++) {
+    buffer[_packetIdSize - 1 - i] = (char)(uint8_t)(value >> (i * 8));
+  }
+  return _packetIdSize;
+}
+
+bool BroadcastRequest::send(int32_t fileDescriptor, int32_t packetId) const {
+  char packetIdBuffer[8];
+  size_t packetIdEnd = _packetIdOffset + _packetIdSize;
+  iovec ioVectors[3];
+  ioVectors[0].iov_base = (void *)_data.data();
+  ioVectors[0].iov_len = _packetIdOffset;
+  ioVectors[1].iov_base = packetIdBuffer;
+  ioVectors[1].iov_len = encodePacketId(packetId, packetIdBuffer);
+  ioVectors[2].iov_base = (void *)(_data.data() + packetIdEnd);
+  ioVectors[2].iov_len = _data.size() - packetIdEnd;
+
+  msghdr message{};
+  message.msg_iov = ioVectors;
+  message.msg_iovlen = 3;
+  while (message.msg_iovlen > 0) {
+    auto sentBytes = sendmsg(fileDescriptor, &message, MSG_NOSIGNAL);
+    if (sentBytes <= 0) {
+      if (sentBytes == -1 && errno == EINTR) continue;
+      if (sentBytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        //Wait until the client can receive again instead of spinning while holding its send mutex. A client that doesn't
+        //read for kSendTimeout milliseconds is given up, so it can't stall the broadcast to all other clients.
+        pollfd pollInfo{};
+        pollInfo.fd = fileDescriptor;
+        pollInfo.events = POLLOUT;
+        int32_t pollResult = -1;
+        do {
+          pollResult = poll(&pollInfo, 1, kSendTimeout);
+        } while (pollResult == -1 && errno == EINTR);
+        if (pollResult <= 0 || (pollInfo.revents & (POLLERR | POLLHUP | POLLNVAL))) return false;
+        continue;
+      }
+      return false;
+    }
+    //Skip what was sent. Partial writes can end in any of the three parts.
+    while (message.msg_iovlen > 0 && (size_t)sentBytes >= message.msg_iov->iov_len) {
+      sentBytes -= message.msg_iov->iov_len;
+      message.msg_iov++;
+      message.msg_iovlen--;
+    }
+    if (message.msg_iovlen > 0) {
+      message.msg_iov->iov_base = (char *)message.msg_iov->iov_base + sentBytes;
+      message.msg_iov->iov_len -= sentBytes;
+    }
+  }
+  return true;
+}
+
+void BroadcastRequest::getData(int32_t packetId, std::vector<char> &data) const {
+  data = _data;
+  encodePacketId(packetId, data.data() + _packetIdOffset);
+}
+
+}
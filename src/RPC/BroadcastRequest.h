@@ -0,0 +1,104 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_BROADCASTREQUEST_H_
+#define HOMEGEAR_BROADCASTREQUEST_H_
+
+#include <homegear-base/BaseLib.h>
+
+namespace Homegear::Rpc {
+
+/**
+ * A binary RPC request which is encoded once and then sent to all clients of a broadcast.
+ *
+ * Requests to IPC and script engine clients start with the packet ID, which is the only part differing between clients.
+ * The request is encoded with a placeholder packet ID. The encoded request is shared by all clients and never modified;
+ * send() writes it around the packet ID of the client with a single gathering write.
+ */
+class BroadcastRequest {
+ public:
+  /**
+   * @param encoder The encoder of the server. Needs to encode requests without header.
+   * @param methodName The name of the RPC method.
+   * @param request The elements of the request following the packet ID.
+   */
+  BroadcastRequest(BaseLib::Rpc::RpcEncoder &encoder, const std::string &methodName, const BaseLib::Array &request);
+  virtual ~BroadcastRequest() = default;
+
+  /**
+   * False when the packet ID couldn't be located in the encoded request. The request needs to be encoded per client
+   * then.
+   */
+  bool isValid() const { return _packetIdSize != 0; }
+
+  const std::string &getMethodName() const { return _methodName; }
+
+  /**
+   * Sends the encoded request with the given packet ID without copying it. The caller needs to hold the send mutex of
+   * the client. Only call this when isValid() returns true.
+   *
+   * @return Returns false when the request couldn't be sent or the client didn't accept data for kSendTimeout milliseconds.
+   */
+  bool send(int32_t fileDescriptor, int32_t packetId) const;
+
+  /**
+   * Fills "data" with the encoded request for the given packet ID. This copies the request, so only use it when the
+   * data is needed as a whole (e. g. for the IPC logger). Only call this when isValid() returns true.
+   */
+  void getData(int32_t packetId, std::vector<char> &data) const;
+ private:
+  static constexpr int32_t kPacketIdPlaceholder = 0x7E3A5C19;
+  /**
+   * Time in milliseconds to wait for a client to accept more data.
+   */
+  static constexpr int32_t kSendTimeout = 5000;
+
+  /**
+   * Writes the packet ID into "buffer" like the encoder does and returns the number of bytes written.
+   */
+  size_t encodePacketId(int32_t packetId, char *buffer) const;
+
+  std::string _methodName;
+  std::vector<char> _data;
+  size_t _packetIdOffset = 0;
+  /**
+   * 4 for 32 bit and 8 for 64 bit integers. "0" when the request is invalid.
+   */
+  size_t _packetIdSize = 0;
+
+  BroadcastRequest(const BroadcastRequest &);
+  BroadcastRequest &operator=(const BroadcastRequest &);
+};
+
+typedef std::shared_ptr<const BroadcastRequest> PBroadcastRequest;
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "ChunkedJsonResultStream.h"
+#include "../GD/GD.h"
+
+#include <sstream>
+
+namespace Homegear::Rpc {
+
+ChunkedJsonResultStream::ChunkedJsonResultStream(std::shared_ptr<C1Net::TcpSocket> socket, BaseLib::VariableType resultType, int32_t messageId, bool closeConnection, size_t chunkSize)
+    : _socket(std::move(socket)), _jsonEncoder(GD::bl.get()), _resultType(resultType), _messageId(messageId), _closeConnection(closeConnection), _chunkSize(chunkSize) {
+  _buffer.reserve(_chunkSize + 1024);
+  std::string prefix = "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(_messageId) + ",\"result\":";
+  _buffer.insert(_buffer.end(), prefix.begin(), prefix.end());
+  _buffer.push_back(_resultType == BaseLib::VariableType::tStruct ? '{' : '[');
+}
+
+bool ChunkedJsonResultStream::appendElement(const BaseLib::PVariable &element) {
+  auto container = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+  container->arrayValue->push_back(element);
+  return append(container);
+}
+
+bool ChunkedJsonResultStream::appendMember(const std::string &name, const BaseLib::PVariable &value) {
+  auto container = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  container->structValue->emplace(name, value);
+  return append(container);
+}
+
+bool ChunkedJsonResultStream::append(const BaseLib::PVariable &container) {
+  try {
+    if (_error) return false;
+    _encoded.clear();
+    _jsonEncoder.encode(container, _encoded);
+    auto begin = _encoded.find_first_of("[{");
+    auto end = _encoded.find_last_of("]}");
+    if (begin == std::string::npos || end == std::string::npos || end <= begin + 1) return true;
+
+    if (!_empty) _buffer.push_back(',');
+    _empty = false;
+    _buffer.insert(_buffer.end(), _encoded.begin() + begin + 1, _encoded.begin() + end);
+    if (_buffer.size() >= _chunkSize) return sendChunk(false);
+    return true;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  _error = true;
+  return false;
+}
+
+bool ChunkedJsonResultStream::finish() {
+  if (_error) return false;
+  _buffer.push_back(_resultType == BaseLib::VariableType::tStruct ? '}' : ']');
+  _buffer.push_back('}');
+  return sendChunk(true);
+}
+
+bool ChunkedJsonResultStream::sendChunk(bool last) {
+  try {
+    _packet.clear();
+    if (!_started) {
+      std::string header = "HTTP/1.1 200 OK\r\nConnection: ";
+      header.append(_closeConnection ? "close\r\n" : "Keep-Alive\r\n");
+      header.append("Content-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n");
+      _packet.insert(_packet.end(), header.begin(), header.end());
+      _started = true;
+    }
+    if (!_buffer.empty()) {
+      std::ostringstream chunkSizeStream;
+      chunkSizeStream << std::hex << _buffer.size() << "\r\n";
+      std::string chunkHeader = chunkSizeStream.str();
+      _packet.insert(_packet.end(), chunkHeader.begin(), chunkHeader.end());
+      _packet.insert(_packet.end(), _buffer.begin(), _buffer.end());
+      _packet.push_back('\r');
+      _packet.push_back('\n');
+      _buffer.clear();
+    }
+    if (last) {
+      _packet.push_back('0');
+      _packet.insert(_packet.end(), {'\r', '\n', '\r', '\n'});
+    }
+    _socket->Send((uint8_t *)_packet.data(), _packet.size());
+    return true;
+  }
+  catch (const C1Net::Exception &ex) {
+    GD::out.printInfo(std::string("Info: Could not send result: ") + ex.what());
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  _error = true;
+  return false;
+}
+
+}
@@ -0,0 +1,93 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_CHUNKEDJSONRESULTSTREAM_H_
+#define HOMEGEAR_CHUNKEDJSONRESULTSTREAM_H_
+
+#include "ResultStream.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Homegear::Rpc {
+
+/**
+ * Writes a JSON-RPC response to an HTTP client using chunked transfer encoding. Every element is encoded as soon as it
+ * is appended and the encoded data is sent whenever "chunkSize" bytes are buffered, so memory usage does not depend on
+ * the size of the result.
+ */
+class ChunkedJsonResultStream : public ResultStream {
+ public:
+  ChunkedJsonResultStream(std::shared_ptr<C1Net::TcpSocket> socket, BaseLib::VariableType resultType, int32_t messageId, bool closeConnection, size_t chunkSize);
+
+  bool appendElement(const BaseLib::PVariable &element) override;
+
+  bool appendMember(const std::string &name, const BaseLib::PVariable &value) override;
+
+  /**
+   * Returns true when data was sent to the client already. An error response is not possible anymore then.
+   */
+  bool started() const { return _started; }
+
+  /**
+   * Completes the response and sends the remaining data.
+   *
+   * @return Returns false when sending failed.
+   */
+  bool finish();
+ private:
+  std::shared_ptr<C1Net::TcpSocket> _socket;
+  BaseLib::Rpc::JsonEncoder _jsonEncoder;
+  BaseLib::VariableType _resultType;
+  int32_t _messageId = 0;
+  bool _closeConnection = false;
+  size_t _chunkSize = 65536;
+  bool _started = false;
+  bool _error = false;
+  bool _empty = true;
+
+  /**
+   * The data of the current chunk.
+   */
+  std::vector<char> _buffer;
+  std::vector<char> _packet;
+  std::string _encoded;
+
+  /**
+   * Encodes "container", which contains the value to append as its only element, and appends it to the buffer
+   * without the enclosing brackets.
+   */
+  bool append(const BaseLib::PVariable &container);
+
+  bool sendChunk(bool last);
+};
+
+}
+
+#endif
@@ -228,6 +228,9 @@ void Client::broadcastEvent(const std::string &source,
 
     if (GD::mqtt->enabled()) GD::mqtt->queueMessage(source, id, channel, *valueKeys, *values); //ACL check is in MQTT
     std::string methodName("event");
+    //The peer is only needed for ACL checks, so it is resolved on first use and then shared by all servers.
+    std::shared_ptr<BaseLib::Systems::Peer> peer;
+    bool peerResolved = false;
     std::lock_guard<std::mutex> serversGuard(_serversMutex);
     for (auto &server: _servers) {
       if (server.second->removed ||
@@ -244,15 +247,9 @@ void Client::broadcastEvent(const std::string &source,
         continue;
 
       bool checkAcls = server.second->getServerClientInfo()->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet();
-      std::shared_ptr<BaseLib::Systems::Peer> peer;
-      if (checkAcls) {
-        std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>
-            families = GD::familyController->getFamilies();
-        for (auto &family: families) {
-          std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-          if (central) peer = central->getPeer(id);
-          if (peer) break;
-        }
+      if (checkAcls && !peerResolved) {
+        peer = GD::familyController->getPeer(id);
+        peerResolved = true;
       }
 
       if (server.second->webSocket || server.second->json) {
@@ -262,16 +259,17 @@ void Client::broadcastEvent(const std::string &source,
             if (id == 0) {
               if (server.second->getServerClientInfo()->acls->variablesBuildingPartsRoomsCategoriesRolesReadSet()) {
                 auto systemVariable = GD::systemVariableController->getInternal(valueKeys->at(i));
-                if (!systemVariable || !server.second->getServerClientInfo()->acls->checkSystemVariableReadAccess(systemVariable))
+                if (!systemVariable || !GD::aclCache.checkSystemVariableReadAccess(server.second->getServerClientInfo()->acls, systemVariable))
                   continue;
               }
             } else if (id == 0x50000000 || id == 0x50000001) {
               if (server.second->getServerClientInfo()->acls->variablesReadSet() && !server.second->getServerClientInfo()->acls->checkNodeBlueVariableReadAccess(valueKeys->at(i), channel)) {
                 continue;
               }
-            } else if (!peer || !server.second->getServerClientInfo()->acls->checkVariableReadAccess(peer,
-                                                                                                     channel,
-                                                                                                     valueKeys->at(i)))
+            } else if (!peer || !GD::aclCache.checkVariableReadAccess(server.second->getServerClientInfo()->acls,
+                                                                      peer,
+                                                                      channel,
+                                                                      valueKeys->at(i)))
               continue;
           }
 
@@ -294,14 +292,14 @@ void Client::broadcastEvent(const std::string &source,
             if (id == 0) {
               if (server.second->getServerClientInfo()->acls->variablesBuildingPartsRoomsCategoriesRolesReadSet()) {
                 auto systemVariable = GD::systemVariableController->getInternal(valueKeys->at(i));
-                if (!systemVariable || !server.second->getServerClientInfo()->acls->checkSystemVariableReadAccess(systemVariable))
+                if (!systemVariable || !GD::aclCache.checkSystemVariableReadAccess(server.second->getServerClientInfo()->acls, systemVariable))
                   continue;
               }
             } else if (id == 0x50000000 || id == 0x50000001) {
               if (server.second->getServerClientInfo()->acls->variablesReadSet() && !server.second->getServerClientInfo()->acls->checkNodeBlueVariableReadAccess(valueKeys->at(i), channel)) {
                 continue;
               }
-            } else if (!peer || !server.second->getServerClientInfo()->acls->checkVariableReadAccess(peer, channel, valueKeys->at(i)))
+            } else if (!peer || !GD::aclCache.checkVariableReadAccess(server.second->getServerClientInfo()->acls, peer, channel, valueKeys->at(i)))
               continue;
           }
 
@@ -724,6 +722,8 @@ void Client::broadcastUpdateDevice(uint64_t id, int32_t channel, std::string add
 #endif
     GD::ipcServer->broadcastUpdateDevice(id, channel, hint);
 
+    std::shared_ptr<BaseLib::Systems::Peer> peer;
+    bool peerResolved = false;
     std::lock_guard<std::mutex> serversGuard(_serversMutex);
     for (std::map<int32_t, std::shared_ptr<RemoteRpcServer>>::const_iterator server = _servers.begin();
          server != _servers.end(); ++server) {
@@ -737,14 +737,9 @@ void Client::broadcastUpdateDevice(uint64_t id, int32_t channel, std::string add
         continue;
 
       if (server->second->getServerClientInfo()->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet()) {
-        std::shared_ptr<BaseLib::Systems::Peer> peer;
-        std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>
-            families = GD::familyController->getFamilies();
-        for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin();
-             i != families.end(); ++i) {
-          std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
-          if (central) peer = central->getPeer(id);
-          if (peer) break;
+        if (!peerResolved) {
+          peer = GD::familyController->getPeer(id);
+          peerResolved = true;
         }
 
         if (checkAcls && (!peer || !server->second->getServerClientInfo()->acls->checkDeviceReadAccess(peer))) continue;
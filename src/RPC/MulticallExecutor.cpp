@@ -0,0 +1,191 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "MulticallExecutor.h"
+#include "../GD/GD.h"
+
+#include <unordered_set>
+
+namespace Homegear::Rpc {
+
+MulticallExecutor::MulticallExecutor() : IQueue(GD::bl.get(), 1, 10000) {
+}
+
+MulticallExecutor::~MulticallExecutor() {
+  stop();
+}
+
+MulticallExecutor::QueueEntry::~QueueEntry() {
+  if (executed) return;
+  std::lock_guard<std::mutex> batchGuard(batch->mutex);
+  batch->dropped.push_back(&call);
+  batch->remaining--;
+  batch->conditionVariable.notify_one();
+}
+
+void MulticallExecutor::start() {
+  try {
+    if (_started || !GD::tuningSettings.rpcMulticallParallel()) return;
+    startQueue(0, true, GD::tuningSettings.rpcMulticallThreads(), 0, SCHED_OTHER);
+    _started = true;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MulticallExecutor::stop() {
+  try {
+    if (!_started) return;
+    _started = false;
+    stopQueue(0);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool MulticallExecutor::isReadOnly(const std::string &methodName) {
+  //Only add methods which neither change data nor the client info. The calls of a multicall share one client info.
+  static const std::unordered_set<std::string> readOnlyMethods{
+      // {{{ Devices and variables
+      "getAllConfig", "getAllMetadata", "getAllValues", "getConfigParameter", "getDeviceDescription", "getDeviceInfo", "getInstallMode",
+      "getKeyMismatchDevice", "getLastEvents", "getLinkInfo", "getLinkPeers", "getLinks", "getMetadata", "getName", "getPairingInfo", "getParamset",
+      "getParamsetDescription", "getParamsetId", "getPeerId", "getServiceMessages", "getSniffedDevices", "getValue", "getVariableDescription",
+      "listFamilies", "listInterfaces", "listKnownDeviceTypes", "listTeams",
+      // }}}
+      // {{{ System variables and data
+      "getAllSystemVariables", "getData", "getSystemVariable", "getSystemVariableFlags", "getUserData", "getUserMetadata",
+      // }}}
+      // {{{ Buildings, rooms, categories and roles
+      "getBuildingMetadata", "getBuildingPartMetadata", "getBuildingParts", "getBuildingPartsInBuilding", "getBuildings", "getCategories",
+      "getCategoryMetadata", "getChannelsInBuildingPart", "getChannelsInCategory", "getChannelsInRoom", "getDevicesInBuildingPart", "getDevicesInCategory",
+      "getDevicesInRoom", "getRoleMetadata", "getRoles", "getRolesInDevice", "getRolesInRoom", "getRoomMetadata", "getRooms", "getRoomsInStory",
+      "getStories", "getStoriesInBuilding", "getStoryMetadata", "getSystemVariablesInCategory", "getSystemVariablesInRole", "getSystemVariablesInRoom",
+      "getVariablesInBuildingPart", "getVariablesInCategory", "getVariablesInRole", "getVariablesInRoom",
+      // }}}
+      // {{{ UI, history and variable profiles
+      "getAllUiElements", "getAvailableUiElements", "getCategoryUiElements", "getRoomUiElements", "getUiElement", "getUiElementMetadata",
+      "getUiElementTemplate", "getUiElementsWithVariable", "getUiNotification", "getUiNotifications", "getVariableHistory",
+      "getVariableHistoryAggregate", "getAllVariableProfiles", "getVariableProfile",
+      // }}}
+      // {{{ System
+      "getInstanceId", "getUpdateStatus", "getVersion", "system.listMethods", "system.methodHelp", "system.methodSignature"
+      // }}}
+  };
+  return readOnlyMethods.find(methodName) != readOnlyMethods.end();
+}
+
+void MulticallExecutor::execute(const BaseLib::PRpcClientInfo &clientInfo, const std::vector<Call> &calls, BaseLib::Array &results) {
+  CallFunction callFunction = [&clientInfo](const Call &call) {
+    if (GD::rpcServers.empty()) return BaseLib::Variable::createError(-32500, "No RPC server available.");
+    auto parameters = call.parameters;
+    return GD::rpcServers.begin()->second->callMethod(clientInfo, call.methodName, parameters);
+  };
+  execute(calls, results, callFunction, ResultCallback());
+}
+
+void MulticallExecutor::execute(const std::vector<Call> &calls, BaseLib::Array &results, const CallFunction &callFunction, const ResultCallback &resultCallback) {
+  try {
+    size_t begin = 0;
+    for (size_t i = 0; i < calls.size(); i++) {
+      if (!calls[i].barrier) continue;
+      executeParallel(callFunction, resultCallback, calls, begin, i, results);
+      executeCall(callFunction, resultCallback, calls[i], results);
+      begin = i + 1;
+    }
+    executeParallel(callFunction, resultCallback, calls, begin, calls.size(), results);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MulticallExecutor::executeCall(const CallFunction &callFunction, const ResultCallback &resultCallback, const Call &call, BaseLib::Array &results) {
+  try {
+    results.at(call.index) = callFunction(call);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    results.at(call.index) = BaseLib::Variable::createError(-32500, "Unknown application error.");
+  }
+  if (!resultCallback) return;
+  try {
+    resultCallback(call, results.at(call.index));
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MulticallExecutor::executeParallel(const CallFunction &callFunction, const ResultCallback &resultCallback, const std::vector<Call> &calls, size_t begin, size_t end, BaseLib::Array &results) {
+  if (begin >= end) return;
+
+  auto batch = std::make_shared<Batch>();
+  batch->remaining = end - begin - 1;
+  for (size_t i = begin + 1; i < end; i++) {
+    auto queueEntry = std::make_shared<QueueEntry>(callFunction, resultCallback, calls[i], results, batch);
+    std::shared_ptr<BaseLib::IQueueEntry> entry = queueEntry;
+    if (!_started || !enqueue(0, entry)) {
+      //The executor is stopping.
+      queueEntry->executed = true;
+      executeCall(callFunction, resultCallback, calls[i], results);
+      std::lock_guard<std::mutex> batchGuard(batch->mutex);
+      batch->remaining--;
+    }
+  }
+
+  executeCall(callFunction, resultCallback, calls[begin], results);
+
+  std::vector<const Call *> dropped;
+  {
+    std::unique_lock<std::mutex> batchLock(batch->mutex);
+    batch->conditionVariable.wait(batchLock, [&] { return batch->remaining == 0; });
+    dropped.swap(batch->dropped);
+  }
+
+  //stop() discards queued entries.
+  for (auto call : dropped) {
+    executeCall(callFunction, resultCallback, *call, results);
+  }
+}
+
+void MulticallExecutor::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry> &entry) {
+  auto queueEntry = std::dynamic_pointer_cast<QueueEntry>(entry);
+  if (!queueEntry) return;
+  queueEntry->executed = true;
+  executeCall(queueEntry->callFunction, queueEntry->resultCallback, queueEntry->call, queueEntry->results);
+
+  std::lock_guard<std::mutex> batchGuard(queueEntry->batch->mutex);
+  queueEntry->batch->remaining--;
+  queueEntry->batch->conditionVariable.notify_one();
+}
+
+}
@@ -0,0 +1,147 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_MULTICALLEXECUTOR_H_
+#define HOMEGEAR_MULTICALLEXECUTOR_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace Homegear::Rpc {
+
+/**
+ * Executes the sub-calls of "system.multicall" on a bounded pool of worker threads.
+ *
+ * Consecutive read-only calls are independent and run in parallel. Write methods (see isReadOnly()) and calls marked as
+ * dependent are barriers: they are executed after all previous calls finished and before any following call starts.
+ * Disabled unless "rpcMulticallParallel" is set in tuning.conf.
+ */
+class MulticallExecutor : public BaseLib::IQueue {
+ public:
+  struct Call {
+    /**
+     * Position of the result in the returned array.
+     */
+    size_t index = 0;
+    std::string methodName;
+    BaseLib::PVariable parameters;
+    bool barrier = false;
+  };
+
+  /**
+   * Executes a call and returns its result.
+   */
+  typedef std::function<BaseLib::PVariable(const Call &call)> CallFunction;
+
+  /**
+   * Called with the result of every call as soon as the call is finished. Might be called by several threads at the
+   * same time.
+   */
+  typedef std::function<void(const Call &call, const BaseLib::PVariable &result)> ResultCallback;
+
+  MulticallExecutor();
+  ~MulticallExecutor() override;
+
+  void start();
+
+  void stop();
+
+  bool enabled() const { return _started; }
+
+  /**
+   * Executes the calls and stores the result of every call at its index in "results". Returns when all calls are
+   * finished.
+   */
+  void execute(const BaseLib::PRpcClientInfo &clientInfo, const std::vector<Call> &calls, BaseLib::Array &results);
+
+  /**
+   * Like execute() above, but calls "callFunction" to execute a call and "resultCallback" (if set) for every finished
+   * call.
+   */
+  void execute(const std::vector<Call> &calls, BaseLib::Array &results, const CallFunction &callFunction, const ResultCallback &resultCallback);
+
+  /**
+   * Returns true for methods which only read data and don't modify the client info shared by all calls of a multicall.
+   * This is an explicit list: not every method starting with "get" or "list" is safe (e. g. "listDevices" sets the
+   * client type).
+   */
+  static bool isReadOnly(const std::string &methodName);
+ private:
+  /**
+   * Calls executed in parallel. The thread calling execute() waits until "remaining" is 0 and then executes the calls in
+   * "dropped" itself.
+   */
+  struct Batch {
+    std::mutex mutex;
+    std::condition_variable conditionVariable;
+    size_t remaining = 0;
+    /**
+     * Calls that were queued, but discarded by stop() before a worker executed them.
+     */
+    std::vector<const Call *> dropped;
+  };
+
+  class QueueEntry : public BaseLib::IQueueEntry {
+   public:
+    QueueEntry(const CallFunction &callFunction, const ResultCallback &resultCallback, const Call &call, BaseLib::Array &results, const std::shared_ptr<Batch> &batch)
+        : callFunction(callFunction), resultCallback(resultCallback), call(call), results(results), batch(batch) {}
+
+    /**
+     * Hands the call back to the waiting thread when the entry is destroyed without being executed.
+     */
+    ~QueueEntry() override;
+
+    const CallFunction &callFunction;
+    const ResultCallback &resultCallback;
+    const Call &call;
+    BaseLib::Array &results;
+    std::shared_ptr<Batch> batch;
+    bool executed = false;
+  };
+
+  std::atomic_bool _started{false};
+
+  static void executeCall(const CallFunction &callFunction, const ResultCallback &resultCallback, const Call &call, BaseLib::Array &results);
+
+  /**
+   * Executes calls[begin] to calls[end - 1] in parallel. The calling thread executes the first call itself.
+   */
+  void executeParallel(const CallFunction &callFunction, const ResultCallback &resultCallback, const std::vector<Call> &calls, size_t begin, size_t end, BaseLib::Array &results);
+
+  void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry> &entry) override;
+};
+
+}
+
+#endif
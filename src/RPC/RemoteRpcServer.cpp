@@ -146,6 +146,9 @@ void RemoteRpcServer::processMethods() {
         if (_methodBufferHead == _methodBufferTail)
           _methodProcessingMessageAvailable =
               false; //Set here, because otherwise it might be set to "true" in publish and then set to false again after the while loop
+        if (GD::tuningSettings.eventServerCoalescing() && isEventMulticall(message)) {
+          message = coalesceEvents(message, lock);
+        }
         lock.unlock();
         if (!removed) {
           if (_serverClientInfo->sendEventsToRpcServer) {
@@ -163,6 +166,108 @@ void RemoteRpcServer::processMethods() {
   }
 }
 
+bool RemoteRpcServer::isEventMulticall(const std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> &method) {
+  if (!method || method->first != "system.multicall" || !method->second || method->second->size() != 1) return false;
+  auto &calls = method->second->front();
+  if (!calls || calls->type != BaseLib::VariableType::tArray) return false;
+  for (auto &call: *calls->arrayValue) {
+    if (call->type != BaseLib::VariableType::tStruct) return false;
+    auto methodNameIterator = call->structValue->find("methodName");
+    if (methodNameIterator == call->structValue->end() || methodNameIterator->second->stringValue != "event") return false;
+  }
+  return true;
+}
+
+std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> RemoteRpcServer::coalesceEvents(const std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> &method, std::unique_lock<std::mutex> &lock) {
+  try {
+    const uint32_t maxBatchSize = GD::tuningSettings.eventServerMaxBatchSize();
+    const uint32_t flushDelay = GD::tuningSettings.eventServerFlushDelay();
+    const int64_t flushTime = BaseLib::HelperFunctions::getTime() + flushDelay;
+
+    auto calls = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    auto &firstCalls = *method->second->front()->arrayValue;
+    calls->arrayValue->reserve(firstCalls.size());
+    calls->arrayValue->insert(calls->arrayValue->end(), firstCalls.begin(), firstCalls.end());
+    uint32_t mergedMethods = 1;
+
+    while (calls->arrayValue->size() < maxBatchSize && !_stopMethodProcessingThread) {
+      if (_methodBufferHead == _methodBufferTail) {
+        if (flushDelay == 0) break;
+        int64_t timeToWait = flushTime - BaseLib::HelperFunctions::getTime();
+        if (timeToWait <= 0) break;
+        _methodProcessingConditionVariable.wait_for(lock, std::chrono::milliseconds(timeToWait), [&] {
+          return _methodBufferHead != _methodBufferTail || _stopMethodProcessingThread;
+        });
+        continue;
+      }
+
+      auto &next = _methodBuffer[_methodBufferTail];
+      //Other methods are sent in order, so merging stops at the first one.
+      if (!isEventMulticall(next)) break;
+      auto &nextCalls = *next->second->front()->arrayValue;
+      if (calls->arrayValue->size() + nextCalls.size() > maxBatchSize) break;
+      calls->arrayValue->insert(calls->arrayValue->end(), nextCalls.begin(), nextCalls.end());
+      mergedMethods++;
+
+      next.reset();
+      _methodBufferTail++;
+      if (_methodBufferTail >= _methodBufferSize) _methodBufferTail = 0;
+      if (_methodBufferHead == _methodBufferTail) _methodProcessingMessageAvailable = false;
+    }
+
+    if (mergedMethods == 1) return method;
+    if (GD::tuningSettings.eventServerCollapseValues()) collapseEvents(calls->arrayValue);
+    if (GD::bl->debugLevel >= 5) {
+      GD::out.printDebug("Debug: Merged " + std::to_string(mergedMethods) + " event multicalls with " + std::to_string(calls->arrayValue->size()) + " events for server " + address.first + ".");
+    }
+
+    auto parameters = std::make_shared<std::list<BaseLib::PVariable>>();
+    parameters->push_back(calls);
+    return std::make_shared<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>>("system.multicall", parameters);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return method;
+}
+
+void RemoteRpcServer::collapseEvents(BaseLib::PArray &calls) {
+  try {
+    //Only an event directly followed by an event of the same variable is removed, so the order of the sent events doesn't
+    //change. Events with equal values are kept: action variables like PRESS_SHORT send the same value on every key press.
+    BaseLib::Array collapsedCalls;
+    collapsedCalls.reserve(calls->size());
+    std::string previousKey;
+    BaseLib::PVariable previousValue;
+    for (auto &call: *calls) {
+      //The variable is identified by all parameters but the value, i. e. by server ID, peer ID and channel (or address) and variable name.
+      std::string key;
+      BaseLib::PVariable value;
+      auto paramsIterator = call->structValue->find("params");
+      if (paramsIterator != call->structValue->end() && paramsIterator->second->arrayValue->size() > 1) {
+        auto &params = *paramsIterator->second->arrayValue;
+        for (size_t j = 0; j < params.size() - 1; j++) {
+          if (params[j]->type == BaseLib::VariableType::tInteger) key.append(std::to_string(params[j]->integerValue));
+          else if (params[j]->type == BaseLib::VariableType::tInteger64) key.append(std::to_string(params[j]->integerValue64));
+          else key.append(params[j]->stringValue);
+          key.push_back('\x1F');
+        }
+        value = params.back();
+      }
+
+      if (!key.empty() && key == previousKey && *value != *previousValue) collapsedCalls.back() = call;
+      else collapsedCalls.push_back(call);
+      previousKey = std::move(key);
+      previousValue = std::move(value);
+    }
+
+    if (collapsedCalls.size() != calls->size()) calls->swap(collapsedCalls);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 BaseLib::PVariable RemoteRpcServer::invoke(std::string &methodName,
                                            std::shared_ptr<std::list<BaseLib::PVariable>> &parameters) {
   if (_serverClientInfo->sendEventsToRpcServer) return invokeClientMethod(methodName, parameters);
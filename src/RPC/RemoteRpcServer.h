@@ -128,6 +128,27 @@ class RemoteRpcServer {
 
   void processMethods();
 
+  /**
+   * Checks if a queued method is a "system.multicall" only containing "event" calls as created by
+   * Client::broadcastEvent().
+   */
+  static bool isEventMulticall(const std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> &method);
+
+  /**
+   * Merges the event multicalls directly following "method" in the method buffer into one multicall. Must be called
+   * with _methodProcessingThreadMutex locked.
+   *
+   * @param method The event multicall that was just taken from the method buffer.
+   * @param lock The lock on _methodProcessingThreadMutex. It is released while waiting for further events.
+   * @return Returns the merged multicall.
+   */
+  std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> coalesceEvents(const std::shared_ptr<std::pair<std::string, std::shared_ptr<std::list<BaseLib::PVariable>>>> &method, std::unique_lock<std::mutex> &lock);
+
+  /**
+   * Removes "event" calls that are directly followed by a call with a different value for the same variable.
+   */
+  static void collapseEvents(BaseLib::PArray &calls);
+
   BaseLib::PVariable invokeClientMethod(std::string &methodName,
                                         std::shared_ptr<std::list<BaseLib::PVariable>> &parameters);
 };
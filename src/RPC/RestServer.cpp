@@ -7,9 +7,11 @@ namespace Homegear {
 
 namespace Rpc {
 
-RestServer::RestServer(std::shared_ptr<BaseLib::Rpc::ServerInfo::Info> &serverInfo) {
+RestServer::RestServer(RpcServer *rpcServer, std::shared_ptr<BaseLib::Rpc::ServerInfo::Info> &serverInfo) {
   _out.init(GD::bl.get());
 
+  _rpcServer = rpcServer;
+
   _jsonEncoder.reset(new BaseLib::Rpc::JsonEncoder(GD::bl.get()));
   _jsonDecoder.reset(new BaseLib::Rpc::JsonDecoder(GD::bl.get()));
 
@@ -365,6 +367,13 @@ void RestServer::process(BaseLib::PRpcClientInfo clientInfo,
           contentString = R"({"result":"error","message":")" + response->structValue->at("faultString")->stringValue
               + "\"}";
         else contentString = R"({"result":"success"})";
+      } else if (request == "batch") {
+        GD::out.printInfo("Info: REST JSON-RPC batch received.");
+        if (json->type != BaseLib::VariableType::tArray) contentString = R"({"result":"error","message":"Batch is not an array."})";
+        else {
+          std::vector<char> response = _rpcServer->callBatch(clientInfo, json);
+          contentString.assign(response.begin(), response.end());
+        }
       } else {
         contentString = R"({"result":"error","message":"Unknown method."})";
       }
@@ -37,9 +37,15 @@ namespace Homegear {
 
 namespace Rpc {
 
+class RpcServer;
+
 class RestServer {
  public:
-  RestServer(std::shared_ptr<BaseLib::Rpc::ServerInfo::Info> &serverInfo);
+  /**
+   * @param rpcServer The RPC server receiving the REST requests. Batches are executed by it, so they are counted in its
+   * statistics.
+   */
+  RestServer(RpcServer *rpcServer, std::shared_ptr<BaseLib::Rpc::ServerInfo::Info> &serverInfo);
 
   virtual ~RestServer();
 
@@ -47,6 +53,7 @@ class RestServer {
 
  private:
   BaseLib::Output _out;
+  RpcServer *_rpcServer = nullptr;
   BaseLib::Rpc::PServerInfo _serverInfo;
   std::unique_ptr<BaseLib::Rpc::JsonEncoder> _jsonEncoder;
   std::unique_ptr<BaseLib::Rpc::JsonDecoder> _jsonDecoder;
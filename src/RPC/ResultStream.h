@@ -0,0 +1,104 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_RESULTSTREAM_H_
+#define HOMEGEAR_RESULTSTREAM_H_
+
+#include <homegear-base/BaseLib.h>
+
+namespace Homegear::Rpc {
+
+/**
+ * Receives the result of an RPC method one array element or struct member at a time.
+ */
+class ResultStream {
+ public:
+  virtual ~ResultStream() = default;
+
+  /**
+   * Appends an element to an array result.
+   *
+   * @return Returns false when the result is not needed anymore, e. g. because the client disconnected. The method
+   * should stop then.
+   */
+  virtual bool appendElement(const BaseLib::PVariable &element) = 0;
+
+  /**
+   * Appends a member to a struct result. See appendElement().
+   */
+  virtual bool appendMember(const std::string &name, const BaseLib::PVariable &value) = 0;
+};
+
+/**
+ * Collects all elements into one variable. Used to return the result of a streaming method from invoke().
+ */
+class CollectingResultStream : public ResultStream {
+ public:
+  explicit CollectingResultStream(BaseLib::VariableType type) : _result(std::make_shared<BaseLib::Variable>(type)) {}
+
+  bool appendElement(const BaseLib::PVariable &element) override {
+    _result->arrayValue->push_back(element);
+    return true;
+  }
+
+  bool appendMember(const std::string &name, const BaseLib::PVariable &value) override {
+    _result->structValue->emplace(name, value);
+    return true;
+  }
+
+  BaseLib::PVariable result() { return _result; }
+ private:
+  BaseLib::PVariable _result;
+};
+
+/**
+ * Implemented by RPC methods with potentially very large results. The RPC server streams their results to the client
+ * instead of encoding them as a whole.
+ */
+class StreamingRpcMethod {
+ public:
+  virtual ~StreamingRpcMethod() = default;
+
+  /**
+   * The type of the result, either tArray or tStruct.
+   */
+  virtual BaseLib::VariableType streamedResultType() = 0;
+
+  /**
+   * Like invoke(), but passes the result to "stream" one element at a time instead of returning it.
+   *
+   * @return Returns an error struct on errors and a void variable otherwise.
+   */
+  virtual BaseLib::PVariable invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) = 0;
+};
+
+}
+
+#endif
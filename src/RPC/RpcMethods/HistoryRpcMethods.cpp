@@ -0,0 +1,98 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "HistoryRpcMethods.h"
+#include "../../GD/GD.h"
+
+namespace Homegear::RpcMethods {
+
+namespace {
+bool checkVariableReadAccess(const BaseLib::PRpcClientInfo &clientInfo, uint64_t peerId, int32_t channel, const std::string &variable) {
+  if (!clientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet()) return true;
+
+  auto peer = GD::familyController->getPeer(peerId);
+  return peer && clientInfo->acls->checkVariableReadAccess(peer, channel, variable);
+}
+}
+
+BaseLib::PVariable RPCGetVariableHistory::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
+  try {
+    ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+                                                                                                                 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString,
+                                                                                                                                                     BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64}),
+                                                                                                                 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString,
+                                                                                                                                                     BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger})
+                                                                                                             }));
+    if (error != ParameterError::Enum::noError) return getError(error);
+
+    if (!clientInfo || !clientInfo->acls->checkMethodAccess("getVariableHistory")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+    auto peerId = (uint64_t)parameters->at(0)->integerValue64;
+    int32_t channel = parameters->at(1)->integerValue;
+    if (!checkVariableReadAccess(clientInfo, peerId, channel, parameters->at(2)->stringValue)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+    uint32_t maxValues = parameters->size() >= 6 ? (uint32_t)std::max(0, parameters->at(5)->integerValue) : 0;
+    return GD::historyStore->getVariableHistory(peerId, channel, parameters->at(2)->stringValue, parameters->at(3)->integerValue64, parameters->at(4)->integerValue64, maxValues);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable RPCGetVariableHistoryAggregate::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
+  try {
+    ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+                                                                                                                 std::vector<BaseLib::VariableType>({BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger, BaseLib::VariableType::tString,
+                                                                                                                                                     BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64, BaseLib::VariableType::tInteger64})
+                                                                                                             }));
+    if (error != ParameterError::Enum::noError) return getError(error);
+
+    if (!clientInfo || !clientInfo->acls->checkMethodAccess("getVariableHistoryAggregate")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+    auto peerId = (uint64_t)parameters->at(0)->integerValue64;
+    int32_t channel = parameters->at(1)->integerValue;
+    if (!checkVariableReadAccess(clientInfo, peerId, channel, parameters->at(2)->stringValue)) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+    return GD::historyStore->getVariableHistoryAggregate(peerId, channel, parameters->at(2)->stringValue, parameters->at(3)->integerValue64, parameters->at(4)->integerValue64, parameters->at(5)->integerValue64);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
@@ -65,4 +65,38 @@ BaseLib::PVariable RpcDisableMaintenanceMode::invoke(BaseLib::PRpcClientInfo cli
   return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
-}
\ No newline at end of file
+BaseLib::PVariable RpcStartDatabaseBackup::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
+  try {
+    if (!parameters->empty()) return getError(ParameterError::Enum::wrongCount);
+
+    if (!clientInfo || !clientInfo->acls->checkMethodAccess("startDatabaseBackup")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+    auto databaseController = dynamic_cast<DatabaseController *>(GD::bl->db.get());
+    if (!databaseController) return BaseLib::Variable::createError(-1, "Database controller is not available.");
+
+    return std::make_shared<BaseLib::Variable>(databaseController->startBackup());
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable RpcGetDatabaseBackupStatus::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
+  try {
+    if (!parameters->empty()) return getError(ParameterError::Enum::wrongCount);
+
+    if (!clientInfo || !clientInfo->acls->checkMethodAccess("getDatabaseBackupStatus")) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
+    auto databaseController = dynamic_cast<DatabaseController *>(GD::bl->db.get());
+    if (!databaseController) return BaseLib::Variable::createError(-1, "Database controller is not available.");
+
+    return databaseController->getBackupStatus();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
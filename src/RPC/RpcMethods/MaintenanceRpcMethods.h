@@ -54,6 +54,24 @@ class RpcDisableMaintenanceMode : public BaseLib::Rpc::RpcMethod {
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
 };
 
+class RpcStartDatabaseBackup : public BaseLib::Rpc::RpcMethod {
+ public:
+  RpcStartDatabaseBackup() {
+    addSignature(BaseLib::VariableType::tBoolean, std::vector<BaseLib::VariableType>());
+  }
+
+  BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
+};
+
+class RpcGetDatabaseBackupStatus : public BaseLib::Rpc::RpcMethod {
+ public:
+  RpcGetDatabaseBackupStatus() {
+    addSignature(BaseLib::VariableType::tStruct, std::vector<BaseLib::VariableType>());
+  }
+
+  BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
+};
+
 }
 
 #endif //HOMEGEAR_SRC_RPC_RPCMETHODS_MAINTENANCERPCMETHODS_H_
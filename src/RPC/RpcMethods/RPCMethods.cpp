@@ -230,41 +230,62 @@ BaseLib::PVariable RPCSystemMulticall::invoke(BaseLib::PRpcClientInfo clientInfo
     if (error != ParameterError::Enum::noError) return getError(error);
 
     BaseLib::PVariable returns(new BaseLib::Variable(BaseLib::VariableType::tArray));
-    returns->arrayValue->reserve(parameters->at(0)->arrayValue->size());
-    for (std::vector<BaseLib::PVariable>::iterator i = parameters->at(0)->arrayValue->begin();
-         i != parameters->at(0)->arrayValue->end(); ++i) {
-      if ((*i)->type != BaseLib::VariableType::tStruct) {
-        returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Array element is no struct."));
+    returns->arrayValue->resize(parameters->at(0)->arrayValue->size());
+    //The calls are validated first and executed afterwards, so independent calls can be executed in parallel.
+    std::vector<Rpc::MulticallExecutor::Call> calls;
+    calls.reserve(parameters->at(0)->arrayValue->size());
+    bool unauthorized = false;
+    for (size_t index = 0; index < parameters->at(0)->arrayValue->size(); index++) {
+      auto &call = parameters->at(0)->arrayValue->at(index);
+      auto &result = returns->arrayValue->at(index);
+      if (call->type != BaseLib::VariableType::tStruct) {
+        result = BaseLib::Variable::createError(-32602, "Array element is no struct.");
         continue;
       }
-      if ((*i)->structValue->size() != 2) {
-        returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "Struct has wrong size."));
+      //"dependent" is optional. Dependent calls are executed after all previous calls when calls are executed in parallel.
+      auto dependentIterator = call->structValue->find("dependent");
+      if (call->structValue->size() != (dependentIterator == call->structValue->end() ? 2 : 3)) {
+        result = BaseLib::Variable::createError(-32602, "Struct has wrong size.");
         continue;
       }
-      if ((*i)->structValue->find("methodName") == (*i)->structValue->end()
-          || (*i)->structValue->at("methodName")->type != BaseLib::VariableType::tString) {
-        returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "No method name provided."));
+      if (call->structValue->find("methodName") == call->structValue->end()
+          || call->structValue->at("methodName")->type != BaseLib::VariableType::tString) {
+        result = BaseLib::Variable::createError(-32602, "No method name provided.");
         continue;
       }
-      if ((*i)->structValue->find("params") == (*i)->structValue->end()
-          || (*i)->structValue->at("params")->type != BaseLib::VariableType::tArray) {
-        returns->arrayValue->push_back(BaseLib::Variable::createError(-32602, "No parameters provided."));
+      if (call->structValue->find("params") == call->structValue->end()
+          || call->structValue->at("params")->type != BaseLib::VariableType::tArray) {
+        result = BaseLib::Variable::createError(-32602, "No parameters provided.");
         continue;
       }
-      std::string methodName = (*i)->structValue->at("methodName")->stringValue;
-      if (!clientInfo->acls->checkMethodAccess(methodName))
-        return BaseLib::Variable::createError(-32603,
-                                              "Unauthorized.");
-      auto parameters = (*i)->structValue->at("params");
+      std::string methodName = call->structValue->at("methodName")->stringValue;
+      if (!clientInfo->acls->checkMethodAccess(methodName)) {
+        //Calls before the unauthorized one are still executed.
+        unauthorized = true;
+        break;
+      }
 
-      if (methodName == "system.multicall")
-        returns->arrayValue->push_back(BaseLib::Variable::createError(-32602,
-                                                                      "Recursive calls to system.multicall are not allowed."));
-      else {
-        returns->arrayValue->push_back(GD::rpcServers.begin()->second->callMethod(clientInfo, methodName, parameters));
+      if (methodName == "system.multicall") {
+        result = BaseLib::Variable::createError(-32602, "Recursive calls to system.multicall are not allowed.");
+      } else {
+        Rpc::MulticallExecutor::Call executorCall;
+        executorCall.index = index;
+        executorCall.methodName = methodName;
+        executorCall.parameters = call->structValue->at("params");
+        executorCall.barrier = (dependentIterator != call->structValue->end() && dependentIterator->second->booleanValue) || !Rpc::MulticallExecutor::isReadOnly(methodName);
+        calls.emplace_back(std::move(executorCall));
       }
     }
 
+    if (GD::multicallExecutor && GD::multicallExecutor->enabled() && calls.size() > 1) {
+      GD::multicallExecutor->execute(clientInfo, calls, *returns->arrayValue);
+    } else {
+      for (auto &call: calls) {
+        returns->arrayValue->at(call.index) = GD::rpcServers.begin()->second->callMethod(clientInfo, call.methodName, call.parameters);
+      }
+    }
+    if (unauthorized) return BaseLib::Variable::createError(-32603, "Unauthorized.");
+
     return returns;
   }
   catch (const std::exception &ex) {
@@ -2471,6 +2492,78 @@ BaseLib::PVariable RPCGetAllConfig::invoke(BaseLib::PRpcClientInfo clientInfo, B
   return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetAllConfig::invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) {
+  try {
+    if (!clientInfo || !clientInfo->acls->checkMethodAccess("getAllConfig"))
+      return BaseLib::Variable::createError(-32603, "Unauthorized.");
+    bool checkAcls = clientInfo->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet();
+    if (parameters->size() > 0) {
+      ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+                                                                                                                   std::vector<
+                                                                                                                       BaseLib::VariableType>(
+                                                                                                                       {BaseLib::VariableType::tInteger})
+                                                                                                               }));
+      if (error != ParameterError::Enum::noError) return getError(error);
+    }
+
+    uint64_t peerId = 0;
+    if (parameters->size() > 0) peerId = parameters->at(0)->integerValue64;
+
+    size_t count = 0;
+    std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
+    for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin();
+         i != families.end(); ++i) {
+      std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
+      if (!central) continue;
+      if (peerId == 0) {
+        //Request the config peer by peer, so only the config of one peer is in memory at a time when streaming.
+        auto peers = central->getPeers();
+        for (auto &peer: peers) {
+          if (!peer) continue;
+          if (checkAcls && !clientInfo->acls->checkDeviceReadAccess(peer)) continue;
+          BaseLib::PVariable result = central->getAllConfig(clientInfo, peer->getID(), checkAcls);
+          if (!result) continue;
+          if (result->errorStruct) {
+            GD::out.printWarning("Warning: Error calling method \"getAllConfig\" for peer " + std::to_string(peer->getID()) + " of device family " + i->second->getName() + ": " + result->structValue->at("faultString")->stringValue);
+            continue;
+          }
+          for (auto &element: *result->arrayValue) {
+            if (!stream.appendElement(element)) return std::make_shared<BaseLib::Variable>();
+          }
+        }
+        continue;
+      }
+
+      if (!central->peerExists(peerId)) continue;
+      if (clientInfo->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet()) {
+        auto peer = central->getPeer(peerId);
+        if (!peer || !clientInfo->acls->checkDeviceReadAccess(peer))
+          return BaseLib::Variable::createError(-32603,
+                                                "Unauthorized.");
+      }
+      BaseLib::PVariable result = central->getAllConfig(clientInfo, peerId, checkAcls);
+      if (result && result->errorStruct) return result;
+      if (result) {
+        for (auto &element: *result->arrayValue) {
+          count++;
+          if (!stream.appendElement(element)) return std::make_shared<BaseLib::Variable>();
+        }
+      }
+      break;
+    }
+
+    if (count == 0 && peerId > 0) return BaseLib::Variable::createError(-2, "Unknown device.");
+    return std::make_shared<BaseLib::Variable>();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCFamilyExists::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
   try {
     if (!clientInfo || !clientInfo->acls->checkMethodAccess("familyExists"))
@@ -2633,6 +2726,13 @@ BaseLib::PVariable RPCGetAllScripts::invoke(BaseLib::PRpcClientInfo clientInfo,
 }
 
 BaseLib::PVariable RPCGetAllSystemVariables::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
+  CollectingResultStream stream(streamedResultType());
+  auto result = invokeStreaming(clientInfo, parameters, stream);
+  if (result->errorStruct) return result;
+  return stream.result();
+}
+
+BaseLib::PVariable RPCGetAllSystemVariables::invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) {
   try {
     if (!clientInfo || !clientInfo->acls->checkMethodAccess("getAllSystemVariables"))
       return BaseLib::Variable::createError(-32603, "Unauthorized.");
@@ -2649,7 +2749,9 @@ BaseLib::PVariable RPCGetAllSystemVariables::invoke(BaseLib::PRpcClientInfo clie
       returnRoomsCategoriesFlags = parameters->at(0)->booleanValue;
     }
 
-    return GD::systemVariableController->getAll(clientInfo, returnRoomsCategoriesFlags, checkAcls);
+    return GD::systemVariableController->getAll(clientInfo, returnRoomsCategoriesFlags, checkAcls, [&](const std::string &name, const BaseLib::PVariable &value) {
+      return stream.appendMember(name, value);
+    });
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -2757,6 +2859,125 @@ BaseLib::PVariable RPCGetAllValues::invoke(BaseLib::PRpcClientInfo clientInfo, B
   return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
+BaseLib::PVariable RPCGetAllValues::invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) {
+  try {
+    if (!clientInfo || !clientInfo->acls->checkMethodAccess("getAllValues"))
+      return BaseLib::Variable::createError(-32603, "Unauthorized.");
+    bool checkAcls = clientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet();
+    if (parameters->size() > 0) {
+      ParameterError::Enum error = checkParameters(parameters, std::vector<std::vector<BaseLib::VariableType>>({
+                                                                                                                   std::vector<
+                                                                                                                       BaseLib::VariableType>(
+                                                                                                                       {BaseLib::VariableType::tBoolean}),
+                                                                                                                   std::vector<
+                                                                                                                       BaseLib::VariableType>(
+                                                                                                                       {BaseLib::VariableType::tInteger}),
+                                                                                                                   std::vector<
+                                                                                                                       BaseLib::VariableType>(
+                                                                                                                       {BaseLib::VariableType::tInteger,
+                                                                                                                        BaseLib::VariableType::tBoolean}),
+                                                                                                                   std::vector<
+                                                                                                                       BaseLib::VariableType>(
+                                                                                                                       {BaseLib::VariableType::tArray}),
+                                                                                                                   std::vector<
+                                                                                                                       BaseLib::VariableType>(
+                                                                                                                       {BaseLib::VariableType::tArray,
+                                                                                                                        BaseLib::VariableType::tBoolean})
+                                                                                                               }));
+      if (error != ParameterError::Enum::noError) return getError(error);
+    }
+
+    uint64_t peerId = 0;
+    bool isArray = false;
+    bool returnWriteOnly = false;
+    if (parameters->size() == 1 && parameters->at(0)->type == BaseLib::VariableType::tBoolean) {
+      returnWriteOnly = parameters->at(0)->booleanValue;
+    } else if (parameters->size() == 1 && (parameters->at(0)->type == BaseLib::VariableType::tInteger
+        || parameters->at(0)->type == BaseLib::VariableType::tInteger64)) {
+      peerId = parameters->at(0)->integerValue64;
+    } else if (parameters->size() == 1 && (parameters->at(0)->type == BaseLib::VariableType::tArray)) {
+      isArray = true;
+    } else if (parameters->size() == 2 && (parameters->at(0)->type == BaseLib::VariableType::tInteger
+        || parameters->at(0)->type == BaseLib::VariableType::tInteger64)) {
+      peerId = parameters->at(0)->integerValue64;
+      returnWriteOnly = parameters->at(1)->booleanValue;
+    } else if (parameters->size() == 2 && (parameters->at(0)->type == BaseLib::VariableType::tArray)) {
+      isArray = true;
+    }
+
+    size_t count = 0;
+    std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
+    for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin();
+         i != families.end(); ++i) {
+      std::shared_ptr<BaseLib::Systems::ICentral> central = i->second->getCentral();
+      if (!central) continue;
+      if (peerId == 0 && !isArray) {
+        //Request the values peer by peer, so only the values of one peer are in memory at a time when streaming.
+        auto peers = central->getPeers();
+        for (auto &peer: peers) {
+          if (!peer) continue;
+          if (checkAcls && !clientInfo->acls->checkDeviceReadAccess(peer)) continue;
+          auto peerIds = std::make_shared<BaseLib::Array>();
+          peerIds->push_back(std::make_shared<BaseLib::Variable>(peer->getID()));
+          BaseLib::PVariable result = central->getAllValues(clientInfo, peerIds, returnWriteOnly, checkAcls);
+          if (!result) continue;
+          if (result->errorStruct) {
+            GD::out.printWarning("Warning: Error calling method \"getAllValues\" for peer " + std::to_string(peer->getID()) + " of device family " + i->second->getName() + ": " + result->structValue->at("faultString")->stringValue);
+            continue;
+          }
+          for (auto &element: *result->arrayValue) {
+            if (!stream.appendElement(element)) return std::make_shared<BaseLib::Variable>();
+          }
+        }
+        continue;
+      }
+      if (peerId > 0) {
+        if (!central->peerExists(peerId)) continue;
+        if (clientInfo->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet()) {
+          auto peer = central->getPeer(peerId);
+          if (!peer || !clientInfo->acls->checkDeviceReadAccess(peer))
+            return BaseLib::Variable::createError(-32603,
+                                                  "Unauthorized.");
+        }
+      }
+
+      BaseLib::PVariable result;
+      if (isArray)
+        result = central->getAllValues(clientInfo, parameters->at(0)->arrayValue, returnWriteOnly, checkAcls);
+      else {
+        auto peerIds = std::make_shared<BaseLib::Array>();
+        if (peerId > 0) peerIds->push_back(std::make_shared<BaseLib::Variable>(peerId));
+        result = central->getAllValues(clientInfo, peerIds, returnWriteOnly, checkAcls);
+      }
+      if (result && result->errorStruct) {
+        if (peerId > 0) return result;
+        else
+          GD::out.printWarning(
+              "Warning: Error calling method \"getAllValues\" on device family " + i->second->getName() + ": "
+                  + result->structValue->at("faultString")->stringValue);
+        continue;
+      }
+      if (result) {
+        for (auto &element: *result->arrayValue) {
+          count++;
+          if (!stream.appendElement(element)) return std::make_shared<BaseLib::Variable>();
+        }
+      }
+      if (peerId > 0) break;
+    }
+
+    if (count == 0 && peerId > 0) return BaseLib::Variable::createError(-2, "Unknown device.");
+    return std::make_shared<BaseLib::Variable>();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 BaseLib::PVariable RPCGetCategories::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
   try {
     if (!clientInfo || !clientInfo->acls->checkMethodAccess("getCategories"))
@@ -5563,6 +5784,13 @@ BaseLib::PVariable RPCListClientServers::invoke(BaseLib::PRpcClientInfo clientIn
 }
 
 BaseLib::PVariable RPCListDevices::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) {
+  CollectingResultStream stream(streamedResultType());
+  auto result = invokeStreaming(clientInfo, parameters, stream);
+  if (result->errorStruct) return result;
+  return stream.result();
+}
+
+BaseLib::PVariable RPCListDevices::invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) {
   try {
     if (!clientInfo || !clientInfo->acls->checkMethodAccess("listDevices"))
       return BaseLib::Variable::createError(-32603, "Unauthorized.");
@@ -5607,7 +5835,6 @@ BaseLib::PVariable RPCListDevices::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
       clientInfo->clientType = BaseLib::RpcClientType::homematicconfigurator;
     }
 
-    BaseLib::PVariable devices(new BaseLib::Variable(BaseLib::VariableType::tArray));
     std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
     for (std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>>::iterator i = families.begin();
          i != families.end(); ++i) {
@@ -5621,13 +5848,14 @@ BaseLib::PVariable RPCListDevices::invoke(BaseLib::PRpcClientInfo clientInfo, Ba
                 + result->structValue->at("faultString")->stringValue);
         continue;
       }
-      if (result && !result->arrayValue->empty())
-        devices->arrayValue->insert(devices->arrayValue->end(),
-                                    result->arrayValue->begin(),
-                                    result->arrayValue->end());
+      if (result) {
+        for (auto &element: *result->arrayValue) {
+          if (!stream.appendElement(element)) return std::make_shared<BaseLib::Variable>();
+        }
+      }
     }
 
-    return devices;
+    return std::make_shared<BaseLib::Variable>();
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -7202,9 +7430,11 @@ BaseLib::PVariable RPCSetId::invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib:
                                                   "Unauthorized.");
         }
 
-        return central->setId(clientInfo,
-                              (uint64_t)parameters->at(0)->integerValue64,
-                              (uint64_t)parameters->at(1)->integerValue64);
+        auto result = central->setId(clientInfo,
+                                     (uint64_t)parameters->at(0)->integerValue64,
+                                     (uint64_t)parameters->at(1)->integerValue64);
+        if (!result->errorStruct) GD::familyController->peerIdChanged((uint64_t)parameters->at(0)->integerValue64, (uint64_t)parameters->at(1)->integerValue64);
+        return result;
       }
     }
 
@@ -31,6 +31,8 @@
 #ifndef RPCMETHODS_H_
 #define RPCMETHODS_H_
 
+#include "../ResultStream.h"
+
 #include <homegear-base/BaseLib.h>
 
 #include <vector>
@@ -565,7 +567,7 @@ class RPCGetAllScripts : public BaseLib::Rpc::RpcMethod {
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
 };
 
-class RPCGetAllConfig : public BaseLib::Rpc::RpcMethod {
+class RPCGetAllConfig : public BaseLib::Rpc::RpcMethod, public StreamingRpcMethod {
  public:
   RPCGetAllConfig() {
     addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
@@ -573,9 +575,13 @@ class RPCGetAllConfig : public BaseLib::Rpc::RpcMethod {
   }
 
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
+
+  BaseLib::VariableType streamedResultType() override { return BaseLib::VariableType::tArray; }
+
+  BaseLib::PVariable invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) override;
 };
 
-class RPCGetAllValues : public BaseLib::Rpc::RpcMethod {
+class RPCGetAllValues : public BaseLib::Rpc::RpcMethod, public StreamingRpcMethod {
  public:
   RPCGetAllValues() {
     addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
@@ -586,9 +592,13 @@ class RPCGetAllValues : public BaseLib::Rpc::RpcMethod {
   }
 
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
+
+  BaseLib::VariableType streamedResultType() override { return BaseLib::VariableType::tArray; }
+
+  BaseLib::PVariable invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) override;
 };
 
-class RPCGetAllSystemVariables : public BaseLib::Rpc::RpcMethod {
+class RPCGetAllSystemVariables : public BaseLib::Rpc::RpcMethod, public StreamingRpcMethod {
  public:
   RPCGetAllSystemVariables() {
     addSignature(BaseLib::VariableType::tVariant, std::vector<BaseLib::VariableType>());
@@ -596,6 +606,10 @@ class RPCGetAllSystemVariables : public BaseLib::Rpc::RpcMethod {
   }
 
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
+
+  BaseLib::VariableType streamedResultType() override { return BaseLib::VariableType::tStruct; }
+
+  BaseLib::PVariable invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) override;
 };
 
 class RPCGetCategories : public BaseLib::Rpc::RpcMethod {
@@ -1204,7 +1218,7 @@ class RPCListClientServers : public BaseLib::Rpc::RpcMethod {
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
 };
 
-class RPCListDevices : public BaseLib::Rpc::RpcMethod {
+class RPCListDevices : public BaseLib::Rpc::RpcMethod, public StreamingRpcMethod {
  public:
   RPCListDevices() {
     addSignature(BaseLib::VariableType::tArray, std::vector<BaseLib::VariableType>());
@@ -1216,6 +1230,10 @@ class RPCListDevices : public BaseLib::Rpc::RpcMethod {
   }
 
   BaseLib::PVariable invoke(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters) override;
+
+  BaseLib::VariableType streamedResultType() override { return BaseLib::VariableType::tArray; }
+
+  BaseLib::PVariable invokeStreaming(BaseLib::PRpcClientInfo clientInfo, BaseLib::PArray parameters, ResultStream &stream) override;
 };
 
 class RPCListFamilies : public BaseLib::Rpc::RpcMethod {
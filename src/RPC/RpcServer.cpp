@@ -29,6 +29,7 @@
 */
 
 #include "RpcServer.h"
+#include "ChunkedJsonResultStream.h"
 #include "RpcMethods/BuildingRpcMethods.h"
 #include "RpcMethods/UiRpcMethods.h"
 #include "RpcMethods/UiNotificationsRpcMethods.h"
@@ -36,8 +37,11 @@
 #include "RpcMethods/NodeBlueRpcMethods.h"
 #include "../GD/GD.h"
 #include "RpcMethods/BuildingPartRpcMethods.h"
+#include "RpcMethods/HistoryRpcMethods.h"
 #include <homegear-base/BaseLib.h>
 #include <gnutls/gnutls.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
 
 #include <memory>
 
@@ -72,6 +76,20 @@ int gnutls_system_recv_timeout(gnutls_transport_ptr_t ptr, unsigned int ms)
 
 namespace Homegear::Rpc {
 
+namespace {
+
+/**
+ * Set by worker threads while reading in event-driven mode. Other threads (e. g. authentication or the RPC client after
+ * a connection was handed over) keep reading the same TLS session blocking.
+ */
+thread_local bool nonBlockingTlsRead = false;
+
+ssize_t tlsPull(gnutls_transport_ptr_t transport, void *data, size_t size) {
+  return recv((int)(intptr_t)transport, data, size, nonBlockingTlsRead ? MSG_DONTWAIT : 0);
+}
+
+}
+
 RpcServer::Client::Client() {
   C1Net::TcpSocketInfo tcp_socket_info;
   auto dummy_socket = std::make_shared<C1Net::Socket>(-1);
@@ -84,7 +102,7 @@ RpcServer::Client::~Client() {
   GD::bl->threadManager.join(readThread);
 }
 
-RpcServer::RpcServer() {
+RpcServer::RpcServer() : IQueue(GD::bl.get(), 1, 1000) {
   _out.init(GD::bl.get());
 
   _rpcDecoder = std::unique_ptr<BaseLib::Rpc::RpcDecoder>(new BaseLib::Rpc::RpcDecoder(GD::bl.get()));
@@ -301,6 +319,11 @@ RpcServer::RpcServer() {
     _rpcMethods->emplace("updateBuildingPart", std::make_shared<RpcMethods::RPCUpdateBuildingPart>());
   }
 
+  { // History
+    _rpcMethods->emplace("getVariableHistory", std::make_shared<RpcMethods::RPCGetVariableHistory>());
+    _rpcMethods->emplace("getVariableHistoryAggregate", std::make_shared<RpcMethods::RPCGetVariableHistoryAggregate>());
+  }
+
   { // System variables
     _rpcMethods->emplace("addRoleToSystemVariable", std::make_shared<RPCAddRoleToSystemVariable>());
     _rpcMethods->emplace("getSystemVariablesInRole", std::make_shared<RPCGetSystemVariablesInRole>());
@@ -632,7 +655,10 @@ void RpcServer::start(BaseLib::Rpc::PServerInfo &info) {
     //}}}
 
     _webServer.reset(new WebServer::WebServer(_info));
-    _restServer.reset(new RestServer(_info));
+    _restServer.reset(new RestServer(this, _info));
+    _eventDriven = GD::tuningSettings.rpcServerEventDriven();
+    if (_eventDriven) startEventProcessing();
+    _maxConnections = _eventDriven ? GD::tuningSettings.rpcServerEventDrivenMaxConnections() : GD::bl->settings.rpcServerMaxConnections();
     GD::bl->threadManager.start(_mainThread, true, _threadPriority, _threadPolicy, &RpcServer::mainThread, this);
     _stopped = false;
   }
@@ -658,6 +684,7 @@ void RpcServer::stop() {
         closeClientConnection(i->second);
       }
     }
+    if (_eventDriven) stopEventProcessing();
 
     while (_clients.size() > 0) {
       collectGarbage();
@@ -742,6 +769,7 @@ void RpcServer::mainThread() {
                 << std::endl;
           }
           client->auth = std::make_shared<Auth>(_info->validGroups);
+          client->readState = std::make_unique<ReadState>(GD::bl.get());
           client->initInterfaceId = "rpc-client-" + address + ":" + std::to_string(port);
           _clients[client->id] = client;
         }
@@ -780,7 +808,9 @@ void RpcServer::mainThread() {
           }
 #endif
 
-          if (!GD::bl->threadManager.start(client->readThread,
+          if (_eventDriven) {
+            if (!addClientToEventLoop(client)) closeClientConnection(client);
+          } else if (!GD::bl->threadManager.start(client->readThread,
                                            false,
                                            _threadPriority,
                                            _threadPolicy,
@@ -811,7 +841,7 @@ void RpcServer::mainThread() {
   if (!_info->socketDescriptor) GD::bl->fileDescriptorManager.shutdown(_serverFileDescriptor);
 }
 
-bool RpcServer::clientValid(std::shared_ptr<Client> &client) {
+bool RpcServer::clientValid(const std::shared_ptr<Client> &client) {
   try {
     return client->socket->IsValid();
   }
@@ -878,7 +908,10 @@ void RpcServer::analyzeRPC(const std::shared_ptr<Client> &client,
     } else if (packetType == PacketType::Enum::jsonRequest || packetType == PacketType::Enum::webSocketRequest) {
       if (client->rpcType == BaseLib::RpcType::unknown) client->rpcType = BaseLib::RpcType::json;
       BaseLib::PVariable result = _jsonDecoder->decode(packet);
-      if (result->type == BaseLib::VariableType::tStruct) {
+      if (result->type == BaseLib::VariableType::tArray) {
+        analyzeJsonBatch(client, result, responseType, keepAlive);
+        return;
+      } else if (result->type == BaseLib::VariableType::tStruct) {
         if (result->structValue->find("user") != result->structValue->end()) {
           _out.printWarning(
               "Warning: WebSocket auth packet received but auth is disabled for WebSockets. Closing connection.");
@@ -933,6 +966,48 @@ void RpcServer::analyzeRPC(const std::shared_ptr<Client> &client,
   }
 }
 
+void RpcServer::analyzeJsonBatch(const std::shared_ptr<Client> &client,
+                                 const BaseLib::PVariable &batch,
+                                 PacketType::Enum responseType,
+                                 bool keepAlive) {
+  try {
+    if (responseType == PacketType::Enum::webSocketResponse) {
+      bool error = false;
+      callBatch(client, batch, [&](const std::vector<char> &response) {
+        if (error || _stopped) return;
+        std::vector<char> data;
+        BaseLib::WebSocket::encode(response, BaseLib::WebSocket::Header::Opcode::text, data);
+        try {
+          client->socket->Send((uint8_t *)data.data(), data.size());
+        }
+        catch (const C1Net::Exception &ex) {
+          _out.printError(std::string("Error: ") + ex.what());
+          error = true;
+        }
+      });
+      if (!keepAlive || error) closeClientConnection(client);
+      return;
+    }
+
+    std::vector<char> data = callBatch(client, batch);
+    std::string header = getHttpResponseHeader("application/json", data.size() + 2, !keepAlive);
+    data.reserve(data.size() + header.size() + 2);
+    data.push_back('\r');
+    data.push_back('\n');
+    data.insert(data.begin(), header.begin(), header.end());
+    if (GD::bl->debugLevel >= 5) {
+      _out.printDebug("Response packet: " + std::string(data.data(), data.size()));
+    }
+    sendRPCResponseToClient(client, data, keepAlive);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+
 void RpcServer::sendRPCResponseToClient(std::shared_ptr<Client> client,
                                         const BaseLib::PVariable &variable,
                                         int32_t messageId,
@@ -1039,6 +1114,8 @@ BaseLib::PVariable RpcServer::callMethod(const BaseLib::PRpcClientInfo &clientIn
       }
     }
     BaseLib::PVariable ret = rpcMethodsIterator->second->invoke(clientInfo, parameters->arrayValue);
+    GD::aclCache.rpcMethodInvoked(methodName);
+    if (GD::nodeBlueServer) GD::nodeBlueServer->rpcMethodInvoked(methodName);
     if (GD::bl->debugLevel >= 5) {
       _out.printDebug("Response: ");
       ret->print(true, false);
@@ -1057,6 +1134,156 @@ BaseLib::PVariable RpcServer::callMethod(const BaseLib::PRpcClientInfo &clientIn
   return BaseLib::Variable::createError(-32500, ": Unknown application error.");
 }
 
+std::vector<char> RpcServer::callBatch(const BaseLib::PRpcClientInfo &clientInfo,
+                                      const BaseLib::PVariable &batch,
+                                      const std::function<void(const std::vector<char> &response)> &responseCallback) {
+  std::vector<char> combinedResponse;
+  try {
+    auto startTime = std::chrono::steady_clock::now();
+    auto &requests = *batch->arrayValue;
+    if (requests.empty() || requests.size() > GD::tuningSettings.rpcServerMaxBatchSize()) {
+      //A single response object, not an array, as required by the JSON-RPC 2.0 specification.
+      encodeBatchResponse(BaseLib::Variable::createError(-32600, requests.empty() ? "Invalid request. The batch is empty." : "Invalid request. The batch contains too many requests."), BaseLib::PVariable(), combinedResponse);
+      if (responseCallback) {
+        responseCallback(combinedResponse);
+        combinedResponse.clear();
+      }
+      return combinedResponse;
+    }
+
+    BaseLib::Array results(requests.size());
+    //The original "id" of every request, so string IDs are echoed unchanged. Empty when the ID is unknown.
+    std::vector<BaseLib::PVariable> messageIds(requests.size());
+    std::vector<char> notifications(requests.size(), 0);
+    std::vector<std::vector<char>> responses(requests.size());
+    std::mutex responseCallbackMutex;
+    auto encodeResponse = [&](size_t index) {
+      if (notifications[index]) return;
+      encodeBatchResponse(results[index], messageIds[index], responses[index]);
+      if (responseCallback) {
+        std::lock_guard<std::mutex> responseCallbackGuard(responseCallbackMutex);
+        responseCallback(responses[index]);
+      }
+    };
+
+    std::vector<MulticallExecutor::Call> calls;
+    calls.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+      auto &request = requests[i];
+      if (request->type != BaseLib::VariableType::tStruct) {
+        results[i] = BaseLib::Variable::createError(-32600, "Invalid request. The request is not an object.");
+        encodeResponse(i);
+        continue;
+      }
+      auto idIterator = request->structValue->find("id");
+      if (idIterator != request->structValue->end()) messageIds[i] = idIterator->second;
+      auto methodIterator = request->structValue->find("method");
+      if (methodIterator == request->structValue->end() || methodIterator->second->stringValue.empty()) {
+        results[i] = BaseLib::Variable::createError(-32600, "Invalid request. \"method\" not found.");
+        encodeResponse(i);
+        continue;
+      }
+
+      MulticallExecutor::Call call;
+      call.index = i;
+      call.methodName = methodIterator->second->stringValue;
+      auto paramsIterator = request->structValue->find("params");
+      if (paramsIterator == request->structValue->end()) call.parameters = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+      else if (paramsIterator->second->type != BaseLib::VariableType::tArray) {
+        results[i] = BaseLib::Variable::createError(-32602, "Invalid params. \"params\" is not an array.");
+        encodeResponse(i);
+        continue;
+      } else call.parameters = paramsIterator->second;
+      call.barrier = !MulticallExecutor::isReadOnly(call.methodName);
+      notifications[i] = (idIterator == request->structValue->end());
+      calls.push_back(std::move(call));
+    }
+
+    MulticallExecutor::CallFunction callFunction = [&](const MulticallExecutor::Call &call) {
+      auto parameters = call.parameters;
+      return callMethod(clientInfo, call.methodName, parameters);
+    };
+    MulticallExecutor::ResultCallback resultCallback = [&](const MulticallExecutor::Call &call, const BaseLib::PVariable &) {
+      encodeResponse(call.index);
+    };
+    if (GD::multicallExecutor && GD::multicallExecutor->enabled() && calls.size() > 1) {
+      GD::multicallExecutor->execute(calls, results, callFunction, resultCallback);
+    } else {
+      for (auto &call: calls) {
+        results.at(call.index) = callFunction(call);
+        resultCallback(call, results.at(call.index));
+      }
+    }
+
+    if (!responseCallback) {
+      size_t size = 2;
+      for (auto &response: responses) {
+        size += response.size() + 1;
+      }
+      combinedResponse.reserve(size);
+      combinedResponse.push_back('[');
+      for (auto &response: responses) {
+        if (response.empty()) continue;
+        if (combinedResponse.size() > 1) combinedResponse.push_back(',');
+        combinedResponse.insert(combinedResponse.end(), response.begin(), response.end());
+      }
+      combinedResponse.push_back(']');
+      if (combinedResponse.size() == 2) combinedResponse.clear();
+    }
+
+    int64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    std::lock_guard<std::mutex> batchStatisticsGuard(_batchStatisticsMutex);
+    _batchCount++;
+    _batchRequestCount += requests.size();
+    if (requests.size() > _maxBatchSize) _maxBatchSize = requests.size();
+    _batchTime += time;
+    if (time > _maxBatchTime) _maxBatchTime = time;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return combinedResponse;
+}
+
+void RpcServer::encodeBatchResponse(const BaseLib::PVariable &result, const BaseLib::PVariable &messageId, std::vector<char> &data) {
+  //Like JsonEncoder::encodeResponse(), which only supports integer IDs.
+  auto response = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  response->structValue->emplace("jsonrpc", std::make_shared<BaseLib::Variable>(std::string("2.0")));
+  if (result->errorStruct) {
+    auto error = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    error->structValue->emplace("code", result->structValue->at("faultCode"));
+    error->structValue->emplace("message", result->structValue->at("faultString"));
+    response->structValue->emplace("error", error);
+  } else response->structValue->emplace("result", result);
+  //A void variable is encoded as "null", as required for requests whose ID couldn't be determined.
+  response->structValue->emplace("id", messageId ? messageId : std::make_shared<BaseLib::Variable>());
+  _jsonEncoder->encode(response, data);
+}
+
+BaseLib::PVariable RpcServer::getStatistics() {
+  try {
+    std::lock_guard<std::mutex> batchStatisticsGuard(_batchStatisticsMutex);
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    statistics->structValue->emplace("batches", std::make_shared<BaseLib::Variable>(_batchCount));
+    statistics->structValue->emplace("batchRequests", std::make_shared<BaseLib::Variable>(_batchRequestCount));
+    statistics->structValue->emplace("averageBatchSize", std::make_shared<BaseLib::Variable>(_batchCount > 0 ? (double)_batchRequestCount / _batchCount : 0.0));
+    statistics->structValue->emplace("maxBatchSize", std::make_shared<BaseLib::Variable>(_maxBatchSize));
+    statistics->structValue->emplace("averageBatchLatencyUs", std::make_shared<BaseLib::Variable>(_batchCount > 0 ? _batchTime / (int64_t)_batchCount : (int64_t)0));
+    statistics->structValue->emplace("maxBatchLatencyUs", std::make_shared<BaseLib::Variable>(_maxBatchTime));
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
 void RpcServer::callMethod(const std::shared_ptr<Client> &client,
                            const std::string &methodName,
                            std::shared_ptr<std::vector<BaseLib::PVariable>> parameters,
@@ -1112,7 +1339,20 @@ void RpcServer::callMethod(const std::shared_ptr<Client> &client,
         i->print(true, false);
       }
     }
+    if (responseType == PacketType::Enum::jsonResponse && GD::tuningSettings.rpcServerStreamResults()) {
+      auto streamingMethod = std::dynamic_pointer_cast<StreamingRpcMethod>(rpcMethodsIterator->second);
+      if (streamingMethod) {
+        sendStreamedResponse(client, *streamingMethod, parameters, messageId, keepAlive);
+        GD::aclCache.rpcMethodInvoked(methodName);
+        if (GD::nodeBlueServer) GD::nodeBlueServer->rpcMethodInvoked(methodName);
+        lifetick_2_.second = true;
+        return;
+      }
+    }
+
     BaseLib::PVariable ret = rpcMethodsIterator->second->invoke(client, parameters);
+    GD::aclCache.rpcMethodInvoked(methodName);
+    if (GD::nodeBlueServer) GD::nodeBlueServer->rpcMethodInvoked(methodName);
     if (GD::bl->debugLevel >= 5) {
       _out.printDebug("Response: ");
       ret->print(true, false);
@@ -1128,6 +1368,34 @@ void RpcServer::callMethod(const std::shared_ptr<Client> &client,
   lifetick_2_.second = true;
 }
 
+void RpcServer::sendStreamedResponse(const std::shared_ptr<Client> &client,
+                                     StreamingRpcMethod &method,
+                                     const BaseLib::PArray &parameters,
+                                     int32_t messageId,
+                                     bool keepAlive) {
+  try {
+    ChunkedJsonResultStream stream(client->socket, method.streamedResultType(), messageId, !keepAlive, GD::tuningSettings.rpcServerStreamChunkSize());
+    BaseLib::PVariable result = method.invokeStreaming(client, parameters, stream);
+    if (result->errorStruct) {
+      if (!stream.started()) {
+        sendRPCResponseToClient(client, result, messageId, PacketType::Enum::jsonResponse, keepAlive);
+        return;
+      }
+      //Part of the result was sent already. Close the connection so the client notices the incomplete response.
+      _out.printError("Error: Could not complete streamed response: " + result->structValue->at("faultString")->stringValue);
+      closeClientConnection(client);
+      return;
+    }
+    if (!stream.finish() || !keepAlive) closeClientConnection(client);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+
 std::string RpcServer::getHttpResponseHeader(const std::string &contentType, uint32_t contentLength, bool closeConnection) {
   std::string header;
   header.append("HTTP/1.1 200 OK\r\n");
@@ -1374,28 +1642,19 @@ void RpcServer::handleConnectionUpgrade(std::shared_ptr<Client> client, BaseLib:
 void RpcServer::readClient(std::shared_ptr<Client> client) {
   try {
     if (!client) return;
-    std::array<uint8_t, 1025> buffer{};
-    int32_t processedBytes = 0;
+    AdaptiveReadBuffer buffer(GD::tuningSettings.rpcServerReadBufferSize(), GD::tuningSettings.rpcServerMaxReadBufferSize());
     int32_t bytesRead = 0;
-    PacketType::Enum packetType = PacketType::binaryRequest;
-    BaseLib::Rpc::BinaryRpc binaryRpc(GD::bl.get());
-    BaseLib::Http http;
-    BaseLib::WebSocket webSocket;
-    bool firstHttpPacket = true;
     bool more_data = false;
 
     _out.printDebug(
         "Listening for incoming packets from client number " + std::to_string(client->socket->GetSocketHandle()) + ".");
     while (!_stopServer) {
       try {
-        bytesRead = client->socket->Read(buffer.data(), buffer.size() - 1, more_data);
-        //Some clients send only one byte in the first packet
-        if (bytesRead == 1 && !binaryRpc.processingStarted() && !http.headerProcessingStarted()
-            && !webSocket.dataProcessingStarted())
-          bytesRead += client->socket->Read(buffer.data() + 1, buffer.size() - 2, more_data);
-        buffer.at(buffer.size() - 1) = '\0'; //Even though it shouldn't matter, make sure there is a null termination.
+        bytesRead = readFromClient(client, buffer, more_data);
       }
       catch (const C1Net::TimeoutException &ex) {
+        //The connection is idle (e.g. keep-alive), so don't keep a grown buffer.
+        buffer.idle();
         continue;
       }
       catch (const C1Net::ClosedException &ex) {
@@ -1409,348 +1668,394 @@ void RpcServer::readClient(std::shared_ptr<Client> client) {
 
       if (!clientValid(client)) break;
 
-      if (GD::bl->debugLevel >= 5) {
-        std::vector<uint8_t> rawPacket(buffer.begin(), buffer.begin() + bytesRead);
-        _out.printDebug("Debug: Packet received: " + BaseLib::HelperFunctions::getHexString(rawPacket));
-      }
+      if (!processClientData(client, buffer.data(), bytesRead)) break;
+      buffer.update(bytesRead);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  //This point is only reached, when stopServer is true, the socket is closed or an error occured
+  endClientConnection(client);
+}
 
-      if (binaryRpc.processingStarted()
-          || (!binaryRpc.processingStarted() && !http.headerProcessingStarted() && !webSocket.dataProcessingStarted()
-              && !strncmp((char *)buffer.data(), "Bin", 3))) {
-        if (!_info->rpcServer) continue;
+int32_t RpcServer::readFromClient(const std::shared_ptr<Client> &client, AdaptiveReadBuffer &buffer, bool &more_data) {
+  int32_t bytesRead = client->socket->Read((uint8_t *)buffer.data(), buffer.size(), more_data);
+  //Some clients send only one byte in the first packet
+  auto &readState = *client->readState;
+  if (bytesRead == 1 && !readState.binaryRpc.processingStarted() && !readState.http.headerProcessingStarted()
+      && !readState.webSocket.dataProcessingStarted())
+    bytesRead += client->socket->Read((uint8_t *)buffer.data() + 1, buffer.size() - 1, more_data);
+  buffer.data()[bytesRead] = '\0'; //Even though it shouldn't matter, make sure there is a null termination.
+  return bytesRead;
+}
 
-        try {
-          processedBytes = 0;
-          bool doBreak = false;
-          while (processedBytes < bytesRead) {
-            processedBytes += binaryRpc.process((char *)buffer.data() + processedBytes, bytesRead - processedBytes);
-            if (binaryRpc.isFinished()) {
-              std::shared_ptr<BaseLib::Rpc::RpcHeader> header = _rpcDecoder->decodeHeader(binaryRpc.getData());
-              if (!client->authenticated && (_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)) {
-                try {
-                  if (!client->auth->basicServer(client->socket, header, client->user, client->acls)) {
-                    if (!(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
-                      _out.printError("Error: Authorization failed. Closing connection.");
-                      doBreak = true;
-                      break;
-                    } else _out.printInfo("Info: Basic authentication failed. Falling back to no authentication.");
-                  } else {
-                    client->authenticated = true;
-                    _out.printDebug(
-                        "Client successfully authorized as user [" + client->user + "] using basic authentication.");
-                  }
-                }
-                catch (AuthException &ex) {
-                  _out.printError(
-                      "Error: Authorization failed. Closing connection. Error was: " + std::string(ex.what()));
-                  doBreak = true;
-                  break;
-                }
-              } else if (!client->authenticated
-                  && !(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
-                _out.printError("Error: Authorization failed for host " + http.getHeader().host + ".");
-                http.reset();
-                doBreak = true;
-                break;
-              }
+bool RpcServer::processClientData(const std::shared_ptr<Client> &client, char *buffer, int32_t bytesRead) {
+  try {
+    auto &packetType = client->readState->packetType;
+    auto &binaryRpc = client->readState->binaryRpc;
+    auto &http = client->readState->http;
+    auto &webSocket = client->readState->webSocket;
+    auto &firstHttpPacket = client->readState->firstHttpPacket;
+    int32_t processedBytes = 0;
 
-              packetType = (binaryRpc.getType()
-                  == BaseLib::Rpc::BinaryRpc::Type::request) ? PacketType::Enum::binaryRequest : PacketType::Enum::binaryResponse;
+    if (GD::bl->debugLevel >= 5) {
+      std::vector<uint8_t> rawPacket(buffer, buffer + bytesRead);
+      _out.printDebug("Debug: Packet received: " + BaseLib::HelperFunctions::getHexString(rawPacket));
+    }
 
-              packetReceived(client, binaryRpc.getData(), packetType, true);
-              binaryRpc.reset();
-            }
-          }
-          if (doBreak) break;
-        }
-        catch (BaseLib::Rpc::BinaryRpcException &ex) {
-          _out.printError(
-              "Error processing binary RPC packet. Closing connection. Error was: " + std::string(ex.what()));
-          binaryRpc.reset();
-          break;
-        }
-        continue;
-      } else if (client->rpcType == BaseLib::RpcType::websocket) {
-        packetType = PacketType::Enum::webSocketRequest;
+    if (binaryRpc.processingStarted()
+        || (!binaryRpc.processingStarted() && !http.headerProcessingStarted() && !webSocket.dataProcessingStarted()
+            && !strncmp(buffer, "Bin", 3))) {
+      if (!_info->rpcServer) return true;
+
+      try {
         processedBytes = 0;
         bool doBreak = false;
         while (processedBytes < bytesRead) {
-          processedBytes += webSocket.process((char *)buffer.data() + processedBytes, bytesRead - processedBytes);
-          if (webSocket.isFinished()) {
-            if (webSocket.getHeader().close) {
-              std::vector<char> response;
-              BaseLib::WebSocket::encode(webSocket.getContent(), BaseLib::WebSocket::Header::Opcode::close, response);
-              sendRPCResponseToClient(client, response, false);
-              closeClientConnection(client);
-            } else if (((_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)
-                || (_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::session))
-                && !client->webSocketAuthorized) {
+          processedBytes += binaryRpc.process(buffer + processedBytes, bytesRead - processedBytes);
+          if (binaryRpc.isFinished()) {
+            std::shared_ptr<BaseLib::Rpc::RpcHeader> header = _rpcDecoder->decodeHeader(binaryRpc.getData());
+            if (!client->authenticated && (_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)) {
               try {
-                if ((_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)
-                    && !client->auth->basicServer(client->socket, webSocket, client->user, client->acls)) {
-                  _out.printError(
-                      "Error: Basic authentication failed for host " + client->address + ". Closing connection.");
-                  std::vector<char> output;
-                  BaseLib::WebSocket::encodeClose(output);
-                  sendRPCResponseToClient(client, output, false);
-                  doBreak = true;
-                  break;
-                } else if ((_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::session)
-                    && !client->auth->sessionServer(client->socket, webSocket, client->user, client->acls)) {
-                  _out.printError(
-                      "Error: Session authentication failed for host " + client->address + ". Closing connection.");
-                  std::vector<char> output;
-                  BaseLib::WebSocket::encodeClose(output);
-                  sendRPCResponseToClient(client, output, false);
-                  doBreak = true;
-                  break;
+                if (!client->auth->basicServer(client->socket, header, client->user, client->acls)) {
+                  if (!(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
+                    _out.printError("Error: Authorization failed. Closing connection.");
+                    doBreak = true;
+                    break;
+                  } else _out.printInfo("Info: Basic authentication failed. Falling back to no authentication.");
                 } else {
-                  client->webSocketAuthorized = true;
-                  if (_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)
-                    _out.printInfo(std::string("Client ")
-                                       + (client->webSocketClient ? "(direction browser => Homegear)" : "(direction Homegear => browser)")
-                                       + " successfully authorized as user [" + client->user
-                                       + "] using basic authentication.");
-                  else if (_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::session)
-                    _out.printInfo(std::string("Client ")
-                                       + (client->webSocketClient ? "(direction browser => Homegear)" : "(direction Homegear => browser)")
-                                       + " successfully authorized as user [" + client->user
-                                       + "] using session authentication.");
-                  if (client->webSocketClient || client->sendEventsToRpcServer) {
-                    _out.printInfo(
-                        "Info: Transferring client number " + std::to_string(client->id) + " to rpc client.");
-                    GD::rpcClient->addWebSocketServer(client->socket,
-                                                      client->webSocketClientId,
-                                                      client,
-                                                      client->address,
-                                                      client->nodeClient);
-                    if (client->webSocketClient) {
-                      C1Net::TcpSocketInfo tcp_socket_info;
-                      auto dummy_socket = std::make_shared<C1Net::Socket>(-1);
-                      client->socket = std::make_shared<C1Net::TcpSocket>(tcp_socket_info, dummy_socket);
-                      client->closed = true;
-                    }
-                  }
+                  client->authenticated = true;
+                  _out.printDebug(
+                      "Client successfully authorized as user [" + client->user + "] using basic authentication.");
                 }
               }
               catch (AuthException &ex) {
-                _out.printError("Error: Authorization failed for host " + http.getHeader().host
-                                    + ". Closing connection. Error was: " + ex.what());
+                _out.printError(
+                    "Error: Authorization failed. Closing connection. Error was: " + std::string(ex.what()));
                 doBreak = true;
                 break;
               }
-            } else if (webSocket.getHeader().opcode == BaseLib::WebSocket::Header::Opcode::ping) {
-              std::vector<char> response;
-              BaseLib::WebSocket::encode(webSocket.getContent(), BaseLib::WebSocket::Header::Opcode::pong, response);
-              sendRPCResponseToClient(client, response, true);
-            } else {
-              packetReceived(client, webSocket.getContent(), packetType, true);
+            } else if (!client->authenticated
+                && !(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
+              _out.printError("Error: Authorization failed for host " + http.getHeader().host + ".");
+              http.reset();
+              doBreak = true;
+              break;
             }
-            webSocket.reset();
-          }
-        }
-        if (doBreak) break;
-        continue;
-      } else //HTTP
-      {
-        bool processHttp = false;
 
-        if (http.headerProcessingStarted()) processHttp = true;
-        else {
-          if (!strncmp((char *)buffer.data(), "GET ", 4) || !strncmp((char *)buffer.data(), "HEAD ", 5)
-              || !strncmp((char *)buffer.data(), "DELETE ", 7)) {
-            buffer.at(bytesRead) = '\0';
-            packetType = PacketType::Enum::xmlRequest;
+            packetType = (binaryRpc.getType()
+                == BaseLib::Rpc::BinaryRpc::Type::request) ? PacketType::Enum::binaryRequest : PacketType::Enum::binaryResponse;
 
-            if (!_info->redirectTo.empty()) {
-              std::vector<char> data;
-              std::vector<std::string> additionalHeaders({std::string("Location: ") + _info->redirectTo});
-              _webServer->getError(301,
-                                   "Moved Permanently",
-                                   "The document has moved <a href=\"" + _info->redirectTo + "\">here</a>.",
-                                   data,
-                                   additionalHeaders);
-              sendRPCResponseToClient(client, data, false);
-              continue;
+            packetReceived(client, binaryRpc.getData(), packetType, true);
+            binaryRpc.reset();
+          }
+        }
+        if (doBreak) return false;
+      }
+      catch (BaseLib::Rpc::BinaryRpcException &ex) {
+        _out.printError(
+            "Error processing binary RPC packet. Closing connection. Error was: " + std::string(ex.what()));
+        binaryRpc.reset();
+        return false;
+      }
+      return true;
+    } else if (client->rpcType == BaseLib::RpcType::websocket) {
+      packetType = PacketType::Enum::webSocketRequest;
+      processedBytes = 0;
+      bool doBreak = false;
+      while (processedBytes < bytesRead) {
+        processedBytes += webSocket.process(buffer + processedBytes, bytesRead - processedBytes);
+        if (webSocket.isFinished()) {
+          if (webSocket.getHeader().close) {
+            std::vector<char> response;
+            BaseLib::WebSocket::encode(webSocket.getContent(), BaseLib::WebSocket::Header::Opcode::close, response);
+            sendRPCResponseToClient(client, response, false);
+            closeClientConnection(client);
+          } else if (((_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)
+              || (_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::session))
+              && !client->webSocketAuthorized) {
+            try {
+              if ((_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)
+                  && !client->auth->basicServer(client->socket, webSocket, client->user, client->acls)) {
+                _out.printError(
+                    "Error: Basic authentication failed for host " + client->address + ". Closing connection.");
+                std::vector<char> output;
+                BaseLib::WebSocket::encodeClose(output);
+                sendRPCResponseToClient(client, output, false);
+                doBreak = true;
+                break;
+              } else if ((_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::session)
+                  && !client->auth->sessionServer(client->socket, webSocket, client->user, client->acls)) {
+                _out.printError(
+                    "Error: Session authentication failed for host " + client->address + ". Closing connection.");
+                std::vector<char> output;
+                BaseLib::WebSocket::encodeClose(output);
+                sendRPCResponseToClient(client, output, false);
+                doBreak = true;
+                break;
+              } else {
+                client->webSocketAuthorized = true;
+                if (_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)
+                  _out.printInfo(std::string("Client ")
+                                     + (client->webSocketClient ? "(direction browser => Homegear)" : "(direction Homegear => browser)")
+                                     + " successfully authorized as user [" + client->user
+                                     + "] using basic authentication.");
+                else if (_info->websocketAuthType & BaseLib::Rpc::ServerInfo::Info::AuthType::session)
+                  _out.printInfo(std::string("Client ")
+                                     + (client->webSocketClient ? "(direction browser => Homegear)" : "(direction Homegear => browser)")
+                                     + " successfully authorized as user [" + client->user
+                                     + "] using session authentication.");
+                if (client->webSocketClient || client->sendEventsToRpcServer) {
+                  _out.printInfo(
+                      "Info: Transferring client number " + std::to_string(client->id) + " to rpc client.");
+                  GD::rpcClient->addWebSocketServer(client->socket,
+                                                    client->webSocketClientId,
+                                                    client,
+                                                    client->address,
+                                                    client->nodeClient);
+                  if (client->webSocketClient) {
+                    C1Net::TcpSocketInfo tcp_socket_info;
+                    auto dummy_socket = std::make_shared<C1Net::Socket>(-1);
+                    client->socket = std::make_shared<C1Net::TcpSocket>(tcp_socket_info, dummy_socket);
+                    client->closed = true;
+                  }
+                }
+              }
             }
-            if (!_info->webServer && !_info->restServer) {
-              std::vector<char> data;
-              _webServer->getError(400,
-                                   "Bad Request",
-                                   "Your client sent a request that this server could not understand.",
-                                   data);
-              sendRPCResponseToClient(client, data, false);
-              continue;
+            catch (AuthException &ex) {
+              _out.printError("Error: Authorization failed for host " + http.getHeader().host
+                                  + ". Closing connection. Error was: " + ex.what());
+              doBreak = true;
+              break;
             }
-
-            processHttp = true;
-            http.reset();
-          } else if (!strncmp((char *)buffer.data(), "POST", 4) || !strncmp((char *)buffer.data(), "PUT", 3)
-              || !strncmp((char *)buffer.data(), "HTTP/1.", 7)) {
-            if (bytesRead < 8) continue;
-            buffer.at(bytesRead) = '\0';
-            packetType = (!strncmp((char *)buffer.data(), "POST", 4)) || (!strncmp((char *)buffer.data(),
-                                                                                   "PUT",
-                                                                                   3)) ? PacketType::Enum::xmlRequest : PacketType::Enum::xmlResponse;
-
-            processHttp = true;
-            http.reset();
+          } else if (webSocket.getHeader().opcode == BaseLib::WebSocket::Header::Opcode::ping) {
+            std::vector<char> response;
+            BaseLib::WebSocket::encode(webSocket.getContent(), BaseLib::WebSocket::Header::Opcode::pong, response);
+            sendRPCResponseToClient(client, response, true);
           } else {
-            _out.printError("Error: Uninterpretable packet received. Closing connection. Packet was: "
-                                + std::string(buffer.begin(), buffer.begin() + bytesRead));
-            break;
+            packetReceived(client, webSocket.getContent(), packetType, true);
           }
+          webSocket.reset();
         }
+      }
+      if (doBreak) return false;
+      return true;
+    } else //HTTP
+    {
+      bool processHttp = false;
 
-        if (processHttp) {
-          try {
-            bool doBreak = false;
-            processedBytes = 0;
-            while (processedBytes < bytesRead) {
-              processedBytes += http.process((char *)buffer.data() + processedBytes, bytesRead - processedBytes);
+      if (http.headerProcessingStarted()) processHttp = true;
+      else {
+        if (!strncmp(buffer, "GET ", 4) || !strncmp(buffer, "HEAD ", 5)
+            || !strncmp(buffer, "DELETE ", 7)) {
+          buffer[bytesRead] = '\0';
+          packetType = PacketType::Enum::xmlRequest;
 
-              if (http.getContentSize() > 104857600) {
-                http.reset();
-                std::vector<char> data;
-                _webServer->getError(400, "Bad Request", "Your client sent a request larger than 100 MiB.", data);
-                sendRPCResponseToClient(client, data, false);
-                doBreak = true;
-                break;
-              }
+          if (!_info->redirectTo.empty()) {
+            std::vector<char> data;
+            std::vector<std::string> additionalHeaders({std::string("Location: ") + _info->redirectTo});
+            _webServer->getError(301,
+                                 "Moved Permanently",
+                                 "The document has moved <a href=\"" + _info->redirectTo + "\">here</a>.",
+                                 data,
+                                 additionalHeaders);
+            sendRPCResponseToClient(client, data, false);
+            return true;
+          }
+          if (!_info->webServer && !_info->restServer) {
+            std::vector<char> data;
+            _webServer->getError(400,
+                                 "Bad Request",
+                                 "Your client sent a request that this server could not understand.",
+                                 data);
+            sendRPCResponseToClient(client, data, false);
+            return true;
+          }
+
+          processHttp = true;
+          http.reset();
+        } else if (!strncmp(buffer, "POST", 4) || !strncmp(buffer, "PUT", 3)
+            || !strncmp(buffer, "HTTP/1.", 7)) {
+          if (bytesRead < 8) return true;
+          buffer[bytesRead] = '\0';
+          packetType = (!strncmp(buffer, "POST", 4)) || (!strncmp(buffer, "PUT", 3)) ? PacketType::Enum::xmlRequest : PacketType::Enum::xmlResponse;
+
+          processHttp = true;
+          http.reset();
+        } else {
+          _out.printError("Error: Uninterpretable packet received. Closing connection. Packet was: "
+                              + std::string(buffer, bytesRead));
+          return false;
+        }
+      }
+
+      if (processHttp) {
+        try {
+          bool doBreak = false;
+          processedBytes = 0;
+          while (processedBytes < bytesRead) {
+            processedBytes += http.process(buffer + processedBytes, bytesRead - processedBytes);
+
+            if (http.getContentSize() > 104857600) {
+              http.reset();
+              std::vector<char> data;
+              _webServer->getError(400, "Bad Request", "Your client sent a request larger than 100 MiB.", data);
+              sendRPCResponseToClient(client, data, false);
+              doBreak = true;
+              break;
+            }
 
-              if (http.isFinished()) {
-                //{{{ Cloud authentication
-                if (firstHttpPacket) {
-                  firstHttpPacket = false;
-                  auto header = http.getHeader();
-                  auto userTypeIterator = header.fields.find("c1-user-type");
-                  if (userTypeIterator != header.fields.end() && !userTypeIterator->second.empty() && userTypeIterator->second != "unknown") {
-                    auto userMapIterator = _cloudUserMap.find(userTypeIterator->second);
-                    if (userMapIterator != _cloudUserMap.end()) {
-                      auto userIdIterator = header.fields.find("c1-userid");
-                      if (userIdIterator != header.fields.end()) {
-                        auto userMapIterator2 = userMapIterator->second.find(userIdIterator->second);
-                        if (userMapIterator2 == userMapIterator->second.end()) userMapIterator2 = userMapIterator->second.find("*");
-                        if (userMapIterator2 != userMapIterator->second.end()) {
-                          if (client->acls->fromUser(userMapIterator2->second)) {
-                            client->user = userMapIterator2->second;
-                            client->authenticated = true;
-                            _out.printInfo("Info: Client successfully authorized as user [" + client->user
-                                               + "] using cloud authentication. Cloud user ID is: "
-                                               + userMapIterator->first);
-                          }
+            if (http.isFinished()) {
+              //{{{ Cloud authentication
+              if (firstHttpPacket) {
+                firstHttpPacket = false;
+                auto header = http.getHeader();
+                auto userTypeIterator = header.fields.find("c1-user-type");
+                if (userTypeIterator != header.fields.end() && !userTypeIterator->second.empty() && userTypeIterator->second != "unknown") {
+                  auto userMapIterator = _cloudUserMap.find(userTypeIterator->second);
+                  if (userMapIterator != _cloudUserMap.end()) {
+                    auto userIdIterator = header.fields.find("c1-userid");
+                    if (userIdIterator != header.fields.end()) {
+                      auto userMapIterator2 = userMapIterator->second.find(userIdIterator->second);
+                      if (userMapIterator2 == userMapIterator->second.end()) userMapIterator2 = userMapIterator->second.find("*");
+                      if (userMapIterator2 != userMapIterator->second.end()) {
+                        bool aclsLoaded = client->acls->fromUser(userMapIterator2->second);
+                        GD::aclCache.invalidate(client->acls);
+                        if (aclsLoaded) {
+                          client->user = userMapIterator2->second;
+                          client->authenticated = true;
+                          _out.printInfo("Info: Client successfully authorized as user [" + client->user
+                                             + "] using cloud authentication. Cloud user ID is: "
+                                             + userMapIterator->first);
                         }
                       }
                     }
                   }
                 }
-                //}}}
+              }
+              //}}}
+
+              if (_info->webSocket && (http.getHeader().connection & BaseLib::Http::Connection::upgrade)) {
+                if (http.getHeader().path.compare(0, 11, "/node-blue/") == 0) {
+                  GD::nodeBlueServer->getNoderedWebsocket()->handoverClient(client->socket, http);
+                  C1Net::TcpSocketInfo tcp_socket_info;
+                  auto dummy_socket = std::make_shared<C1Net::Socket>(-1);
+                  client->socket = std::make_shared<C1Net::TcpSocket>(tcp_socket_info, dummy_socket);
+                  client->closed = true;
+                  continue;
+                } else {
+                  //Do this before basic auth, because currently basic auth is not supported by WebSockets. Authorization takes place after the upgrade.
+                  handleConnectionUpgrade(client, http);
+                  http.reset();
+                  continue;
+                }
+              }
 
-                if (_info->webSocket && (http.getHeader().connection & BaseLib::Http::Connection::upgrade)) {
-                  if (http.getHeader().path.compare(0, 11, "/node-blue/") == 0) {
-                    GD::nodeBlueServer->getNoderedWebsocket()->handoverClient(client->socket, http);
-                    C1Net::TcpSocketInfo tcp_socket_info;
-                    auto dummy_socket = std::make_shared<C1Net::Socket>(-1);
-                    client->socket = std::make_shared<C1Net::TcpSocket>(tcp_socket_info, dummy_socket);
-                    client->closed = true;
-                    continue;
+              if (!client->authenticated && (_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)) {
+                try {
+                  if (!client->auth->basicServer(client->socket, http, client->user, client->acls)) {
+                    if (!(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
+                      _out.printError(
+                          "Error: Authorization failed for host " + http.getHeader().host + ". Closing connection.");
+                      http.reset();
+                      doBreak = true;
+                      break;
+                    } else _out.printInfo("Info: Basic authentication failed. Falling back to no authentication.");
                   } else {
-                    //Do this before basic auth, because currently basic auth is not supported by WebSockets. Authorization takes place after the upgrade.
-                    handleConnectionUpgrade(client, http);
-                    http.reset();
-                    continue;
+                    client->authenticated = true;
+                    _out.printInfo("Info: Client successfully authorized as user [" + client->user
+                                       + "] using basic authentication.");
                   }
                 }
-
-                if (!client->authenticated && (_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::basic)) {
-                  try {
-                    if (!client->auth->basicServer(client->socket, http, client->user, client->acls)) {
-                      if (!(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
-                        _out.printError(
-                            "Error: Authorization failed for host " + http.getHeader().host + ". Closing connection.");
-                        http.reset();
-                        doBreak = true;
-                        break;
-                      } else _out.printInfo("Info: Basic authentication failed. Falling back to no authentication.");
-                    } else {
-                      client->authenticated = true;
-                      _out.printInfo("Info: Client successfully authorized as user [" + client->user
-                                         + "] using basic authentication.");
-                    }
-                  }
-                  catch (AuthException &ex) {
-                    _out.printError("Error: Authorization failed for host " + http.getHeader().host
-                                        + ". Closing connection. Error was: " + ex.what());
-                    http.reset();
-                    doBreak = true;
-                    break;
-                  }
-                } else if (!client->authenticated
-                    && !(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
-                  _out.printError("Error: Authorization failed for host " + http.getHeader().host + ".");
+                catch (AuthException &ex) {
+                  _out.printError("Error: Authorization failed for host " + http.getHeader().host
+                                      + ". Closing connection. Error was: " + ex.what());
                   http.reset();
                   doBreak = true;
                   break;
                 }
-                if (_info->restServer && http.getHeader().path.compare(0, 5, "/api/") == 0) {
-                  if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Packet is handled by REST server.");
-                  _restServer->process(client, http, client->socket);
-                } else if (_info->webServer && (
-                    !_info->rpcServer ||
-                        (http.getHeader().method != "POST" && http.getType() != BaseLib::Http::Type::Enum::response) ||
-                        (!http.getHeader().contentType.empty() && http.getHeader().contentType != "text/xml" && http.getHeader().contentType != "application/json") ||
-                        http.getHeader().path.compare(0, 11, "/node-blue/") == 0 ||
-                        http.getHeader().path.compare(0, 4, "/ui/") == 0 ||
-                        http.getHeader().path.compare(0, 7, "/admin/") == 0
-                )) {
-                  if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Packet is handled by webserver.");
-                  client->rpcType = BaseLib::RpcType::webserver;
-                  http.getHeader().remoteAddress = client->address;
-                  http.getHeader().remotePort = client->port;
-                  if (http.getHeader().method == "POST" || http.getHeader().method == "PUT")
-                    _webServer->post(client,
-                                     http,
-                                     client->socket);
-                  else if (http.getHeader().method == "GET" || http.getHeader().method == "HEAD")
-                    _webServer->get(client, http, client->socket, _info->cacheAssets);
-                  else if (http.getHeader().method == "DELETE") _webServer->delete_(client, http, client->socket);
-                  if (http.getHeader().connection & BaseLib::Http::Connection::Enum::close)
-                    closeClientConnection(client);
-                  client->lastReceivedPacket = BaseLib::HelperFunctions::getTime();
-                } else if (http.getContentSize() > 0 && _info->rpcServer) {
-                  if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Packet is handled by RPC server.");
-                  if (http.getHeader().contentType == "application/json" || http.getContent().at(0) == '{')
-                    packetType = (packetType == PacketType::xmlRequest || packetType == PacketType::jsonRequest) ? PacketType::jsonRequest : PacketType::jsonResponse;
-                  packetReceived(client,
-                                 http.getContent(),
-                                 packetType,
-                                 http.getHeader().connection & BaseLib::Http::Connection::Enum::keepAlive);
-                }
+              } else if (!client->authenticated
+                  && !(_info->authType & BaseLib::Rpc::ServerInfo::Info::AuthType::none)) {
+                _out.printError("Error: Authorization failed for host " + http.getHeader().host + ".");
                 http.reset();
-                if (!client->socket->IsValid()) {
-                  if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Connection to client number " + std::to_string(client->socket->GetSocketHandle()) + " closed.");
-                  if (processedBytes < bytesRead)
-                    _out.printInfo("Info: " + std::to_string(bytesRead - processedBytes) + " bytes are not processed, because connection to client number " + std::to_string(client->socket->GetSocketHandle()) + " was closed.");
-                  break;
-                }
+                doBreak = true;
+                break;
+              }
+              if (_info->restServer && http.getHeader().path.compare(0, 5, "/api/") == 0) {
+                if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Packet is handled by REST server.");
+                _restServer->process(client, http, client->socket);
+              } else if (_info->webServer && (
+                  !_info->rpcServer ||
+                      (http.getHeader().method != "POST" && http.getType() != BaseLib::Http::Type::Enum::response) ||
+                      (!http.getHeader().contentType.empty() && http.getHeader().contentType != "text/xml" && http.getHeader().contentType != "application/json") ||
+                      http.getHeader().path.compare(0, 11, "/node-blue/") == 0 ||
+                      http.getHeader().path.compare(0, 4, "/ui/") == 0 ||
+                      http.getHeader().path.compare(0, 7, "/admin/") == 0
+              )) {
+                if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Packet is handled by webserver.");
+                client->rpcType = BaseLib::RpcType::webserver;
+                http.getHeader().remoteAddress = client->address;
+                http.getHeader().remotePort = client->port;
+                if (http.getHeader().method == "POST" || http.getHeader().method == "PUT")
+                  _webServer->post(client,
+                                   http,
+                                   client->socket);
+                else if (http.getHeader().method == "GET" || http.getHeader().method == "HEAD")
+                  _webServer->get(client, http, client->socket, _info->cacheAssets);
+                else if (http.getHeader().method == "DELETE") _webServer->delete_(client, http, client->socket);
+                if (http.getHeader().connection & BaseLib::Http::Connection::Enum::close)
+                  closeClientConnection(client);
+                client->lastReceivedPacket = BaseLib::HelperFunctions::getTime();
+              } else if (http.getContentSize() > 0 && _info->rpcServer) {
+                if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Packet is handled by RPC server.");
+                if (http.getHeader().contentType == "application/json" || http.getContent().at(0) == '{')
+                  packetType = (packetType == PacketType::xmlRequest || packetType == PacketType::jsonRequest) ? PacketType::jsonRequest : PacketType::jsonResponse;
+                packetReceived(client,
+                               http.getContent(),
+                               packetType,
+                               http.getHeader().connection & BaseLib::Http::Connection::Enum::keepAlive);
+              }
+              http.reset();
+              if (!client->socket->IsValid()) {
+                if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Connection to client number " + std::to_string(client->socket->GetSocketHandle()) + " closed.");
+                if (processedBytes < bytesRead)
+                  _out.printInfo("Info: " + std::to_string(bytesRead - processedBytes) + " bytes are not processed, because connection to client number " + std::to_string(client->socket->GetSocketHandle()) + " was closed.");
+                break;
               }
             }
-            if (doBreak) break;
-          }
-          catch (BaseLib::HttpException &ex) {
-            _out.printError("XML RPC Server: Could not process HTTP packet: " + std::string(ex.what()) + " Buffer: "
-                                + std::string(buffer.begin(), buffer.begin() + bytesRead));
-            std::vector<char> data;
-            _webServer->getError(400,
-                                 "Bad Request",
-                                 "Your client sent a request that this server could not understand.",
-                                 data);
-            sendRPCResponseToClient(client, data, false);
-            break;
           }
+          if (doBreak) return false;
+        }
+        catch (BaseLib::HttpException &ex) {
+          _out.printError("XML RPC Server: Could not process HTTP packet: " + std::string(ex.what()) + " Buffer: "
+                              + std::string(buffer, bytesRead));
+          std::vector<char> data;
+          _webServer->getError(400,
+                               "Bad Request",
+                               "Your client sent a request that this server could not understand.",
+                               data);
+          sendRPCResponseToClient(client, data, false);
+          return false;
         }
       }
     }
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return false;
+}
+
+void RpcServer::endClientConnection(const std::shared_ptr<Client> &client) {
+  try {
     if (client->rpcType == BaseLib::RpcType::websocket) //Send close packet
     {
       std::vector<char> payload;
@@ -1765,18 +2070,223 @@ void RpcServer::readClient(std::shared_ptr<Client> client) {
   catch (...) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
   }
-  //This point is only reached, when stopServer is true, the socket is closed or an error occured
   closeClientConnection(client);
 }
 
+//{{{ Event-driven mode
+void RpcServer::startEventProcessing() {
+  try {
+    uint32_t ioThreadCount = GD::tuningSettings.rpcServerIoThreads();
+    for (uint32_t i = 0; i < ioThreadCount; i++) {
+      int32_t epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+      if (epollDescriptor == -1) {
+        _out.printError("Error: Could not create epoll instance: " + std::string(strerror(errno)));
+        break;
+      }
+      _epollDescriptors.push_back(epollDescriptor);
+    }
+    if (_epollDescriptors.empty()) {
+      _out.printError("Error: Falling back to one thread per connection.");
+      _eventDriven = false;
+      return;
+    }
+
+    startQueue(0, true, GD::tuningSettings.rpcServerWorkerThreads(), _threadPriority, _threadPolicy);
+    _ioThreads.resize(_epollDescriptors.size());
+    for (int32_t i = 0; i < (int32_t)_ioThreads.size(); i++) {
+      GD::bl->threadManager.start(_ioThreads[i], true, _threadPriority, _threadPolicy, &RpcServer::ioThread, this, i);
+    }
+    _out.printInfo("Info: Using event-driven connection handling with " + std::to_string(_ioThreads.size()) + " I/O threads and "
+                       + std::to_string(GD::tuningSettings.rpcServerWorkerThreads()) + " worker threads.");
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void RpcServer::stopEventProcessing() {
+  try {
+    for (auto &ioThread: _ioThreads) {
+      GD::bl->threadManager.join(ioThread);
+    }
+    _ioThreads.clear();
+    stopQueue(0);
+    for (auto epollDescriptor: _epollDescriptors) {
+      close(epollDescriptor);
+    }
+    _epollDescriptors.clear();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool RpcServer::addClientToEventLoop(const std::shared_ptr<Client> &client) {
+  try {
+    if (_epollDescriptors.empty()) return false;
+    client->epollDescriptor = _epollDescriptors.at(_nextIoThread++ % _epollDescriptors.size());
+    client->eventToken = ((uint64_t)_nextEventGeneration++ << 32) | (uint32_t)client->id;
+
+    auto tlsSession = client->socket->GetTlsSessionHandle();
+    if (tlsSession) {
+      //Lets worker threads read without blocking (see readFromClientNonBlocking()).
+      gnutls_transport_set_pull_function(tlsSession, &tlsPull);
+
+      //Data received together with the TLS handshake might already be buffered by GnuTLS, which epoll can't see. The
+      //client is registered with epoll after this data was processed.
+      if (gnutls_record_check_pending(tlsSession) > 0) {
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<ClientQueueEntry>(client);
+        return enqueue(0, entry);
+      }
+    }
+
+    return armClient(client);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+bool RpcServer::armClient(const std::shared_ptr<Client> &client) {
+  try {
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    event.data.u64 = client->eventToken;
+    if (epoll_ctl(client->epollDescriptor, EPOLL_CTL_MOD, client->id, &event) == 0) return true;
+    if (errno == ENOENT && epoll_ctl(client->epollDescriptor, EPOLL_CTL_ADD, client->id, &event) == 0) return true;
+    _out.printError("Error: Could not register client number " + std::to_string(client->id) + " with epoll: " + std::string(strerror(errno)));
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void RpcServer::ioThread(int32_t index) {
+  try {
+    int32_t epollDescriptor = _epollDescriptors.at(index);
+    std::array<epoll_event, 64> events{};
+    while (!_stopServer) {
+      int32_t eventCount = epoll_wait(epollDescriptor, events.data(), events.size(), 100);
+      if (eventCount == -1) {
+        if (errno == EINTR) continue;
+        _out.printError("Error: Could not wait for client data: " + std::string(strerror(errno)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+
+      for (int32_t i = 0; i < eventCount; i++) {
+        std::shared_ptr<Client> client;
+        {
+          std::lock_guard<std::mutex> stateGuard(_stateMutex);
+          auto clientIterator = _clients.find((int32_t)(uint32_t)events[i].data.u64);
+          if (clientIterator != _clients.end()) client = clientIterator->second;
+        }
+        //The file descriptor might have been reused by a new connection since the event was queued.
+        if (!client || client->closed || client->eventToken != events[i].data.u64) continue;
+
+        std::shared_ptr<BaseLib::IQueueEntry> entry = std::make_shared<ClientQueueEntry>(client);
+        if (!enqueue(0, entry)) closeClientConnection(client);
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+RpcServer::NonBlockingReadResult RpcServer::readFromClientNonBlocking(const std::shared_ptr<Client> &client, AdaptiveReadBuffer &buffer, int32_t &bytesRead) {
+  auto tlsSession = client->socket->GetTlsSessionHandle();
+  ssize_t result = 0;
+  if (tlsSession) {
+    nonBlockingTlsRead = true;
+    result = gnutls_record_recv(tlsSession, buffer.data(), buffer.size());
+    nonBlockingTlsRead = false;
+    if (result == GNUTLS_E_AGAIN || result == GNUTLS_E_INTERRUPTED) return NonBlockingReadResult::wouldBlock;
+    if (result < 0) {
+      if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Error reading from client number " + std::to_string(client->id) + ": " + gnutls_strerror((int)result));
+      return NonBlockingReadResult::closed;
+    }
+  } else {
+    result = recv(client->socket->GetSocketHandle(), buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (result == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return NonBlockingReadResult::wouldBlock;
+      if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: Error reading from client number " + std::to_string(client->id) + ": " + std::string(strerror(errno)));
+      return NonBlockingReadResult::closed;
+    }
+  }
+  if (result == 0) return NonBlockingReadResult::closed;
+
+  bytesRead = (int32_t)result;
+  buffer.data()[bytesRead] = '\0';
+  return NonBlockingReadResult::data;
+}
+
+bool RpcServer::readClientData(const std::shared_ptr<Client> &client) {
+  try {
+    //Only one buffer per worker thread is needed, as a worker processes one client at a time.
+    thread_local AdaptiveReadBuffer buffer(GD::tuningSettings.rpcServerReadBufferSize(), GD::tuningSettings.rpcServerMaxReadBufferSize());
+    int32_t bytesRead = 0;
+
+    //Read until the socket would block. This also consumes data already decrypted by GnuTLS, which epoll can't see.
+    while (!client->closed && !_stopServer) {
+      auto result = readFromClientNonBlocking(client, buffer, bytesRead);
+      if (result == NonBlockingReadResult::wouldBlock) {
+        //The client goes back to epoll and might stay idle. The buffer grows again quickly when the upload continues.
+        buffer.idle();
+        return true;
+      } else if (result == NonBlockingReadResult::closed) {
+        buffer.idle();
+        return false;
+      }
+
+      if (!clientValid(client)) return false;
+
+      if (!processClientData(client, buffer.data(), bytesRead)) return false;
+      buffer.update(bytesRead);
+    }
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return false;
+}
+
+void RpcServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry> &entry) {
+  try {
+    auto queueEntry = std::dynamic_pointer_cast<ClientQueueEntry>(entry);
+    if (!queueEntry || queueEntry->client->closed) return;
+    auto &client = queueEntry->client;
+
+    if (!readClientData(client) || _stopServer) {
+      endClientConnection(client);
+      return;
+    }
+
+    //The connection was closed or handed over to the RPC client or Node-BLUE while processing the data.
+    if (client->closed) return;
+
+    if (!armClient(client)) closeClientConnection(client);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+//}}}
+
 C1Net::PSocket RpcServer::getClientSocketDescriptor(std::string &address, int32_t &port) {
   C1Net::PSocket socket_descriptor;
   try {
     {
       //Don't lock _stateMutex => no synchronisation needed
-      if (_clients.size() > GD::bl->settings.rpcServerMaxConnections()) {
+      if (_clients.size() > _maxConnections) {
         collectGarbage();
-        if (_clients.size() > GD::bl->settings.rpcServerMaxConnections()) {
+        if (_clients.size() > _maxConnections) {
           _out.printError(
               "Error: There are too many clients connected to me. Closing oldest connection. You can increase the number of allowed connections in main.conf.");
 
@@ -1809,7 +2319,7 @@ C1Net::PSocket RpcServer::getClientSocketDescriptor(std::string &address, int32_
         GD::out.printError("Error polling server socket descriptor: " + std::string(strerror(errno)));
         return socket_descriptor;
       } else if (poll_result == 0) {
-        if (BaseLib::HelperFunctions::getTime() - _lastGargabeCollection > 60000 || _clients.size() > GD::bl->settings.rpcServerMaxConnections() * 100 / 112) {
+        if (BaseLib::HelperFunctions::getTime() - _lastGargabeCollection > 60000 || _clients.size() > _maxConnections * 100 / 112) {
           collectGarbage();
         }
         return socket_descriptor;
@@ -34,6 +34,7 @@
 #include "RpcMethods/RPCMethods.h"
 #include "Auth.h"
 #include "RestServer.h"
+#include "AdaptiveReadBuffer.h"
 #include "../WebServer/WebServer.h"
 #include <homegear-base/BaseLib.h>
 
@@ -43,6 +44,7 @@
 #include <list>
 #include <mutex>
 #include <memory>
+#include <functional>
 
 #include <gnutls/gnutls.h>
 
@@ -55,21 +57,8 @@ class SocketBindException : public C1Net::Exception {
   explicit SocketBindException(const std::string &message) : C1Net::Exception(message) {}
 };
 
-class RpcServer {
+class RpcServer : public BaseLib::IQueue {
  public:
-  class Client : public BaseLib::RpcClientInfo {
-   public:
-    bool webSocketClient = false;
-    bool webSocketAuthorized = false;
-    bool nodeClient = false;
-    std::thread readThread;
-    std::shared_ptr<Auth> auth;
-
-    Client();
-
-    virtual ~Client();
-  };
-
   struct PacketType {
     enum Enum {
       xmlRequest,
@@ -83,6 +72,44 @@ class RpcServer {
     };
   };
 
+  /**
+   * Parser state of a client connection. It is kept between reads, so in event-driven mode the data of a connection
+   * can be processed by any worker thread.
+   */
+  struct ReadState {
+    explicit ReadState(BaseLib::SharedObjects *bl) : binaryRpc(bl) {}
+
+    PacketType::Enum packetType = PacketType::binaryRequest;
+    BaseLib::Rpc::BinaryRpc binaryRpc;
+    BaseLib::Http http;
+    BaseLib::WebSocket webSocket;
+    bool firstHttpPacket = true;
+  };
+
+  class Client : public BaseLib::RpcClientInfo {
+   public:
+    bool webSocketClient = false;
+    bool webSocketAuthorized = false;
+    bool nodeClient = false;
+    std::thread readThread;
+    std::shared_ptr<Auth> auth;
+    std::unique_ptr<ReadState> readState;
+
+    /**
+     * The epoll instance the client is registered with in event-driven mode.
+     */
+    int32_t epollDescriptor = -1;
+    /**
+     * Identifies the client in epoll events. Contains a generation next to the client ID, so events of a closed
+     * connection are not mistaken for events of a new connection reusing its file descriptor.
+     */
+    uint64_t eventToken = 0;
+
+    Client();
+
+    virtual ~Client();
+  };
+
   RpcServer();
 
   virtual ~RpcServer();
@@ -113,11 +140,37 @@ class RpcServer {
                                 const std::string &methodName,
                                 BaseLib::PVariable &parameters);
 
+  /**
+   * Executes the requests of a JSON-RPC 2.0 batch. Requests without "id" are notifications and get no response.
+   *
+   * @param clientInfo The calling client.
+   * @param batch The decoded batch array.
+   * @param responseCallback When set, it is called with every encoded response as soon as it is available. The calls
+   * are serialized.
+   * @return Without "responseCallback", returns all responses as one JSON array. The array is empty when the batch only
+   * contained notifications.
+   */
+  std::vector<char> callBatch(const BaseLib::PRpcClientInfo &clientInfo,
+                              const BaseLib::PVariable &batch,
+                              const std::function<void(const std::vector<char> &response)> &responseCallback = nullptr);
+
+  /**
+   * Returns the number, sizes and latencies of the processed JSON-RPC batches.
+   */
+  BaseLib::PVariable getStatistics();
+
   BaseLib::PEventHandler addWebserverEventHandler(BaseLib::Rpc::IWebserverEventSink *eventHandler);
 
   void removeWebserverEventHandler(BaseLib::PEventHandler eventHandler);
  protected:
  private:
+  class ClientQueueEntry : public BaseLib::IQueueEntry {
+   public:
+    explicit ClientQueueEntry(std::shared_ptr<Client> client) : client(std::move(client)) {}
+
+    std::shared_ptr<Client> client;
+  };
+
   BaseLib::Output _out;
   BaseLib::Rpc::PServerInfo _info;
   gnutls_certificate_credentials_t _x509Cred = nullptr;
@@ -146,6 +199,24 @@ class RpcServer {
   std::pair<std::atomic<int64_t>, std::atomic<bool>> lifetick_1_;
   std::pair<std::atomic<int64_t>, std::atomic<bool>> lifetick_2_;
   std::unordered_map<std::string, std::unordered_map<std::string, std::string>> _cloudUserMap;
+  uint32_t _maxConnections = 50;
+
+  // {{{ Event-driven mode
+  bool _eventDriven = false;
+  std::vector<int32_t> _epollDescriptors;
+  std::vector<std::thread> _ioThreads;
+  std::atomic<uint32_t> _nextIoThread{0};
+  std::atomic<uint32_t> _nextEventGeneration{0};
+  // }}}
+
+  // {{{ Batch statistics
+  std::mutex _batchStatisticsMutex;
+  uint64_t _batchCount = 0;
+  uint64_t _batchRequestCount = 0;
+  uint64_t _maxBatchSize = 0;
+  int64_t _batchTime = 0;
+  int64_t _maxBatchTime = 0;
+  // }}}
 
   void collectGarbage();
 
@@ -159,6 +230,82 @@ class RpcServer {
 
   void readClient(std::shared_ptr<Client> client);
 
+  /**
+   * Reads from a client into "buffer" and null terminates the data. Throws the exceptions of C1Net::TcpSocket::Read().
+   *
+   * @return Returns the number of bytes read.
+   */
+  int32_t readFromClient(const std::shared_ptr<Client> &client, AdaptiveReadBuffer &buffer, bool &more_data);
+
+  /**
+   * Processes data read from a client.
+   *
+   * @param client The client the data was received from.
+   * @param buffer The data. The buffer must have space for a null termination after the data.
+   * @param bytesRead The number of bytes in buffer.
+   * @return Returns false when the connection needs to be closed.
+   */
+  bool processClientData(const std::shared_ptr<Client> &client, char *buffer, int32_t bytesRead);
+
+  /**
+   * Sends a WebSocket close packet if necessary and closes the connection. Called when reading from a client ended.
+   */
+  void endClientConnection(const std::shared_ptr<Client> &client);
+
+  // {{{ Event-driven mode
+  enum class NonBlockingReadResult {
+    data,
+    wouldBlock,
+    closed
+  };
+
+  void startEventProcessing();
+
+  void stopEventProcessing();
+
+  /**
+   * Registers a newly accepted client with one of the epoll instances.
+   *
+   * @return Returns false when the client could not be registered.
+   */
+  bool addClientToEventLoop(const std::shared_ptr<Client> &client);
+
+  /**
+   * (Re)enables notifications for incoming data of a client.
+   */
+  bool armClient(const std::shared_ptr<Client> &client);
+
+  /**
+   * Waits for incoming data on the clients registered with one epoll instance and queues the clients for
+   * processing. Clients are registered with EPOLLONESHOT, so a client is never processed by two workers at the same
+   * time. It is rearmed after its data was processed.
+   */
+  void ioThread(int32_t index);
+
+  /**
+   * Reads from a client without blocking and null terminates the data. TLS records which are not complete yet are
+   * buffered by GnuTLS until the rest arrives.
+   *
+   * @param bytesRead The number of bytes read when "data" is returned.
+   */
+  NonBlockingReadResult readFromClientNonBlocking(const std::shared_ptr<Client> &client, AdaptiveReadBuffer &buffer, int32_t &bytesRead);
+
+  /**
+   * Reads and processes all data available from a client until the socket would block. Called by the worker threads.
+   *
+   * @return Returns false when the connection needs to be closed.
+   */
+  bool readClientData(const std::shared_ptr<Client> &client);
+
+  void processQueueEntry(int32_t index, std::shared_ptr<BaseLib::IQueueEntry> &entry) override;
+  // }}}
+
+  /**
+   * Encodes a JSON-RPC response to a batch request echoing the original "id" of the request. "messageId" is encoded as
+   * null when empty.
+   */
+  void encodeBatchResponse(const BaseLib::PVariable &result, const BaseLib::PVariable &messageId, std::vector<char> &data);
+
   void sendRPCResponseToClient(std::shared_ptr<Client> client,
                                const BaseLib::PVariable &variable,
                                int32_t messageId,
@@ -179,6 +326,15 @@ class RpcServer {
                   PacketType::Enum packetType,
                   bool keepAlive);
 
+  /**
+   * Executes a JSON-RPC batch received from a client. HTTP clients get one combined response, WebSocket clients get
+   * every response as soon as it is available.
+   */
+  void analyzeJsonBatch(const std::shared_ptr<Client> &client,
+                        const BaseLib::PVariable &batch,
+                        PacketType::Enum responseType,
+                        bool keepAlive);
+
   void analyzeRPCResponse(const std::shared_ptr<Client> &client,
                           const std::vector<char> &packet,
                           PacketType::Enum packetType,
@@ -191,11 +347,20 @@ class RpcServer {
                   PacketType::Enum responseType,
                   bool keepAlive);
 
+  /**
+   * Executes a method supporting streaming and sends its result to a JSON-RPC client while it is generated.
+   */
+  void sendStreamedResponse(const std::shared_ptr<Client> &client,
+                            StreamingRpcMethod &method,
+                            const BaseLib::PArray &parameters,
+                            int32_t messageId,
+                            bool keepAlive);
+
   static std::string getHttpResponseHeader(const std::string &contentType, uint32_t contentLength, bool closeConnection);
 
   void closeClientConnection(std::shared_ptr<Client> client);
 
-  bool clientValid(std::shared_ptr<Client> &client);
+  bool clientValid(const std::shared_ptr<Client> &client);
 };
 
 }
@@ -0,0 +1,133 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_VARIABLECACHE_H_
+#define HOMEGEAR_VARIABLECACHE_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Homegear::Rpc {
+
+/**
+ * Identifies a variable of a peer channel or, with "peerId" 0, a system variable.
+ */
+struct VariableCacheKey {
+  uint64_t peerId = 0;
+  int32_t channel = -1;
+  std::string variable;
+
+  bool operator==(const VariableCacheKey &other) const { return peerId == other.peerId && channel == other.channel && variable == other.variable; }
+};
+
+struct VariableCacheKeyHash {
+  size_t operator()(const VariableCacheKey &key) const {
+    size_t hash = std::hash<std::string>()(key.variable);
+    hash ^= std::hash<uint64_t>()(key.peerId) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<int32_t>()(key.channel) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+  }
+};
+
+/**
+ * Map from variables to cached values holding at most "maxEntries" entries. When full, all entries are discarded, as
+ * the values are cheap to recompute and tracking usage would cost more than it saves. Not thread safe.
+ */
+template<typename Value>
+class BoundedVariableCache {
+ public:
+  explicit BoundedVariableCache(size_t maxEntries) : _maxEntries(maxEntries) {}
+
+  /**
+   * Returns the cached value or nullptr.
+   */
+  const Value *find(const VariableCacheKey &key) const {
+    auto entryIterator = _entries.find(key);
+    return entryIterator == _entries.end() ? nullptr : &entryIterator->second;
+  }
+
+  void set(const VariableCacheKey &key, Value value) {
+    auto entryIterator = _entries.find(key);
+    if (entryIterator != _entries.end()) {
+      entryIterator->second = std::move(value);
+      return;
+    }
+    if (_entries.size() >= _maxEntries) _entries.clear();
+    _entries.emplace(key, std::move(value));
+  }
+
+  void clear() { _entries.clear(); }
+ private:
+  size_t _maxEntries;
+  std::unordered_map<VariableCacheKey, Value, VariableCacheKeyHash> _entries;
+};
+
+/**
+ * Base class of caches which are invalidated after RPC methods changing the cached data.
+ *
+ * Values are computed outside of the cache's lock. To not store a value computed from outdated data, read
+ * generation() before computing it and only store it when no invalidation happened in the meantime.
+ */
+class InvalidatingCache {
+ public:
+  explicit InvalidatingCache(std::unordered_set<std::string> invalidatingMethods) : _invalidatingMethods(std::move(invalidatingMethods)) {}
+  virtual ~InvalidatingCache() = default;
+
+  /**
+   * Discards all cached values.
+   */
+  virtual void invalidate() = 0;
+
+  /**
+   * Calls invalidate() when the RPC method might have changed cached data.
+   */
+  void rpcMethodInvoked(const std::string &methodName) {
+    if (_invalidatingMethods.find(methodName) != _invalidatingMethods.end()) invalidate();
+  }
+
+  uint64_t generation() const { return _generation; }
+ protected:
+  /**
+   * Incremented on every invalidation.
+   */
+  std::atomic<uint64_t> _generation{0};
+ private:
+  const std::unordered_set<std::string> _invalidatingMethods;
+
+  InvalidatingCache(const InvalidatingCache &);
+  InvalidatingCache &operator=(const InvalidatingCache &);
+};
+
+}
+
+#endif
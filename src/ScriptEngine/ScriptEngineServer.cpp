@@ -39,6 +39,7 @@
 #include "../RPC/RpcMethods/NodeBlueRpcMethods.h"
 #include "../RPC/RpcMethods/MaintenanceRpcMethods.h"
 #include "../RPC/RpcMethods/BuildingPartRpcMethods.h"
+#include "../RPC/RpcMethods/HistoryRpcMethods.h"
 
 #include <homegear-base/BaseLib.h>
 #include <homegear-base/Managers/ProcessManager.h>
@@ -272,6 +273,11 @@ ScriptEngineServer::ScriptEngineServer() : IQueue(GD::bl.get(), 3, 100000) {
     _rpcMethods.emplace("updateCategory", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new Rpc::RPCUpdateCategory()));
   }
 
+  { // History
+    _rpcMethods.emplace("getVariableHistory", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new RpcMethods::RPCGetVariableHistory()));
+    _rpcMethods.emplace("getVariableHistoryAggregate", std::shared_ptr<BaseLib::Rpc::RpcMethod>(new RpcMethods::RPCGetVariableHistoryAggregate()));
+  }
+
   { // System variables
     _rpcMethods.emplace("addRoleToSystemVariable", std::static_pointer_cast<BaseLib::Rpc::RpcMethod>(std::make_shared<Rpc::RPCAddRoleToSystemVariable>()));
     _rpcMethods.emplace("getSystemVariablesInRole", std::static_pointer_cast<BaseLib::Rpc::RpcMethod>(std::make_shared<Rpc::RPCGetSystemVariablesInRole>()));
@@ -336,6 +342,8 @@ ScriptEngineServer::ScriptEngineServer() : IQueue(GD::bl.get(), 3, 100000) {
   { // Maintenance
     _rpcMethods.emplace("enableMaintenanceMode", std::make_shared<RpcMethods::RpcEnableMaintenanceMode>());
     _rpcMethods.emplace("disableMaintenanceMode", std::make_shared<RpcMethods::RpcDisableMaintenanceMode>());
+    _rpcMethods.emplace("startDatabaseBackup", std::make_shared<RpcMethods::RpcStartDatabaseBackup>());
+    _rpcMethods.emplace("getDatabaseBackupStatus", std::make_shared<RpcMethods::RpcGetDatabaseBackupStatus>());
   }
 
   _localRpcMethods.emplace("generateWebSshToken", std::bind(&ScriptEngineServer::generateWebSshToken, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -871,12 +879,7 @@ void ScriptEngineServer::broadcastEvent(std::string &source, uint64_t id, int32_
     bool checkAcls = _scriptEngineClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesDevicesReadSet();
     std::shared_ptr<BaseLib::Systems::Peer> peer;
     if (checkAcls) {
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (auto &family: families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) peer = central->getPeer(id);
-        if (peer) break;
-      }
+      peer = GD::familyController->getPeer(id);
 
       if (!peer) return;
 
@@ -888,12 +891,12 @@ void ScriptEngineServer::broadcastEvent(std::string &source, uint64_t id, int32_
         if (id == 0) {
           if (_scriptEngineClientInfo->acls->variablesBuildingPartsRoomsCategoriesRolesReadSet()) {
             auto systemVariable = GD::systemVariableController->getInternal(variables->at(i));
-            if (systemVariable && _scriptEngineClientInfo->acls->checkSystemVariableReadAccess(systemVariable)) {
+            if (systemVariable && GD::aclCache.checkSystemVariableReadAccess(_scriptEngineClientInfo->acls, systemVariable)) {
               newVariables->push_back(variables->at(i));
               newValues->push_back(values->at(i));
             }
           }
-        } else if (peer && _scriptEngineClientInfo->acls->checkVariableReadAccess(peer, channel, variables->at(i))) {
+        } else if (peer && GD::aclCache.checkVariableReadAccess(_scriptEngineClientInfo->acls, peer, channel, variables->at(i))) {
           newVariables->push_back(variables->at(i));
           newValues->push_back(values->at(i));
         }
@@ -910,16 +913,24 @@ void ScriptEngineServer::broadcastEvent(std::string &source, uint64_t id, int32_
         clients.push_back(client.second);
       }
     }
+    if (clients.empty()) return;
+
+    auto parameters = std::make_shared<BaseLib::Array>();
+    parameters->reserve(5);
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
+    parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
+
+    //Encoded once for all clients. Only the packet ID is written per client.
+    auto broadcastRequest = std::make_shared<const Rpc::BroadcastRequest>(*_rpcEncoder, "broadcastEvent", BaseLib::Array{std::make_shared<BaseLib::Variable>(false), std::make_shared<BaseLib::Variable>(parameters)});
+    if (!broadcastRequest->isValid()) broadcastRequest.reset();
 
     for (auto &client: clients) {
-      auto parameters = std::make_shared<BaseLib::Array>();
-      parameters->reserve(5);
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(source));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(id));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(channel));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(*variables));
-      parameters->emplace_back(std::make_shared<BaseLib::Variable>(values));
-      std::shared_ptr<BaseLib::IQueueEntry> queueEntry = std::make_shared<QueueEntry>(client, "broadcastEvent", parameters);
+      std::shared_ptr<BaseLib::IQueueEntry> queueEntry;
+      if (broadcastRequest) queueEntry = std::make_shared<QueueEntry>(client, broadcastRequest, parameters);
+      else queueEntry = std::make_shared<QueueEntry>(client, "broadcastEvent", parameters);
       if (!enqueue(2, queueEntry)) printQueueFullError(_out, "Error: Could not queue RPC method call \"broadcastEvent\". Queue is full.");
     }
   }
@@ -940,16 +951,11 @@ void ScriptEngineServer::broadcastServiceMessage(const BaseLib::PServiceMessage
     std::shared_ptr<BaseLib::Systems::Peer> peer;
 
     if (serviceMessage->peerId > 0) {
-      auto families = GD::familyController->getFamilies();
-      for (auto &family: families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) peer = central->getPeer(serviceMessage->peerId);
-        if (peer) break;
-      }
+      peer = GD::familyController->getPeer(serviceMessage->peerId);
       if (!peer) return;
     }
 
-    if (checkAcls && peer && !serviceMessage->variable.empty() && !_scriptEngineClientInfo->acls->checkVariableReadAccess(peer, serviceMessage->channel, serviceMessage->variable)) {
+    if (checkAcls && peer && !serviceMessage->variable.empty() && !GD::aclCache.checkVariableReadAccess(_scriptEngineClientInfo->acls, peer, serviceMessage->channel, serviceMessage->variable)) {
       return;
     }
 
@@ -1052,13 +1058,8 @@ void ScriptEngineServer::broadcastUpdateDevice(uint64_t id, int32_t channel, int
 
     if (!_scriptEngineClientInfo->acls->checkEventServerMethodAccess("updateDevice")) return;
     if (_scriptEngineClientInfo->acls->buildingPartsRoomsCategoriesRolesDevicesReadSet()) {
-      std::shared_ptr<BaseLib::Systems::Peer> peer;
-      std::map<int32_t, std::shared_ptr<BaseLib::Systems::DeviceFamily>> families = GD::familyController->getFamilies();
-      for (auto &family: families) {
-        std::shared_ptr<BaseLib::Systems::ICentral> central = family.second->getCentral();
-        if (central) peer = central->getPeer(id);
-        if (!peer || !_scriptEngineClientInfo->acls->checkDeviceReadAccess(peer)) return;
-      }
+      auto peer = GD::familyController->getPeer(id);
+      if (!peer || !_scriptEngineClientInfo->acls->checkDeviceReadAccess(peer)) return;
     }
 
     std::vector<PScriptEngineClientData> clients;
@@ -1331,6 +1332,8 @@ void ScriptEngineServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLi
       }
 
       BaseLib::PVariable result = _rpcMethods.at(queueEntry->methodName)->invoke(scriptInfo->clientInfo, queueEntry->parameters->at(3)->arrayValue);
+      GD::aclCache.rpcMethodInvoked(queueEntry->methodName);
+      if (GD::nodeBlueServer) GD::nodeBlueServer->rpcMethodInvoked(queueEntry->methodName);
       if (GD::bl->debugLevel >= 5) {
         _out.printDebug("Response: ");
         result->print(true, false);
@@ -1359,7 +1362,7 @@ void ScriptEngineServer::processQueueEntry(int32_t index, std::shared_ptr<BaseLi
       queueEntry->clientData->requestConditionVariable.notify_all();
     } else if (index == 2) //Second queue for sending packets. Response is processed by first queue
     {
-      sendRequest(queueEntry->clientData, queueEntry->methodName, queueEntry->parameters, false);
+      sendRequest(queueEntry->clientData, queueEntry->methodName, queueEntry->parameters, false, queueEntry->broadcastRequest);
     }
   }
   catch (const std::exception &ex) {
@@ -1393,7 +1396,24 @@ BaseLib::PVariable ScriptEngineServer::send(PScriptEngineClientData &clientData,
   return BaseLib::PVariable(new BaseLib::Variable());
 }
 
-BaseLib::PVariable ScriptEngineServer::sendRequest(PScriptEngineClientData &clientData, std::string methodName, const BaseLib::PArray &parameters, bool wait) {
+BaseLib::PVariable ScriptEngineServer::send(PScriptEngineClientData &clientData, const Rpc::BroadcastRequest &broadcastRequest, int32_t packetId) {
+  try {
+    std::lock_guard<std::mutex> sendGuard(clientData->sendMutex);
+    if (!broadcastRequest.send(clientData->fileDescriptor->descriptor, packetId)) {
+      if (clientData->fileDescriptor->descriptor != -1) _out.printError("Could not send data to client: " + std::to_string(clientData->fileDescriptor->descriptor));
+      return BaseLib::Variable::createError(-32500, "Unknown application error.");
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return BaseLib::PVariable(new BaseLib::Variable());
+}
+
+BaseLib::PVariable ScriptEngineServer::sendRequest(PScriptEngineClientData &clientData, std::string methodName, const BaseLib::PArray &parameters, bool wait, const Rpc::PBroadcastRequest &broadcastRequest) {
   try {
     lifetick_1_.first = BaseLib::HelperFunctions::getTime();
     lifetick_1_.second = false;
@@ -1404,13 +1424,17 @@ BaseLib::PVariable ScriptEngineServer::sendRequest(PScriptEngineClientData &clie
       std::lock_guard<std::mutex> packetIdGuard(_packetIdMutex);
       packetId = _currentPacketId++;
     }
-    BaseLib::PArray array = std::make_shared<BaseLib::Array>();
-    array->reserve(3);
-    array->push_back(std::make_shared<BaseLib::Variable>(packetId));
-    array->push_back(std::make_shared<BaseLib::Variable>(wait));
-    array->push_back(std::make_shared<BaseLib::Variable>(parameters));
+    //Broadcasts are sent from the shared encoded request, see send().
+    bool sendBroadcastRequest = broadcastRequest && !wait;
     std::vector<char> data;
-    _rpcEncoder->encodeRequest(methodName, array, data);
+    if (!sendBroadcastRequest) {
+      BaseLib::PArray array = std::make_shared<BaseLib::Array>();
+      array->reserve(3);
+      array->push_back(std::make_shared<BaseLib::Variable>(packetId));
+      array->push_back(std::make_shared<BaseLib::Variable>(wait));
+      array->push_back(std::make_shared<BaseLib::Variable>(parameters));
+      _rpcEncoder->encodeRequest(methodName, array, data);
+    }
 
     PScriptEngineResponse response;
     if (wait) {
@@ -1425,10 +1449,13 @@ BaseLib::PVariable ScriptEngineServer::sendRequest(PScriptEngineClientData &clie
       }
     }
 
-    if (GD::ipcLogger->enabled()) GD::ipcLogger->log(IpcModule::scriptEngine, packetId, clientData->pid, IpcLoggerPacketDirection::toClient, data);
+    if (GD::ipcLogger->enabled()) {
+      if (sendBroadcastRequest) broadcastRequest->getData(packetId, data);
+      GD::ipcLogger->log(IpcModule::scriptEngine, packetId, clientData->pid, IpcLoggerPacketDirection::toClient, data);
+    }
 
     std::unique_lock<std::mutex> waitLock(clientData->waitMutex);
-    BaseLib::PVariable result = send(clientData, data);
+    BaseLib::PVariable result = sendBroadcastRequest ? send(clientData, *broadcastRequest, packetId) : send(clientData, data);
     if (result->errorStruct || !wait) {
       std::lock_guard<std::mutex> responseGuard(clientData->rpcResponsesMutex);
       clientData->rpcResponses.erase(packetId);
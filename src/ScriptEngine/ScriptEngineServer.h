@@ -34,6 +34,7 @@
 #ifndef NO_SCRIPTENGINE
 
 #include "ScriptEngineProcess.h"
+#include "../RPC/BroadcastRequest.h"
 #include <homegear-base/BaseLib.h>
 
 #include <sys/types.h>
@@ -129,12 +130,24 @@ class ScriptEngineServer : public BaseLib::IQueue {
       this->parameters = parameters;
     }
 
+    QueueEntry(const PScriptEngineClientData &clientData, const Rpc::PBroadcastRequest &broadcastRequest, const BaseLib::PArray &parameters) {
+      this->time = BaseLib::HelperFunctions::getTime();
+      this->clientData = clientData;
+      this->methodName = broadcastRequest->getMethodName();
+      this->parameters = parameters;
+      this->broadcastRequest = broadcastRequest;
+    }
+
     int64_t time = 0;
     PScriptEngineClientData clientData;
 
     // {{{ Request
     std::string methodName;
     BaseLib::PArray parameters;
+    /**
+     * Set when the request was encoded once for all clients.
+     */
+    Rpc::PBroadcastRequest broadcastRequest;
     // }}}
 
     // {{{ Response
@@ -204,7 +217,12 @@ class ScriptEngineServer : public BaseLib::IQueue {
 
   BaseLib::PVariable send(PScriptEngineClientData &clientData, std::vector<char> &data);
 
-  BaseLib::PVariable sendRequest(PScriptEngineClientData &clientData, std::string methodName, const BaseLib::PArray &parameters, bool wait);
+  /**
+   * Sends the shared encoded request of a broadcast with the packet ID of this client.
+   */
+  BaseLib::PVariable send(PScriptEngineClientData &clientData, const Rpc::BroadcastRequest &broadcastRequest, int32_t packetId);
+
+  BaseLib::PVariable sendRequest(PScriptEngineClientData &clientData, std::string methodName, const BaseLib::PArray &parameters, bool wait, const Rpc::PBroadcastRequest &broadcastRequest = Rpc::PBroadcastRequest());
 
   void sendResponse(PScriptEngineClientData &clientData, BaseLib::PVariable &scriptId, BaseLib::PVariable &packetId, BaseLib::PVariable &variable);
 
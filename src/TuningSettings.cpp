@@ -0,0 +1,286 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "TuningSettings.h"
+#include "GD/GD.h"
+
+namespace Homegear {
+
+TuningSettings::TuningSettings() = default;
+
+void TuningSettings::reset() {
+  // {{{ Database
+  _databaseGroupCommit = false;
+  _databaseGroupCommitMaxBatchSize = 1000;
+  _databaseGroupCommitMaxLatency = 100;
+  _factoryDatabaseTables.clear();
+  _databaseReadConnections = 0;
+  _databaseBackupInterval = 0;
+  _databaseBackupPagesPerStep = 100;
+  _databaseBackupStepInterval = 10;
+  _databaseDataCacheSize = 100000;
+  // }}}
+
+  // {{{ History
+  _historyEnabled = false;
+  _historySegmentDuration = 3600;
+  _historyFlushInterval = 60;
+  _historyRetention = 365;
+  _historyDownsamplingAge = 30;
+  _historyDownsamplingInterval = 300;
+  // }}}
+
+  // {{{ Event bus
+  _eventBusThreads = 0;
+  _eventBusQueueSize = 10000;
+  _eventBusOverflowPolicy = "block";
+  // }}}
+
+  // {{{ Event servers
+  _eventServerCoalescing = false;
+  _eventServerMaxBatchSize = 100;
+  _eventServerFlushDelay = 0;
+  _eventServerCollapseValues = false;
+  // }}}
+
+  // {{{ RPC server
+  _rpcServerEventDriven = false;
+  _rpcServerIoThreads = 2;
+  _rpcServerWorkerThreads = 10;
+  _rpcServerEventDrivenMaxConnections = 10000;
+  _rpcServerReadBufferSize = 16384;
+  _rpcServerMaxReadBufferSize = 1048576;
+  _rpcMulticallParallel = false;
+  _rpcMulticallThreads = 8;
+  _rpcServerMaxBatchSize = 1000;
+  _rpcServerStreamResults = false;
+  _rpcServerStreamChunkSize = 65536;
+  // }}}
+}
+
+void TuningSettings::load(const std::string &filename) {
+  try {
+    reset();
+    char input[1024];
+    FILE *fin;
+    int32_t len, ptr;
+    bool found = false;
+
+    if (!BaseLib::Io::fileExists(filename)) {
+      GD::bl->out.printDebug("Debug: " + filename + " doesn't exist. Using default tuning settings.");
+      return;
+    }
+
+    if (!(fin = fopen(filename.c_str(), "r"))) {
+      GD::bl->out.printError("Unable to open config file: " + filename + ". " + strerror(errno));
+      return;
+    }
+
+    while (fgets(input, 1024, fin)) {
+      if (input[0] == '#') continue;
+      len = strlen(input);
+      if (len < 2) continue;
+      if (input[len - 1] == '\n') input[len - 1] = '\0';
+      ptr = 0;
+      found = false;
+      while (ptr < len) {
+        if (input[ptr] == '=') {
+          found = true;
+          input[ptr++] = '\0';
+          break;
+        }
+        ptr++;
+      }
+      if (found) {
+        std::string name(input);
+        BaseLib::HelperFunctions::toLower(name);
+        BaseLib::HelperFunctions::trim(name);
+        std::string value(&input[ptr]);
+        BaseLib::HelperFunctions::trim(value);
+        // {{{ Database
+        if (name == "databasegroupcommit") {
+          _databaseGroupCommit = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): databaseGroupCommit set to " + std::to_string(_databaseGroupCommit));
+        } else if (name == "databasegroupcommitmaxbatchsize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _databaseGroupCommitMaxBatchSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseGroupCommitMaxBatchSize set to " + std::to_string(_databaseGroupCommitMaxBatchSize));
+        } else if (name == "databasegroupcommitmaxlatency") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _databaseGroupCommitMaxLatency = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseGroupCommitMaxLatency set to " + std::to_string(_databaseGroupCommitMaxLatency));
+        } else if (name == "factorydatabasetables") {
+          _factoryDatabaseTables.clear();
+          auto tables = BaseLib::HelperFunctions::splitAll(value, ',');
+          for (auto &table : tables) {
+            BaseLib::HelperFunctions::toLower(BaseLib::HelperFunctions::trim(table));
+            if (!table.empty() && table != "*") _factoryDatabaseTables.emplace(table);
+          }
+          GD::bl->out.printDebug("Debug (tuning settings): factoryDatabaseTables set to " + value);
+        } else if (name == "databasereadconnections") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _databaseReadConnections = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseReadConnections set to " + std::to_string(_databaseReadConnections));
+        } else if (name == "databasebackupinterval") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _databaseBackupInterval = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseBackupInterval set to " + std::to_string(_databaseBackupInterval));
+        } else if (name == "databasebackuppagesperstep") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _databaseBackupPagesPerStep = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseBackupPagesPerStep set to " + std::to_string(_databaseBackupPagesPerStep));
+        } else if (name == "databasebackupstepinterval") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _databaseBackupStepInterval = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseBackupStepInterval set to " + std::to_string(_databaseBackupStepInterval));
+        } else if (name == "databasedatacachesize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _databaseDataCacheSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): databaseDataCacheSize set to " + std::to_string(_databaseDataCacheSize));
+        }
+        // }}}
+        // {{{ History
+        else if (name == "historyenabled") {
+          _historyEnabled = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): historyEnabled set to " + std::to_string(_historyEnabled));
+        } else if (name == "historysegmentduration") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 60) _historySegmentDuration = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): historySegmentDuration set to " + std::to_string(_historySegmentDuration));
+        } else if (name == "historyflushinterval") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _historyFlushInterval = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): historyFlushInterval set to " + std::to_string(_historyFlushInterval));
+        } else if (name == "historyretention") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _historyRetention = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): historyRetention set to " + std::to_string(_historyRetention));
+        } else if (name == "historydownsamplingage") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _historyDownsamplingAge = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): historyDownsamplingAge set to " + std::to_string(_historyDownsamplingAge));
+        } else if (name == "historydownsamplinginterval") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _historyDownsamplingInterval = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): historyDownsamplingInterval set to " + std::to_string(_historyDownsamplingInterval));
+        }
+        // }}}
+        // {{{ Event bus
+        else if (name == "eventbusthreads") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _eventBusThreads = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): eventBusThreads set to " + std::to_string(_eventBusThreads));
+        } else if (name == "eventbusqueuesize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _eventBusQueueSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): eventBusQueueSize set to " + std::to_string(_eventBusQueueSize));
+        } else if (name == "eventbusoverflowpolicy") {
+          std::string policy = value;
+          BaseLib::HelperFunctions::toLower(policy);
+          if (policy == "dropoldest" || policy == "dropnewest" || policy == "block") _eventBusOverflowPolicy = value;
+          else GD::bl->out.printWarning("Warning (tuning settings): Unknown eventBusOverflowPolicy: " + value);
+          GD::bl->out.printDebug("Debug (tuning settings): eventBusOverflowPolicy set to " + _eventBusOverflowPolicy);
+        }
+        // }}}
+        // {{{ Event servers
+        else if (name == "eventservercoalescing") {
+          _eventServerCoalescing = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): eventServerCoalescing set to " + std::to_string(_eventServerCoalescing));
+        } else if (name == "eventservermaxbatchsize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _eventServerMaxBatchSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): eventServerMaxBatchSize set to " + std::to_string(_eventServerMaxBatchSize));
+        } else if (name == "eventserverflushdelay") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 0) _eventServerFlushDelay = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): eventServerFlushDelay set to " + std::to_string(_eventServerFlushDelay));
+        } else if (name == "eventservercollapsevalues") {
+          _eventServerCollapseValues = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): eventServerCollapseValues set to " + std::to_string(_eventServerCollapseValues));
+        }
+        // }}}
+        // {{{ RPC server
+        else if (name == "rpcservereventdriven") {
+          _rpcServerEventDriven = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerEventDriven set to " + std::to_string(_rpcServerEventDriven));
+        } else if (name == "rpcserveriothreads") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _rpcServerIoThreads = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerIoThreads set to " + std::to_string(_rpcServerIoThreads));
+        } else if (name == "rpcserverworkerthreads") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _rpcServerWorkerThreads = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerWorkerThreads set to " + std::to_string(_rpcServerWorkerThreads));
+        } else if (name == "rpcservereventdrivenmaxconnections") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _rpcServerEventDrivenMaxConnections = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerEventDrivenMaxConnections set to " + std::to_string(_rpcServerEventDrivenMaxConnections));
+        } else if (name == "rpcserverreadbuffersize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 1024) _rpcServerReadBufferSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerReadBufferSize set to " + std::to_string(_rpcServerReadBufferSize));
+        } else if (name == "rpcservermaxreadbuffersize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 1024) _rpcServerMaxReadBufferSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerMaxReadBufferSize set to " + std::to_string(_rpcServerMaxReadBufferSize));
+        } else if (name == "rpcmulticallparallel") {
+          _rpcMulticallParallel = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): rpcMulticallParallel set to " + std::to_string(_rpcMulticallParallel));
+        } else if (name == "rpcmulticallthreads") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _rpcMulticallThreads = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcMulticallThreads set to " + std::to_string(_rpcMulticallThreads));
+        } else if (name == "rpcservermaxbatchsize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue > 0) _rpcServerMaxBatchSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerMaxBatchSize set to " + std::to_string(_rpcServerMaxBatchSize));
+        } else if (name == "rpcserverstreamresults") {
+          _rpcServerStreamResults = (BaseLib::HelperFunctions::toLower(value) == "true");
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerStreamResults set to " + std::to_string(_rpcServerStreamResults));
+        } else if (name == "rpcserverstreamchunksize") {
+          int32_t integerValue = BaseLib::Math::getNumber(value, false);
+          if (integerValue >= 1024) _rpcServerStreamChunkSize = integerValue;
+          GD::bl->out.printDebug("Debug (tuning settings): rpcServerStreamChunkSize set to " + std::to_string(_rpcServerStreamChunkSize));
+        }
+        // }}}
+        else {
+          GD::bl->out.printWarning("Warning: Setting not found: " + std::string(input));
+        }
+      }
+    }
+
+    fclose(fin);
+  }
+  catch (const std::exception &ex) {
+    GD::bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+}
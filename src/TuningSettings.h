@@ -0,0 +1,183 @@
+/* Copyright 2013-2020 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ * 
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with Homegear.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ * 
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef HOMEGEAR_TUNINGSETTINGS_H_
+#define HOMEGEAR_TUNINGSETTINGS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <string>
+#include <cstring>
+#include <unordered_set>
+
+namespace Homegear {
+
+/**
+ * Performance related settings read from "tuning.conf" in the configuration directory. The file is optional. When it
+ * doesn't exist, the defaults are used.
+ */
+class TuningSettings {
+ public:
+  TuningSettings();
+
+  virtual ~TuningSettings() = default;
+
+  void load(const std::string &filename);
+
+  // {{{ Database
+  bool databaseGroupCommit() { return _databaseGroupCommit; }
+
+  uint32_t databaseGroupCommitMaxBatchSize() { return _databaseGroupCommitMaxBatchSize; }
+
+  uint32_t databaseGroupCommitMaxLatency() { return _databaseGroupCommitMaxLatency; }
+
+  std::unordered_set<std::string> factoryDatabaseTables() { return _factoryDatabaseTables; }
+
+  uint32_t databaseReadConnections() { return _databaseReadConnections; }
+
+  uint32_t databaseBackupInterval() { return _databaseBackupInterval; }
+
+  uint32_t databaseBackupPagesPerStep() { return _databaseBackupPagesPerStep; }
+
+  uint32_t databaseBackupStepInterval() { return _databaseBackupStepInterval; }
+
+  uint32_t databaseDataCacheSize() { return _databaseDataCacheSize; }
+  // }}}
+
+  // {{{ History
+  bool historyEnabled() { return _historyEnabled; }
+
+  uint32_t historySegmentDuration() { return _historySegmentDuration; }
+
+  uint32_t historyFlushInterval() { return _historyFlushInterval; }
+
+  uint32_t historyRetention() { return _historyRetention; }
+
+  uint32_t historyDownsamplingAge() { return _historyDownsamplingAge; }
+
+  uint32_t historyDownsamplingInterval() { return _historyDownsamplingInterval; }
+  // }}}
+
+  // {{{ Event bus
+  uint32_t eventBusThreads() { return _eventBusThreads; }
+
+  uint32_t eventBusQueueSize() { return _eventBusQueueSize; }
+
+  std::string eventBusOverflowPolicy() { return _eventBusOverflowPolicy; }
+  // }}}
+
+  // {{{ Event servers
+  bool eventServerCoalescing() { return _eventServerCoalescing; }
+
+  uint32_t eventServerMaxBatchSize() { return _eventServerMaxBatchSize; }
+
+  uint32_t eventServerFlushDelay() { return _eventServerFlushDelay; }
+
+  bool eventServerCollapseValues() { return _eventServerCollapseValues; }
+  // }}}
+
+  // {{{ RPC server
+  bool rpcServerEventDriven() { return _rpcServerEventDriven; }
+
+  uint32_t rpcServerIoThreads() { return _rpcServerIoThreads; }
+
+  uint32_t rpcServerWorkerThreads() { return _rpcServerWorkerThreads; }
+
+  uint32_t rpcServerEventDrivenMaxConnections() { return _rpcServerEventDrivenMaxConnections; }
+
+  uint32_t rpcServerReadBufferSize() { return _rpcServerReadBufferSize; }
+
+  uint32_t rpcServerMaxReadBufferSize() { return _rpcServerMaxReadBufferSize; }
+
+  bool rpcMulticallParallel() { return _rpcMulticallParallel; }
+
+  uint32_t rpcMulticallThreads() { return _rpcMulticallThreads; }
+
+  uint32_t rpcServerMaxBatchSize() { return _rpcServerMaxBatchSize; }
+
+  bool rpcServerStreamResults() { return _rpcServerStreamResults; }
+
+  uint32_t rpcServerStreamChunkSize() { return _rpcServerStreamChunkSize; }
+  // }}}
+ private:
+  // {{{ Database
+  bool _databaseGroupCommit = false;
+  uint32_t _databaseGroupCommitMaxBatchSize = 1000;
+  uint32_t _databaseGroupCommitMaxLatency = 100;
+  std::unordered_set<std::string> _factoryDatabaseTables;
+  uint32_t _databaseReadConnections = 0;
+  uint32_t _databaseBackupInterval = 0;
+  uint32_t _databaseBackupPagesPerStep = 100;
+  uint32_t _databaseBackupStepInterval = 10;
+  uint32_t _databaseDataCacheSize = 100000;
+  // }}}
+
+  // {{{ History
+  bool _historyEnabled = false;
+  uint32_t _historySegmentDuration = 3600;
+  uint32_t _historyFlushInterval = 60;
+  uint32_t _historyRetention = 365;
+  uint32_t _historyDownsamplingAge = 30;
+  uint32_t _historyDownsamplingInterval = 300;
+  // }}}
+
+  // {{{ Event bus
+  uint32_t _eventBusThreads = 0;
+  uint32_t _eventBusQueueSize = 10000;
+  std::string _eventBusOverflowPolicy = "block";
+  // }}}
+
+  // {{{ Event servers
+  bool _eventServerCoalescing = false;
+  uint32_t _eventServerMaxBatchSize = 100;
+  uint32_t _eventServerFlushDelay = 0;
+  bool _eventServerCollapseValues = false;
+  // }}}
+
+  // {{{ RPC server
+  bool _rpcServerEventDriven = false;
+  uint32_t _rpcServerIoThreads = 2;
+  uint32_t _rpcServerWorkerThreads = 10;
+  uint32_t _rpcServerEventDrivenMaxConnections = 10000;
+  uint32_t _rpcServerReadBufferSize = 16384;
+  uint32_t _rpcServerMaxReadBufferSize = 1048576;
+  bool _rpcMulticallParallel = false;
+  uint32_t _rpcMulticallThreads = 8;
+  uint32_t _rpcServerMaxBatchSize = 1000;
+  bool _rpcServerStreamResults = false;
+  uint32_t _rpcServerStreamChunkSize = 65536;
+  // }}}
+
+  void reset();
+};
+
+}
+
+#endif
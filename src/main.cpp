@@ -90,6 +90,7 @@ void exitHomegear(int exitCode) {
 
 void loadSettings(bool hideOutput = false) {
   GD::bl->settings.load(GD::configPath + "main.conf", GD::executablePath, hideOutput);
+  GD::tuningSettings.load(GD::configPath + "tuning.conf");
 }
 
 void bindRPCServers() {
@@ -170,6 +171,8 @@ void terminateHomegear(int signalNumber) {
     if (GD::rpcClient) GD::rpcClient->dispose();
     GD::out.printInfo("(Shutdown) => Closing physical interfaces...");
     if (GD::familyController) GD::familyController->physicalInterfaceStopListening();
+    GD::out.printInfo("(Shutdown) => Stopping event bus...");
+    if (GD::familyController) GD::familyController->stopEventBus();
     if (GD::bl->hgdc) {
       GD::out.printInfo("(Shutdown) => Stopping Homegear Daisy Chain client...");
       if (GD::bl->hgdc) GD::bl->hgdc->stop();
@@ -183,10 +186,15 @@ void terminateHomegear(int signalNumber) {
     GD::out.printInfo("(Shutdown) => Stopping script engine server...");
     if (GD::scriptEngineServer) GD::scriptEngineServer->stop();
     #endif
+    if (GD::multicallExecutor) GD::multicallExecutor->stop();
     GD::out.printMessage("(Shutdown) => Saving device families");
     if (GD::familyController) GD::familyController->save(false);
     GD::out.printMessage("(Shutdown) => Disposing device families");
     if (GD::familyController) GD::familyController->disposeDeviceFamilies();
+    if (GD::historyStore) {
+      GD::out.printMessage("(Shutdown) => Stopping history store");
+      GD::historyStore->stop();
+    }
     if (GD::bl->hgdc) {
       GD::out.printMessage("(Shutdown) => Disposing Homegear Daisy Chain client...");
       GD::bl->hgdc.reset();
@@ -831,6 +839,12 @@ void startUp() {
 
     GD::variableProfileManager = std::make_unique<VariableProfileManager>();
 
+    GD::historyStore = std::make_unique<HistoryStore>();
+    GD::historyStore->start();
+
+    GD::multicallExecutor = std::make_unique<Rpc::MulticallExecutor>();
+    GD::multicallExecutor->start();
+
     GD::ipcLogger = std::make_unique<IpcLogger>();
 
     GD::nodeBlueServer = std::make_unique<NodeBlue::NodeBlueServer>();
@@ -868,6 +882,7 @@ void startUp() {
 
     GD::out.printInfo("Loading devices...");
     if (BaseLib::Io::fileExists(GD::configPath + "physicalinterfaces.conf")) GD::out.printWarning("Warning: File physicalinterfaces.conf exists in config directory. Interface configuration has been moved to " + GD::bl->settings.familyConfigPath());
+    GD::familyController->startEventBus();
     GD::familyController->load(); //Don't load before database is open!
 
     GD::out.printInfo("Initializing RPC client...");